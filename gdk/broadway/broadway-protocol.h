@@ -238,6 +238,22 @@ typedef struct {
   guint32 parent;
 } BroadwayRequestSetTransientFor;
 
+/* The data of an uploaded texture is a PNG or JPEG image, or starts
+ * with one of these. All numbers are little-endian uint32.
+ *
+ * BROADWAY_TEXTURE_MAGIC_RAW is followed by the width and height and
+ * a zlib stream of the unpremultiplied RGBA rows.
+ *
+ * BROADWAY_TEXTURE_MAGIC_DELTA is followed by the id of a texture
+ * of the same size, which it replaces some tiles of, and the number
+ * of tiles. Each tile is its x and y position, the size of its data
+ * and the data, which is in one of the other formats. Sync changes
+ * with broadway.js.
+ */
+#define BROADWAY_TEXTURE_MAGIC_RAW "BRDZ"
+#define BROADWAY_TEXTURE_MAGIC_DELTA "BRDD"
+#define BROADWAY_TEXTURE_MAGIC_SIZE 4
+
 typedef struct {
   BroadwayRequestBase base;
   guint32 id;
@@ -135,6 +135,8 @@ struct BroadwaySurface {
 struct _BroadwayTexture {
   grefcount refcount;
   guint32 id;
+  /* The texture a delta applies to, which we keep alive */
+  guint32 base_id;
   GBytes *bytes;
 };
 
@@ -1910,6 +1912,16 @@ broadway_server_upload_texture (BroadwayServer   *server,
   texture->id = ++server->next_texture_id;
   texture->bytes = g_bytes_ref (bytes);
 
+  if (g_bytes_get_size (bytes) >= BROADWAY_TEXTURE_MAGIC_SIZE + 4 &&
+      memcmp (g_bytes_get_data (bytes, NULL), BROADWAY_TEXTURE_MAGIC_DELTA, BROADWAY_TEXTURE_MAGIC_SIZE) == 0)
+    {
+      guint32 base_id;
+
+      memcpy (&base_id, (const char *) g_bytes_get_data (bytes, NULL) + BROADWAY_TEXTURE_MAGIC_SIZE, sizeof (guint32));
+      texture->base_id = GUINT32_FROM_LE (base_id);
+      broadway_server_ref_texture (server, texture->base_id);
+    }
+
   g_hash_table_replace (server->textures,
                         GINT_TO_POINTER (texture->id),
                         texture);
@@ -1941,10 +1953,15 @@ broadway_server_release_texture (BroadwayServer   *server,
 
   if (texture && g_ref_count_dec (&texture->refcount))
     {
+      guint32 base_id = texture->base_id;
+
       g_hash_table_remove (server->textures, GINT_TO_POINTER (id));
 
       if (server->output)
         broadway_output_release_texture (server->output, id);
+
+      if (base_id)
+        broadway_server_release_texture (server, base_id);
     }
 }
 
@@ -2110,25 +2127,37 @@ broadway_server_new_surface (BroadwayServer *server,
   return surface->id;
 }
 
+static int
+compare_texture_ids (gconstpointer a,
+                     gconstpointer b)
+{
+  const BroadwayTexture *ta = a;
+  const BroadwayTexture *tb = b;
+
+  return ta->id < tb->id ? -1 : (ta->id > tb->id ? 1 : 0);
+}
+
 static void
 broadway_server_resync_surfaces (BroadwayServer *server)
 {
-  GHashTableIter iter;
-  gpointer key, value;
+  GList *textures;
   GList *l;
 
   if (server->output == NULL)
     return;
 
-  /* First upload all textures */
-  g_hash_table_iter_init (&iter, server->textures);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  /* First upload all textures, in the order they were created
+   * so that deltas come after their base.
+   */
+  textures = g_list_sort (g_hash_table_get_values (server->textures), compare_texture_ids);
+  for (l = textures; l != NULL; l = l->next)
     {
-      BroadwayTexture *texture = value;
+      BroadwayTexture *texture = l->data;
       broadway_output_upload_texture (server->output,
-                                      GPOINTER_TO_INT (key),
+                                      texture->id,
                                       texture->bytes);
     }
+  g_list_free (textures);
 
   /* Then create all surfaces */
   for (l = server->surfaces; l != NULL; l = l->next)
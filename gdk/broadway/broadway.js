@@ -119,14 +119,14 @@ function encodeBase64Chunk (uint8, start, end) {
     return output.join('');
 }
 
-function bytesToDataUri(uint8) {
+function bytesToDataUri(uint8, type) {
     var tmp;
     var len = uint8.length;
     var extraBytes = len % 3; // if we have 1 byte left, pad 2 bytes
     var parts = [];
     var maxChunkLength = 16383; // must be multiple of 3
 
-    parts.push("data:image/png;base64,");
+    parts.push("data:" + type + ";base64,");
 
     // go through the array every three bytes, we'll deal with trailing stuff later
     for (var i = 0, len2 = len - extraBytes; i < len2; i += maxChunkLength) {
@@ -253,24 +253,128 @@ function getButtonMask (button) {
     return 0;
 }
 
+// Texture data is a PNG or JPEG image, or starts with one of these.
+// See broadway-protocol.h for the formats.
+var TEXTURE_MAGIC_RAW = 0x5a445242;   // "BRDZ"
+var TEXTURE_MAGIC_DELTA = 0x44445242; // "BRDD"
+
+function textureMagic(data) {
+    if (data.length < 4)
+        return 0;
+    return new DataView(data.buffer, data.byteOffset, data.byteLength).getUint32(0, true);
+}
+
+function imageType(data) {
+    // Lossy textures are sent as JPEG, everything else as PNG
+    if (data.length > 2 && data[0] == 0xff && data[1] == 0xd8)
+        return "image/jpeg";
+    return "image/png";
+}
+
+// Raw textures are zlib-compressed RGBA rows
+function decodeRaw(data) {
+    var view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+    var width = view.getUint32(4, true);
+    var height = view.getUint32(8, true);
+    var stream = new Blob([data.subarray(12)]).stream().pipeThrough(new DecompressionStream("deflate"));
+
+    return new Response(stream).arrayBuffer().then(
+        (buffer) => createImageBitmap(new ImageData(new Uint8ClampedArray(buffer), width, height)));
+}
+
+function decodeImage(data) {
+    if (textureMagic(data) == TEXTURE_MAGIC_RAW)
+        return decodeRaw(data);
+    return createImageBitmap(new Blob([data], {type: imageType(data)}));
+}
+
 function Texture(id, data) {
-    var url;
-    if (useDataUrls) {
-        url = bytesToDataUri(data);
+    this.url = null;
+    this.refcount = 1;
+    this.id = id;
+    textures[id] = this;
+
+    var magic = textureMagic(data);
+    if (magic == TEXTURE_MAGIC_RAW || magic == TEXTURE_MAGIC_DELTA) {
+        // These are drawn into a canvas, which then becomes the image
+        var draw = magic == TEXTURE_MAGIC_RAW ? this.drawRaw(data) : this.drawDelta(data);
+        this.decoded = draw.then((canvas) => this.setCanvas(canvas));
     } else {
-        var blob = new Blob([data],{type: "image/png"});
-        url = window.URL.createObjectURL(blob);
+        this.setUrl(this.imageUrl(data, imageType(data)));
+        this.decoded = this.image.decode();
     }
+}
+
+Texture.prototype.imageUrl = function(data, type) {
+    if (useDataUrls)
+        return bytesToDataUri(data, type);
+    return window.URL.createObjectURL(new Blob([data],{type: type}));
+}
 
+Texture.prototype.setUrl = function(url) {
     this.url = url;
-    this.refcount = 1;
-    this.id = id;
+    this.image = new Image();
+    this.image.src = url;
+}
 
-    var image = new Image();
-    image.src = this.url;
-    this.image = image;
-    this.decoded = image.decode();
-    textures[id] = this;
+Texture.prototype.setCanvas = function(canvas) {
+    if (useDataUrls) {
+        this.setUrl(canvas.toDataURL());
+        return this.image.decode();
+    }
+
+    return new Promise((resolve) => canvas.toBlob(resolve)).then(
+        (blob) => {
+            this.setUrl(window.URL.createObjectURL(blob));
+            return this.image.decode();
+        });
+}
+
+function newCanvas(width, height) {
+    var canvas = document.createElement("canvas");
+    canvas.width = width;
+    canvas.height = height;
+    return canvas;
+}
+
+Texture.prototype.drawRaw = function(data) {
+    return decodeRaw(data).then(
+        (bitmap) => {
+            var canvas = newCanvas(bitmap.width, bitmap.height);
+            canvas.getContext("2d").drawImage(bitmap, 0, 0);
+            return canvas;
+        });
+}
+
+// A delta replaces some tiles of an earlier texture
+Texture.prototype.drawDelta = function(data) {
+    var view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+    var base = textures[view.getUint32(4, true)].ref();
+    var n_tiles = view.getUint32(8, true);
+    var positions = [];
+    var decodes = [];
+    var pos = 12;
+
+    for (var i = 0; i < n_tiles; i++) {
+        var size = view.getUint32(pos + 8, true);
+        positions.push([view.getUint32(pos, true), view.getUint32(pos + 4, true)]);
+        decodes.push(decodeImage(data.subarray(pos + 12, pos + 12 + size)));
+        pos += 12 + size;
+    }
+
+    return base.decoded.then(() => Promise.all(decodes)).then(
+        (tiles) => {
+            var canvas = newCanvas(base.image.naturalWidth, base.image.naturalHeight);
+            var context = canvas.getContext("2d");
+            context.drawImage(base.image, 0, 0);
+            for (var i = 0; i < tiles.length; i++) {
+                var x = positions[i][0];
+                var y = positions[i][1];
+                context.clearRect(x, y, tiles[i].width, tiles[i].height);
+                context.drawImage(tiles[i], x, y);
+            }
+            return canvas;
+        }).finally(() => base.unref());
 }
 
 Texture.prototype.ref = function() {
@@ -281,13 +385,28 @@ Texture.prototype.ref = function() {
 Texture.prototype.unref = function() {
     this.refcount -= 1;
     if (this.refcount == 0) {
-        if (this.url.startsWith("blob")) {
+        if (this.url && this.url.startsWith("blob")) {
             window.URL.revokeObjectURL(this.url);
         }
         delete textures[this.id];
     }
 }
 
+// Drops the reference once the image has loaded. Textures that are
+// drawn into a canvas only have an url once they are decoded.
+Texture.prototype.showIn = function(image) {
+    var texture = this;
+    var show = function() {
+        image.src = texture.url;
+        image.onload = function() { texture.unref(); };
+    };
+
+    if (this.url)
+        show();
+    else
+        this.decoded.then(show, () => texture.unref());
+}
+
 function sendConfigureNotify(surface)
 {
     sendInput(BROADWAY_EVENT_CONFIGURE_NOTIFY, [surface.id, surface.x, surface.y, surface.width, surface.height]);
@@ -605,10 +724,7 @@ TransformNodes.prototype.insertNode = function(parent, previousSibling, is_tople
             image.height = rect.height;
             image.style["position"] = "absolute";
             set_rect_style(image, rect);
-            var texture = textures[texture_id].ref();
-            image.src = texture.url;
-            // Unref blob url when loaded
-            image.onload = function() { texture.unref(); };
+            textures[texture_id].ref().showIn(image);
             newNode = image;
         }
         break;
@@ -992,13 +1108,7 @@ function handleDisplayCommands(display_commands)
         case DISPLAY_OP_CHANGE_TEXTURE:
             var image = cmd[1];
             var texture = cmd[2];
-            // We need a new closure here to have a separate copy of "texture" for each iteration in the onload callback...
-            var block = function(t) {
-                image.src = t.url;
-                // Unref blob url when loaded
-                image.onload = function() { t.unref(); };
-            };
-            block(texture);
+            texture.showIn(image);
             break;
         case DISPLAY_OP_CHANGE_TRANSFORM:
             var div = cmd[1];
@@ -333,6 +333,26 @@ client_handle_request (BroadwayClient *client,
           while (to_read > 0);
           close (fd);
 
+          /* Deltas refer to their base by the client's id for it */
+          if (request->upload_texture.size >= BROADWAY_TEXTURE_MAGIC_SIZE + 4 &&
+              memcmp (data, BROADWAY_TEXTURE_MAGIC_DELTA, BROADWAY_TEXTURE_MAGIC_SIZE) == 0)
+            {
+              guint32 base_id;
+
+              memcpy (&base_id, data + BROADWAY_TEXTURE_MAGIC_SIZE, sizeof (guint32));
+              base_id = GPOINTER_TO_INT (g_hash_table_lookup (client->textures,
+                                                              GINT_TO_POINTER (GUINT32_FROM_LE (base_id))));
+              if (base_id == 0)
+                {
+                  g_warning ("Texture delta for unknown texture");
+                  g_free (data);
+                  break;
+                }
+
+              base_id = GUINT32_TO_LE (base_id);
+              memcpy (data + BROADWAY_TEXTURE_MAGIC_SIZE, &base_id, sizeof (guint32));
+            }
+
           texture = g_bytes_new_take (data, request->upload_texture.size);
           global_id = broadway_server_upload_texture (server, texture);
           g_bytes_unref (texture);
@@ -16,6 +16,7 @@
 #include "gdk-private.h"
 
 #include <gdk/gdktextureprivate.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
 
 #include <glib.h>
 #include <glib/gprintf.h>
@@ -38,12 +39,38 @@
 
 typedef struct BroadwayInput BroadwayInput;
 
+/* Textures with identical content share one id, so that
+ * we don't encode and send them to the browser again. Textures
+ * that are no longer used stay in the browser for a while, in
+ * case their content shows up again.
+ */
+typedef struct _CachedTexture CachedTexture;
+
+struct _CachedTexture {
+  guint32 id;
+  int refcount; /* 0 while in unused_textures */
+  int width;
+  int height;
+  char *checksum;
+  /* The checksums of all tiles, if deltas can be made against it */
+  guint8 *tile_checksums;
+  /* For deltas, the texture they apply to. We hold a ref on it */
+  CachedTexture *base;
+  GList unused_link;
+};
+
 struct _GdkBroadwayServer {
   GObject parent_instance;
   GdkDisplay *display;
 
   guint32 next_serial;
   guint32 next_texture_id;
+  GHashTable *textures_by_checksum; /* checksum -> CachedTexture */
+  GHashTable *textures_by_id;       /* id -> CachedTexture, owns them */
+  GHashTable *delta_bases;          /* size -> last CachedTexture with tile checksums */
+  GQueue unused_textures;           /* most recently used first */
+  gsize unused_pixels;
+  gsize bandwidth; /* bytes per second, 0 if unlimited */
   GSocketConnection *connection;
 
   guint32 recv_buffer_size;
@@ -64,16 +91,41 @@ static GType gdk_broadway_server_get_type (void);
 
 G_DEFINE_TYPE (GdkBroadwayServer, gdk_broadway_server, G_TYPE_OBJECT)
 
+static void
+cached_texture_free (CachedTexture *cached)
+{
+  g_free (cached->checksum);
+  g_free (cached->tile_checksums);
+  g_free (cached);
+}
+
 static void
 gdk_broadway_server_init (GdkBroadwayServer *server)
 {
+  const char *bandwidth;
+
   server->next_serial = 1;
   server->next_texture_id = 1;
+  server->textures_by_checksum = g_hash_table_new (g_str_hash, g_str_equal);
+  server->textures_by_id = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                  NULL, (GDestroyNotify) cached_texture_free);
+  server->delta_bases = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_queue_init (&server->unused_textures);
+
+  bandwidth = g_getenv ("BROADWAY_BANDWIDTH");
+  if (bandwidth)
+    server->bandwidth = g_ascii_strtoull (bandwidth, NULL, 10) * 1024;
 }
 
 static void
 gdk_broadway_server_finalize (GObject *object)
 {
+  GdkBroadwayServer *server = GDK_BROADWAY_SERVER (object);
+
+  g_hash_table_unref (server->textures_by_checksum);
+  g_hash_table_unref (server->delta_bases);
+  g_hash_table_unref (server->textures_by_id);
+
   G_OBJECT_CLASS (gdk_broadway_server_parent_class)->finalize (object);
 }
 
@@ -637,22 +689,518 @@ write_png_cb (void         *closure,
   return CAIRO_STATUS_SUCCESS;
 }
 
+/* Textures are split into tiles of this size, so that updates
+ * of a texture can send just the tiles that changed.
+ */
+#define TILE_SIZE 64
+#define TILE_CHECKSUM_SIZE 20 /* SHA1 */
+
+/* Smaller textures are always sent in full */
+#define MIN_DELTA_TILES 4
+
+/* How many unused textures, and how many pixels of them, we keep
+ * in the browser.
+ */
+#define MAX_UNUSED_TEXTURES 64
+#define MAX_UNUSED_PIXELS (16 * 1024 * 1024)
+
+/* Texture sizes are only estimated to pick a codec, with the rough
+ * ratios of a fast deflate and of PNG for typical UI content.
+ */
+#define RAW_COMPRESSION_RATIO 2
+#define PNG_COMPRESSION_RATIO 3
+
+/* With a bandwidth budget, textures should not take longer than this
+ * to transfer.
+ */
+#define MAX_TEXTURE_TRANSFER_MS 100
+
+typedef enum {
+  TEXTURE_CODEC_PNG,
+  TEXTURE_CODEC_RAW,
+  TEXTURE_CODEC_JPEG
+} TextureCodec;
+
+static inline int
+get_n_tiles (int size)
+{
+  return (size + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+static inline gpointer
+get_size_key (int width,
+              int height)
+{
+  return GUINT_TO_POINTER (((guint) width << 16) | (guint) height);
+}
+
+/* Returns the checksum of the whole texture, and the checksums
+ * of all its tiles in @tile_checksums.
+ */
+static char *
+compute_texture_checksums (cairo_surface_t  *surface,
+                           guint8          **tile_checksums)
+{
+  GChecksum **columns;
+  GChecksum *checksum;
+  const guchar *data;
+  guint8 *digests;
+  int width, height, stride, n_columns, n_rows, x, y, ty;
+  gsize len;
+  char *result;
+
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+
+  n_columns = get_n_tiles (width);
+  n_rows = get_n_tiles (height);
+  digests = g_malloc ((gsize) n_columns * n_rows * TILE_CHECKSUM_SIZE);
+
+  columns = g_new (GChecksum *, n_columns);
+  for (x = 0; x < n_columns; x++)
+    columns[x] = g_checksum_new (G_CHECKSUM_SHA1);
+
+  /* Do a row of tiles at a time, so the pixels are read in order */
+  for (ty = 0; ty < n_rows; ty++)
+    {
+      for (y = ty * TILE_SIZE; y < MIN (height, (ty + 1) * TILE_SIZE); y++)
+        {
+          for (x = 0; x < n_columns; x++)
+            g_checksum_update (columns[x],
+                               data + y * stride + x * TILE_SIZE * 4,
+                               MIN (TILE_SIZE, width - x * TILE_SIZE) * 4);
+        }
+
+      for (x = 0; x < n_columns; x++)
+        {
+          len = TILE_CHECKSUM_SIZE;
+          g_checksum_get_digest (columns[x],
+                                 digests + (ty * n_columns + x) * TILE_CHECKSUM_SIZE,
+                                 &len);
+          g_checksum_reset (columns[x]);
+        }
+    }
+
+  for (x = 0; x < n_columns; x++)
+    g_checksum_free (columns[x]);
+  g_free (columns);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  g_checksum_update (checksum, (const guchar *) &width, sizeof (width));
+  g_checksum_update (checksum, (const guchar *) &height, sizeof (height));
+  g_checksum_update (checksum, digests, (gsize) n_columns * n_rows * TILE_CHECKSUM_SIZE);
+  result = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  *tile_checksums = digests;
+
+  return result;
+}
+
+static gboolean
+surface_is_opaque (cairo_surface_t *surface)
+{
+  const guchar *data;
+  int width, height, stride, x, y;
+
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+
+  for (y = 0; y < height; y++)
+    {
+      const guint32 *row = (const guint32 *) (data + y * stride);
+
+      for (x = 0; x < width; x++)
+        {
+          if ((row[x] >> 24) != 0xFF)
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+/* Picks the codec before encoding anything. Without a bandwidth budget
+ * textures are sent as PNG. With one, we prefer the cheap raw encoding
+ * if its estimated size fits into the budget, then PNG, and go lossy
+ * for opaque textures that would not fit even as PNG.
+ */
+static TextureCodec
+choose_codec (GdkBroadwayServer *server,
+              cairo_surface_t   *surface,
+              gsize              n_pixels)
+{
+  gsize budget;
+
+  if (server->bandwidth == 0)
+    return TEXTURE_CODEC_PNG;
+
+  budget = server->bandwidth * MAX_TEXTURE_TRANSFER_MS / 1000;
+
+  if (n_pixels * 4 / RAW_COMPRESSION_RATIO <= budget)
+    return TEXTURE_CODEC_RAW;
+
+  if (n_pixels * 4 / PNG_COMPRESSION_RATIO <= budget ||
+      !surface_is_opaque (surface))
+    return TEXTURE_CODEC_PNG;
+
+  return TEXTURE_CODEC_JPEG;
+}
+
+static void
+append_uint32 (GByteArray *array,
+               guint32     value)
+{
+  value = GUINT32_TO_LE (value);
+  g_byte_array_append (array, (const guint8 *) &value, sizeof (guint32));
+}
+
+static cairo_status_t
+append_png_cb (void         *closure,
+               const guchar *data,
+               unsigned int  length)
+{
+  g_byte_array_append (closure, data, length);
+
+  return CAIRO_STATUS_SUCCESS;
+}
+
+static gboolean
+encode_raw (cairo_surface_t *surface,
+            GByteArray      *array)
+{
+  GConverter *compressor;
+  GConverterResult result;
+  const guchar *data;
+  guint8 *rgba, *in;
+  gsize in_left, bytes_read, bytes_written, len;
+  int width, height, stride, x, y;
+
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+
+  /* The browser wants unpremultiplied RGBA */
+  rgba = g_malloc ((gsize) width * height * 4);
+  for (y = 0; y < height; y++)
+    {
+      const guint32 *row = (const guint32 *) (data + y * stride);
+      guint8 *out = rgba + (gsize) y * width * 4;
+
+      for (x = 0; x < width; x++)
+        {
+          guint a = row[x] >> 24;
+          guint r = (row[x] >> 16) & 0xFF;
+          guint g = (row[x] >> 8) & 0xFF;
+          guint b = row[x] & 0xFF;
+
+          if (a != 0 && a != 0xFF)
+            {
+              r = (r * 255 + a / 2) / a;
+              g = (g * 255 + a / 2) / a;
+              b = (b * 255 + a / 2) / a;
+            }
+
+          out[4 * x + 0] = r;
+          out[4 * x + 1] = g;
+          out[4 * x + 2] = b;
+          out[4 * x + 3] = a;
+        }
+    }
+
+  g_byte_array_append (array, (const guint8 *) BROADWAY_TEXTURE_MAGIC_RAW, BROADWAY_TEXTURE_MAGIC_SIZE);
+  append_uint32 (array, width);
+  append_uint32 (array, height);
+
+  /* Speed matters more than size here, that's what PNG is for */
+  compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 1));
+  in = rgba;
+  in_left = (gsize) width * height * 4;
+  do
+    {
+      len = array->len;
+      g_byte_array_set_size (array, len + 65536);
+      result = g_converter_convert (compressor,
+                                    in, in_left,
+                                    array->data + len, 65536,
+                                    G_CONVERTER_INPUT_AT_END,
+                                    &bytes_read, &bytes_written,
+                                    NULL);
+      g_byte_array_set_size (array, len + bytes_written);
+      in += bytes_read;
+      in_left -= bytes_read;
+    }
+  while (result == G_CONVERTER_CONVERTED);
+
+  g_object_unref (compressor);
+  g_free (rgba);
+
+  return result == G_CONVERTER_FINISHED;
+}
+
+static gboolean
+encode_jpeg (cairo_surface_t *surface,
+             GByteArray      *array)
+{
+  GdkPixbuf *pixbuf;
+  char *buffer;
+  gsize size;
+  gboolean result;
+
+  pixbuf = gdk_pixbuf_get_from_surface (surface, 0, 0,
+                                        cairo_image_surface_get_width (surface),
+                                        cairo_image_surface_get_height (surface));
+  if (pixbuf == NULL)
+    return FALSE;
+
+  result = gdk_pixbuf_save_to_buffer (pixbuf, &buffer, &size, "jpeg", NULL,
+                                      "quality", "85",
+                                      NULL);
+  g_object_unref (pixbuf);
+
+  if (!result)
+    return FALSE;
+
+  g_byte_array_append (array, (const guint8 *) buffer, size);
+  g_free (buffer);
+
+  return TRUE;
+}
+
+/* Appends the surface to @array, PNG is the fallback if the
+ * other codecs fail. The browser detects the codec from the data.
+ */
+static void
+encode_image (cairo_surface_t *surface,
+              TextureCodec     codec,
+              GByteArray      *array)
+{
+  guint len = array->len;
+
+  if (codec == TEXTURE_CODEC_RAW && encode_raw (surface, array))
+    return;
+
+  if (codec == TEXTURE_CODEC_JPEG && encode_jpeg (surface, array))
+    return;
+
+  g_byte_array_set_size (array, len);
+  cairo_surface_write_to_png_stream (surface, append_png_cb, array);
+}
+
+static guint
+count_changed_tiles (const guint8 *old_checksums,
+                     const guint8 *new_checksums,
+                     guint         n_tiles)
+{
+  guint i, n_changed = 0;
+
+  for (i = 0; i < n_tiles; i++)
+    {
+      if (memcmp (old_checksums + i * TILE_CHECKSUM_SIZE,
+                  new_checksums + i * TILE_CHECKSUM_SIZE,
+                  TILE_CHECKSUM_SIZE) != 0)
+        n_changed++;
+    }
+
+  return n_changed;
+}
+
+/* Appends the tiles of @surface that differ from @base */
+static void
+encode_delta (GdkBroadwayServer *server,
+              cairo_surface_t   *surface,
+              CachedTexture     *base,
+              const guint8      *tile_checksums,
+              guint              n_changed,
+              GByteArray        *array)
+{
+  TextureCodec codec;
+  guchar *data;
+  int width, height, stride, n_columns, n_rows, tx, ty;
+
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+  n_columns = get_n_tiles (width);
+  n_rows = get_n_tiles (height);
+
+  codec = choose_codec (server, surface, (gsize) n_changed * TILE_SIZE * TILE_SIZE);
+
+  g_byte_array_append (array, (const guint8 *) BROADWAY_TEXTURE_MAGIC_DELTA, BROADWAY_TEXTURE_MAGIC_SIZE);
+  append_uint32 (array, base->id);
+  append_uint32 (array, n_changed);
+
+  for (ty = 0; ty < n_rows; ty++)
+    for (tx = 0; tx < n_columns; tx++)
+      {
+        guint i = (ty * n_columns + tx) * TILE_CHECKSUM_SIZE;
+        cairo_surface_t *tile;
+        guint32 size;
+        guint pos;
+        int x, y;
+
+        if (memcmp (base->tile_checksums + i, tile_checksums + i, TILE_CHECKSUM_SIZE) == 0)
+          continue;
+
+        x = tx * TILE_SIZE;
+        y = ty * TILE_SIZE;
+        tile = cairo_image_surface_create_for_data (data + y * stride + x * 4,
+                                                    CAIRO_FORMAT_ARGB32,
+                                                    MIN (TILE_SIZE, width - x),
+                                                    MIN (TILE_SIZE, height - y),
+                                                    stride);
+
+        append_uint32 (array, x);
+        append_uint32 (array, y);
+        pos = array->len;
+        append_uint32 (array, 0);
+        encode_image (tile, codec, array);
+
+        size = GUINT32_TO_LE (array->len - pos - sizeof (guint32));
+        memcpy (array->data + pos, &size, sizeof (guint32));
+
+        cairo_surface_destroy (tile);
+      }
+}
+
+static void
+cached_texture_ref (GdkBroadwayServer *server,
+                    CachedTexture     *cached)
+{
+  if (cached->refcount == 0)
+    {
+      g_queue_unlink (&server->unused_textures, &cached->unused_link);
+      server->unused_pixels -= (gsize) cached->width * cached->height;
+    }
+
+  cached->refcount++;
+}
+
+static void cached_texture_unref (GdkBroadwayServer *server,
+                                  CachedTexture     *cached);
+
+/* Removes an unused texture from the browser */
+static void
+cached_texture_destroy (GdkBroadwayServer *server,
+                        CachedTexture     *cached)
+{
+  BroadwayRequestReleaseTexture msg;
+  CachedTexture *base = cached->base;
+
+  g_queue_unlink (&server->unused_textures, &cached->unused_link);
+  server->unused_pixels -= (gsize) cached->width * cached->height;
+
+  if (g_hash_table_lookup (server->delta_bases, get_size_key (cached->width, cached->height)) == cached)
+    g_hash_table_remove (server->delta_bases, get_size_key (cached->width, cached->height));
+  g_hash_table_remove (server->textures_by_checksum, cached->checksum);
+
+  msg.id = cached->id;
+  gdk_broadway_server_send_message (server, msg,
+                                    BROADWAY_REQUEST_RELEASE_TEXTURE);
+
+  g_hash_table_remove (server->textures_by_id, GUINT_TO_POINTER (msg.id));
+
+  if (base)
+    cached_texture_unref (server, base);
+}
+
+static void
+cached_texture_unref (GdkBroadwayServer *server,
+                      CachedTexture     *cached)
+{
+  if (--cached->refcount > 0)
+    return;
+
+  g_queue_push_head_link (&server->unused_textures, &cached->unused_link);
+  server->unused_pixels += (gsize) cached->width * cached->height;
+
+  while (server->unused_textures.length > MAX_UNUSED_TEXTURES ||
+         server->unused_pixels > MAX_UNUSED_PIXELS)
+    cached_texture_destroy (server, g_queue_peek_tail (&server->unused_textures));
+}
+
 guint32
 gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
                                     GdkTexture        *texture)
 {
-  guint32 id;
+  CachedTexture *cached, *base;
   cairo_surface_t *surface = gdk_texture_download_surface (texture);
   BroadwayRequestUploadTexture msg;
+  GByteArray *array;
+  guint8 *tile_checksums;
   PngData data;
+  char *checksum;
+  int width, height;
+  guint n_tiles, n_changed;
+
+  checksum = compute_texture_checksums (surface, &tile_checksums);
+  cached = g_hash_table_lookup (server->textures_by_checksum, checksum);
+  if (cached)
+    {
+      cached_texture_ref (server, cached);
+      g_free (checksum);
+      g_free (tile_checksums);
+      cairo_surface_destroy (surface);
+      return cached->id;
+    }
+
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+  n_tiles = get_n_tiles (width) * get_n_tiles (height);
+
+  cached = g_new0 (CachedTexture, 1);
+  cached->id = server->next_texture_id++;
+  cached->refcount = 1;
+  cached->width = width;
+  cached->height = height;
+  cached->checksum = checksum;
+  cached->unused_link.data = cached;
+  g_hash_table_insert (server->textures_by_checksum, cached->checksum, cached);
+  g_hash_table_insert (server->textures_by_id, GUINT_TO_POINTER (cached->id), cached);
+
+  /* Updates of a texture send the tiles that changed, as long as
+   * that's at most half of them.
+   */
+  base = NULL;
+  n_changed = n_tiles;
+  if (n_tiles >= MIN_DELTA_TILES && width <= G_MAXUINT16 && height <= G_MAXUINT16)
+    {
+      base = g_hash_table_lookup (server->delta_bases, get_size_key (width, height));
+      if (base)
+        n_changed = count_changed_tiles (base->tile_checksums, tile_checksums, n_tiles);
+    }
 
-  id = server->next_texture_id++;
+  array = g_byte_array_new ();
+
+  if (base && n_changed * 2 <= n_tiles)
+    {
+      encode_delta (server, surface, base, tile_checksums, n_changed, array);
+      cached->base = base;
+      cached_texture_ref (server, base);
+      g_free (tile_checksums);
+    }
+  else
+    {
+      encode_image (surface, choose_codec (server, surface, (gsize) width * height), array);
+      cached->tile_checksums = tile_checksums;
+      if (n_tiles >= MIN_DELTA_TILES && width <= G_MAXUINT16 && height <= G_MAXUINT16)
+        g_hash_table_insert (server->delta_bases, get_size_key (width, height), cached);
+    }
+
+  cairo_surface_destroy (surface);
 
   data.fd = open_shared_memory ();
   data.size = 0;
-  cairo_surface_write_to_png_stream (surface, write_png_cb, &data);
+  write_png_cb (&data, array->data, array->len);
+  g_byte_array_unref (array);
 
-  msg.id = id;
+  msg.id = cached->id;
   msg.offset = 0;
   msg.size = data.size;
 
@@ -660,7 +1208,7 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
   gdk_broadway_server_send_fd_message (server, msg,
                                        BROADWAY_REQUEST_UPLOAD_TEXTURE, data.fd);
 
-  return id;
+  return cached->id;
 }
 
 
@@ -669,6 +1217,14 @@ gdk_broadway_server_release_texture (GdkBroadwayServer *server,
                                      guint32            id)
 {
   BroadwayRequestReleaseTexture msg;
+  CachedTexture *cached;
+
+  cached = g_hash_table_lookup (server->textures_by_id, GUINT_TO_POINTER (id));
+  if (cached)
+    {
+      cached_texture_unref (server, cached);
+      return;
+    }
 
   msg.id = id;
 
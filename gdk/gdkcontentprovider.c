@@ -22,6 +22,7 @@
 
 #include "gdkclipboard.h"
 #include "gdkcontentformats.h"
+#include "gdkcontentserializer.h"
 #include "gdkintl.h"
 
 /**
@@ -46,8 +47,23 @@ typedef struct _GdkContentProviderPrivate GdkContentProviderPrivate;
 struct _GdkContentProviderPrivate
 {
   GdkContentFormats *formats;
+
+  /* only set for providers whose value can't change behind our back */
+  guint cache_serialized : 1;
+  /* mime type => GBytes, the serialized value for it */
+  GHashTable *serialized;
+  /* the mime types in @serialized, oldest first */
+  GQueue serialized_order;
+  gsize serialized_size;
+  /* increased on every content change, so we don't cache
+   * data that was serialized from old contents
+   */
+  guint content_serial;
 };
 
+/* Cap on the size of serialized data we keep around per provider */
+#define MAX_SERIALIZED_SIZE (64 * 1024 * 1024)
+
 enum {
   PROP_0,
   PROP_FORMATS,
@@ -155,12 +171,36 @@ gdk_content_provider_get_property (GObject    *gobject,
     }
 }
 
+static void
+gdk_content_provider_clear_serialized (GdkContentProvider *provider)
+{
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+
+  if (priv->serialized)
+    g_hash_table_remove_all (priv->serialized);
+  g_queue_clear (&priv->serialized_order);
+  priv->serialized_size = 0;
+}
+
+static void
+gdk_content_provider_finalize (GObject *object)
+{
+  GdkContentProvider *provider = GDK_CONTENT_PROVIDER (object);
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+
+  g_clear_pointer (&priv->serialized, g_hash_table_unref);
+  g_queue_clear (&priv->serialized_order);
+
+  G_OBJECT_CLASS (gdk_content_provider_parent_class)->finalize (object);
+}
+
 static void
 gdk_content_provider_class_init (GdkContentProviderClass *class)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (class);
 
   object_class->get_property = gdk_content_provider_get_property;
+  object_class->finalize = gdk_content_provider_finalize;
 
   class->attach_clipboard = gdk_content_provider_real_attach_clipboard;
   class->detach_clipboard = gdk_content_provider_real_detach_clipboard;
@@ -264,8 +304,13 @@ gdk_content_provider_ref_storable_formats (GdkContentProvider *provider)
 void
 gdk_content_provider_content_changed (GdkContentProvider *provider)
 {
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+
   g_return_if_fail (GDK_IS_CONTENT_PROVIDER (provider));
 
+  priv->content_serial++;
+  gdk_content_provider_clear_serialized (provider);
+
   g_signal_emit (provider, signals[CONTENT_CHANGED], 0);
 
   g_object_notify_by_pspec (G_OBJECT (provider), properties[PROP_FORMATS]);
@@ -391,3 +436,418 @@ gdk_content_provider_detach_clipboard (GdkContentProvider *provider,
 
   return GDK_CONTENT_PROVIDER_GET_CLASS (provider)->detach_clipboard (provider, clipboard);
 }
+
+/* An output stream that passes everything on to another stream and
+ * keeps a copy of the data, unless there's too much of it to cache.
+ */
+#define GDK_TYPE_CACHING_OUTPUT_STREAM (gdk_caching_output_stream_get_type ())
+G_DECLARE_FINAL_TYPE (GdkCachingOutputStream, gdk_caching_output_stream, GDK, CACHING_OUTPUT_STREAM, GOutputStream)
+
+struct _GdkCachingOutputStream
+{
+  GOutputStream parent_instance;
+
+  GOutputStream *stream;
+  GByteArray *data; /* NULL once there was too much data */
+};
+
+G_DEFINE_TYPE (GdkCachingOutputStream, gdk_caching_output_stream, G_TYPE_OUTPUT_STREAM)
+
+static void
+gdk_caching_output_stream_append (GdkCachingOutputStream *self,
+                                  const void             *buffer,
+                                  gsize                   count)
+{
+  if (self->data == NULL)
+    return;
+
+  if (self->data->len + count > MAX_SERIALIZED_SIZE)
+    {
+      g_clear_pointer (&self->data, g_byte_array_unref);
+      return;
+    }
+
+  g_byte_array_append (self->data, buffer, count);
+}
+
+static gssize
+gdk_caching_output_stream_write (GOutputStream  *stream,
+                                 const void     *buffer,
+                                 gsize           count,
+                                 GCancellable   *cancellable,
+                                 GError        **error)
+{
+  GdkCachingOutputStream *self = GDK_CACHING_OUTPUT_STREAM (stream);
+  gssize written;
+
+  written = g_output_stream_write (self->stream, buffer, count, cancellable, error);
+  if (written > 0)
+    gdk_caching_output_stream_append (self, buffer, written);
+
+  return written;
+}
+
+static void
+gdk_caching_output_stream_write_done (GObject      *stream,
+                                      GAsyncResult *result,
+                                      gpointer      user_data)
+{
+  GTask *task = user_data;
+  GError *error = NULL;
+  gssize written;
+
+  written = g_output_stream_write_finish (G_OUTPUT_STREAM (stream), result, &error);
+  if (written < 0)
+    {
+      g_task_return_error (task, error);
+    }
+  else
+    {
+      gdk_caching_output_stream_append (g_task_get_source_object (task),
+                                        g_task_get_task_data (task),
+                                        written);
+      g_task_return_int (task, written);
+    }
+
+  g_object_unref (task);
+}
+
+static void
+gdk_caching_output_stream_write_async (GOutputStream       *stream,
+                                       const void          *buffer,
+                                       gsize                count,
+                                       int                  io_priority,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+  GdkCachingOutputStream *self = GDK_CACHING_OUTPUT_STREAM (stream);
+  GTask *task;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_priority (task, io_priority);
+  g_task_set_source_tag (task, gdk_caching_output_stream_write_async);
+  /* The buffer stays valid until the operation is done */
+  g_task_set_task_data (task, (gpointer) buffer, NULL);
+
+  g_output_stream_write_async (self->stream,
+                               buffer,
+                               count,
+                               io_priority,
+                               cancellable,
+                               gdk_caching_output_stream_write_done,
+                               task);
+}
+
+static gssize
+gdk_caching_output_stream_write_finish (GOutputStream  *stream,
+                                        GAsyncResult   *result,
+                                        GError        **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+
+static void
+gdk_caching_output_stream_finalize (GObject *object)
+{
+  GdkCachingOutputStream *self = GDK_CACHING_OUTPUT_STREAM (object);
+
+  g_object_unref (self->stream);
+  g_clear_pointer (&self->data, g_byte_array_unref);
+
+  G_OBJECT_CLASS (gdk_caching_output_stream_parent_class)->finalize (object);
+}
+
+static void
+gdk_caching_output_stream_class_init (GdkCachingOutputStreamClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GOutputStreamClass *stream_class = G_OUTPUT_STREAM_CLASS (klass);
+
+  object_class->finalize = gdk_caching_output_stream_finalize;
+
+  stream_class->write_fn = gdk_caching_output_stream_write;
+  stream_class->write_async = gdk_caching_output_stream_write_async;
+  stream_class->write_finish = gdk_caching_output_stream_write_finish;
+}
+
+static void
+gdk_caching_output_stream_init (GdkCachingOutputStream *self)
+{
+  self->data = g_byte_array_new ();
+}
+
+static GOutputStream *
+gdk_caching_output_stream_new (GOutputStream *stream)
+{
+  GdkCachingOutputStream *self;
+
+  self = g_object_new (GDK_TYPE_CACHING_OUTPUT_STREAM, NULL);
+  self->stream = g_object_ref (stream);
+
+  return G_OUTPUT_STREAM (self);
+}
+
+/* Returns %NULL if there was too much data to cache */
+static GBytes *
+gdk_caching_output_stream_steal_bytes (GdkCachingOutputStream *self)
+{
+  GByteArray *data = g_steal_pointer (&self->data);
+
+  if (data == NULL)
+    return NULL;
+
+  return g_byte_array_free_to_bytes (data);
+}
+
+typedef struct {
+  GOutputStream *stream;
+  GOutputStream *buffer;
+  const char *mime_type;
+  guint content_serial;
+  GBytes *bytes;
+} SerializeData;
+
+static void
+serialize_data_free (gpointer data)
+{
+  SerializeData *sdata = data;
+
+  g_object_unref (sdata->stream);
+  g_clear_object (&sdata->buffer);
+  g_clear_pointer (&sdata->bytes, g_bytes_unref);
+  g_slice_free (SerializeData, sdata);
+}
+
+static void
+gdk_content_provider_serialize_write_done (GObject      *stream,
+                                           GAsyncResult *result,
+                                           gpointer      user_data)
+{
+  GTask *task = user_data;
+  GError *error = NULL;
+
+  if (g_output_stream_write_all_finish (G_OUTPUT_STREAM (stream), result, NULL, &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+
+  g_object_unref (task);
+}
+
+/* Writes the data straight from the bytes, there's no need
+ * for intermediate copies.
+ */
+static void
+gdk_content_provider_serialize_write (GTask  *task,
+                                      GBytes *bytes)
+{
+  SerializeData *data = g_task_get_task_data (task);
+  gconstpointer bytes_data;
+  gsize size;
+
+  data->bytes = g_bytes_ref (bytes);
+  bytes_data = g_bytes_get_data (bytes, &size);
+
+  g_output_stream_write_all_async (data->stream,
+                                   bytes_data,
+                                   size,
+                                   g_task_get_priority (task),
+                                   g_task_get_cancellable (task),
+                                   gdk_content_provider_serialize_write_done,
+                                   task);
+}
+
+static void
+gdk_content_provider_cache_serialized (GdkContentProvider *provider,
+                                       const char         *mime_type,
+                                       GBytes             *bytes)
+{
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+  gsize size = g_bytes_get_size (bytes);
+  GBytes *old;
+
+  if (size > MAX_SERIALIZED_SIZE)
+    return;
+
+  if (priv->serialized == NULL)
+    priv->serialized = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_bytes_unref);
+
+  old = g_hash_table_lookup (priv->serialized, mime_type);
+  if (old)
+    {
+      priv->serialized_size -= g_bytes_get_size (old);
+      g_hash_table_remove (priv->serialized, mime_type);
+      g_queue_remove (&priv->serialized_order, mime_type);
+    }
+
+  /* Make room by dropping the formats that were cached first */
+  while (priv->serialized_size + size > MAX_SERIALIZED_SIZE)
+    {
+      const char *oldest = g_queue_pop_head (&priv->serialized_order);
+
+      priv->serialized_size -= g_bytes_get_size (g_hash_table_lookup (priv->serialized, oldest));
+      g_hash_table_remove (priv->serialized, oldest);
+    }
+
+  g_hash_table_insert (priv->serialized, (gpointer) mime_type, g_bytes_ref (bytes));
+  g_queue_push_tail (&priv->serialized_order, (gpointer) mime_type);
+  priv->serialized_size += size;
+}
+
+static void
+gdk_content_provider_serialize_done (GObject      *source,
+                                     GAsyncResult *result,
+                                     gpointer      user_data)
+{
+  GTask *task = user_data;
+  GdkContentProvider *provider = g_task_get_source_object (task);
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+  SerializeData *data = g_task_get_task_data (task);
+  GError *error = NULL;
+  GBytes *bytes;
+
+  if (!gdk_content_serialize_finish (result, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  /* The data has already been written, it only needs to be cached */
+  if (data->buffer)
+    {
+      bytes = gdk_caching_output_stream_steal_bytes (GDK_CACHING_OUTPUT_STREAM (data->buffer));
+      if (bytes && data->content_serial == priv->content_serial)
+        gdk_content_provider_cache_serialized (provider, data->mime_type, bytes);
+      g_clear_pointer (&bytes, g_bytes_unref);
+    }
+
+  g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+/*
+ * gdk_content_provider_serialize_async:
+ * @provider: a #GdkContentProvider
+ * @mime_type: the interned mime type to serialize to
+ * @gtype: the type to get the value of @provider in
+ * @stream: the stream to write to
+ * @io_priority: the I/O priority of the operation
+ * @cancellable: (nullable): optional #GCancellable object
+ * @callback: (scope async): callback to call when the operation is done
+ * @user_data: (closure): data to pass to the callback function
+ *
+ * Gets the value of @provider as @gtype, serializes it to @mime_type
+ * and writes the result to @stream.
+ *
+ * If caching was enabled with gdk_content_provider_set_cache_serialized(),
+ * the serialized data is kept around until the content changes, so
+ * serving the same format to multiple readers only serializes once.
+ */
+void
+gdk_content_provider_serialize_async (GdkContentProvider  *provider,
+                                      const char          *mime_type,
+                                      GType                gtype,
+                                      GOutputStream       *stream,
+                                      int                  io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+  GValue value = G_VALUE_INIT;
+  SerializeData *data;
+  GError *error = NULL;
+  GBytes *bytes;
+  GTask *task;
+
+  g_return_if_fail (GDK_IS_CONTENT_PROVIDER (provider));
+  g_return_if_fail (mime_type == g_intern_string (mime_type));
+  g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+
+  task = g_task_new (provider, cancellable, callback, user_data);
+  g_task_set_priority (task, io_priority);
+  g_task_set_source_tag (task, gdk_content_provider_serialize_async);
+
+  data = g_slice_new0 (SerializeData);
+  data->stream = g_object_ref (stream);
+  data->mime_type = mime_type;
+  data->content_serial = priv->content_serial;
+  g_task_set_task_data (task, data, serialize_data_free);
+
+  bytes = priv->serialized ? g_hash_table_lookup (priv->serialized, mime_type) : NULL;
+  if (bytes)
+    {
+      gdk_content_provider_serialize_write (task, bytes);
+      return;
+    }
+
+  g_value_init (&value, gtype);
+  if (!gdk_content_provider_get_value (provider, &value, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      g_value_unset (&value);
+      return;
+    }
+
+  if (priv->cache_serialized)
+    data->buffer = gdk_caching_output_stream_new (stream);
+
+  gdk_content_serialize_async (data->buffer ? data->buffer : stream,
+                               mime_type,
+                               &value,
+                               io_priority,
+                               cancellable,
+                               gdk_content_provider_serialize_done,
+                               task);
+  g_value_unset (&value);
+}
+
+gboolean
+gdk_content_provider_serialize_finish (GdkContentProvider  *provider,
+                                       GAsyncResult        *result,
+                                       GError             **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, provider), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gdk_content_provider_serialize_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/*
+ * gdk_content_provider_set_cache_serialized:
+ * @provider: a #GdkContentProvider
+ * @cache_serialized: whether to cache serialized data
+ *
+ * Enables caching in gdk_content_provider_serialize_async().
+ *
+ * This must only be enabled for providers that have an immutable
+ * value or that call gdk_content_provider_content_changed() whenever
+ * their value changes, or stale data would be served.
+ */
+void
+gdk_content_provider_set_cache_serialized (GdkContentProvider *provider,
+                                           gboolean            cache_serialized)
+{
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+
+  g_return_if_fail (GDK_IS_CONTENT_PROVIDER (provider));
+
+  priv->cache_serialized = cache_serialized;
+  if (!cache_serialized)
+    gdk_content_provider_clear_serialized (provider);
+}
+
+gboolean
+gdk_content_provider_get_cache_serialized (GdkContentProvider *provider)
+{
+  GdkContentProviderPrivate *priv = gdk_content_provider_get_instance_private (provider);
+
+  g_return_val_if_fail (GDK_IS_CONTENT_PROVIDER (provider), FALSE);
+
+  return priv->cache_serialized;
+}
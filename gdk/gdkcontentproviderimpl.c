@@ -104,6 +104,8 @@ gdk_content_provider_value_class_init (GdkContentProviderValueClass *class)
 static void
 gdk_content_provider_value_init (GdkContentProviderValue *content)
 {
+  /* The value never changes */
+  gdk_content_provider_set_cache_serialized (GDK_CONTENT_PROVIDER (content), TRUE);
 }
 
 /**
@@ -430,8 +432,16 @@ gdk_content_provider_new_union (GdkContentProvider **providers,
   result->n_providers = n_providers;
   result->providers = g_memdup2 (providers, sizeof (GdkContentProvider *) * n_providers);
 
+  /* Changes are forwarded below, so caching is safe if it is safe
+   * for all the providers.
+   */
+  gdk_content_provider_set_cache_serialized (GDK_CONTENT_PROVIDER (result), TRUE);
+
   for (i = 0; i < n_providers; i++)
     {
+      if (!gdk_content_provider_get_cache_serialized (result->providers[i]))
+        gdk_content_provider_set_cache_serialized (GDK_CONTENT_PROVIDER (result), FALSE);
+
       g_signal_connect_swapped (result->providers[i],
                                 "content-changed",
                                 G_CALLBACK (gdk_content_provider_content_changed),
@@ -571,6 +581,8 @@ gdk_content_provider_bytes_class_init (GdkContentProviderBytesClass *class)
 static void
 gdk_content_provider_bytes_init (GdkContentProviderBytes *content)
 {
+  /* The bytes never change */
+  gdk_content_provider_set_cache_serialized (GDK_CONTENT_PROVIDER (content), TRUE);
 }
 
 /**
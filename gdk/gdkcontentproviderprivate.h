@@ -28,6 +28,22 @@ void                    gdk_content_provider_attach_clipboard   (GdkContentProvi
 void                    gdk_content_provider_detach_clipboard   (GdkContentProvider     *provider,
                                                                  GdkClipboard           *clipboard);
 
+void                    gdk_content_provider_serialize_async    (GdkContentProvider     *provider,
+                                                                 const char             *mime_type,
+                                                                 GType                   gtype,
+                                                                 GOutputStream          *stream,
+                                                                 int                     io_priority,
+                                                                 GCancellable           *cancellable,
+                                                                 GAsyncReadyCallback     callback,
+                                                                 gpointer                user_data);
+gboolean                gdk_content_provider_serialize_finish   (GdkContentProvider     *provider,
+                                                                 GAsyncResult           *result,
+                                                                 GError                **error);
+
+void                    gdk_content_provider_set_cache_serialized (GdkContentProvider   *provider,
+                                                                   gboolean              cache_serialized);
+gboolean                gdk_content_provider_get_cache_serialized (GdkContentProvider   *provider);
+
 G_END_DECLS
 
 #endif /* __GDK_CONTENT_PROVIDER_PRIVATE_H__ */
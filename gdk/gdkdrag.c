@@ -29,7 +29,7 @@
 #include "gdksurface.h"
 #include "gdkintl.h"
 #include "gdkcontentformats.h"
-#include "gdkcontentprovider.h"
+#include "gdkcontentproviderprivate.h"
 #include "gdkcontentserializer.h"
 #include "gdkcursor.h"
 #include "gdkenumtypes.h"
@@ -556,7 +556,7 @@ gdk_drag_write_serialize_done (GObject      *content,
 {
   GError *error = NULL;
 
-  if (gdk_content_serialize_finish (result, &error))
+  if (gdk_content_provider_serialize_finish (GDK_CONTENT_PROVIDER (content), result, &error))
     g_task_return_boolean (task, TRUE);
   else
     g_task_return_error (task, error);
@@ -609,28 +609,14 @@ gdk_drag_write_async (GdkDrag             *drag,
   gtype = gdk_content_formats_match_gtype (formats, mime_formats);
   if (gtype != G_TYPE_INVALID)
     {
-      GValue value = G_VALUE_INIT;
-      GError *error = NULL;
-
-      g_assert (gtype != G_TYPE_INVALID);
-      
-      g_value_init (&value, gtype);
-      if (gdk_content_provider_get_value (priv->content, &value, &error))
-        {
-          gdk_content_serialize_async (stream,
-                                       mime_type,
-                                       &value,
-                                       io_priority,
-                                       cancellable,
-                                       gdk_drag_write_serialize_done,
-                                       g_object_ref (task));
-        }
-      else
-        {
-          g_task_return_error (task, error);
-        }
-      
-      g_value_unset (&value);
+      gdk_content_provider_serialize_async (priv->content,
+                                            mime_type,
+                                            gtype,
+                                            stream,
+                                            io_priority,
+                                            cancellable,
+                                            gdk_drag_write_serialize_done,
+                                            g_object_ref (task));
     }
   else
     {
@@ -31,6 +31,7 @@
 #include "gdkdragprivate.h"
 #include "gdkdropprivate.h"
 #include "gdkkeysprivate.h"
+#include "gdkprofilerprivate.h"
 #include "gdk-private.h"
 
 #include <gobject/gvaluecollector.h>
@@ -144,13 +145,90 @@ value_event_lcopy_value (const GValue *value,
   return NULL;
 }
 
+/* Pointing devices and touchscreens can send hundreds of events per
+ * second, so instead of freeing events we keep a few instances of
+ * every event type around and hand them out again in gdk_event_alloc().
+ *
+ * Reused events are cleared and only go through gdk_event_init() again,
+ * so event types must not have instance_init functions of their own.
+ */
+#define EVENT_POOL_SIZE 16
+
+typedef struct {
+  GdkEvent *events[EVENT_POOL_SIZE];
+  guint n_events;
+  gsize instance_size;
+} GdkEventPool;
+
+G_LOCK_DEFINE_STATIC (event_pools);
+static GdkEventPool event_pools[GDK_EVENT_LAST];
+static gint64 event_pool_hits;
+static gint64 event_pool_misses;
+static guint event_pool_hits_counter;
+static guint event_pool_misses_counter;
+
+static gboolean
+gdk_event_pool_push (GdkEvent *event)
+{
+  GdkEventPool *pool = &event_pools[event->event_type];
+  gboolean pushed = FALSE;
+
+  G_LOCK (event_pools);
+
+  if (pool->n_events < EVENT_POOL_SIZE)
+    {
+      if (pool->instance_size == 0)
+        {
+          GTypeQuery query;
+
+          g_type_query (G_TYPE_FROM_INSTANCE (event), &query);
+          pool->instance_size = query.instance_size;
+        }
+
+      pool->events[pool->n_events++] = event;
+      pushed = TRUE;
+    }
+
+  G_UNLOCK (event_pools);
+
+  return pushed;
+}
+
+static GdkEvent *
+gdk_event_pool_pop (GdkEventType  event_type,
+                    gsize        *instance_size)
+{
+  GdkEventPool *pool = &event_pools[event_type];
+  GdkEvent *event = NULL;
+
+  G_LOCK (event_pools);
+
+  if (pool->n_events > 0)
+    {
+      event = pool->events[--pool->n_events];
+      *instance_size = pool->instance_size;
+      event_pool_hits++;
+      gdk_profiler_set_int_counter (event_pool_hits_counter, event_pool_hits);
+    }
+  else
+    {
+      event_pool_misses++;
+      gdk_profiler_set_int_counter (event_pool_misses_counter, event_pool_misses);
+    }
+
+  G_UNLOCK (event_pools);
+
+  return event;
+}
+
 static void
 gdk_event_finalize (GdkEvent *self)
 {
   g_clear_object (&self->surface);
   g_clear_object (&self->device);
 
-  g_type_free_instance ((GTypeInstance *) self);
+  if (!gdk_event_pool_push (self))
+    g_type_free_instance ((GTypeInstance *) self);
 }
 
 static GdkModifierType
@@ -265,7 +343,8 @@ gdk_event_get_type (void)
 /*< private >
  * GdkEventTypeInfo:
  * @instance_size: the size of the instance of a GdkEvent subclass
- * @instance_init: (nullable): the function to initialize the instance data
+ * @instance_init: (nullable): the function to initialize the instance data;
+ *   must be %NULL, as pooled events are reused without calling it
  * @finalize: (nullable): the function to free the instance data
  * @get_state: (nullable): the function to retrieve the #GdkModifierType
  *   associated to the event
@@ -337,6 +416,7 @@ gdk_event_type_register_static (const char             *type_name,
   info.instance_size = type_info->instance_size;
   info.n_preallocs = 0;
   info.instance_init = (GInstanceInitFunc) type_info->instance_init;
+  g_assert (info.instance_init == NULL);
   info.value_table = NULL;
 
   return g_type_register_static (GDK_TYPE_EVENT, type_name, &info, 0);
@@ -409,14 +489,32 @@ gdk_event_alloc (GdkEventType event_type,
   g_assert (event_type >= GDK_DELETE && event_type < GDK_EVENT_LAST);
   g_assert (gdk_event_types[event_type] != G_TYPE_INVALID);
 
-  GdkEvent *event = (GdkEvent *) g_type_create_instance (gdk_event_types[event_type]);
+  gsize instance_size;
+  GdkEvent *event = gdk_event_pool_pop (event_type, &instance_size);
 
-  GDK_NOTE (EVENTS, {
-            char *str = g_enum_to_string (GDK_TYPE_EVENT_TYPE, event_type);
-            g_message ("Allocating a new %s for event type %s",
-                       g_type_name (gdk_event_types[event_type]), str);
-            g_free (str);
-            });
+  if (event != NULL)
+    {
+      memset ((char *) event + sizeof (GTypeInstance), 0, instance_size - sizeof (GTypeInstance));
+      gdk_event_init (event);
+
+      GDK_NOTE (EVENTS, {
+                char *str = g_enum_to_string (GDK_TYPE_EVENT_TYPE, event_type);
+                g_message ("Reusing a pooled %s for event type %s",
+                           g_type_name (gdk_event_types[event_type]), str);
+                g_free (str);
+                });
+    }
+  else
+    {
+      event = (GdkEvent *) g_type_create_instance (gdk_event_types[event_type]);
+
+      GDK_NOTE (EVENTS, {
+                char *str = g_enum_to_string (GDK_TYPE_EVENT_TYPE, event_type);
+                g_message ("Allocating a new %s for event type %s",
+                           g_type_name (gdk_event_types[event_type]), str);
+                g_free (str);
+                });
+    }
 
   event->event_type = event_type;
   event->surface = surface != NULL ? g_object_ref (surface) : NULL;
@@ -442,6 +540,9 @@ gdk_event_init_types_once (void)
   g_type_ensure (GDK_TYPE_SCROLL_EVENT);
   g_type_ensure (GDK_TYPE_TOUCH_EVENT);
   g_type_ensure (GDK_TYPE_TOUCHPAD_EVENT);
+
+  event_pool_hits_counter = gdk_profiler_define_int_counter ("event-pool-hits", "Events reused from the event pool");
+  event_pool_misses_counter = gdk_profiler_define_int_counter ("event-pool-misses", "Events allocated because the event pool was empty");
 }
 
 /*< private >
@@ -56,6 +56,11 @@ gdk_memory_format_bytes_per_pixel (GdkMemoryFormat format)
     case GDK_MEMORY_B8G8R8:
       return 3;
 
+    case GDK_MEMORY_NV12:
+    case GDK_MEMORY_I420:
+      /* bytes in the luma plane */
+      return 1;
+
     case GDK_MEMORY_N_FORMATS:
     default:
       g_assert_not_reached ();
@@ -63,6 +68,75 @@ gdk_memory_format_bytes_per_pixel (GdkMemoryFormat format)
     }
 }
 
+gboolean
+gdk_memory_format_is_planar (GdkMemoryFormat format)
+{
+  return format == GDK_MEMORY_NV12 ||
+         format == GDK_MEMORY_I420;
+}
+
+/*<private>
+ * gdk_memory_format_get_planes:
+ * @format: the format of the data
+ * @data: the start of the data
+ * @stride: the rowstride of the data, for planar formats the
+ *     rowstride of the luma plane
+ * @height: the height of the image
+ * @planes: (out caller-allocates): return location for
+ *     %GDK_MEMORY_MAX_PLANES plane pointers
+ * @strides: (out caller-allocates): return location for
+ *     %GDK_MEMORY_MAX_PLANES plane strides
+ *
+ * Splits @data into its planes, following the layout documented
+ * for #GdkMemoryFormat. Packed formats consist of a single plane.
+ *
+ * Returns: the number of planes
+ */
+guint
+gdk_memory_format_get_planes (GdkMemoryFormat  format,
+                              const guchar    *data,
+                              gsize            stride,
+                              gsize            height,
+                              const guchar   **planes,
+                              gsize           *strides)
+{
+  gsize chroma_height = (height + 1) / 2;
+
+  planes[0] = data;
+  strides[0] = stride;
+
+  switch (format)
+    {
+    case GDK_MEMORY_NV12:
+      planes[1] = data + stride * height;
+      strides[1] = stride;
+      return 2;
+
+    case GDK_MEMORY_I420:
+      strides[1] = (stride + 1) / 2;
+      strides[2] = (stride + 1) / 2;
+      planes[1] = data + stride * height;
+      planes[2] = planes[1] + strides[1] * chroma_height;
+      return 3;
+
+    case GDK_MEMORY_B8G8R8A8_PREMULTIPLIED:
+    case GDK_MEMORY_A8R8G8B8_PREMULTIPLIED:
+    case GDK_MEMORY_R8G8B8A8_PREMULTIPLIED:
+    case GDK_MEMORY_B8G8R8A8:
+    case GDK_MEMORY_A8R8G8B8:
+    case GDK_MEMORY_R8G8B8A8:
+    case GDK_MEMORY_A8B8G8R8:
+    case GDK_MEMORY_R8G8B8:
+    case GDK_MEMORY_B8G8R8:
+      return 1;
+
+    case GDK_MEMORY_N_FORMATS:
+    default:
+      g_assert_not_reached ();
+      return 1;
+    }
+}
+
 static void
 gdk_memory_texture_dispose (GObject *object)
 {
@@ -81,6 +155,18 @@ gdk_memory_texture_download (GdkTexture         *texture,
 {
   GdkMemoryTexture *self = GDK_MEMORY_TEXTURE (texture);
 
+  if (gdk_memory_format_is_planar (self->format))
+    {
+      gdk_memory_convert_planar_area (data, stride,
+                                      GDK_MEMORY_CAIRO_FORMAT_ARGB32,
+                                      g_bytes_get_data (self->bytes, NULL),
+                                      self->stride,
+                                      self->format,
+                                      gdk_texture_get_height (texture),
+                                      area);
+      return;
+    }
+
   gdk_memory_convert (data, stride,
                       GDK_MEMORY_CAIRO_FORMAT_ARGB32,
                       (guchar *) g_bytes_get_data (self->bytes, NULL)
@@ -118,6 +204,10 @@ gdk_memory_texture_init (GdkMemoryTexture *self)
  * The #GBytes must contain @stride x @height pixels
  * in the given format.
  *
+ * For planar formats, @stride is the rowstride of the luma
+ * plane and the #GBytes must contain all planes as laid out
+ * in the documentation of #GdkMemoryFormat.
+ *
  * Returns: A newly-created #GdkTexture
  */
 GdkTexture *
@@ -276,6 +366,119 @@ SWIZZLE_PREMULTIPLY (3,0,1,2, 0,1,2,3)
 SWIZZLE_PREMULTIPLY (3,0,1,2, 3,0,1,2)
 SWIZZLE_PREMULTIPLY (3,0,1,2, 0,3,2,1)
 
+/* BT.601, limited range */
+#define YUV_TO_R(c,d,e) (CLAMP (298 * (c) + 409 * (e) + 128, 0, 0xFFFF) >> 8)
+#define YUV_TO_G(c,d,e) (CLAMP (298 * (c) - 100 * (d) - 208 * (e) + 128, 0, 0xFFFF) >> 8)
+#define YUV_TO_B(c,d,e) (CLAMP (298 * (c) + 516 * (d) + 128, 0, 0xFFFF) >> 8)
+
+#define YUV_CONVERT(A,R,G,B) \
+static void \
+convert_yuv_ ## A ## R ## G ## B (guchar        *dest_data, \
+                                 gsize          dest_stride, \
+                                 const guchar **planes, \
+                                 const gsize   *strides, \
+                                 guint          n_planes, \
+                                 gsize          x_offset, \
+                                 gsize          y_offset, \
+                                 gsize          width, \
+                                 gsize          height) \
+{ \
+  gsize x, y; \
+\
+  for (y = 0; y < height; y++) \
+    { \
+      const guchar *luma = planes[0] + (y_offset + y) * strides[0] + x_offset; \
+      const guchar *cb, *cr; \
+      int step; \
+\
+      cb = planes[1] + (y_offset + y) / 2 * strides[1]; \
+      if (n_planes == 2) \
+        { \
+          cr = cb + 1; \
+          step = 2; \
+        } \
+      else \
+        { \
+          cr = planes[2] + (y_offset + y) / 2 * strides[2]; \
+          step = 1; \
+        } \
+\
+      for (x = 0; x < width; x++) \
+        { \
+          gsize cx = (x_offset + x) / 2 * step; \
+          int c = luma[x] - 16; \
+          int d = cb[cx] - 128; \
+          int e = cr[cx] - 128; \
+\
+          dest_data[4 * x + A] = 0xFF; \
+          dest_data[4 * x + R] = YUV_TO_R (c, d, e); \
+          dest_data[4 * x + G] = YUV_TO_G (c, d, e); \
+          dest_data[4 * x + B] = YUV_TO_B (c, d, e); \
+        } \
+\
+      dest_data += dest_stride; \
+    } \
+}
+
+YUV_CONVERT(3,2,1,0)
+YUV_CONVERT(0,1,2,3)
+YUV_CONVERT(3,0,1,2)
+
+typedef void (* PlanarConversionFunc) (guchar        *dest_data,
+                                       gsize          dest_stride,
+                                       const guchar **planes,
+                                       const gsize   *strides,
+                                       guint          n_planes,
+                                       gsize          x_offset,
+                                       gsize          y_offset,
+                                       gsize          width,
+                                       gsize          height);
+
+static PlanarConversionFunc planar_converters[3] =
+{
+  convert_yuv_3210, convert_yuv_0123, convert_yuv_3012
+};
+
+/*<private>
+ * gdk_memory_convert_planar_area:
+ * @dest_data: the destination
+ * @dest_stride: rowstride of the destination
+ * @dest_format: format of the destination, must be one of the
+ *     premultiplied 4 byte formats
+ * @src_data: the start of the source image
+ * @src_stride: rowstride of the source, see gdk_memory_format_get_planes()
+ * @src_format: a planar format
+ * @src_height: the height of the whole source image
+ * @area: the area of the source image to convert
+ *
+ * Converts the given area of a planar image. Unlike gdk_memory_convert(),
+ * this needs to know the full image to be able to find the chroma planes.
+ */
+void
+gdk_memory_convert_planar_area (guchar             *dest_data,
+                                gsize               dest_stride,
+                                GdkMemoryFormat     dest_format,
+                                const guchar       *src_data,
+                                gsize               src_stride,
+                                GdkMemoryFormat     src_format,
+                                gsize               src_height,
+                                const GdkRectangle *area)
+{
+  const guchar *planes[GDK_MEMORY_MAX_PLANES];
+  gsize strides[GDK_MEMORY_MAX_PLANES];
+  guint n_planes;
+
+  g_assert (dest_format < 3);
+  g_assert (gdk_memory_format_is_planar (src_format));
+
+  n_planes = gdk_memory_format_get_planes (src_format, src_data, src_stride, src_height, planes, strides);
+
+  planar_converters[dest_format] (dest_data, dest_stride,
+                                  planes, strides, n_planes,
+                                  area->x, area->y,
+                                  area->width, area->height);
+}
+
 typedef void (* ConversionFunc) (guchar       *dest_data,
                                  gsize         dest_stride,
                                  const guchar *src_data,
@@ -293,7 +496,9 @@ static ConversionFunc converters[GDK_MEMORY_N_FORMATS][3] =
   { convert_swizzle_premultiply_3210_3012, convert_swizzle_premultiply_0123_3012, convert_swizzle_premultiply_3012_3012 },
   { convert_swizzle_premultiply_3210_0321, convert_swizzle_premultiply_0123_0321, convert_swizzle_premultiply_3012_0321 },
   { convert_swizzle_opaque_3210, convert_swizzle_opaque_0123, convert_swizzle_opaque_3012 },
-  { convert_swizzle_opaque_3012, convert_swizzle_opaque_0321, convert_swizzle_opaque_3210 }
+  { convert_swizzle_opaque_3012, convert_swizzle_opaque_0321, convert_swizzle_opaque_3210 },
+  { NULL, NULL, NULL },
+  { NULL, NULL, NULL }
 };
 
 void
@@ -309,5 +514,15 @@ gdk_memory_convert (guchar          *dest_data,
   g_assert (dest_format < 3);
   g_assert (src_format < GDK_MEMORY_N_FORMATS);
 
+  /* Planar data is assumed to be the full image */
+  if (gdk_memory_format_is_planar (src_format))
+    {
+      gdk_memory_convert_planar_area (dest_data, dest_stride, dest_format,
+                                      src_data, src_stride, src_format,
+                                      height,
+                                      &(GdkRectangle) { 0, 0, width, height });
+      return;
+    }
+
   converters[src_format][dest_format] (dest_data, dest_stride, src_data, src_stride, width, height);
 }
@@ -42,6 +42,12 @@ G_BEGIN_DECLS
  * @GDK_MEMORY_A8B8G8R8: 4 bytes; for alpha, blue, green, red.
  * @GDK_MEMORY_R8G8B8: 3 bytes; for red, green, blue. The data is opaque.
  * @GDK_MEMORY_B8G8R8: 3 bytes; for blue, green, red. The data is opaque.
+ * @GDK_MEMORY_NV12: 2 planes; a plane of 1 byte luma (Y) per pixel,
+ *     followed by a plane of interleaved chroma (Cb, Cr) byte pairs
+ *     subsampled by 2 in both directions. The data is opaque.
+ * @GDK_MEMORY_I420: 3 planes; a plane of 1 byte luma (Y) per pixel,
+ *     followed by a Cb plane and a Cr plane, each subsampled by 2 in both
+ *     directions. The data is opaque.
  * @GDK_MEMORY_N_FORMATS: The number of formats. This value will change as
  *     more formats get added, so do not rely on its concrete integer.
  *
@@ -53,6 +59,12 @@ G_BEGIN_DECLS
  * CAIRO_FORMAT_ARGB32 is represented by different #GdkMemoryFormats on
  * architectures with different endiannesses.
  * 
+ * The planar YUV formats use BT.601 limited range coefficients. Their planes
+ * follow each other without gaps: the luma plane consists of height rows of
+ * stride bytes each. For %GDK_MEMORY_NV12 the chroma plane uses the same
+ * stride, for %GDK_MEMORY_I420 both chroma planes use a stride of
+ * (stride + 1) / 2. Chroma planes have (height + 1) / 2 rows.
+ *
  * Its naming is modelled after VkFormat (see
  * https://www.khronos.org/registry/vulkan/specs/1.0/html/vkspec.html#VkFormat
  * for details).
@@ -67,6 +79,8 @@ typedef enum {
   GDK_MEMORY_A8B8G8R8,
   GDK_MEMORY_R8G8B8,
   GDK_MEMORY_B8G8R8,
+  GDK_MEMORY_NV12,
+  GDK_MEMORY_I420,
 
   GDK_MEMORY_N_FORMATS
 } GdkMemoryFormat;
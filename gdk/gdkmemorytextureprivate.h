@@ -31,7 +31,16 @@ G_BEGIN_DECLS
 
 #define GDK_MEMORY_CAIRO_FORMAT_ARGB32 GDK_MEMORY_DEFAULT
 
+#define GDK_MEMORY_MAX_PLANES 3
+
 gsize                   gdk_memory_format_bytes_per_pixel   (GdkMemoryFormat    format);
+gboolean                gdk_memory_format_is_planar         (GdkMemoryFormat    format);
+guint                   gdk_memory_format_get_planes        (GdkMemoryFormat    format,
+                                                             const guchar      *data,
+                                                             gsize              stride,
+                                                             gsize              height,
+                                                             const guchar     **planes,
+                                                             gsize             *strides);
 
 GdkMemoryFormat         gdk_memory_texture_get_format       (GdkMemoryTexture  *self);
 const guchar *          gdk_memory_texture_get_data         (GdkMemoryTexture  *self);
@@ -45,6 +54,14 @@ void                    gdk_memory_convert                  (guchar            *
                                                              GdkMemoryFormat    src_format,
                                                              gsize              width,
                                                              gsize              height);
+void                    gdk_memory_convert_planar_area      (guchar            *dest_data,
+                                                             gsize              dest_stride,
+                                                             GdkMemoryFormat    dest_format,
+                                                             const guchar      *src_data,
+                                                             gsize              src_stride,
+                                                             GdkMemoryFormat    src_format,
+                                                             gsize              src_height,
+                                                             const GdkRectangle *area);
 
 
 G_END_DECLS
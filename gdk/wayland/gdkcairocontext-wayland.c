@@ -63,18 +63,38 @@ gdk_wayland_cairo_context_surface_get_region (cairo_surface_t *surface)
   return cairo_surface_get_user_data (surface, &gdk_wayland_cairo_region_key);
 }
 
-static GdkWaylandCairoContext *
-gdk_wayland_cairo_context_get_from_surface (cairo_surface_t *surface)
+/* Per-buffer state, attached to the cairo surface */
+typedef struct {
+  GdkWaylandCairoContext *self;
+  GdkWaylandShmPool *pool; /* not owned, only used for comparison */
+  int slot;                /* -1 if not allocated from a pool slot */
+  guint busy : 1;          /* attached, waiting for release */
+  guint stale : 1;         /* wrong size, drop on release */
+} GdkWaylandCairoBuffer;
+
+static GdkWaylandCairoBuffer *
+gdk_wayland_cairo_context_get_buffer (cairo_surface_t *surface)
 {
   return cairo_surface_get_user_data (surface, &gdk_wayland_cairo_context_key);
 }
 
 static void
 gdk_wayland_cairo_context_add_surface (GdkWaylandCairoContext *self,
-                                       cairo_surface_t        *surface)
+                                       cairo_surface_t        *surface,
+                                       int                     slot)
 {
+  GdkWaylandCairoBuffer *buffer;
+
+  buffer = g_new0 (GdkWaylandCairoBuffer, 1);
+  buffer->self = self;
+  buffer->pool = self->pool;
+  buffer->slot = slot;
+
   cairo_surface_reference (surface);
-  cairo_surface_set_user_data (surface, &gdk_wayland_cairo_context_key, self, NULL);
+  cairo_surface_set_user_data (surface, &gdk_wayland_cairo_context_key, buffer, g_free);
+
+  if (slot >= 0)
+    self->slots[slot] = surface;
 
   self->surfaces = g_slist_prepend (self->surfaces, surface);
 }
@@ -83,6 +103,11 @@ static void
 gdk_wayland_cairo_context_remove_surface (GdkWaylandCairoContext *self,
                                           cairo_surface_t        *surface)
 {
+  GdkWaylandCairoBuffer *buffer = gdk_wayland_cairo_context_get_buffer (surface);
+
+  if (buffer->slot >= 0 && buffer->pool == self->pool)
+    self->slots[buffer->slot] = NULL;
+
   self->surfaces = g_slist_remove (self->surfaces, surface);
 
   cairo_surface_set_user_data (surface, &gdk_wayland_cairo_context_key, NULL, NULL);
@@ -94,27 +119,50 @@ gdk_wayland_cairo_context_buffer_release (void             *_data,
                                           struct wl_buffer *wl_buffer)
 {
   cairo_surface_t *cairo_surface = _data;
-  GdkWaylandCairoContext *self = gdk_wayland_cairo_context_get_from_surface (cairo_surface);
+  GdkWaylandCairoBuffer *buffer = gdk_wayland_cairo_context_get_buffer (cairo_surface);
 
   /* context was destroyed before compositor released this buffer */
-  if (self == NULL)
+  if (buffer == NULL)
     return;
 
-  /* Cache one surface for reuse when drawing */
-  if (self->cached_surface == NULL)
-    {
-      self->cached_surface = cairo_surface;
-      return;
-    }
+  buffer->busy = FALSE;
 
-  /* Get rid of all the extra ones */
-  gdk_wayland_cairo_context_remove_surface (self, cairo_surface);
+  /* Keep pool buffers around for reuse, get rid of all the extra ones */
+  if (buffer->stale || buffer->slot < 0)
+    gdk_wayland_cairo_context_remove_surface (buffer->self, cairo_surface);
 }
 
 static const struct wl_buffer_listener buffer_listener = {
   gdk_wayland_cairo_context_buffer_release
 };
 
+/* Make sure the pool slots can hold a buffer of @size bytes.
+ * The pool grows with some headroom and only shrinks when it is way
+ * too big, so that interactive resizes don't reallocate all the time.
+ */
+static void
+gdk_wayland_cairo_context_ensure_pool (GdkWaylandCairoContext *self,
+                                       gsize                   size)
+{
+  GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self)));
+  gsize page_size = 4096;
+  int i;
+
+  if (self->pool &&
+      size <= self->slot_size &&
+      size >= self->slot_size / 4)
+    return;
+
+  /* Buffers of the old pool keep it alive until they are gone */
+  g_clear_pointer (&self->pool, _gdk_wayland_shm_pool_unref);
+  for (i = 0; i < GDK_WAYLAND_CAIRO_CONTEXT_N_SLOTS; i++)
+    self->slots[i] = NULL;
+
+  self->slot_size = (size + size / 4 + page_size - 1) & ~(page_size - 1);
+  self->pool = _gdk_wayland_shm_pool_new (display_wayland,
+                                          self->slot_size * GDK_WAYLAND_CAIRO_CONTEXT_N_SLOTS);
+}
+
 static cairo_surface_t *
 gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
 {
@@ -123,16 +171,41 @@ gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
   cairo_surface_t *cairo_surface;
   struct wl_buffer *buffer;
   cairo_region_t *region;
-  int width, height;
+  int width, height, scale;
+  int i, slot;
 
   width = gdk_surface_get_width (surface);
   height = gdk_surface_get_height (surface);
-  cairo_surface = _gdk_wayland_display_create_shm_surface (display_wayland,
-                                                           width, height,
-                                                           gdk_surface_get_scale_factor (surface));
+  scale = gdk_surface_get_scale_factor (surface);
+
+  gdk_wayland_cairo_context_ensure_pool (self, _gdk_wayland_shm_surface_get_size (width, height, scale));
+
+  slot = -1;
+  for (i = 0; i < GDK_WAYLAND_CAIRO_CONTEXT_N_SLOTS; i++)
+    {
+      if (self->slots[i] == NULL)
+        {
+          slot = i;
+          break;
+        }
+    }
+
+  if (slot >= 0)
+    cairo_surface = _gdk_wayland_shm_pool_create_surface (self->pool,
+                                                          display_wayland,
+                                                          slot * self->slot_size,
+                                                          width, height,
+                                                          scale);
+  else
+    cairo_surface = _gdk_wayland_display_create_shm_surface (display_wayland,
+                                                             width, height,
+                                                             scale);
+
   buffer = _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface);
   wl_buffer_add_listener (buffer, &buffer_listener, cairo_surface);
-  gdk_wayland_cairo_context_add_surface (self, cairo_surface);
+  gdk_wayland_cairo_context_add_surface (self, cairo_surface, slot);
+  /* the context holds the reference now */
+  cairo_surface_destroy (cairo_surface);
 
   region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, width, height });
   gdk_wayland_cairo_context_surface_add_region (cairo_surface, region);
@@ -141,6 +214,43 @@ gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
   return cairo_surface;
 }
 
+/* Prefer the free buffer with the least damage to repaint */
+static cairo_surface_t *
+gdk_wayland_cairo_context_find_free_surface (GdkWaylandCairoContext *self)
+{
+  cairo_surface_t *result = NULL;
+  int result_area = G_MAXINT;
+  GSList *l;
+
+  for (l = self->surfaces; l; l = l->next)
+    {
+      GdkWaylandCairoBuffer *buffer = gdk_wayland_cairo_context_get_buffer (l->data);
+      const cairo_region_t *region;
+      cairo_rectangle_int_t extents;
+      int area;
+
+      if (buffer->busy || buffer->stale)
+        continue;
+
+      region = gdk_wayland_cairo_context_surface_get_region (l->data);
+      if (region)
+        {
+          cairo_region_get_extents (region, &extents);
+          area = extents.width * extents.height;
+        }
+      else
+        area = 0;
+
+      if (area < result_area)
+        {
+          result = l->data;
+          result_area = area;
+        }
+    }
+
+  return result;
+}
+
 static void
 gdk_wayland_cairo_context_begin_frame (GdkDrawContext *draw_context,
                                        cairo_region_t *region)
@@ -150,11 +260,11 @@ gdk_wayland_cairo_context_begin_frame (GdkDrawContext *draw_context,
   GSList *l;
   cairo_t *cr;
 
-  if (self->cached_surface)
-    self->paint_surface = g_steal_pointer (&self->cached_surface);
-  else
+  self->paint_surface = gdk_wayland_cairo_context_find_free_surface (self);
+  if (self->paint_surface == NULL)
     self->paint_surface = gdk_wayland_cairo_context_create_surface (self);
 
+  /* Repaint everything that changed since this buffer was last used */
   surface_region = gdk_wayland_cairo_context_surface_get_region (self->paint_surface);
   if (surface_region)
     cairo_region_union (region, surface_region);
@@ -187,6 +297,7 @@ gdk_wayland_cairo_context_end_frame (GdkDrawContext *draw_context,
   gdk_wayland_surface_commit (surface);
   gdk_wayland_surface_notify_committed (surface);
 
+  gdk_wayland_cairo_context_get_buffer (self->paint_surface)->busy = TRUE;
   gdk_wayland_cairo_context_surface_clear_region (self->paint_surface);
   self->paint_surface = NULL;
 }
@@ -194,17 +305,34 @@ gdk_wayland_cairo_context_end_frame (GdkDrawContext *draw_context,
 static void
 gdk_wayland_cairo_context_clear_all_cairo_surfaces (GdkWaylandCairoContext *self)
 {
-  self->cached_surface = NULL;
   while (self->surfaces)
     gdk_wayland_cairo_context_remove_surface (self, self->surfaces->data);
+
+  g_clear_pointer (&self->pool, _gdk_wayland_shm_pool_unref);
 }
 
 static void
 gdk_wayland_cairo_context_surface_resized (GdkDrawContext *draw_context)
 {
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (draw_context);
+  GSList *l, *next;
+
+  /* Free buffers can go right away, the compositor may still be
+   * reading from busy ones, so we keep their memory untouched
+   * until they are released. The pool itself is kept and reused
+   * if the new size fits.
+   */
+  for (l = self->surfaces; l; l = next)
+    {
+      GdkWaylandCairoBuffer *buffer = gdk_wayland_cairo_context_get_buffer (l->data);
 
-  gdk_wayland_cairo_context_clear_all_cairo_surfaces (self);
+      next = l->next;
+
+      if (buffer->busy)
+        buffer->stale = TRUE;
+      else
+        gdk_wayland_cairo_context_remove_surface (self, l->data);
+    }
 }
 
 static cairo_t *
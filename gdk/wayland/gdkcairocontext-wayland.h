@@ -32,6 +32,8 @@ G_BEGIN_DECLS
 #define GDK_IS_WAYLAND_CAIRO_CONTEXT_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE ((klass), GDK_TYPE_WAYLAND_CAIRO_CONTEXT))
 #define GDK_WAYLAND_CAIRO_CONTEXT_GET_CLASS(obj)	(G_TYPE_INSTANCE_GET_CLASS ((obj), GDK_TYPE_WAYLAND_CAIRO_CONTEXT, GdkWaylandCairoContextClass))
 
+#define GDK_WAYLAND_CAIRO_CONTEXT_N_SLOTS 3
+
 typedef struct _GdkWaylandCairoContext GdkWaylandCairoContext;
 typedef struct _GdkWaylandCairoContextClass GdkWaylandCairoContextClass;
 
@@ -40,8 +42,12 @@ struct _GdkWaylandCairoContext
   GdkCairoContext parent_instance;
 
   GSList *surfaces;
-  cairo_surface_t *cached_surface;
   cairo_surface_t *paint_surface;
+
+  /* Buffers are allocated from slots in a shared pool */
+  struct _GdkWaylandShmPool *pool;
+  gsize slot_size;
+  cairo_surface_t *slots[GDK_WAYLAND_CAIRO_CONTEXT_N_SLOTS];
 };
 
 struct _GdkWaylandCairoContextClass
@@ -1246,10 +1246,15 @@ gdk_wayland_display_get_wl_compositor (GdkDisplay *display)
 
 static const cairo_user_data_key_t gdk_wayland_shm_surface_cairo_key;
 
-typedef struct _GdkWaylandCairoSurfaceData {
+struct _GdkWaylandShmPool {
+  grefcount ref_count;
   gpointer buf;
   size_t buf_length;
   struct wl_shm_pool *pool;
+};
+
+typedef struct _GdkWaylandCairoSurfaceData {
+  GdkWaylandShmPool *pool;
   struct wl_buffer *buffer;
   GdkWaylandDisplay *display;
   uint32_t scale;
@@ -1361,6 +1366,43 @@ fail:
   return NULL;
 }
 
+GdkWaylandShmPool *
+_gdk_wayland_shm_pool_new (GdkWaylandDisplay *display,
+                           gsize              size)
+{
+  GdkWaylandShmPool *pool;
+
+  pool = g_new (GdkWaylandShmPool, 1);
+  g_ref_count_init (&pool->ref_count);
+  pool->pool = create_shm_pool (display->shm,
+                                size,
+                                &pool->buf_length,
+                                &pool->buf);
+  if (G_UNLIKELY (pool->pool == NULL))
+    g_error ("Unable to create shared memory pool");
+
+  return pool;
+}
+
+GdkWaylandShmPool *
+_gdk_wayland_shm_pool_ref (GdkWaylandShmPool *pool)
+{
+  g_ref_count_inc (&pool->ref_count);
+
+  return pool;
+}
+
+void
+_gdk_wayland_shm_pool_unref (GdkWaylandShmPool *pool)
+{
+  if (!g_ref_count_dec (&pool->ref_count))
+    return;
+
+  wl_shm_pool_destroy (pool->pool);
+  munmap (pool->buf, pool->buf_length);
+  g_free (pool);
+}
+
 static void
 gdk_wayland_cairo_surface_destroy (void *p)
 {
@@ -1369,45 +1411,55 @@ gdk_wayland_cairo_surface_destroy (void *p)
   if (data->buffer)
     wl_buffer_destroy (data->buffer);
 
-  if (data->pool)
-    wl_shm_pool_destroy (data->pool);
-
-  munmap (data->buf, data->buf_length);
+  _gdk_wayland_shm_pool_unref (data->pool);
   g_free (data);
 }
 
+gsize
+_gdk_wayland_shm_surface_get_size (int   width,
+                                   int   height,
+                                   guint scale)
+{
+  int stride;
+
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
+
+  return (gsize) height * scale * stride;
+}
+
+/* Creates a surface backed by the memory of @pool, starting at @offset.
+ * The surface keeps a reference on the pool, so buffers of a pool can
+ * outlive the code that created it.
+ */
 cairo_surface_t *
-_gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
-                                         int                width,
-                                         int                height,
-                                         guint              scale)
+_gdk_wayland_shm_pool_create_surface (GdkWaylandShmPool *pool,
+                                      GdkWaylandDisplay *display,
+                                      gsize              offset,
+                                      int                width,
+                                      int                height,
+                                      guint              scale)
 {
   GdkWaylandCairoSurfaceData *data;
   cairo_surface_t *surface = NULL;
   cairo_status_t status;
   int stride;
 
+  g_assert (offset + _gdk_wayland_shm_surface_get_size (width, height, scale) <= pool->buf_length);
+
   data = g_new (GdkWaylandCairoSurfaceData, 1);
   data->display = display;
-  data->buffer = NULL;
+  data->pool = _gdk_wayland_shm_pool_ref (pool);
   data->scale = scale;
 
   stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
 
-  data->pool = create_shm_pool (display->shm,
-                                height * scale * stride,
-                                &data->buf_length,
-                                &data->buf);
-  if (G_UNLIKELY (data->pool == NULL))
-    g_error ("Unable to create shared memory pool");
-
-  surface = cairo_image_surface_create_for_data (data->buf,
+  surface = cairo_image_surface_create_for_data ((guchar *) pool->buf + offset,
                                                  CAIRO_FORMAT_ARGB32,
                                                  width * scale,
                                                  height * scale,
                                                  stride);
 
-  data->buffer = wl_shm_pool_create_buffer (data->pool, 0,
+  data->buffer = wl_shm_pool_create_buffer (pool->pool, offset,
                                             width * scale, height * scale,
                                             stride, WL_SHM_FORMAT_ARGB8888);
 
@@ -1426,6 +1478,23 @@ _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
   return surface;
 }
 
+cairo_surface_t *
+_gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
+                                         int                width,
+                                         int                height,
+                                         guint              scale)
+{
+  GdkWaylandShmPool *pool;
+  cairo_surface_t *surface;
+
+  pool = _gdk_wayland_shm_pool_new (display,
+                                    _gdk_wayland_shm_surface_get_size (width, height, scale));
+  surface = _gdk_wayland_shm_pool_create_surface (pool, display, 0, width, height, scale);
+  _gdk_wayland_shm_pool_unref (pool);
+
+  return surface;
+}
+
 struct wl_buffer *
 _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface)
 {
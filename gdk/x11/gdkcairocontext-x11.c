@@ -30,8 +30,338 @@
 
 #include <X11/Xlib.h>
 
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
 G_DEFINE_TYPE (GdkX11CairoContext, gdk_x11_cairo_context, GDK_TYPE_CAIRO_CONTEXT)
 
+#ifdef HAVE_XSHM
+/* A window-sized image in shared memory that the X server can read
+ * without the pixels going through the socket.
+ */
+struct _GdkX11ShmBuffer
+{
+  XShmSegmentInfo shminfo;
+  XImage *image;
+  cairo_surface_t *surface;
+  /* the server is still reading from the image */
+  gboolean busy;
+};
+
+static void
+gdk_x11_shm_buffer_free (GdkDisplay      *display,
+                         GdkX11ShmBuffer *buffer)
+{
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+
+  cairo_surface_destroy (buffer->surface);
+
+  /* The server handles requests in order, so it is done with
+   * any pending XShmPutImage() before the detach.
+   */
+  XShmDetach (xdisplay, &buffer->shminfo);
+  shmdt (buffer->shminfo.shmaddr);
+
+  /* XDestroyImage() would try to free() the shared memory */
+  buffer->image->data = NULL;
+  XDestroyImage (buffer->image);
+
+  g_free (buffer);
+}
+
+/* Sets @attach_failed if the server can't access our shared memory,
+ * other failures might go away with a different size.
+ */
+static GdkX11ShmBuffer *
+gdk_x11_shm_buffer_new (GdkDisplay *display,
+                        int         width,
+                        int         height,
+                        int         scale,
+                        gboolean   *attach_failed)
+{
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (display);
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  Visual *visual = gdk_x11_display_get_window_visual (display_x11);
+  int depth = gdk_x11_display_get_window_depth (display_x11);
+  GdkX11ShmBuffer *buffer;
+  XImage *image;
+  gboolean attached;
+
+  *attach_failed = FALSE;
+
+  /* We only handle the formats cairo can draw to directly */
+  if ((depth != 24 && depth != 32) ||
+      visual->red_mask != 0xff0000 ||
+      visual->green_mask != 0xff00 ||
+      visual->blue_mask != 0xff)
+    return NULL;
+
+  buffer = g_new0 (GdkX11ShmBuffer, 1);
+
+  image = XShmCreateImage (xdisplay, visual, depth, ZPixmap, NULL,
+                           &buffer->shminfo,
+                           width * scale, height * scale);
+  if (image == NULL)
+    {
+      g_free (buffer);
+      return NULL;
+    }
+
+  if (image->bits_per_pixel != 32 ||
+      image->byte_order != (G_BYTE_ORDER == G_LITTLE_ENDIAN ? LSBFirst : MSBFirst))
+    goto fail;
+
+  buffer->shminfo.shmid = shmget (IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+  if (buffer->shminfo.shmid == -1)
+    goto fail;
+
+  buffer->shminfo.shmaddr = shmat (buffer->shminfo.shmid, NULL, 0);
+  if (buffer->shminfo.shmaddr == (char *) -1)
+    {
+      shmctl (buffer->shminfo.shmid, IPC_RMID, NULL);
+      goto fail;
+    }
+  buffer->shminfo.readOnly = False;
+
+  /* This fails for clients that aren't on the same machine as the server */
+  gdk_x11_display_error_trap_push (display);
+  XShmAttach (xdisplay, &buffer->shminfo);
+  XSync (xdisplay, False);
+  attached = gdk_x11_display_error_trap_pop (display) == 0;
+
+  /* The segment goes away once both sides have detached from it */
+  shmctl (buffer->shminfo.shmid, IPC_RMID, NULL);
+
+  if (!attached)
+    {
+      shmdt (buffer->shminfo.shmaddr);
+      *attach_failed = TRUE;
+      goto fail;
+    }
+
+  image->data = buffer->shminfo.shmaddr;
+  buffer->image = image;
+  buffer->surface = cairo_image_surface_create_for_data ((guchar *) image->data,
+                                                         depth == 32 ? CAIRO_FORMAT_ARGB32
+                                                                     : CAIRO_FORMAT_RGB24,
+                                                         image->width,
+                                                         image->height,
+                                                         image->bytes_per_line);
+  cairo_surface_set_device_scale (buffer->surface, scale, scale);
+
+  return buffer;
+
+fail:
+  XDestroyImage (image);
+  g_free (buffer);
+  return NULL;
+}
+
+static Bool
+is_shm_completion (Display  *xdisplay,
+                   XEvent   *xevent,
+                   XPointer  data)
+{
+  GdkX11ShmBuffer *buffer = (GdkX11ShmBuffer *) data;
+
+  return xevent->type == XShmGetEventBase (xdisplay) + ShmCompletion &&
+         ((XShmCompletionEvent *) xevent)->shmseg == buffer->shminfo.shmseg;
+}
+
+/* Blocks until the server is done reading from @buffer */
+static void
+gdk_x11_shm_buffer_wait (GdkDisplay      *display,
+                         GdkX11ShmBuffer *buffer)
+{
+  XEvent xevent;
+
+  if (!buffer->busy)
+    return;
+
+  XIfEvent (gdk_x11_display_get_xdisplay (display), &xevent, is_shm_completion, (XPointer) buffer);
+  buffer->busy = FALSE;
+}
+
+static gboolean
+gdk_x11_cairo_context_xevent (GdkX11CairoContext *self,
+                              XEvent             *xevent)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  XShmCompletionEvent *completion;
+  guint i;
+
+  if (xevent->type != GDK_X11_DISPLAY (display)->shm_event_base + ShmCompletion)
+    return FALSE;
+
+  completion = (XShmCompletionEvent *) xevent;
+
+  for (i = 0; i < G_N_ELEMENTS (self->shm_buffers); i++)
+    {
+      if (self->shm_buffers[i] &&
+          self->shm_buffers[i]->shminfo.shmseg == completion->shmseg)
+        {
+          self->shm_buffers[i]->busy = FALSE;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static void
+gdk_x11_cairo_context_clear_shm_buffers (GdkX11CairoContext *self)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (self->shm_buffers); i++)
+    {
+      if (self->shm_buffers[i])
+        {
+          gdk_x11_shm_buffer_free (display, self->shm_buffers[i]);
+          self->shm_buffers[i] = NULL;
+        }
+    }
+}
+
+/* Returns the buffer to paint the next frame into. We alternate between
+ * two of them, so that we don't have to wait for the server to finish
+ * reading the last frame before we can start drawing the next one.
+ */
+static GdkX11ShmBuffer *
+gdk_x11_cairo_context_get_shm_buffer (GdkX11CairoContext *self)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  GdkX11ShmBuffer *buffer;
+  int width, height, scale;
+
+  if (self->shm_failed || !GDK_X11_DISPLAY (display)->have_shm)
+    return NULL;
+
+  scale = gdk_surface_get_scale_factor (surface);
+  width = gdk_surface_get_width (surface);
+  height = gdk_surface_get_height (surface);
+
+  if (width == 0 || height == 0)
+    return NULL;
+
+  buffer = self->shm_buffers[self->shm_current];
+  if (buffer &&
+      (buffer->image->width != width * scale ||
+       buffer->image->height != height * scale))
+    {
+      gdk_x11_shm_buffer_free (display, buffer);
+      self->shm_buffers[self->shm_current] = NULL;
+      buffer = NULL;
+    }
+
+  if (buffer == NULL)
+    {
+      gboolean attach_failed;
+
+      buffer = gdk_x11_shm_buffer_new (display, width, height, scale, &attach_failed);
+      if (buffer == NULL)
+        {
+          /* No point in trying again if the server can't see our memory */
+          if (attach_failed)
+            {
+              GDK_DISPLAY_NOTE (display, MISC, g_message ("MIT-SHM not usable, falling back to XPutImage"));
+              self->shm_failed = TRUE;
+              gdk_x11_cairo_context_clear_shm_buffers (self);
+            }
+          return NULL;
+        }
+
+      self->shm_buffers[self->shm_current] = buffer;
+
+      if (!self->shm_xevent_connected)
+        {
+          g_signal_connect_object (display, "xevent",
+                                   G_CALLBACK (gdk_x11_cairo_context_xevent),
+                                   self,
+                                   G_CONNECT_SWAPPED);
+          self->shm_xevent_connected = TRUE;
+        }
+    }
+  else
+    {
+      gdk_x11_shm_buffer_wait (display, buffer);
+    }
+
+  if (self->gc == NULL)
+    self->gc = XCreateGC (xdisplay, GDK_SURFACE_XID (surface), 0, NULL);
+
+  return buffer;
+}
+
+/* Gets the @n-th rectangle of @region in device pixels, clipped
+ * to @bounds. Returns %FALSE if nothing is left.
+ */
+static gboolean
+get_device_rectangle (cairo_region_t              *region,
+                      int                          n,
+                      int                          scale,
+                      const cairo_rectangle_int_t *bounds,
+                      cairo_rectangle_int_t       *rect)
+{
+  cairo_region_get_rectangle (region, n, rect);
+  rect->x *= scale;
+  rect->y *= scale;
+  rect->width *= scale;
+  rect->height *= scale;
+
+  return gdk_rectangle_intersect (rect, bounds, rect);
+}
+
+static void
+gdk_x11_cairo_context_put_shm_buffer (GdkX11CairoContext *self,
+                                      GdkX11ShmBuffer    *buffer,
+                                      cairo_region_t     *painted)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  cairo_rectangle_int_t rect, bounds;
+  int i, n, scale, last;
+
+  cairo_surface_flush (buffer->surface);
+
+  scale = gdk_surface_get_scale_factor (surface);
+  bounds = (cairo_rectangle_int_t) { 0, 0, buffer->image->width, buffer->image->height };
+
+  /* Only send the parts that were repainted. The server processes
+   * requests in order, so a completion event for the last one tells
+   * us that it is done with the image.
+   */
+  n = cairo_region_num_rectangles (painted);
+  for (last = n - 1; last >= 0; last--)
+    {
+      if (get_device_rectangle (painted, last, scale, &bounds, &rect))
+        break;
+    }
+
+  for (i = 0; i <= last; i++)
+    {
+      if (!get_device_rectangle (painted, i, scale, &bounds, &rect))
+        continue;
+
+      XShmPutImage (xdisplay, GDK_SURFACE_XID (surface), self->gc, buffer->image,
+                    rect.x, rect.y,
+                    rect.x, rect.y,
+                    rect.width, rect.height,
+                    i == last);
+    }
+
+  buffer->busy = last >= 0;
+  XFlush (xdisplay);
+}
+#endif
+
 static cairo_surface_t *
 create_cairo_surface_for_surface (GdkSurface *surface)
 {
@@ -66,6 +396,24 @@ gdk_x11_cairo_context_begin_frame (GdkDrawContext *draw_context,
   surface = gdk_draw_context_get_surface (draw_context);
   cairo_region_get_extents (region, &clip_box);
 
+#ifdef HAVE_XSHM
+  self->shm_buffer = gdk_x11_cairo_context_get_shm_buffer (self);
+  if (self->shm_buffer)
+    {
+      cairo_t *cr;
+
+      self->paint_surface = cairo_surface_reference (self->shm_buffer->surface);
+
+      /* The buffer still contains an older frame, clear the repaint area */
+      cr = cairo_create (self->paint_surface);
+      cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+      gdk_cairo_region (cr, region);
+      cairo_fill (cr);
+      cairo_destroy (cr);
+      return;
+    }
+#endif
+
   self->window_surface = create_cairo_surface_for_surface (surface);
   self->paint_surface = gdk_surface_create_similar_surface (surface,
                                                             cairo_surface_get_content (self->window_surface),
@@ -84,6 +432,18 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
   cairo_t *cr;
 
+#ifdef HAVE_XSHM
+  if (self->shm_buffer)
+    {
+      gdk_x11_cairo_context_put_shm_buffer (self, self->shm_buffer, painted);
+
+      self->shm_buffer = NULL;
+      self->shm_current = (self->shm_current + 1) % G_N_ELEMENTS (self->shm_buffers);
+      g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+      return;
+    }
+#endif
+
   cr = cairo_create (self->window_surface);
 
   cairo_set_source_surface (cr, self->paint_surface, 0, 0);
@@ -101,6 +461,16 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   g_clear_pointer (&self->window_surface, cairo_surface_destroy);
 }
 
+static void
+gdk_x11_cairo_context_surface_resized (GdkDrawContext *draw_context)
+{
+#ifdef HAVE_XSHM
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
+
+  gdk_x11_cairo_context_clear_shm_buffers (self);
+#endif
+}
+
 static cairo_t *
 gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
 {
@@ -109,14 +479,38 @@ gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
   return cairo_create (self->paint_surface);
 }
 
+static void
+gdk_x11_cairo_context_dispose (GObject *object)
+{
+#ifdef HAVE_XSHM
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (object);
+
+  gdk_x11_cairo_context_clear_shm_buffers (self);
+
+  if (self->gc)
+    {
+      GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+
+      XFreeGC (gdk_x11_display_get_xdisplay (display), self->gc);
+      self->gc = NULL;
+    }
+#endif
+
+  G_OBJECT_CLASS (gdk_x11_cairo_context_parent_class)->dispose (object);
+}
+
 static void
 gdk_x11_cairo_context_class_init (GdkX11CairoContextClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS (klass);
   GdkCairoContextClass *cairo_context_class = GDK_CAIRO_CONTEXT_CLASS (klass);
 
+  gobject_class->dispose = gdk_x11_cairo_context_dispose;
+
   draw_context_class->begin_frame = gdk_x11_cairo_context_begin_frame;
   draw_context_class->end_frame = gdk_x11_cairo_context_end_frame;
+  draw_context_class->surface_resized = gdk_x11_cairo_context_surface_resized;
 
   cairo_context_class->cairo_create = gdk_x11_cairo_context_cairo_create;
 }
@@ -125,4 +519,3 @@ static void
 gdk_x11_cairo_context_init (GdkX11CairoContext *self)
 {
 }
-
@@ -25,6 +25,8 @@
 
 #include "gdkcairocontextprivate.h"
 
+#include <X11/Xlib.h>
+
 G_BEGIN_DECLS
 
 #define GDK_TYPE_X11_CAIRO_CONTEXT		(gdk_x11_cairo_context_get_type ())
@@ -36,6 +38,7 @@ G_BEGIN_DECLS
 
 typedef struct _GdkX11CairoContext GdkX11CairoContext;
 typedef struct _GdkX11CairoContextClass GdkX11CairoContextClass;
+typedef struct _GdkX11ShmBuffer GdkX11ShmBuffer;
 
 struct _GdkX11CairoContext
 {
@@ -43,6 +46,15 @@ struct _GdkX11CairoContext
 
   cairo_surface_t *window_surface;
   cairo_surface_t *paint_surface;
+
+  /* MIT-SHM buffers, painted into alternately */
+  GdkX11ShmBuffer *shm_buffers[2];
+  GdkX11ShmBuffer *shm_buffer; /* the one used for the current frame */
+  guint shm_current;
+  GC gc;
+
+  guint shm_failed : 1;
+  guint shm_xevent_connected : 1;
 };
 
 struct _GdkX11CairoContextClass
@@ -77,6 +77,10 @@
 #include <X11/extensions/Xrandr.h>
 #endif
 
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
 enum {
   XEVENT,
   LAST_SIGNAL
@@ -1595,6 +1599,15 @@ gdk_x11_display_open (const char *display_name)
   }
 #endif
 
+  display_x11->have_shm = FALSE;
+#ifdef HAVE_XSHM
+  if (XShmQueryExtension (display_x11->xdisplay))
+    {
+      display_x11->have_shm = TRUE;
+      display_x11->shm_event_base = XShmGetEventBase (display_x11->xdisplay);
+    }
+#endif
+
 #ifdef HAVE_XDAMAGE
   display_x11->have_damage = FALSE;
   if (XDamageQueryExtension (display_x11->xdisplay,
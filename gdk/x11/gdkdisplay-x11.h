@@ -117,6 +117,7 @@ struct _GdkX11Display
 
   /* Sets of atoms for DND */
   guint use_sync : 1;
+  guint have_shm : 1;
 
   guint have_shapes : 1;
   guint have_input_shapes : 1;
@@ -151,6 +152,10 @@ struct _GdkX11Display
   guint has_glx_create_es2_context : 1;
   guint has_async_glx_swap_buffers : 1;
 
+#ifdef HAVE_XSHM
+  int shm_event_base;
+#endif
+
 #ifdef HAVE_XDAMAGE
   int damage_event_base;
   int damage_error_base;
@@ -79,7 +79,8 @@ upload_gdk_texture (GdkTexture      *source_texture,
 
   /* Note: GdkGLTextures are already handled before we reach this and reused as-is */
 
-  if (GDK_IS_MEMORY_TEXTURE (source_texture))
+  if (GDK_IS_MEMORY_TEXTURE (source_texture) &&
+      !gdk_memory_format_is_planar (gdk_memory_texture_get_format (GDK_MEMORY_TEXTURE (source_texture))))
     {
       GdkMemoryTexture *memory_texture = GDK_MEMORY_TEXTURE (source_texture);
       data = gdk_memory_texture_get_data (memory_texture);
@@ -144,6 +145,8 @@ texture_free (gpointer data)
 
       for (i = 0; i < t->n_slices; i ++)
         glDeleteTextures (1, &t->slices[i].texture_id);
+
+      g_free (t->slices);
     }
 
   g_slice_free (Texture, t);
@@ -508,6 +511,136 @@ gsk_gl_driver_slice_texture (GskGLDriver   *self,
   *out_n_slices = cols * rows;
 }
 
+static void
+upload_plane (const guchar *data,
+              gsize         stride,
+              int           width,
+              int           height,
+              int           bpp)
+{
+  GLenum format = bpp == 2 ? GL_RG : GL_RED;
+  GLenum internal_format = bpp == 2 ? GL_RG8 : GL_R8;
+  int y;
+
+  glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+
+  if (stride % bpp == 0)
+    {
+      glPixelStorei (GL_UNPACK_ROW_LENGTH, stride / bpp);
+      glTexImage2D (GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+      glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
+    }
+  else
+    {
+      glTexImage2D (GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, NULL);
+      for (y = 0; y < height; y++)
+        glTexSubImage2D (GL_TEXTURE_2D, 0, 0, y, width, 1, format, GL_UNSIGNED_BYTE, data + y * stride);
+    }
+
+  glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+}
+
+/* Uploads the planes of a planar memory texture as separate textures,
+ * so they can be converted to RGB in a shader. Returns the number of
+ * planes, or 0 if the texture needs to be converted on the CPU.
+ */
+guint
+gsk_gl_driver_get_planes_for_texture (GskGLDriver *self,
+                                      GdkTexture  *texture,
+                                      int         *out_texture_ids)
+{
+  GdkMemoryTexture *memory_texture;
+  GdkMemoryFormat format;
+  const guchar *planes[GDK_MEMORY_MAX_PLANES];
+  gsize strides[GDK_MEMORY_MAX_PLANES];
+  TextureSlice *slices;
+  Texture *tex;
+  guint n_planes, i;
+  int major, minor;
+
+  if (!GDK_IS_MEMORY_TEXTURE (texture))
+    return 0;
+
+  memory_texture = GDK_MEMORY_TEXTURE (texture);
+  format = gdk_memory_texture_get_format (memory_texture);
+  if (!gdk_memory_format_is_planar (format))
+    return 0;
+
+  /* We need GL_RED and GL_RG */
+  gdk_gl_context_get_version (self->gl_context, &major, &minor);
+  if (gdk_gl_context_get_use_es (self->gl_context) && major < 3)
+    return 0;
+
+  tex = gdk_texture_get_render_data (texture, self);
+
+  if (tex == NULL)
+    {
+      n_planes = gdk_memory_format_get_planes (format,
+                                               gdk_memory_texture_get_data (memory_texture),
+                                               gdk_memory_texture_get_stride (memory_texture),
+                                               texture->height,
+                                               planes, strides);
+
+      slices = g_new0 (TextureSlice, n_planes);
+
+      for (i = 0; i < n_planes; i++)
+        {
+          guint texture_id;
+          int width, height;
+
+          if (i == 0)
+            {
+              width = texture->width;
+              height = texture->height;
+            }
+          else
+            {
+              width = (texture->width + 1) / 2;
+              height = (texture->height + 1) / 2;
+            }
+
+          glGenTextures (1, &texture_id);
+
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (self->profiler, self->counters.created_textures);
+#endif
+          glBindTexture (GL_TEXTURE_2D, texture_id);
+          gsk_gl_driver_set_texture_parameters (self, GL_LINEAR, GL_LINEAR);
+          upload_plane (planes[i], strides[i], width, height,
+                        (i == 1 && n_planes == 2) ? 2 : 1);
+          gdk_gl_context_label_object_printf (self->gl_context, GL_TEXTURE, texture_id,
+                                              "GdkTexture<%p> plane %u", texture, i);
+
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
+#endif
+
+          slices[i].rect = (GdkRectangle) { 0, 0, width, height };
+          slices[i].texture_id = texture_id;
+        }
+
+      tex = texture_new ();
+      tex->width = texture->width;
+      tex->height = texture->height;
+      tex->min_filter = GL_LINEAR;
+      tex->mag_filter = GL_LINEAR;
+      tex->in_use = TRUE;
+      tex->slices = slices;
+      tex->n_slices = n_planes;
+
+      /* Like sliced textures, planes are not inserted into self->textures */
+      gdk_texture_set_render_data (texture, self, tex, texture_free);
+
+      /* Restore the bound texture */
+      self->bound_source_texture = NULL;
+    }
+
+  for (i = 0; i < tex->n_slices; i++)
+    out_texture_ids[i] = tex->slices[i].texture_id;
+
+  return tex->n_slices;
+}
+
 int
 gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
                                        GdkTexture  *texture,
@@ -551,7 +684,8 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
     {
       t = gdk_texture_get_render_data (texture, self);
 
-      if (t)
+      /* Sliced and planar textures don't have a single texture id */
+      if (t && t->texture_id != 0)
         {
           if (t->min_filter == min_filter && t->mag_filter == mag_filter)
             return t->texture_id;
@@ -80,6 +80,9 @@ void            gsk_gl_driver_slice_texture             (GskGLDriver     *self,
                                                          GdkTexture      *texture,
                                                          TextureSlice   **out_slices,
                                                          guint           *out_n_slices);
+guint           gsk_gl_driver_get_planes_for_texture    (GskGLDriver     *self,
+                                                         GdkTexture      *texture,
+                                                         int             *out_texture_ids);
 
 G_END_DECLS
 
@@ -25,6 +25,7 @@
 
 #include "gdk/gdkgltextureprivate.h"
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 #include "gdk/gdkrgbaprivate.h"
 
@@ -1034,6 +1035,36 @@ upload_texture (GskGLRenderer *self,
     }
 }
 
+static inline gboolean
+render_planar_texture_node (GskGLRenderer   *self,
+                            GskRenderNode   *node,
+                            RenderOpBuilder *builder)
+{
+  GdkTexture *texture = gsk_texture_node_get_texture (node);
+  int texture_ids[GDK_MEMORY_MAX_PLANES];
+  guint n_planes;
+  OpYuv *op;
+
+  n_planes = gsk_gl_driver_get_planes_for_texture (self->gl_driver, texture, texture_ids);
+  if (n_planes == 0)
+    return FALSE;
+
+  ops_set_program (builder, &self->programs->yuv_program);
+  ops_set_texture (builder, texture_ids[0]);
+
+  op = ops_begin (builder, OP_CHANGE_YUV);
+  op->n_planes = n_planes;
+  op->source2 = texture_ids[1];
+  op->source3 = n_planes == 3 ? texture_ids[2] : 0;
+
+  load_vertex_data_with_region (ops_draw (builder, NULL),
+                                &node->bounds, builder,
+                                &(TextureRegion) { 0, 0, 0, 1, 1 },
+                                FALSE);
+
+  return TRUE;
+}
+
 static inline void
 render_texture_node (GskGLRenderer       *self,
                      GskRenderNode       *node,
@@ -1079,6 +1110,10 @@ render_texture_node (GskGLRenderer       *self,
           });
         }
     }
+  else if (render_planar_texture_node (self, node, builder))
+    {
+      /* Converted to RGB in the shader */
+    }
   else
     {
       TextureRegion r;
@@ -3184,6 +3219,24 @@ apply_cross_fade_op (const Program     *program,
   glUniform1f (program->cross_fade.progress_location, op->progress);
 }
 
+static inline void
+apply_yuv_op (const Program *program,
+              const OpYuv   *op)
+{
+  OP_PRINT (" -> YUV %d planes", op->n_planes);
+  glUniform1i (program->yuv.n_planes_location, op->n_planes);
+  /* Chroma planes */
+  glUniform1i (program->yuv.source2_location, 1);
+  glActiveTexture (GL_TEXTURE0 + 1);
+  glBindTexture (GL_TEXTURE_2D, op->source2);
+  if (op->n_planes == 3)
+    {
+      glUniform1i (program->yuv.source3_location, 2);
+      glActiveTexture (GL_TEXTURE0 + 2);
+      glBindTexture (GL_TEXTURE_2D, op->source3);
+    }
+}
+
 static inline void
 apply_blend_op (const Program *program,
                 const OpBlend *op)
@@ -3328,6 +3381,7 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
     { "/org/gtk/libgsk/glsl/outset_shadow.glsl",             "outset shadow" },
     { "/org/gtk/libgsk/glsl/repeat.glsl",                    "repeat" },
     { "/org/gtk/libgsk/glsl/unblurred_outset_shadow.glsl",   "unblurred_outset shadow" },
+    { "/org/gtk/libgsk/glsl/yuv.glsl",                       "yuv" },
   };
 
   gsk_gl_shader_builder_init (&shader_builder,
@@ -3429,6 +3483,11 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
   INIT_PROGRAM_UNIFORM_LOCATION (repeat, child_bounds);
   INIT_PROGRAM_UNIFORM_LOCATION (repeat, texture_rect);
 
+  /* yuv */
+  INIT_PROGRAM_UNIFORM_LOCATION (yuv, n_planes);
+  INIT_PROGRAM_UNIFORM_LOCATION (yuv, source2);
+  INIT_PROGRAM_UNIFORM_LOCATION (yuv, source3);
+
 
   /* We initialize the alpha uniform here, since the default value is important.
    * We can't do it in the shader like a reasonable person would because that doesn't
@@ -4103,6 +4162,11 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self)
           apply_blend_op (program, ptr);
           break;
 
+        case OP_CHANGE_YUV:
+          g_assert (program == &self->programs->yuv_program);
+          apply_yuv_op (program, ptr);
+          break;
+
         case OP_CHANGE_LINEAR_GRADIENT:
           apply_linear_gradient_op (program, ptr);
           break;
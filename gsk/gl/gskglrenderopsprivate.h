@@ -13,7 +13,7 @@
 #include "opbuffer.h"
 
 #define GL_N_VERTICES 6
-#define GL_N_PROGRAMS 15
+#define GL_N_PROGRAMS 16
 #define GL_MAX_GRADIENT_STOPS 6
 
 typedef struct
@@ -171,6 +171,11 @@ struct _Program
       int child_bounds_location;
       int texture_rect_location;
     } repeat;
+    struct {
+      int n_planes_location;
+      int source2_location;
+      int source3_location;
+    } yuv;
     struct {
       int size_location;
       int args_locations[8];
@@ -201,6 +206,7 @@ typedef struct {
       Program outset_shadow_program;
       Program repeat_program;
       Program unblurred_outset_shadow_program;
+      Program yuv_program;
     };
   };
   GHashTable *custom_programs; /* GskGLShader -> Program* */
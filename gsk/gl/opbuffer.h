@@ -42,6 +42,7 @@ typedef enum
   OP_CHANGE_GL_SHADER_ARGS             = 28,
   OP_CHANGE_EXTRA_SOURCE_TEXTURE       = 29,
   OP_CHANGE_CONIC_GRADIENT             = 30,
+  OP_CHANGE_YUV                        = 31,
   OP_LAST
 } OpKind;
 
@@ -194,6 +195,13 @@ typedef struct
   int source2;
 } OpCrossFade;
 
+typedef struct
+{
+  int n_planes;
+  int source2;
+  int source3;
+} OpYuv;
+
 typedef struct
 {
   char *filename;
@@ -126,12 +126,13 @@ static void
 blur_rows (guchar *dst_buffer,
            guchar *tmp_buffer,
            int     buffer_width,
-           int     buffer_height,
+           int     first_row,
+           int     n_rows,
            int     d)
 {
   int i;
 
-  for (i = 0; i < buffer_height; i++)
+  for (i = first_row; i < first_row + n_rows; i++)
     {
       guchar *row = dst_buffer + i * buffer_width;
 
@@ -156,33 +157,331 @@ blur_rows (guchar *dst_buffer,
     }
 }
 
-/* Swaps width and height.
+/* Number of columns blur_yspan() handles at once. This is a cache line
+ * per row, and having it fixed means the inner loops have a constant
+ * trip count, which the compiler vectorizes even at -O2. The running
+ * sums live on the stack, so they can't alias the pixel rows either.
+ */
+#define BLUR_STRIP_WIDTH 64
+
+/* This is the vertical equivalent of blur_xspan(). Instead of
+ * transposing the buffer and running the sliding window down each
+ * column separately, we keep one running sum per column and slide
+ * the window over whole rows of the strip at a time. The inner loops
+ * then walk memory linearly and have no dependencies between columns,
+ * so the compiler can turn them into SIMD code.
+ *
+ * Unlike blur_xspan() this can't work in place, since the rows leaving
+ * the window have to be read back after the rows entering it have been
+ * written, so the result goes into @dst.
+ *
+ * @src and @dst point to the first column of the strip.
  */
 static void
-flip_buffer (guchar *dst_buffer,
-             guchar *src_buffer,
-             int     width,
-             int     height)
+blur_yspan (const guchar *src,
+            guchar       *dst,
+            int           buffer_width,
+            int           height,
+            int           d,
+            int           shift)
 {
-  /* Working in blocks increases cache efficiency, compared to reading
-   * or writing an entire column at once
+  guint sums[BLUR_STRIP_WIDTH];
+  guint reciprocal;
+  int offset;
+  int i, x;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  /* For sizes that aren't unrolled below we divide by multiplying with
+   * a fixed point reciprocal instead, which vectorizes where a divide
+   * doesn't. This is exact as long as sum * d < 2^32, so for anything
+   * bigger we keep the real division.
    */
-#define BLOCK_SIZE 16
-
-  int i0, j0;
-
-  for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
-    for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-      {
-        int max_j = MIN(j0 + BLOCK_SIZE, height);
-        int max_i = MIN(i0 + BLOCK_SIZE, width);
-        int i, j;
-
-        for (i = i0; i < max_i; i++)
-          for (j = j0; j < max_j; j++)
-            dst_buffer[i * height + j] = src_buffer[j * width + i];
-      }
-#undef BLOCK_SIZE
+  reciprocal = (G_MAXUINT32 / d) + 1;
+
+  memset (sums, 0, sizeof (sums));
+
+#define DIVIDE(n, D) ((n) / (D))
+
+#define BLUR_COLUMNS_KERNEL(D)                                          \
+  for (i = -(D) + offset; i < height + offset; i++)                     \
+    {                                                                   \
+      if (i >= 0 && i < height)                                         \
+        {                                                               \
+          const guchar *in = src + i * buffer_width;                    \
+          for (x = 0; x < BLUR_STRIP_WIDTH; x++)                        \
+            sums[x] += in[x];                                           \
+        }                                                               \
+                                                                        \
+      if (i >= offset)                                                  \
+        {                                                               \
+          guchar *out = dst + (i - offset) * buffer_width;              \
+                                                                        \
+          if (i >= (D))                                                 \
+            {                                                           \
+              const guchar *in = src + (i - (D)) * buffer_width;        \
+              for (x = 0; x < BLUR_STRIP_WIDTH; x++)                    \
+                sums[x] -= in[x];                                       \
+            }                                                           \
+                                                                        \
+          for (x = 0; x < BLUR_STRIP_WIDTH; x++)                        \
+            out[x] = DIVIDE (sums[x] + (D) / 2, (D));                   \
+        }                                                               \
+    }                                                                   \
+  break;
+
+  /* Same as in blur_xspan(): the constant divisors let the compiler
+   * replace the division with a multiplication. */
+  switch (d)
+    {
+    case BOX_FILTER_SIZE_2: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_2);
+    case BOX_FILTER_SIZE_3: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_3);
+    case BOX_FILTER_SIZE_4: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_4);
+    case BOX_FILTER_SIZE_5: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_5);
+    case BOX_FILTER_SIZE_6: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_6);
+    case BOX_FILTER_SIZE_7: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_7);
+    case BOX_FILTER_SIZE_8: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_8);
+    case BOX_FILTER_SIZE_9: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_9);
+    case BOX_FILTER_SIZE_10: BLUR_COLUMNS_KERNEL (BOX_FILTER_SIZE_10);
+    default:
+      if (d < 4096)
+        {
+#undef DIVIDE
+#define DIVIDE(n, D) ((guint) (((guint64) (n) * reciprocal) >> 32))
+          BLUR_COLUMNS_KERNEL (d);
+        }
+      else
+        {
+#undef DIVIDE
+#define DIVIDE(n, D) ((n) / (D))
+          BLUR_COLUMNS_KERNEL (d);
+        }
+    }
+
+#undef BLUR_COLUMNS_KERNEL
+#undef DIVIDE
+}
+
+/* Runs the three vertical box blur passes over one strip of
+ * BLUR_STRIP_WIDTH columns, using the same columns of @tmp.
+ */
+static void
+blur_strip (guchar *src,
+            guchar *tmp,
+            int     buffer_width,
+            int     buffer_height,
+            int     d)
+{
+  int i;
+
+  /* See blur_rows() for why even sizes are done this way */
+  if (d % 2 == 1)
+    {
+      blur_yspan (src, tmp, buffer_width, buffer_height, d, 0);
+      blur_yspan (tmp, src, buffer_width, buffer_height, d, 0);
+      blur_yspan (src, tmp, buffer_width, buffer_height, d, 0);
+    }
+  else
+    {
+      blur_yspan (src, tmp, buffer_width, buffer_height, d, 1);
+      blur_yspan (tmp, src, buffer_width, buffer_height, d, -1);
+      blur_yspan (src, tmp, buffer_width, buffer_height, d + 1, 0);
+    }
+
+  for (i = 0; i < buffer_height; i++)
+    memcpy (src + i * buffer_width, tmp + i * buffer_width, BLUR_STRIP_WIDTH);
+}
+
+/* Blurs the columns [first_column, first_column + n_columns)
+ * vertically. @tmp_buffer must be as large as @buffer; only the
+ * same columns of it are touched.
+ */
+static void
+blur_columns (guchar *buffer,
+              guchar *tmp_buffer,
+              int     buffer_width,
+              int     buffer_height,
+              int     first_column,
+              int     n_columns,
+              int     d)
+{
+  int end = first_column + n_columns;
+  int x, i;
+
+  for (x = first_column; x + BLUR_STRIP_WIDTH <= end; x += BLUR_STRIP_WIDTH)
+    blur_strip (buffer + x, tmp_buffer + x, buffer_width, buffer_height, d);
+
+  /* Whatever is left is padded to a full strip, the padding columns
+   * don't influence the others.
+   */
+  if (x < end)
+    {
+      guchar *padded;
+
+      padded = g_malloc0 (2 * BLUR_STRIP_WIDTH * buffer_height);
+
+      for (i = 0; i < buffer_height; i++)
+        memcpy (padded + i * BLUR_STRIP_WIDTH, buffer + i * buffer_width + x, end - x);
+
+      blur_strip (padded, padded + BLUR_STRIP_WIDTH * buffer_height,
+                  BLUR_STRIP_WIDTH, buffer_height, d);
+
+      for (i = 0; i < buffer_height; i++)
+        memcpy (buffer + i * buffer_width + x, padded + i * BLUR_STRIP_WIDTH, end - x);
+
+      g_free (padded);
+    }
+}
+
+/* Surfaces with fewer pixels than this are blurred on the calling
+ * thread; below that the cost of waking up the workers dominates.
+ */
+#define PARALLEL_BLUR_MIN_PIXELS (512 * 512)
+
+#define PARALLEL_BLUR_MAX_THREADS 8
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  int pending;
+} BlurTask;
+
+typedef struct
+{
+  BlurTask *task;
+  guchar *buffer;
+  guchar *tmp_buffer;
+  int width;
+  int height;
+  int d;
+  gboolean vertical;
+  int start;
+  int n;
+} BlurJob;
+
+static void
+blur_job_run (BlurJob *job)
+{
+  if (job->vertical)
+    {
+      blur_columns (job->buffer, job->tmp_buffer,
+                    job->width, job->height,
+                    job->start, job->n, job->d);
+    }
+  else
+    {
+      blur_rows (job->buffer, job->tmp_buffer,
+                 job->width, job->start, job->n, job->d);
+    }
+}
+
+static void
+blur_job_thread_func (gpointer data,
+                      gpointer user_data)
+{
+  BlurJob *job = data;
+  BlurTask *task = job->task;
+
+  blur_job_run (job);
+
+  g_mutex_lock (&task->lock);
+  task->pending--;
+  if (task->pending == 0)
+    g_cond_signal (&task->cond);
+  g_mutex_unlock (&task->lock);
+}
+
+static guint
+get_n_blur_threads (void)
+{
+  return MIN (g_get_num_processors (), PARALLEL_BLUR_MAX_THREADS);
+}
+
+static GThreadPool *
+get_blur_thread_pool (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (blur_job_thread_func,
+                                    NULL,
+                                    get_n_blur_threads (),
+                                    FALSE,
+                                    NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/* Splits one pass into @n_jobs pieces of [0, @total) rows or column
+ * strips and runs them on the blur thread pool. The last piece is run
+ * on the calling thread, which then waits for the others.
+ */
+static void
+blur_parallel (guchar   *buffer,
+               guchar   *tmp_buffer,
+               int       width,
+               int       height,
+               int       d,
+               gboolean  vertical,
+               int       total,
+               guint     n_jobs)
+{
+  GThreadPool *pool = get_blur_thread_pool ();
+  BlurJob *jobs;
+  BlurTask task;
+  guint i;
+
+  jobs = g_newa (BlurJob, n_jobs);
+
+  g_mutex_init (&task.lock);
+  g_cond_init (&task.cond);
+  task.pending = n_jobs - 1;
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      int start = total * i / n_jobs;
+      int end = total * (i + 1) / n_jobs;
+
+      /* The vertical pass is split in whole strips */
+      if (vertical)
+        {
+          start *= BLUR_STRIP_WIDTH;
+          end = MIN (end * BLUR_STRIP_WIDTH, width);
+        }
+
+      jobs[i].task = &task;
+      jobs[i].buffer = buffer;
+      /* The horizontal pass only needs one row of scratch space per job */
+      jobs[i].tmp_buffer = vertical ? tmp_buffer : tmp_buffer + i * width;
+      jobs[i].width = width;
+      jobs[i].height = height;
+      jobs[i].d = d;
+      jobs[i].vertical = vertical;
+      jobs[i].start = start;
+      jobs[i].n = end - start;
+
+      if (i + 1 < n_jobs)
+        g_thread_pool_push (pool, &jobs[i], NULL);
+    }
+
+  blur_job_run (&jobs[n_jobs - 1]);
+
+  g_mutex_lock (&task.lock);
+  while (task.pending > 0)
+    g_cond_wait (&task.cond, &task.lock);
+  g_mutex_unlock (&task.lock);
+
+  g_cond_clear (&task.cond);
+  g_mutex_clear (&task.lock);
 }
 
 static void
@@ -192,30 +491,45 @@ _boxblur (guchar      *buffer,
           int          radius,
           GskBlurFlags flags)
 {
-  guchar *flipped_buffer;
+  guchar *tmp_buffer;
   int d = get_box_filter_size (radius);
+  guint n_threads = 1;
 
-  flipped_buffer = g_malloc (width * height);
+  if (width * height >= PARALLEL_BLUR_MIN_PIXELS)
+    n_threads = get_n_blur_threads ();
 
   if (flags & GSK_BLUR_Y)
     {
-      /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
+      int n_strips = (width + BLUR_STRIP_WIDTH - 1) / BLUR_STRIP_WIDTH;
+      guint n_jobs = CLAMP ((guint) n_strips, 1, n_threads);
 
-      /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
+      tmp_buffer = g_malloc (width * height);
 
-      /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
+      if (n_jobs > 1)
+        blur_parallel (buffer, tmp_buffer, width, height, d, TRUE, n_strips, n_jobs);
+      else
+        blur_columns (buffer, tmp_buffer, width, height, 0, width, d);
+
+      g_free (tmp_buffer);
     }
 
   if (flags & GSK_BLUR_X)
     {
-      /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
-    }
+      guint n_jobs = CLAMP ((guint) height, 1, n_threads);
 
-  g_free (flipped_buffer);
+      if (n_jobs > 1)
+        {
+          tmp_buffer = g_malloc (width * n_jobs);
+          blur_parallel (buffer, tmp_buffer, width, height, d, FALSE, height, n_jobs);
+        }
+      else
+        {
+          tmp_buffer = g_malloc (width);
+          blur_rows (buffer, tmp_buffer, width, 0, height, d);
+        }
+
+      g_free (tmp_buffer);
+    }
 }
 
 /*
@@ -0,0 +1,31 @@
+// VERTEX_SHADER:
+void main() {
+  gl_Position = u_projection * u_modelview * vec4(aPosition, 0.0, 1.0);
+
+  vUv = vec2(aUv.x, aUv.y);
+}
+
+// FRAGMENT_SHADER:
+uniform int u_n_planes;
+uniform sampler2D u_source2;
+uniform sampler2D u_source3;
+
+void main() {
+  float y = GskTexture(u_source, vUv).r;
+  vec2 cbcr;
+
+  if (u_n_planes == 2)
+    cbcr = GskTexture(u_source2, vUv).rg;
+  else
+    cbcr = vec2(GskTexture(u_source2, vUv).r, GskTexture(u_source3, vUv).r);
+
+  /* BT.601, limited range */
+  y = 1.164383 * (y - 16.0 / 255.0);
+  cbcr = cbcr - 128.0 / 255.0;
+
+  vec3 rgb = vec3(y + 1.596027 * cbcr.y,
+                  y - 0.391762 * cbcr.x - 0.812968 * cbcr.y,
+                  y + 2.017232 * cbcr.x);
+
+  gskSetOutputColor(vec4(clamp(rgb, 0.0, 1.0), 1.0) * u_alpha);
+}
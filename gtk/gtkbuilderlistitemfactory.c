@@ -22,7 +22,9 @@
 #include "gtkbuilderlistitemfactory.h"
 
 #include "gtkbuilder.h"
+#include "gtkbuilderplanprivate.h"
 #include "gtkbuilderprivate.h"
+#include "gtkdebug.h"
 #include "gtkintl.h"
 #include "gtklistitemfactoryprivate.h"
 #include "gtklistitemprivate.h"
@@ -54,6 +56,11 @@
  *     </template>
  *   </interface>
  * ]|
+ *
+ * The template is only parsed once. Unless it uses features that need
+ * the full #GtkBuilder machinery, like custom tags, the resulting
+ * objects, property values and expressions are then used to set up
+ * every list item without parsing the template again.
  */
 
 struct _GtkBuilderListItemFactory
@@ -64,6 +71,9 @@ struct _GtkBuilderListItemFactory
   GBytes *bytes;
   GBytes *data;
   char *resource;
+
+  GtkBuilderPlan *plan;
+  guint plan_failed : 1;
 };
 
 struct _GtkBuilderListItemFactoryClass
@@ -84,17 +94,53 @@ G_DEFINE_TYPE (GtkBuilderListItemFactory, gtk_builder_list_item_factory, GTK_TYP
 
 static GParamSpec *properties[N_PROPS] = { NULL, };
 
+static GtkBuilderPlan *
+gtk_builder_list_item_factory_get_plan (GtkBuilderListItemFactory *self,
+                                        GType                      template_type)
+{
+  GError *error = NULL;
+
+  if (self->plan == NULL && !self->plan_failed)
+    {
+      self->plan = gtk_builder_plan_new (self->scope, template_type, self->data, &error);
+      if (self->plan == NULL)
+        {
+          GTK_NOTE (BUILDER,
+                    g_message ("Using GtkBuilder for list item template: %s", error->message));
+          g_error_free (error);
+          self->plan_failed = TRUE;
+        }
+    }
+
+  if (self->plan && gtk_builder_plan_get_template_type (self->plan) != template_type)
+    return NULL;
+
+  return self->plan;
+}
+
 static void
 gtk_builder_list_item_factory_setup (GtkListItemFactory *factory,
                                      GtkListItemWidget  *widget,
                                      GtkListItem        *list_item)
 {
   GtkBuilderListItemFactory *self = GTK_BUILDER_LIST_ITEM_FACTORY (factory);
+  GtkBuilderPlan *plan;
   GtkBuilder *builder;
   GError *error = NULL;
 
   GTK_LIST_ITEM_FACTORY_CLASS (gtk_builder_list_item_factory_parent_class)->setup (factory, widget, list_item);
 
+  plan = gtk_builder_list_item_factory_get_plan (self, G_OBJECT_TYPE (list_item));
+  if (plan)
+    {
+      if (!gtk_builder_plan_instantiate (plan, G_OBJECT (list_item), &error))
+        {
+          g_critical ("Error building template for list item: %s", error->message);
+          g_error_free (error);
+        }
+      return;
+    }
+
   builder = gtk_builder_new ();
 
   gtk_builder_set_current_object (builder, G_OBJECT (list_item));
@@ -181,6 +227,10 @@ gtk_builder_list_item_factory_set_bytes (GtkBuilderListItemFactory *self,
           self->data = data;
         }
     }
+  else
+    {
+      self->data = g_bytes_ref (bytes);
+    }
 
   return TRUE;
 }
@@ -243,6 +293,7 @@ gtk_builder_list_item_factory_finalize (GObject *object)
   g_bytes_unref (self->bytes);
   g_bytes_unref (self->data);
   g_free (self->resource);
+  g_clear_pointer (&self->plan, gtk_builder_plan_free);
 
   G_OBJECT_CLASS (gtk_builder_list_item_factory_parent_class)->finalize (object);
 }
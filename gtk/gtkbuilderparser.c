@@ -204,6 +204,26 @@ gtk_buildable_parse_context_parse (GtkBuildableParseContext *context,
   return res;
 }
 
+/* Runs @parser over @text, which may be precompiled. This is for code
+ * that wants to look at a UI definition without building it.
+ */
+gboolean
+_gtk_buildable_parser_parse (const GtkBuildableParser  *parser,
+                             gpointer                   user_data,
+                             const char                *text,
+                             gssize                     text_len,
+                             GError                   **error)
+{
+  GtkBuildableParseContext context;
+  gboolean res;
+
+  gtk_buildable_parse_context_init (&context, parser, user_data);
+  res = gtk_buildable_parse_context_parse (&context, text, text_len, error);
+  gtk_buildable_parse_context_free (&context);
+
+  return res;
+}
+
 
 /**
  * gtk_buildable_parse_context_push:
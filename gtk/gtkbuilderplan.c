@@ -0,0 +1,2108 @@
+/* gtkbuilderplan.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkbuilderplanprivate.h"
+
+#include "gtkbuildableprivate.h"
+#include "gtkbuilderlistitemfactory.h"
+#include "gtkbuilderprivate.h"
+#include "gtkbuilderscopeprivate.h"
+#include "gtkdebug.h"
+#include "gtkexpression.h"
+#include "gtkshortcutaction.h"
+#include "gtkshortcuttrigger.h"
+#include "gtkversion.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* A GtkBuilderPlan is a template that has been parsed once into a tree
+ * of objects with their types, property specs, property values,
+ * expressions and signal handlers resolved, so that it can be
+ * instantiated over and over without going through GtkBuilder.
+ *
+ * It is used by GtkBuilderListItemFactory, which instantiates the same
+ * template for every row it creates.
+ *
+ * Only the parts of the format that such templates typically use are
+ * supported: objects, properties, bindings, expressions, signals and
+ * children. Custom tags, internal children, constructors and toplevel
+ * objects other than the template make gtk_builder_plan_new() fail, and
+ * callers are expected to fall back to GtkBuilder in that case.
+ *
+ * Instantiating a plan does the same things GtkBuilder does in the same
+ * order: nested objects are created before the object whose property
+ * they are set on, children are added right after they are created,
+ * and references to other objects, bindings and signals are set up once
+ * all objects exist.
+ */
+
+#define NO_OBJECT G_MAXUINT
+
+typedef struct _PlanExpression PlanExpression;
+
+typedef struct
+{
+  char *name;
+  guint index;
+} PlanReference;
+
+typedef enum {
+  EXPRESSION_CONSTANT,
+  EXPRESSION_OBJECT,
+  EXPRESSION_LOOKUP,
+  EXPRESSION_CLOSURE
+} PlanExpressionType;
+
+struct _PlanExpression
+{
+  PlanExpressionType type;
+  /* Set if the expression does not depend on any of the objects
+   * of the plan, it is then shared by all instances.
+   */
+  GtkExpression *expression;
+  union {
+    struct {
+      GType type;
+      GString *text;
+    } constant;
+    PlanReference object;
+    struct {
+      GType this_type;
+      char *property_name;
+      GParamSpec *pspec;
+      PlanExpression *expression;
+    } lookup;
+    struct {
+      GType type;
+      char *function_name;
+      GCallback callback;
+      PlanReference object;
+      gboolean swapped;
+      GPtrArray *params;
+    } closure;
+  };
+};
+
+typedef enum {
+  PROPERTY_VALUE,
+  PROPERTY_OBJECT,
+  PROPERTY_REFERENCE,
+  PROPERTY_EXPRESSION
+} PlanPropertyType;
+
+typedef struct
+{
+  GParamSpec *pspec;
+  PlanPropertyType type;
+  union {
+    GValue value;
+    guint object;
+    PlanReference reference;
+    PlanExpression *expression;
+  };
+  /* Only used while parsing */
+  GString *text;
+  char *context;
+  gboolean translatable;
+  gboolean bound;
+} PlanProperty;
+
+typedef struct
+{
+  GParamSpec *target_pspec;
+  /* The source for a property binding or the this object
+   * for an expression binding.
+   */
+  PlanReference source;
+  char *source_property;
+  GBindingFlags flags;
+  PlanExpression *expression;
+} PlanBinding;
+
+typedef struct
+{
+  guint id;
+  GQuark detail;
+  char *handler;
+  GCallback callback;
+  GConnectFlags flags;
+  PlanReference object;
+} PlanSignal;
+
+typedef struct
+{
+  GType type;
+  GObjectClass *oclass;
+  GtkBuildableIface *buildable_iface;
+  /* Whether parser_finished() needs to be called */
+  gboolean parser_finished;
+  char *id;
+  /* The type attribute of the <child> this object is in */
+  char *child_type;
+  GPtrArray *properties;
+  GArray *children;
+  GPtrArray *bindings;
+  GPtrArray *signals;
+  /* Set once the object has children, at that point GtkBuilder
+   * has constructed it and ignores further properties.
+   */
+  gboolean has_children;
+} PlanObject;
+
+struct _GtkBuilderPlan
+{
+  GtkBuilder *builder;
+  GtkBuilderScope *scope;
+  GType template_type;
+  /* PlanObject, the first one is the template */
+  GPtrArray *objects;
+  /* Set if closures need to be created by the scope, which may
+   * look at the current object.
+   */
+  gboolean needs_current_object;
+};
+
+typedef enum {
+  FRAME_INTERFACE,
+  FRAME_REQUIRES,
+  FRAME_OBJECT,
+  FRAME_PROPERTY,
+  FRAME_BINDING,
+  FRAME_CHILD,
+  FRAME_SIGNAL,
+  FRAME_EXPRESSION,
+  FRAME_PLACEHOLDER
+} FrameType;
+
+typedef struct
+{
+  FrameType type;
+  gpointer data;
+} Frame;
+
+typedef struct
+{
+  GtkBuilderPlan *plan;
+  GArray *frames;
+  GHashTable *ids;
+  char *domain;
+  gboolean has_interface;
+} PlanParser;
+
+static void
+plan_reference_clear (PlanReference *ref)
+{
+  g_free (ref->name);
+}
+
+static void
+plan_expression_free (PlanExpression *expr)
+{
+  g_clear_pointer (&expr->expression, gtk_expression_unref);
+
+  switch (expr->type)
+    {
+    case EXPRESSION_CONSTANT:
+      if (expr->constant.text)
+        g_string_free (expr->constant.text, TRUE);
+      break;
+
+    case EXPRESSION_OBJECT:
+      plan_reference_clear (&expr->object);
+      break;
+
+    case EXPRESSION_LOOKUP:
+      g_free (expr->lookup.property_name);
+      g_clear_pointer (&expr->lookup.expression, plan_expression_free);
+      break;
+
+    case EXPRESSION_CLOSURE:
+      g_free (expr->closure.function_name);
+      plan_reference_clear (&expr->closure.object);
+      g_ptr_array_unref (expr->closure.params);
+      break;
+
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  g_slice_free (PlanExpression, expr);
+}
+
+static void
+plan_property_free (PlanProperty *prop)
+{
+  switch (prop->type)
+    {
+    case PROPERTY_VALUE:
+      if (G_IS_VALUE (&prop->value))
+        g_value_unset (&prop->value);
+      break;
+
+    case PROPERTY_OBJECT:
+      break;
+
+    case PROPERTY_REFERENCE:
+      plan_reference_clear (&prop->reference);
+      break;
+
+    case PROPERTY_EXPRESSION:
+      g_clear_pointer (&prop->expression, plan_expression_free);
+      break;
+
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  if (prop->text)
+    g_string_free (prop->text, TRUE);
+  g_free (prop->context);
+
+  g_slice_free (PlanProperty, prop);
+}
+
+static void
+plan_binding_free (PlanBinding *binding)
+{
+  plan_reference_clear (&binding->source);
+  g_free (binding->source_property);
+  g_clear_pointer (&binding->expression, plan_expression_free);
+
+  g_slice_free (PlanBinding, binding);
+}
+
+static void
+plan_signal_free (PlanSignal *signal)
+{
+  g_free (signal->handler);
+  plan_reference_clear (&signal->object);
+
+  g_slice_free (PlanSignal, signal);
+}
+
+static void
+plan_object_free (PlanObject *object)
+{
+  g_type_class_unref (object->oclass);
+  g_free (object->id);
+  g_free (object->child_type);
+  g_ptr_array_unref (object->properties);
+  g_array_unref (object->children);
+  g_ptr_array_unref (object->bindings);
+  g_ptr_array_unref (object->signals);
+
+  g_slice_free (PlanObject, object);
+}
+
+static guint
+plan_object_new (GtkBuilderPlan *self,
+                 GType           type)
+{
+  PlanObject *object;
+
+  object = g_slice_new0 (PlanObject);
+  object->type = type;
+  object->oclass = g_type_class_ref (type);
+  object->buildable_iface = g_type_interface_peek (object->oclass, GTK_TYPE_BUILDABLE);
+  if (object->buildable_iface && object->buildable_iface->parser_finished)
+    {
+      gpointer widget_class = g_type_class_peek (GTK_TYPE_WIDGET);
+      GtkBuildableIface *widget_iface = NULL;
+
+      /* GtkWidget's implementation does nothing, so widgets that don't
+       * override it don't need a builder for it.
+       */
+      if (widget_class)
+        widget_iface = g_type_interface_peek (widget_class, GTK_TYPE_BUILDABLE);
+      object->parser_finished = widget_iface == NULL ||
+                                object->buildable_iface->parser_finished != widget_iface->parser_finished;
+    }
+  object->properties = g_ptr_array_new_with_free_func ((GDestroyNotify) plan_property_free);
+  object->children = g_array_new (FALSE, FALSE, sizeof (guint));
+  object->bindings = g_ptr_array_new_with_free_func ((GDestroyNotify) plan_binding_free);
+  object->signals = g_ptr_array_new_with_free_func ((GDestroyNotify) plan_signal_free);
+
+  g_ptr_array_add (self->objects, object);
+
+  return self->objects->len - 1;
+}
+
+static inline PlanObject *
+plan_get_object (GtkBuilderPlan *self,
+                 guint           index)
+{
+  return g_ptr_array_index (self->objects, index);
+}
+
+/* {{{ Parsing */
+
+static void
+set_error (GtkBuildableParseContext  *context,
+           GError                   **error,
+           GtkBuilderError            code,
+           const char                *format,
+           ...) G_GNUC_PRINTF (4, 5);
+
+static void
+set_error (GtkBuildableParseContext  *context,
+           GError                   **error,
+           GtkBuilderError            code,
+           const char                *format,
+           ...)
+{
+  va_list args;
+  char *message;
+  int line, col;
+
+  va_start (args, format);
+  message = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  gtk_buildable_parse_context_get_position (context, &line, &col);
+  g_set_error (error, GTK_BUILDER_ERROR, code, "%d:%d %s", line, col, message);
+
+  g_free (message);
+}
+
+static void
+set_unsupported_error (GtkBuildableParseContext  *context,
+                       const char                *element_name,
+                       GError                   **error)
+{
+  set_error (context, error,
+             GTK_BUILDER_ERROR_UNHANDLED_TAG,
+             "<%s> is not supported here", element_name);
+}
+
+static Frame *
+peek_frame (PlanParser *parser)
+{
+  if (parser->frames->len == 0)
+    return NULL;
+
+  return &g_array_index (parser->frames, Frame, parser->frames->len - 1);
+}
+
+static void
+push_frame (PlanParser *parser,
+            FrameType   type,
+            gpointer    data)
+{
+  Frame frame = { type, data };
+
+  g_array_append_val (parser->frames, frame);
+}
+
+static PlanObject *
+peek_object (PlanParser *parser,
+             guint      *index)
+{
+  Frame *frame = peek_frame (parser);
+
+  if (frame == NULL || frame->type != FRAME_OBJECT)
+    return NULL;
+
+  if (index)
+    *index = GPOINTER_TO_UINT (frame->data);
+
+  return plan_get_object (parser->plan, GPOINTER_TO_UINT (frame->data));
+}
+
+static gboolean
+add_id (PlanParser                *parser,
+        GtkBuildableParseContext  *context,
+        const char                *id,
+        guint                      index,
+        GError                   **error)
+{
+  if (g_hash_table_contains (parser->ids, id))
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_DUPLICATE_ID,
+                 "Duplicate object ID '%s'", id);
+      return FALSE;
+    }
+
+  g_hash_table_insert (parser->ids, g_strdup (id), GUINT_TO_POINTER (index));
+
+  return TRUE;
+}
+
+static void
+parse_interface (PlanParser                *parser,
+                 GtkBuildableParseContext  *context,
+                 const char                *element_name,
+                 const char               **names,
+                 const char               **values,
+                 GError                   **error)
+{
+  const char *domain = NULL;
+
+  if (peek_frame (parser) != NULL)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "domain", &domain,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  if (domain)
+    {
+      g_free (parser->domain);
+      parser->domain = g_strdup (domain);
+    }
+
+  push_frame (parser, FRAME_INTERFACE, NULL);
+}
+
+static void
+parse_requires (PlanParser                *parser,
+                GtkBuildableParseContext  *context,
+                const char                *element_name,
+                const char               **names,
+                const char               **values,
+                GError                   **error)
+{
+  const char *library = NULL;
+  const char *version = NULL;
+  int major, minor;
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING, "lib", &library,
+                                    G_MARKUP_COLLECT_STRING, "version", &version,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  if (strcmp (library, "gtk") == 0)
+    {
+      if (sscanf (version, "%d.%d", &major, &minor) != 2)
+        {
+          set_error (context, error,
+                     GTK_BUILDER_ERROR_INVALID_VALUE,
+                     "'version' attribute has malformed value '%s'", version);
+          return;
+        }
+
+      /* We allow 3.99.x to pass as 4.0, like GtkBuilder */
+      if (!(major == 4 && minor == 0) &&
+          gtk_check_version (major, minor, 0) != NULL)
+        {
+          set_error (context, error,
+                     GTK_BUILDER_ERROR_VERSION_MISMATCH,
+                     "Required GTK version %d.%d, current version is %d.%d",
+                     major, minor, GTK_MAJOR_VERSION, GTK_MINOR_VERSION);
+          return;
+        }
+    }
+
+  push_frame (parser, FRAME_REQUIRES, NULL);
+}
+
+static void
+parse_template (PlanParser                *parser,
+                GtkBuildableParseContext  *context,
+                const char                *element_name,
+                const char               **names,
+                const char               **values,
+                GError                   **error)
+{
+  GtkBuilderPlan *self = parser->plan;
+  const char *object_class = NULL;
+  Frame *frame;
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING, "class", &object_class,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "parent", NULL,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  frame = peek_frame (parser);
+  if (frame == NULL || frame->type != FRAME_INTERFACE || self->objects->len > 0)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (g_type_from_name (object_class) != self->template_type)
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_TEMPLATE_MISMATCH,
+                 "Parsed template definition for type '%s', expected type '%s'",
+                 object_class, g_type_name (self->template_type));
+      return;
+    }
+
+  plan_object_new (self, self->template_type);
+  if (!add_id (parser, context, object_class, 0, error))
+    return;
+
+  push_frame (parser, FRAME_OBJECT, GUINT_TO_POINTER (0));
+}
+
+static void
+parse_object (PlanParser                *parser,
+              GtkBuildableParseContext  *context,
+              const char                *element_name,
+              const char               **names,
+              const char               **values,
+              GError                   **error)
+{
+  GtkBuilderPlan *self = parser->plan;
+  const char *object_class = NULL;
+  const char *constructor = NULL;
+  const char *type_func = NULL;
+  const char *object_id = NULL;
+  PlanObject *object;
+  GType type;
+  guint index;
+  Frame *frame;
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "class", &object_class,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "constructor", &constructor,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "type-func", &type_func,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "id", &object_id,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  /* Toplevel objects other than the template are not supported,
+   * they would need to be owned by something.
+   */
+  frame = peek_frame (parser);
+  if (frame == NULL ||
+      !(frame->type == FRAME_CHILD || frame->type == FRAME_PROPERTY) ||
+      constructor != NULL)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (type_func)
+    type = gtk_builder_scope_get_type_from_function (self->scope, self->builder, type_func);
+  else if (object_class)
+    type = gtk_builder_get_type_from_name (self->builder, object_class);
+  else
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_MISSING_ATTRIBUTE,
+                 "<%s> requires attribute 'class'", element_name);
+      return;
+    }
+
+  if (type == G_TYPE_INVALID ||
+      !g_type_is_a (type, G_TYPE_OBJECT) ||
+      G_TYPE_IS_ABSTRACT (type))
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_INVALID_VALUE,
+                 "Invalid object type '%s'", type_func ? type_func : object_class);
+      return;
+    }
+
+  if (g_type_is_a (type, self->template_type))
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_OBJECT_TYPE_REFUSED,
+                 "Refused to build object of type '%s' because it "
+                 "conforms to the template type '%s', avoiding infinite recursion.",
+                 g_type_name (type), g_type_name (self->template_type));
+      return;
+    }
+
+  index = plan_object_new (self, type);
+  object = plan_get_object (self, index);
+
+  if (object_id)
+    {
+      if (!add_id (parser, context, object_id, index, error))
+        return;
+      object->id = g_strdup (object_id);
+    }
+
+  if (frame->type == FRAME_PROPERTY)
+    {
+      PlanProperty *prop = frame->data;
+
+      if (prop->type != PROPERTY_VALUE || !G_IS_PARAM_SPEC_OBJECT (prop->pspec))
+        {
+          set_unsupported_error (context, element_name, error);
+          return;
+        }
+
+      prop->type = PROPERTY_OBJECT;
+      prop->object = index;
+    }
+  else
+    {
+      PlanObject *parent;
+
+      /* The frame below the <child> is the parent */
+      parent = plan_get_object (self, GPOINTER_TO_UINT (g_array_index (parser->frames, Frame, parser->frames->len - 2).data));
+      g_array_append_val (parent->children, index);
+      object->child_type = g_strdup (frame->data);
+    }
+
+  push_frame (parser, FRAME_OBJECT, GUINT_TO_POINTER (index));
+}
+
+static void
+parse_child (PlanParser                *parser,
+             GtkBuildableParseContext  *context,
+             const char                *element_name,
+             const char               **names,
+             const char               **values,
+             GError                   **error)
+{
+  const char *type = NULL;
+  const char *internal_child = NULL;
+  PlanObject *object;
+
+  object = peek_object (parser, NULL);
+  if (object == NULL)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "type", &type,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "internal-child", &internal_child,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  if (internal_child != NULL)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (object->buildable_iface == NULL && !g_type_is_a (object->type, G_TYPE_LIST_STORE))
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_INVALID_TAG,
+                 "Objects of type '%s' can't have children",
+                 g_type_name (object->type));
+      return;
+    }
+
+  object->has_children = TRUE;
+
+  /* The frame keeps the type, the object takes it over */
+  push_frame (parser, FRAME_CHILD, (gpointer) g_intern_string (type));
+}
+
+static void
+parse_property (PlanParser                *parser,
+                GtkBuildableParseContext  *context,
+                const char                *element_name,
+                const char               **names,
+                const char               **values,
+                GError                   **error)
+{
+  const char *name = NULL;
+  const char *translation_context = NULL;
+  const char *bind_source = NULL;
+  const char *bind_property = NULL;
+  const char *bind_flags_str = NULL;
+  GBindingFlags bind_flags = G_BINDING_DEFAULT;
+  gboolean translatable = FALSE;
+  PlanObject *object;
+  PlanProperty *prop;
+  GParamSpec *pspec;
+
+  object = peek_object (parser, NULL);
+  if (object == NULL || object->has_children)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING, "name", &name,
+                                    G_MARKUP_COLLECT_BOOLEAN|G_MARKUP_COLLECT_OPTIONAL, "translatable", &translatable,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "comments", NULL,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "context", &translation_context,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "bind-source", &bind_source,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "bind-property", &bind_property,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "bind-flags", &bind_flags_str,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  pspec = g_object_class_find_property (object->oclass, name);
+  if (pspec == NULL)
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_INVALID_PROPERTY,
+                 "Invalid property: %s.%s",
+                 g_type_name (object->type), name);
+      return;
+    }
+
+  if (bind_flags_str &&
+      !_gtk_builder_flags_from_string (G_TYPE_BINDING_FLAGS, NULL, bind_flags_str, &bind_flags, error))
+    return;
+
+  if (bind_source)
+    {
+      PlanBinding *binding;
+
+      binding = g_slice_new0 (PlanBinding);
+      binding->target_pspec = pspec;
+      binding->source.name = g_strdup (bind_source);
+      binding->source_property = g_strdup (bind_property ? bind_property : name);
+      binding->flags = bind_flags;
+      g_ptr_array_add (object->bindings, binding);
+    }
+  else if (bind_property)
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_MISSING_ATTRIBUTE,
+                 "<%s> requires attribute 'bind-source'", element_name);
+      return;
+    }
+
+  prop = g_slice_new0 (PlanProperty);
+  prop->pspec = pspec;
+  prop->type = PROPERTY_VALUE;
+  prop->text = g_string_new ("");
+  prop->context = g_strdup (translation_context);
+  prop->translatable = translatable;
+  prop->bound = bind_source != NULL;
+
+  push_frame (parser, FRAME_PROPERTY, prop);
+}
+
+static void
+parse_binding (PlanParser                *parser,
+               GtkBuildableParseContext  *context,
+               const char                *element_name,
+               const char               **names,
+               const char               **values,
+               GError                   **error)
+{
+  const char *name = NULL;
+  const char *object_name = NULL;
+  PlanBinding *binding;
+  PlanObject *object;
+  GParamSpec *pspec;
+
+  object = peek_object (parser, NULL);
+  if (object == NULL)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING, "name", &name,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "object", &object_name,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  pspec = g_object_class_find_property (object->oclass, name);
+  if (pspec == NULL ||
+      (pspec->flags & G_PARAM_CONSTRUCT_ONLY) ||
+      !(pspec->flags & G_PARAM_WRITABLE))
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_INVALID_PROPERTY,
+                 "Invalid property: %s.%s",
+                 g_type_name (object->type), name);
+      return;
+    }
+
+  binding = g_slice_new0 (PlanBinding);
+  binding->target_pspec = pspec;
+  /* Expressions are evaluated for the template by default */
+  binding->source.name = g_strdup (object_name);
+  binding->source.index = 0;
+
+  push_frame (parser, FRAME_BINDING, binding);
+}
+
+static void
+parse_signal (PlanParser                *parser,
+              GtkBuildableParseContext  *context,
+              const char                *element_name,
+              const char               **names,
+              const char               **values,
+              GError                   **error)
+{
+  const char *name;
+  const char *handler = NULL;
+  const char *object_name = NULL;
+  gboolean after = FALSE;
+  gboolean swapped = -1;
+  PlanObject *object;
+  PlanSignal *signal;
+  GQuark detail;
+  guint id;
+
+  object = peek_object (parser, NULL);
+  if (object == NULL)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  if (!g_markup_collect_attributes (element_name, names, values, error,
+                                    G_MARKUP_COLLECT_STRING, "name", &name,
+                                    G_MARKUP_COLLECT_STRING, "handler", &handler,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "object", &object_name,
+                                    G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "last_modification_time", NULL,
+                                    G_MARKUP_COLLECT_BOOLEAN|G_MARKUP_COLLECT_OPTIONAL, "after", &after,
+                                    G_MARKUP_COLLECT_TRISTATE|G_MARKUP_COLLECT_OPTIONAL, "swapped", &swapped,
+                                    G_MARKUP_COLLECT_INVALID))
+    return;
+
+  if (!g_signal_parse_name (name, object->type, &id, &detail, FALSE))
+    {
+      set_error (context, error,
+                 GTK_BUILDER_ERROR_INVALID_SIGNAL,
+                 "Invalid signal '%s' for type '%s'",
+                 name, g_type_name (object->type));
+      return;
+    }
+
+  /* Swapped defaults to FALSE except when object is set */
+  if (swapped == -1)
+    swapped = object_name != NULL;
+
+  signal = g_slice_new0 (PlanSignal);
+  signal->id = id;
+  signal->detail = detail;
+  signal->handler = g_strdup (handler);
+  if (after)
+    signal->flags |= G_CONNECT_AFTER;
+  if (swapped)
+    signal->flags |= G_CONNECT_SWAPPED;
+  signal->object.name = g_strdup (object_name);
+  signal->object.index = NO_OBJECT;
+
+  g_ptr_array_add (object->signals, signal);
+
+  push_frame (parser, FRAME_SIGNAL, NULL);
+}
+
+/* Finds where an expression element goes, like
+ * check_expression_parent() in the GtkBuilder parser.
+ */
+static PlanExpression **
+get_expression_slot (PlanParser *parser)
+{
+  Frame *frame = peek_frame (parser);
+
+  if (frame == NULL)
+    return NULL;
+
+  switch (frame->type)
+    {
+    case FRAME_PROPERTY:
+      {
+        PlanProperty *prop = frame->data;
+
+        if (prop->type != PROPERTY_VALUE ||
+            G_PARAM_SPEC_VALUE_TYPE (prop->pspec) != GTK_TYPE_EXPRESSION)
+          return NULL;
+
+        prop->type = PROPERTY_EXPRESSION;
+        prop->expression = NULL;
+        return &prop->expression;
+      }
+
+    case FRAME_BINDING:
+      {
+        PlanBinding *binding = frame->data;
+
+        if (binding->expression)
+          return NULL;
+        return &binding->expression;
+      }
+
+    case FRAME_EXPRESSION:
+      {
+        PlanExpression *expr = frame->data;
+
+        switch (expr->type)
+          {
+          case EXPRESSION_LOOKUP:
+            if (expr->lookup.expression)
+              return NULL;
+            return &expr->lookup.expression;
+
+          case EXPRESSION_CLOSURE:
+            g_ptr_array_add (expr->closure.params, NULL);
+            return (PlanExpression **) &expr->closure.params->pdata[expr->closure.params->len - 1];
+
+          case EXPRESSION_CONSTANT:
+          case EXPRESSION_OBJECT:
+            return NULL;
+
+          default:
+            g_assert_not_reached ();
+            return NULL;
+          }
+      }
+
+    case FRAME_INTERFACE:
+    case FRAME_REQUIRES:
+    case FRAME_OBJECT:
+    case FRAME_CHILD:
+    case FRAME_SIGNAL:
+    case FRAME_PLACEHOLDER:
+    default:
+      return NULL;
+    }
+}
+
+static GType
+parse_type_attribute (PlanParser                *parser,
+                      GtkBuildableParseContext  *context,
+                      const char                *type_name,
+                      GError                   **error)
+{
+  GType type;
+
+  if (type_name == NULL)
+    return G_TYPE_INVALID;
+
+  type = gtk_builder_get_type_from_name (parser->plan->builder, type_name);
+  if (type == G_TYPE_INVALID)
+    set_error (context, error,
+               GTK_BUILDER_ERROR_INVALID_VALUE,
+               "Invalid type '%s'", type_name);
+
+  return type;
+}
+
+static void
+parse_expression (PlanParser                *parser,
+                  GtkBuildableParseContext  *context,
+                  const char                *element_name,
+                  const char               **names,
+                  const char               **values,
+                  GError                   **error)
+{
+  PlanExpression **slot;
+  PlanExpression *expr;
+  const char *type_name = NULL;
+
+  slot = get_expression_slot (parser);
+  if (slot == NULL)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+
+  expr = g_slice_new0 (PlanExpression);
+
+  if (strcmp (element_name, "constant") == 0)
+    {
+      expr->type = EXPRESSION_CONSTANT;
+      expr->constant.text = g_string_new (NULL);
+
+      if (g_markup_collect_attributes (element_name, names, values, error,
+                                       G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "type", &type_name,
+                                       G_MARKUP_COLLECT_INVALID))
+        expr->constant.type = parse_type_attribute (parser, context, type_name, error);
+    }
+  else if (strcmp (element_name, "lookup") == 0)
+    {
+      const char *property_name = NULL;
+
+      expr->type = EXPRESSION_LOOKUP;
+
+      if (g_markup_collect_attributes (element_name, names, values, error,
+                                       G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "type", &type_name,
+                                       G_MARKUP_COLLECT_STRING, "name", &property_name,
+                                       G_MARKUP_COLLECT_INVALID))
+        {
+          expr->lookup.this_type = parse_type_attribute (parser, context, type_name, error);
+          expr->lookup.property_name = g_strdup (property_name);
+        }
+    }
+  else
+    {
+      const char *function_name = NULL;
+      const char *object_name = NULL;
+      gboolean swapped = -1;
+
+      expr->type = EXPRESSION_CLOSURE;
+      expr->closure.params = g_ptr_array_new_with_free_func ((GDestroyNotify) plan_expression_free);
+      expr->closure.object.index = NO_OBJECT;
+
+      if (g_markup_collect_attributes (element_name, names, values, error,
+                                       G_MARKUP_COLLECT_STRING, "type", &type_name,
+                                       G_MARKUP_COLLECT_STRING, "function", &function_name,
+                                       G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "object", &object_name,
+                                       G_MARKUP_COLLECT_TRISTATE|G_MARKUP_COLLECT_OPTIONAL, "swapped", &swapped,
+                                       G_MARKUP_COLLECT_INVALID))
+        {
+          expr->closure.type = parse_type_attribute (parser, context, type_name, error);
+          expr->closure.function_name = g_strdup (function_name);
+          expr->closure.object.name = g_strdup (object_name);
+          /* Swapped defaults to FALSE except when object is set */
+          expr->closure.swapped = swapped == -1 ? object_name != NULL : swapped;
+        }
+    }
+
+  /* Hand it to the parent right away, so it gets freed on errors */
+  *slot = expr;
+
+  push_frame (parser, FRAME_EXPRESSION, expr);
+}
+
+static void
+start_element (GtkBuildableParseContext  *context,
+               const char                *element_name,
+               const char               **names,
+               const char               **values,
+               gpointer                   user_data,
+               GError                   **error)
+{
+  PlanParser *parser = user_data;
+
+  if (!parser->has_interface && strcmp (element_name, "interface") != 0)
+    {
+      set_unsupported_error (context, element_name, error);
+      return;
+    }
+  parser->has_interface = TRUE;
+
+  if (strcmp (element_name, "object") == 0)
+    parse_object (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "property") == 0)
+    parse_property (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "binding") == 0)
+    parse_binding (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "child") == 0)
+    parse_child (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "signal") == 0)
+    parse_signal (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "template") == 0)
+    parse_template (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "requires") == 0)
+    parse_requires (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "interface") == 0)
+    parse_interface (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "constant") == 0 ||
+           strcmp (element_name, "lookup") == 0 ||
+           strcmp (element_name, "closure") == 0)
+    parse_expression (parser, context, element_name, names, values, error);
+  else if (strcmp (element_name, "placeholder") == 0)
+    push_frame (parser, FRAME_PLACEHOLDER, NULL);
+  else
+    /* This includes all custom tags, like <style> or <layout> */
+    set_unsupported_error (context, element_name, error);
+}
+
+static void
+end_property (PlanParser                *parser,
+              GtkBuildableParseContext  *context,
+              PlanProperty              *prop,
+              GError                   **error)
+{
+  PlanObject *object = peek_object (parser, NULL);
+  GParamSpec *pspec = prop->pspec;
+  GType value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
+
+  if (prop->type == PROPERTY_VALUE)
+    {
+      if (prop->bound && prop->text->len == 0)
+        {
+          /* Only there for the binding */
+          plan_property_free (prop);
+          return;
+        }
+
+      if (prop->translatable && prop->text->len)
+        g_string_assign (prop->text,
+                         _gtk_builder_parser_translate (parser->domain,
+                                                        prop->context,
+                                                        prop->text->str));
+
+      if (G_IS_PARAM_SPEC_OBJECT (pspec) &&
+          value_type != GDK_TYPE_PIXBUF &&
+          value_type != GDK_TYPE_TEXTURE &&
+          value_type != GDK_TYPE_PAINTABLE &&
+          value_type != GTK_TYPE_SHORTCUT_TRIGGER &&
+          value_type != GTK_TYPE_SHORTCUT_ACTION &&
+          value_type != G_TYPE_FILE)
+        {
+          /* GtkBuilder delays these when the object doesn't exist yet,
+           * we always do, so they can't be construct-only.
+           */
+          if (pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+            {
+              set_error (context, error,
+                         GTK_BUILDER_ERROR_INVALID_PROPERTY,
+                         "Object references in construct-only property %s.%s are not supported",
+                         g_type_name (object->type), pspec->name);
+              plan_property_free (prop);
+              return;
+            }
+
+          prop->type = PROPERTY_REFERENCE;
+          prop->reference.name = g_strdup (g_strstrip (prop->text->str));
+        }
+      else if (!gtk_builder_value_from_string (parser->plan->builder, pspec,
+                                               prop->text->str,
+                                               &prop->value,
+                                               error))
+        {
+          plan_property_free (prop);
+          return;
+        }
+    }
+  else if (prop->type == PROPERTY_EXPRESSION && prop->expression == NULL)
+    {
+      plan_property_free (prop);
+      return;
+    }
+
+  g_string_free (prop->text, TRUE);
+  prop->text = NULL;
+  g_clear_pointer (&prop->context, g_free);
+
+  g_ptr_array_add (object->properties, prop);
+}
+
+static void
+end_expression (PlanParser                *parser,
+                GtkBuildableParseContext  *context,
+                PlanExpression            *expr,
+                GError                   **error)
+{
+  if (expr->type == EXPRESSION_CONSTANT)
+    {
+      GString *text = expr->constant.text;
+
+      expr->constant.text = NULL;
+
+      if (expr->constant.type == G_TYPE_INVALID)
+        {
+          expr->type = EXPRESSION_OBJECT;
+          expr->object.name = g_string_free (text, FALSE);
+        }
+      else
+        {
+          GValue value = G_VALUE_INIT;
+
+          if (gtk_builder_value_from_string_type (parser->plan->builder,
+                                                  expr->constant.type,
+                                                  text->str,
+                                                  &value,
+                                                  error))
+            {
+              if (G_VALUE_HOLDS_OBJECT (&value))
+                expr->expression = gtk_object_expression_new (g_value_get_object (&value));
+              else
+                expr->expression = gtk_constant_expression_new_for_value (&value);
+
+              g_value_unset (&value);
+            }
+
+          g_string_free (text, TRUE);
+        }
+    }
+}
+
+static void
+end_element (GtkBuildableParseContext  *context,
+             const char                *element_name,
+             gpointer                   user_data,
+             GError                   **error)
+{
+  PlanParser *parser = user_data;
+  Frame frame;
+
+  g_assert (parser->frames->len > 0);
+
+  frame = *peek_frame (parser);
+  g_array_set_size (parser->frames, parser->frames->len - 1);
+
+  switch (frame.type)
+    {
+    case FRAME_PROPERTY:
+      end_property (parser, context, frame.data, error);
+      break;
+
+    case FRAME_BINDING:
+      {
+        PlanBinding *binding = frame.data;
+
+        if (binding->expression == NULL)
+          {
+            set_error (context, error,
+                       GTK_BUILDER_ERROR_INVALID_TAG,
+                       "Binding tag requires an expression");
+            plan_binding_free (binding);
+          }
+        else
+          g_ptr_array_add (peek_object (parser, NULL)->bindings, binding);
+      }
+      break;
+
+    case FRAME_EXPRESSION:
+      end_expression (parser, context, frame.data, error);
+      break;
+
+    case FRAME_INTERFACE:
+    case FRAME_REQUIRES:
+    case FRAME_OBJECT:
+    case FRAME_CHILD:
+    case FRAME_SIGNAL:
+    case FRAME_PLACEHOLDER:
+      break;
+
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+static void
+text (GtkBuildableParseContext  *context,
+      const char                *text,
+      gsize                      text_len,
+      gpointer                   user_data,
+      GError                   **error)
+{
+  PlanParser *parser = user_data;
+  Frame *frame = peek_frame (parser);
+
+  if (frame == NULL)
+    return;
+
+  if (frame->type == FRAME_PROPERTY)
+    {
+      PlanProperty *prop = frame->data;
+
+      g_string_append_len (prop->text, text, text_len);
+    }
+  else if (frame->type == FRAME_EXPRESSION)
+    {
+      PlanExpression *expr = frame->data;
+
+      if (expr->type == EXPRESSION_CONSTANT)
+        {
+          g_string_append_len (expr->constant.text, text, text_len);
+        }
+      else if (expr->type == EXPRESSION_LOOKUP)
+        {
+          while (text_len > 0 && g_ascii_isspace (*text))
+            {
+              text++;
+              text_len--;
+            }
+          while (text_len > 0 && g_ascii_isspace (text[text_len - 1]))
+            text_len--;
+
+          if (expr->lookup.expression == NULL && text_len > 0)
+            {
+              PlanExpression *object = g_slice_new0 (PlanExpression);
+
+              object->type = EXPRESSION_OBJECT;
+              object->object.name = g_strndup (text, text_len);
+              expr->lookup.expression = object;
+            }
+        }
+    }
+}
+
+static const GtkBuildableParser plan_parser = {
+  start_element,
+  end_element,
+  text,
+  NULL,
+};
+
+/* }}} */
+/* {{{ Compiling */
+
+static gboolean
+resolve_reference (PlanParser     *parser,
+                   PlanReference  *ref,
+                   GError        **error)
+{
+  gpointer index;
+
+  if (ref->name == NULL)
+    return TRUE;
+
+  if (!g_hash_table_lookup_extended (parser->ids, ref->name, NULL, &index))
+    {
+      g_set_error (error,
+                   GTK_BUILDER_ERROR, GTK_BUILDER_ERROR_INVALID_ID,
+                   "Object with ID %s not found", ref->name);
+      return FALSE;
+    }
+
+  ref->index = GPOINTER_TO_UINT (index);
+
+  return TRUE;
+}
+
+static GCallback
+resolve_callback (GtkBuilderPlan  *self,
+                  const char      *function_name,
+                  GError         **error)
+{
+  /* Only the C scope is known to create the same closures for the
+   * same function, other scopes get asked for every instance.
+   */
+  if (G_OBJECT_TYPE (self->scope) != GTK_TYPE_BUILDER_CSCOPE)
+    {
+      self->needs_current_object = TRUE;
+      return NULL;
+    }
+
+  return gtk_builder_cscope_get_callback (GTK_BUILDER_CSCOPE (self->scope), function_name, error);
+}
+
+static GType
+plan_expression_get_value_type (GtkBuilderPlan *self,
+                                PlanExpression *expr)
+{
+  if (expr->expression)
+    return gtk_expression_get_value_type (expr->expression);
+
+  switch (expr->type)
+    {
+    case EXPRESSION_OBJECT:
+      return plan_get_object (self, expr->object.index)->type;
+
+    case EXPRESSION_LOOKUP:
+      return G_PARAM_SPEC_VALUE_TYPE (expr->lookup.pspec);
+
+    case EXPRESSION_CLOSURE:
+      return expr->closure.type;
+
+    case EXPRESSION_CONSTANT:
+    default:
+      g_assert_not_reached ();
+      return G_TYPE_INVALID;
+    }
+}
+
+static gboolean
+compile_expression (PlanParser      *parser,
+                    PlanExpression  *expr,
+                    GError         **error)
+{
+  GtkBuilderPlan *self = parser->plan;
+
+  switch (expr->type)
+    {
+    case EXPRESSION_CONSTANT:
+      g_assert (expr->expression);
+      return TRUE;
+
+    case EXPRESSION_OBJECT:
+      return resolve_reference (parser, &expr->object, error);
+
+    case EXPRESSION_LOOKUP:
+      {
+        PlanExpression *child = expr->lookup.expression;
+        GType type;
+
+        if (child && !compile_expression (parser, child, error))
+          return FALSE;
+
+        if (expr->lookup.this_type != G_TYPE_INVALID)
+          type = expr->lookup.this_type;
+        else if (child != NULL)
+          type = plan_expression_get_value_type (self, child);
+        else
+          {
+            g_set_error (error,
+                         GTK_BUILDER_ERROR,
+                         GTK_BUILDER_ERROR_MISSING_ATTRIBUTE,
+                         "Lookups require a type attribute if they don't have an expression.");
+            return FALSE;
+          }
+
+        if (g_type_is_a (type, G_TYPE_OBJECT))
+          {
+            GObjectClass *class = g_type_class_ref (type);
+            expr->lookup.pspec = g_object_class_find_property (class, expr->lookup.property_name);
+            g_type_class_unref (class);
+          }
+        else if (g_type_is_a (type, G_TYPE_INTERFACE))
+          {
+            GTypeInterface *iface = g_type_default_interface_ref (type);
+            expr->lookup.pspec = g_object_interface_find_property (iface, expr->lookup.property_name);
+            g_type_default_interface_unref (iface);
+          }
+
+        if (expr->lookup.pspec == NULL)
+          {
+            g_set_error (error,
+                         GTK_BUILDER_ERROR,
+                         GTK_BUILDER_ERROR_MISSING_ATTRIBUTE,
+                         "Type `%s` does not have a property name `%s`",
+                         g_type_name (type), expr->lookup.property_name);
+            return FALSE;
+          }
+
+        /* Lookups on constants are the same for every instance */
+        if (child == NULL || child->expression != NULL)
+          expr->expression = gtk_property_expression_new_for_pspec (child ? gtk_expression_ref (child->expression) : NULL,
+                                                                    expr->lookup.pspec);
+      }
+      return TRUE;
+
+    case EXPRESSION_CLOSURE:
+      {
+        guint i;
+
+        for (i = 0; i < expr->closure.params->len; i++)
+          {
+            if (!compile_expression (parser, g_ptr_array_index (expr->closure.params, i), error))
+              return FALSE;
+          }
+
+        if (!resolve_reference (parser, &expr->closure.object, error))
+          return FALSE;
+
+        expr->closure.callback = resolve_callback (self, expr->closure.function_name, error);
+        if (expr->closure.callback == NULL && !self->needs_current_object)
+          return FALSE;
+      }
+      return TRUE;
+
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+static gboolean
+compile_object (PlanParser  *parser,
+                PlanObject  *object,
+                GError     **error)
+{
+  GtkBuilderPlan *self = parser->plan;
+  guint i;
+
+  for (i = 0; i < object->properties->len; i++)
+    {
+      PlanProperty *prop = g_ptr_array_index (object->properties, i);
+
+      switch (prop->type)
+        {
+        case PROPERTY_VALUE:
+        case PROPERTY_OBJECT:
+          break;
+
+        case PROPERTY_REFERENCE:
+          if (!resolve_reference (parser, &prop->reference, error))
+            return FALSE;
+          break;
+
+        case PROPERTY_EXPRESSION:
+          if (!compile_expression (parser, prop->expression, error))
+            return FALSE;
+          break;
+
+        default:
+          g_assert_not_reached ();
+          break;
+        }
+    }
+
+  for (i = 0; i < object->bindings->len; i++)
+    {
+      PlanBinding *binding = g_ptr_array_index (object->bindings, i);
+
+      if (!resolve_reference (parser, &binding->source, error))
+        return FALSE;
+
+      if (binding->expression && !compile_expression (parser, binding->expression, error))
+        return FALSE;
+    }
+
+  for (i = 0; i < object->signals->len; i++)
+    {
+      PlanSignal *signal = g_ptr_array_index (object->signals, i);
+
+      if (!resolve_reference (parser, &signal->object, error))
+        return FALSE;
+
+      signal->callback = resolve_callback (self, signal->handler, error);
+      if (signal->callback == NULL && !self->needs_current_object)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * gtk_builder_plan_new:
+ * @scope: (nullable): the scope to use
+ * @template_type: the type of the objects the template will be
+ *     instantiated for
+ * @data: the UI definition, which may be precompiled
+ * @error: return location for an error
+ *
+ * Parses the template in @data and resolves everything that doesn't
+ * change between instances.
+ *
+ * This fails if the template uses anything that plans don't support,
+ * callers are expected to use GtkBuilder then.
+ *
+ * Returns: (nullable): A new plan
+ */
+GtkBuilderPlan *
+gtk_builder_plan_new (GtkBuilderScope  *scope,
+                      GType             template_type,
+                      GBytes           *data,
+                      GError          **error)
+{
+  GtkBuilderPlan *self;
+  PlanParser parser;
+  gboolean result;
+  guint i;
+
+  self = g_slice_new0 (GtkBuilderPlan);
+  self->builder = gtk_builder_new ();
+  if (scope)
+    gtk_builder_set_scope (self->builder, scope);
+  self->scope = gtk_builder_get_scope (self->builder);
+  self->template_type = template_type;
+  self->objects = g_ptr_array_new_with_free_func ((GDestroyNotify) plan_object_free);
+
+  memset (&parser, 0, sizeof (PlanParser));
+  parser.plan = self;
+  parser.frames = g_array_new (FALSE, FALSE, sizeof (Frame));
+  parser.ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  parser.domain = g_strdup (gtk_builder_get_translation_domain (self->builder));
+
+  result = _gtk_buildable_parser_parse (&plan_parser, &parser,
+                                        g_bytes_get_data (data, NULL),
+                                        g_bytes_get_size (data),
+                                        error);
+
+  /* Free what's left on the stack after an error */
+  for (i = 0; i < parser.frames->len; i++)
+    {
+      Frame *frame = &g_array_index (parser.frames, Frame, i);
+
+      if (frame->type == FRAME_PROPERTY)
+        plan_property_free (frame->data);
+      else if (frame->type == FRAME_BINDING)
+        plan_binding_free (frame->data);
+    }
+
+  if (result && self->objects->len == 0)
+    {
+      g_set_error (error,
+                   GTK_BUILDER_ERROR, GTK_BUILDER_ERROR_INVALID_TAG,
+                   "No template found");
+      result = FALSE;
+    }
+
+  for (i = 0; result && i < self->objects->len; i++)
+    result = compile_object (&parser, plan_get_object (self, i), error);
+
+  g_array_unref (parser.frames);
+  g_hash_table_unref (parser.ids);
+  g_free (parser.domain);
+
+  if (!result)
+    {
+      gtk_builder_plan_free (self);
+      return NULL;
+    }
+
+  return self;
+}
+
+/* }}} */
+/* {{{ Instantiating */
+
+void
+gtk_builder_plan_free (GtkBuilderPlan *self)
+{
+  g_ptr_array_unref (self->objects);
+  g_object_unref (self->builder);
+
+  g_slice_free (GtkBuilderPlan, self);
+}
+
+GType
+gtk_builder_plan_get_template_type (GtkBuilderPlan *self)
+{
+  return self->template_type;
+}
+
+static GClosure *
+create_closure (GtkBuilderPlan  *self,
+                GObject        **objects,
+                const char      *function_name,
+                GCallback        callback,
+                gboolean         swapped,
+                guint            object_index,
+                GError         **error)
+{
+  GObject *object = object_index != NO_OBJECT ? objects[object_index] : NULL;
+
+  if (callback)
+    {
+      /* The C scope uses the current object, which is the template */
+      return gtk_builder_cscope_create_closure_for_funcptr (GTK_BUILDER_CSCOPE (self->scope),
+                                                            self->builder,
+                                                            callback,
+                                                            swapped,
+                                                            object ? object : objects[0]);
+    }
+
+  return gtk_builder_create_closure (self->builder,
+                                     function_name,
+                                     swapped ? GTK_BUILDER_CLOSURE_SWAPPED : 0,
+                                     object,
+                                     error);
+}
+
+static GtkExpression *
+instantiate_expression (GtkBuilderPlan  *self,
+                        PlanExpression  *expr,
+                        GObject        **objects,
+                        GError         **error)
+{
+  if (expr->expression)
+    return gtk_expression_ref (expr->expression);
+
+  switch (expr->type)
+    {
+    case EXPRESSION_OBJECT:
+      return gtk_object_expression_new (objects[expr->object.index]);
+
+    case EXPRESSION_LOOKUP:
+      {
+        GtkExpression *child;
+
+        child = instantiate_expression (self, expr->lookup.expression, objects, error);
+        if (child == NULL)
+          return NULL;
+
+        return gtk_property_expression_new_for_pspec (child, expr->lookup.pspec);
+      }
+
+    case EXPRESSION_CLOSURE:
+      {
+        GtkExpression **params;
+        GClosure *closure;
+        guint i, n_params;
+
+        closure = create_closure (self, objects,
+                                  expr->closure.function_name,
+                                  expr->closure.callback,
+                                  expr->closure.swapped,
+                                  expr->closure.object.index,
+                                  error);
+        if (closure == NULL)
+          return NULL;
+
+        n_params = expr->closure.params->len;
+        params = g_newa (GtkExpression *, n_params);
+        for (i = 0; i < n_params; i++)
+          {
+            params[i] = instantiate_expression (self, g_ptr_array_index (expr->closure.params, i), objects, error);
+            if (params[i] == NULL)
+              {
+                while (i-- > 0)
+                  gtk_expression_unref (params[i]);
+                g_closure_sink (g_closure_ref (closure));
+                g_closure_unref (closure);
+                return NULL;
+              }
+          }
+
+        return gtk_closure_expression_new (expr->closure.type, closure, n_params, params);
+      }
+
+    case EXPRESSION_CONSTANT:
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
+}
+
+/* GtkBuildable implementations may look up objects in the builder
+ * they are passed, so they get one of their own that knows the objects
+ * of this instantiation, like GtkBuilder would. It is only created once
+ * it is needed.
+ */
+static GtkBuilder *
+get_instance_builder (GtkBuilderPlan  *self,
+                      GObject        **objects,
+                      GtkBuilder     **builder)
+{
+  guint i;
+
+  if (*builder)
+    return *builder;
+
+  *builder = gtk_builder_new ();
+  gtk_builder_set_scope (*builder, self->scope);
+  gtk_builder_set_current_object (*builder, objects[0]);
+  gtk_builder_expose_object (*builder, g_type_name (self->template_type), objects[0]);
+
+  for (i = 1; i < self->objects->len; i++)
+    {
+      PlanObject *object = plan_get_object (self, i);
+
+      if (objects[i] && object->id)
+        gtk_builder_expose_object (*builder, object->id, objects[i]);
+    }
+
+  return *builder;
+}
+
+static void
+set_property (GtkBuilderPlan  *self,
+              PlanObject      *object,
+              GObject         *instance,
+              GObject        **objects,
+              GtkBuilder     **builder,
+              const char      *name,
+              const GValue    *value)
+{
+  if (object->buildable_iface && object->buildable_iface->set_buildable_property)
+    object->buildable_iface->set_buildable_property (GTK_BUILDABLE (instance),
+                                                     get_instance_builder (self, objects, builder),
+                                                     name, value);
+  else
+    g_object_set_property (instance, name, value);
+}
+
+static gboolean
+sets_property (PlanObject *object,
+               const char *name)
+{
+  guint i;
+
+  for (i = 0; i < object->properties->len; i++)
+    {
+      PlanProperty *prop = g_ptr_array_index (object->properties, i);
+
+      if (g_str_equal (prop->pspec->name, name))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+instantiate_object (GtkBuilderPlan  *self,
+                    guint            index,
+                    GObject        **objects,
+                    GtkBuilder     **builder,
+                    GPtrArray       *finalizers,
+                    GError         **error)
+{
+  PlanObject *object = plan_get_object (self, index);
+  const char **names;
+  GValue *values;
+  guint i, n_values, n_construct;
+  GObject *instance;
+  gboolean result = TRUE;
+
+  /* Objects set as properties are created first, so they can
+   * be passed at construct time.
+   */
+  for (i = 0; i < object->properties->len; i++)
+    {
+      PlanProperty *prop = g_ptr_array_index (object->properties, i);
+
+      if (prop->type == PROPERTY_OBJECT &&
+          !instantiate_object (self, prop->object, objects, builder, finalizers, error))
+        return FALSE;
+    }
+
+  /* Collect the values, construct properties first */
+  names = g_newa (const char *, object->properties->len + 1);
+  values = g_newa (GValue, object->properties->len + 1);
+  memset (values, 0, sizeof (GValue) * (object->properties->len + 1));
+  n_values = 0;
+  n_construct = 0;
+
+  /* Like GtkBuilder, nested factories use our scope unless the
+   * template gives them one.
+   */
+  if (index != 0 &&
+      g_type_is_a (object->type, GTK_TYPE_BUILDER_LIST_ITEM_FACTORY) &&
+      !sets_property (object, "scope"))
+    {
+      names[0] = "scope";
+      g_value_init (&values[0], GTK_TYPE_BUILDER_SCOPE);
+      g_value_set_object (&values[0], self->scope);
+      n_values++;
+      n_construct++;
+    }
+
+  for (i = 0; i < object->properties->len; i++)
+    {
+      PlanProperty *prop = g_ptr_array_index (object->properties, i);
+      GParamSpec *pspec = prop->pspec;
+      GValue *value;
+
+      if (prop->type == PROPERTY_REFERENCE)
+        continue;
+
+      if (index == 0 && (pspec->flags & G_PARAM_CONSTRUCT_ONLY))
+        continue;
+
+      if (index != 0 && (pspec->flags & (G_PARAM_CONSTRUCT | G_PARAM_CONSTRUCT_ONLY)))
+        {
+          memmove (names + n_construct + 1, names + n_construct, sizeof (const char *) * (n_values - n_construct));
+          memmove (values + n_construct + 1, values + n_construct, sizeof (GValue) * (n_values - n_construct));
+          value = &values[n_construct];
+          names[n_construct] = pspec->name;
+          n_construct++;
+        }
+      else
+        {
+          value = &values[n_values];
+          names[n_values] = pspec->name;
+        }
+      n_values++;
+
+      memset (value, 0, sizeof (GValue));
+      switch (prop->type)
+        {
+        case PROPERTY_VALUE:
+          g_value_init (value, G_VALUE_TYPE (&prop->value));
+          g_value_copy (&prop->value, value);
+          break;
+
+        case PROPERTY_OBJECT:
+          g_value_init (value, G_OBJECT_TYPE (objects[prop->object]));
+          g_value_set_object (value, objects[prop->object]);
+          break;
+
+        case PROPERTY_EXPRESSION:
+          {
+            GtkExpression *expression;
+
+            expression = instantiate_expression (self, prop->expression, objects, error);
+            if (expression == NULL)
+              {
+                result = FALSE;
+                goto out;
+              }
+            g_value_init (value, GTK_TYPE_EXPRESSION);
+            gtk_value_take_expression (value, expression);
+          }
+          break;
+
+        case PROPERTY_REFERENCE:
+        default:
+          g_assert_not_reached ();
+          break;
+        }
+    }
+
+  if (index == 0)
+    {
+      instance = objects[0];
+    }
+  else
+    {
+      instance = g_object_new_with_properties (object->type, n_construct, names, values);
+
+      /* Like GtkBuilder, make sure we own a reference */
+      if (G_IS_INITIALLY_UNOWNED (instance))
+        g_object_ref_sink (instance);
+
+      objects[index] = instance;
+
+      if (*builder && object->id)
+        gtk_builder_expose_object (*builder, object->id, instance);
+    }
+
+  for (i = n_construct; i < n_values; i++)
+    set_property (self, object, instance, objects, builder, names[i], &values[i]);
+
+  if (object->id)
+    {
+      if (object->buildable_iface)
+        gtk_buildable_set_buildable_id (GTK_BUILDABLE (instance), object->id);
+      else
+        g_object_set_data_full (instance, "gtk-builder-id", g_strdup (object->id), g_free);
+    }
+
+  for (i = 0; i < object->children->len; i++)
+    {
+      guint child_index = g_array_index (object->children, guint, i);
+      PlanObject *child = plan_get_object (self, child_index);
+
+      if (!instantiate_object (self, child_index, objects, builder, finalizers, error))
+        {
+          result = FALSE;
+          goto out;
+        }
+
+      if (G_IS_LIST_STORE (instance))
+        g_list_store_append (G_LIST_STORE (instance), objects[child_index]);
+      else
+        gtk_buildable_add_child (GTK_BUILDABLE (instance),
+                                 get_instance_builder (self, objects, builder),
+                                 objects[child_index], child->child_type);
+    }
+
+  if (object->parser_finished)
+    g_ptr_array_add (finalizers, instance);
+
+out:
+  for (i = 0; i < n_values; i++)
+    {
+      if (G_IS_VALUE (&values[i]))
+        g_value_unset (&values[i]);
+    }
+
+  return result;
+}
+
+static gboolean
+instantiate_connections (GtkBuilderPlan  *self,
+                         PlanObject      *object,
+                         GObject         *instance,
+                         GObject        **objects,
+                         GError         **error)
+{
+  guint i;
+
+  for (i = 0; i < object->properties->len; i++)
+    {
+      PlanProperty *prop = g_ptr_array_index (object->properties, i);
+
+      if (prop->type == PROPERTY_REFERENCE)
+        g_object_set (instance, prop->pspec->name, objects[prop->reference.index], NULL);
+    }
+
+  for (i = 0; i < object->bindings->len; i++)
+    {
+      PlanBinding *binding = g_ptr_array_index (object->bindings, i);
+
+      if (binding->expression)
+        {
+          GtkExpression *expression;
+
+          expression = instantiate_expression (self, binding->expression, objects, error);
+          if (expression == NULL)
+            return FALSE;
+
+          gtk_expression_bind (expression, instance, binding->target_pspec->name, objects[binding->source.index]);
+        }
+      else
+        {
+          g_object_bind_property (objects[binding->source.index], binding->source_property,
+                                  instance, binding->target_pspec->name,
+                                  binding->flags);
+        }
+    }
+
+  for (i = 0; i < object->signals->len; i++)
+    {
+      PlanSignal *signal = g_ptr_array_index (object->signals, i);
+      GClosure *closure;
+
+      closure = create_closure (self, objects,
+                                signal->handler,
+                                signal->callback,
+                                signal->flags & G_CONNECT_SWAPPED ? TRUE : FALSE,
+                                signal->object.index,
+                                error);
+      if (closure == NULL)
+        return FALSE;
+
+      g_signal_connect_closure_by_id (instance,
+                                      signal->id,
+                                      signal->detail,
+                                      closure,
+                                      signal->flags & G_CONNECT_AFTER ? TRUE : FALSE);
+    }
+
+  return TRUE;
+}
+
+/**
+ * gtk_builder_plan_instantiate:
+ * @self: a #GtkBuilderPlan
+ * @template_object: the object to instantiate the template for
+ * @error: return location for an error
+ *
+ * Creates the objects of the template, sets them up and connects
+ * them to @template_object, like gtk_builder_extend_with_template()
+ * would.
+ *
+ * Returns: %TRUE on success
+ */
+gboolean
+gtk_builder_plan_instantiate (GtkBuilderPlan  *self,
+                              GObject         *template_object,
+                              GError         **error)
+{
+  GPtrArray *finalizers;
+  GObject **objects;
+  GtkBuilder *builder = NULL;
+  gboolean result;
+  guint i;
+
+  g_return_val_if_fail (G_OBJECT_TYPE (template_object) == self->template_type, FALSE);
+
+  if (self->needs_current_object)
+    gtk_builder_set_current_object (self->builder, template_object);
+
+  objects = g_new0 (GObject *, self->objects->len);
+  objects[0] = template_object;
+  finalizers = g_ptr_array_new ();
+
+  result = instantiate_object (self, 0, objects, &builder, finalizers, error);
+
+  for (i = 0; result && i < self->objects->len; i++)
+    result = instantiate_connections (self, plan_get_object (self, i), objects[i], objects, error);
+
+  for (i = 0; result && i < finalizers->len; i++)
+    gtk_buildable_parser_finished (g_ptr_array_index (finalizers, i),
+                                   get_instance_builder (self, objects, &builder));
+
+  g_clear_object (&builder);
+
+  /* Like GtkBuilder going away, only the template keeps objects alive */
+  for (i = 1; i < self->objects->len; i++)
+    g_clear_object (&objects[i]);
+
+  g_ptr_array_unref (finalizers);
+  g_free (objects);
+
+  if (self->needs_current_object)
+    gtk_builder_set_current_object (self->builder, NULL);
+
+  return result;
+}
+
+/* }}} */
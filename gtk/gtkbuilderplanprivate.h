@@ -0,0 +1,39 @@
+/* gtkbuilderplanprivate.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_BUILDER_PLAN_PRIVATE_H__
+#define __GTK_BUILDER_PLAN_PRIVATE_H__
+
+#include <gtk/gtkbuilderscope.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkBuilderPlan GtkBuilderPlan;
+
+GtkBuilderPlan *        gtk_builder_plan_new                    (GtkBuilderScope        *scope,
+                                                                 GType                   template_type,
+                                                                 GBytes                 *data,
+                                                                 GError                **error);
+void                    gtk_builder_plan_free                   (GtkBuilderPlan         *self);
+
+GType                   gtk_builder_plan_get_template_type      (GtkBuilderPlan         *self);
+gboolean                gtk_builder_plan_instantiate            (GtkBuilderPlan         *self,
+                                                                 GObject                *template_object,
+                                                                 GError                **error);
+
+G_END_DECLS
+
+#endif /* __GTK_BUILDER_PLAN_PRIVATE_H__ */
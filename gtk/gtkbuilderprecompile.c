@@ -23,6 +23,12 @@
 #include "gtkbuilder.h"
 #include "gtkbuildableprivate.h"
 
+/* Bump this whenever the format of the records changes, so that
+ * data precompiled with gtk4-builder-tool by a different GTK is
+ * rejected instead of misread.
+ */
+#define PRECOMPILED_VERSION 1
+
 /*****************************************  Record a GMarkup parser call ***************************/
 
 typedef enum
@@ -249,11 +255,40 @@ marshal_string (GString *marshaled,
   marshal_uint32 (marshaled, s->offset);
 }
 
+static gboolean
+record_data_tree_has_elements (RecordDataTree *tree)
+{
+  GList *l;
+
+  for (l = tree->children; l != NULL; l = l->next)
+    {
+      RecordDataTree *child = l->data;
+
+      if (child->type == RECORD_TYPE_ELEMENT)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+is_blank (const char *text)
+{
+  for (; *text; text++)
+    {
+      if (!g_ascii_isspace (*text))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 marshal_tree (GString *marshaled,
               GHashTable *strings,
               RecordDataTree *tree)
 {
+  gboolean skip_blanks;
   GList *l;
   int i;
 
@@ -276,8 +311,19 @@ marshal_tree (GString *marshaled,
           marshal_string (marshaled, strings, tree->attributes[i]);
           marshal_string (marshaled, strings, tree->values[i]);
         }
+      /* Whitespace between elements is just indentation, like
+       * xml-stripblanks in resources, so don't replay it.
+       */
+      skip_blanks = record_data_tree_has_elements (tree);
       for (l = g_list_last (tree->children); l != NULL; l = l->prev)
-        marshal_tree (marshaled, strings, l->data);
+        {
+          RecordDataTree *child = l->data;
+
+          if (skip_blanks && child->type == RECORD_TYPE_TEXT && is_blank (child->data))
+            continue;
+
+          marshal_tree (marshaled, strings, child);
+        }
 
       marshal_uint32 (marshaled, RECORD_TYPE_END_ELEMENT);
       break;
@@ -345,6 +391,7 @@ _gtk_buildable_parser_precompile (const char          *text,
   marshaled = g_string_new ("");
   /* Magic marker */
   g_string_append_len (marshaled, "GBU\0", 4);
+  marshal_uint32 (marshaled, PRECOMPILED_VERSION);
   marshal_uint32 (marshaled, offset);
 
   for (l = string_table; l != NULL; l = l->next)
@@ -365,46 +412,80 @@ _gtk_buildable_parser_precompile (const char          *text,
 
 /*****************************************  Replay GMarkup parser callbacks ***************************/
 
-static guint32
-demarshal_uint32 (const char **tree)
+typedef struct {
+  const char *strings;
+  guint32 strings_len;
+  const char *tree;
+  const char *end;
+} ReplayData;
+
+static gboolean
+demarshal_uint32 (ReplayData *replay,
+                  guint32    *value)
 {
-  const guchar *p = (const guchar *)*tree;
-  guchar c = *p;
+  const guchar *p = (const guchar *)replay->tree;
+  gsize size;
+  guchar c;
   /* see marshal_uint32 for format */
 
+  if (replay->tree >= replay->end)
+    return FALSE;
+
+  c = *p;
   if (c < 128) /* 7 bit */
-    {
-      *tree += 1;
-      return c;
-    }
+    size = 1;
   else if ((c & 0xc0) == 0x80) /* 14 bit */
-    {
-      *tree += 2;
-      return (c & 0x3f) << 8 | p[1];
-    }
+    size = 2;
   else if ((c & 0xe0) == 0xc0) /* 21 bit */
-    {
-      *tree += 3;
-      return (c & 0x1f) << 16 | p[1] << 8 | p[2];
-    }
+    size = 3;
   else if ((c & 0xf0) == 0xe0) /* 28 bit */
-    {
-      *tree += 4;
-      return (c & 0xf) << 24 | p[1] << 16 | p[2] << 8 | p[3];
-    }
+    size = 4;
+  else if (c == 0xf0) /* 32 bit */
+    size = 5;
   else
+    return FALSE;
+
+  if ((gsize) (replay->end - replay->tree) < size)
+    return FALSE;
+
+  switch (size)
     {
-      *tree += 5;
-      return p[1] << 24 | p[2] << 16 | p[3] << 8 | p[4];
+    case 1:
+      *value = c;
+      break;
+    case 2:
+      *value = (c & 0x3f) << 8 | p[1];
+      break;
+    case 3:
+      *value = (c & 0x1f) << 16 | p[1] << 8 | p[2];
+      break;
+    case 4:
+      *value = (c & 0xf) << 24 | p[1] << 16 | p[2] << 8 | p[3];
+      break;
+    default:
+      *value = (guint32) p[1] << 24 | p[2] << 16 | p[3] << 8 | p[4];
+      break;
     }
+
+  replay->tree += size;
+
+  return TRUE;
 }
 
-static const char *
-demarshal_string (const char **tree, const char *strings)
+static gboolean
+demarshal_string (ReplayData  *replay,
+                  const char **string)
 {
-  guint32 offset = demarshal_uint32 (tree);
+  guint32 offset;
+
+  /* The string table is nul-terminated, so any offset into it is too */
+  if (!demarshal_uint32 (replay, &offset) ||
+      offset >= replay->strings_len)
+    return FALSE;
+
+  *string = replay->strings + offset;
 
-  return strings + offset;
+  return TRUE;
 }
 
 static void
@@ -416,10 +497,20 @@ propagate_error (GtkBuildableParseContext *context,
   g_propagate_error (dest, src);
 }
 
+static gboolean
+corrupt_error (GtkBuildableParseContext  *context,
+               GError                   **error)
+{
+  propagate_error (context, error,
+                   g_error_new_literal (G_MARKUP_ERROR,
+                                        G_MARKUP_ERROR_PARSE,
+                                        "Precompiled data is corrupt"));
+  return FALSE;
+}
+
 static gboolean
 replay_start_element (GtkBuildableParseContext *context,
-                      const char **tree,
-                      const char *strings,
+                      ReplayData *replay,
                       GError **error)
 {
   const char *element_name;
@@ -428,15 +519,25 @@ replay_start_element (GtkBuildableParseContext *context,
   const char **attr_values;
   GError *tmp_error = NULL;
 
-  element_name = demarshal_string (tree, strings);
-  n_attrs = demarshal_uint32 (tree);
+  if (!demarshal_string (replay, &element_name) ||
+      !demarshal_uint32 (replay, &n_attrs))
+    return corrupt_error (context, error);
 
-  attr_names = g_newa (const char *, n_attrs + 1);
-  attr_values = g_newa (const char *, n_attrs + 1);
+  /* Each attribute takes at least two bytes */
+  if (n_attrs > (gsize) (replay->end - replay->tree) / 2)
+    return corrupt_error (context, error);
+
+  attr_names = g_new (const char *, n_attrs + 1);
+  attr_values = g_new (const char *, n_attrs + 1);
   for (i = 0; i < n_attrs; i++)
     {
-      attr_names[i] = demarshal_string (tree, strings);
-      attr_values[i] = demarshal_string (tree, strings);
+      if (!demarshal_string (replay, &attr_names[i]) ||
+          !demarshal_string (replay, &attr_values[i]))
+        {
+          g_free (attr_names);
+          g_free (attr_values);
+          return corrupt_error (context, error);
+        }
     }
   attr_names[i] = NULL;
   attr_values[i] = NULL;
@@ -448,6 +549,9 @@ replay_start_element (GtkBuildableParseContext *context,
                                                   context,
                                                   &tmp_error);
 
+  g_free (attr_names);
+  g_free (attr_values);
+
   if (tmp_error)
     {
       propagate_error (context, error, tmp_error);
@@ -459,8 +563,7 @@ replay_start_element (GtkBuildableParseContext *context,
 
 static gboolean
 replay_end_element (GtkBuildableParseContext *context,
-                    const char **tree,
-                    const char *strings,
+                    ReplayData *replay,
                     GError **error)
 {
   GError *tmp_error = NULL;
@@ -480,14 +583,14 @@ replay_end_element (GtkBuildableParseContext *context,
 
 static gboolean
 replay_text (GtkBuildableParseContext *context,
-             const char **tree,
-             const char *strings,
+             ReplayData *replay,
              GError **error)
 {
   const char *text;
   GError *tmp_error = NULL;
 
-  text = demarshal_string (tree, strings);
+  if (!demarshal_string (replay, &text))
+    return corrupt_error (context, error);
 
   (*context->internal_callbacks->text) (NULL,
                                         text,
@@ -522,42 +625,68 @@ _gtk_buildable_parser_replay_precompiled (GtkBuildableParseContext *context,
                                           gssize                data_len,
                                           GError              **error)
 {
-  const char *data_end = data + data_len;
-  guint32 type, len;
-  const char *strings;
-  const char *tree;
+  ReplayData replay;
+  guint32 type, version, len;
+  guint depth;
 
-  data = data + 4; /* Skip header */
+  replay.tree = data + 4; /* Skip magic */
+  replay.end = data + data_len;
 
-  len = demarshal_uint32 (&data);
+  if (!demarshal_uint32 (&replay, &version))
+    return corrupt_error (context, error);
 
-  strings = data;
-  data = data + len;
-  tree = data;
+  if (version != PRECOMPILED_VERSION)
+    {
+      propagate_error (context, error,
+                       g_error_new (GTK_BUILDER_ERROR,
+                                    GTK_BUILDER_ERROR_VERSION_MISMATCH,
+                                    "Precompiled data has version %u, but version %u is required",
+                                    version, PRECOMPILED_VERSION));
+      return FALSE;
+    }
 
-  while (tree < data_end)
+  if (!demarshal_uint32 (&replay, &len) ||
+      len > (gsize) (replay.end - replay.tree) ||
+      (len > 0 && replay.tree[len - 1] != '\0'))
+    return corrupt_error (context, error);
+
+  replay.strings = replay.tree;
+  replay.strings_len = len;
+  replay.tree += len;
+
+  depth = 0;
+  while (replay.tree < replay.end)
     {
       gboolean res;
-      type = demarshal_uint32 (&tree);
+
+      if (!demarshal_uint32 (&replay, &type))
+        return corrupt_error (context, error);
 
       switch (type)
         {
         case RECORD_TYPE_ELEMENT:
-          res = replay_start_element (context, &tree, strings, error);
+          res = replay_start_element (context, &replay, error);
+          depth++;
           break;
         case RECORD_TYPE_END_ELEMENT:
-          res = replay_end_element (context, &tree, strings, error);
+          if (depth == 0)
+            return corrupt_error (context, error);
+          res = replay_end_element (context, &replay, error);
+          depth--;
           break;
         case RECORD_TYPE_TEXT:
-          res = replay_text (context, &tree, strings, error);
+          res = replay_text (context, &replay, error);
           break;
         default:
-          g_assert_not_reached ();
+          return corrupt_error (context, error);
         }
 
       if (!res)
         return FALSE;
     }
 
+  if (depth != 0)
+    return corrupt_error (context, error);
+
   return TRUE;
 }
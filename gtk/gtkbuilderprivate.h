@@ -202,6 +202,11 @@ gboolean _gtk_buildable_parser_replay_precompiled (GtkBuildableParseContext *con
                                                    const char           *data,
                                                    gssize                data_len,
                                                    GError              **error);
+gboolean _gtk_buildable_parser_parse (const GtkBuildableParser *parser,
+                                      gpointer              user_data,
+                                      const char           *text,
+                                      gssize                text_len,
+                                      GError              **error);
 void _gtk_builder_parser_parse_buffer (GtkBuilder *builder,
                                        const char *filename,
                                        const char *buffer,
@@ -268,7 +268,7 @@ gtk_builder_cscope_get_type_from_name (GtkBuilderScope *scope,
   return type;
 }
 
-static GCallback
+GCallback
 gtk_builder_cscope_get_callback (GtkBuilderCScope  *self,
                                  const char        *function_name,
                                  GError           **error)
@@ -319,7 +319,7 @@ gtk_builder_cscope_get_type_from_function (GtkBuilderScope *scope,
   return type_func();
 }
 
-static GClosure *
+GClosure *
 gtk_builder_cscope_create_closure_for_funcptr (GtkBuilderCScope *self,
                                                GtkBuilder       *builder,
                                                GCallback         callback,
@@ -37,6 +37,15 @@ GClosure *              gtk_builder_scope_create_closure        (GtkBuilderScope
                                                                  GObject                *object,
                                                                  GError                **error);
 
+GCallback               gtk_builder_cscope_get_callback         (GtkBuilderCScope       *self,
+                                                                 const char             *function_name,
+                                                                 GError                **error);
+GClosure *              gtk_builder_cscope_create_closure_for_funcptr
+                                                                (GtkBuilderCScope       *self,
+                                                                 GtkBuilder             *builder,
+                                                                 GCallback               callback,
+                                                                 gboolean                swapped,
+                                                                 GObject                *object);
 
 G_END_DECLS
 
@@ -204,6 +204,7 @@ enum
   PROP_SINGLE_CLICK_ACTIVATE,
   PROP_REORDERABLE,
   PROP_ENABLE_RUBBERBAND,
+  PROP_FIXED_ROW_HEIGHT,
 
   N_PROPS
 };
@@ -463,11 +464,50 @@ clear_adjustment (GtkColumnView *self)
   g_clear_object (&self->hadjustment);
 }
 
+static void
+gtk_column_view_clear_cell_sizes (GtkColumnView *self)
+{
+  guint i;
+
+  for (i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->columns)); i++)
+    {
+      GtkColumnViewColumn *column = g_list_model_get_item (G_LIST_MODEL (self->columns), i);
+
+      gtk_column_view_column_clear_cell_sizes (column);
+
+      g_object_unref (column);
+    }
+}
+
+static void
+gtk_column_view_model_items_changed_cb (GListModel    *model,
+                                        guint          position,
+                                        guint          removed,
+                                        guint          added,
+                                        GtkColumnView *self)
+{
+  guint i;
+
+  for (i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->columns)); i++)
+    {
+      GtkColumnViewColumn *column = g_list_model_get_item (G_LIST_MODEL (self->columns), i);
+
+      gtk_column_view_column_items_changed (column, position, removed, added);
+
+      g_object_unref (column);
+    }
+}
+
 static void
 gtk_column_view_dispose (GObject *object)
 {
   GtkColumnView *self = GTK_COLUMN_VIEW (object);
 
+  if (gtk_list_view_get_model (self->listview))
+    g_signal_handlers_disconnect_by_func (gtk_list_view_get_model (self->listview),
+                                          gtk_column_view_model_items_changed_cb,
+                                          self);
+
   while (g_list_model_get_n_items (G_LIST_MODEL (self->columns)) > 0)
     {
       GtkColumnViewColumn *column = g_list_model_get_item (G_LIST_MODEL (self->columns), 0);
@@ -554,6 +594,10 @@ gtk_column_view_get_property (GObject    *object,
       g_value_set_boolean (value, gtk_column_view_get_enable_rubberband (self));
       break;
 
+    case PROP_FIXED_ROW_HEIGHT:
+      g_value_set_int (value, gtk_column_view_get_fixed_row_height (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -637,6 +681,10 @@ gtk_column_view_set_property (GObject      *object,
       gtk_column_view_set_enable_rubberband (self, g_value_get_boolean (value));
       break;
 
+    case PROP_FIXED_ROW_HEIGHT:
+      gtk_column_view_set_fixed_row_height (self, g_value_get_int (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -769,6 +817,19 @@ gtk_column_view_class_init (GtkColumnViewClass *klass)
                           FALSE,
                           G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkColumnView:fixed-row-height:
+   *
+   * The height of all rows, 0 to use the height of the first row or
+   * -1 to measure every row
+   */
+  properties[PROP_FIXED_ROW_HEIGHT] =
+    g_param_spec_int ("fixed-row-height",
+                      P_("Fixed row height"),
+                      P_("The height of all rows, 0 to use the height of the first row or -1 to measure every row"),
+                      -1, G_MAXINT, -1,
+                      G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 
   /**
@@ -1386,8 +1447,18 @@ gtk_column_view_set_model (GtkColumnView     *self,
   if (gtk_list_view_get_model (self->listview) == model)
     return;
 
+  if (gtk_list_view_get_model (self->listview))
+    g_signal_handlers_disconnect_by_func (gtk_list_view_get_model (self->listview),
+                                          gtk_column_view_model_items_changed_cb,
+                                          self);
+
   gtk_list_view_set_model (self->listview, model);
 
+  if (model)
+    g_signal_connect (model, "items-changed", G_CALLBACK (gtk_column_view_model_items_changed_cb), self);
+
+  gtk_column_view_clear_cell_sizes (self);
+
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
 
@@ -1817,3 +1888,45 @@ gtk_column_view_get_enable_rubberband (GtkColumnView *self)
 
   return gtk_list_view_get_enable_rubberband (self->listview);
 }
+
+/**
+ * gtk_column_view_set_fixed_row_height:
+ * @self: a #GtkColumnView
+ * @fixed_row_height: the height of all rows, 0 to use the height
+ *   of the first row, or -1 to measure every row
+ *
+ * Sets whether all rows of the column view have the same height.
+ *
+ * See gtk_list_view_set_fixed_row_height() for details.
+ */
+void
+gtk_column_view_set_fixed_row_height (GtkColumnView *self,
+                                      int            fixed_row_height)
+{
+  g_return_if_fail (GTK_IS_COLUMN_VIEW (self));
+  g_return_if_fail (fixed_row_height >= -1);
+
+  if (fixed_row_height == gtk_list_view_get_fixed_row_height (self->listview))
+    return;
+
+  gtk_list_view_set_fixed_row_height (self->listview, fixed_row_height);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FIXED_ROW_HEIGHT]);
+}
+
+/**
+ * gtk_column_view_get_fixed_row_height:
+ * @self: a #GtkColumnView
+ *
+ * Returns the value set via gtk_column_view_set_fixed_row_height().
+ *
+ * Returns: the fixed height of rows, 0 if it is measured from the
+ *   first row or -1 if every row is measured
+ */
+int
+gtk_column_view_get_fixed_row_height (GtkColumnView *self)
+{
+  g_return_val_if_fail (GTK_IS_COLUMN_VIEW (self), -1);
+
+  return gtk_list_view_get_fixed_row_height (self->listview);
+}
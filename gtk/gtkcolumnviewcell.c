@@ -38,6 +38,9 @@ struct _GtkColumnViewCell
   /* This list isn't sorted - next/prev refer to list elements, not rows in the list */
   GtkColumnViewCell *next_cell;
   GtkColumnViewCell *prev_cell;
+
+  /* The item the column last measured us with, no reference, only compared */
+  gpointer measured_item;
 };
 
 struct _GtkColumnViewCellClass
@@ -213,7 +216,7 @@ gtk_column_view_cell_resize_func (GtkWidget *widget)
   GtkColumnViewCell *self = GTK_COLUMN_VIEW_CELL (widget);
 
   if (self->column)
-    gtk_column_view_column_queue_resize (self->column);
+    gtk_column_view_column_cell_resized (self->column, self);
 }
 
 static void
@@ -268,3 +271,16 @@ gtk_column_view_cell_get_column (GtkColumnViewCell *self)
 {
   return self->column;
 }
+
+gpointer
+gtk_column_view_cell_get_measured_item (GtkColumnViewCell *self)
+{
+  return self->measured_item;
+}
+
+void
+gtk_column_view_cell_set_measured_item (GtkColumnViewCell *self,
+                                        gpointer           item)
+{
+  self->measured_item = item;
+}
@@ -44,6 +44,10 @@ GtkColumnViewCell *     gtk_column_view_cell_get_next           (GtkColumnViewCe
 GtkColumnViewCell *     gtk_column_view_cell_get_prev           (GtkColumnViewCell      *self);
 GtkColumnViewColumn *   gtk_column_view_cell_get_column         (GtkColumnViewCell      *self);
 
+gpointer                gtk_column_view_cell_get_measured_item  (GtkColumnViewCell      *self);
+void                    gtk_column_view_cell_set_measured_item  (GtkColumnViewCell      *self,
+                                                                 gpointer                item);
+
 G_END_DECLS
 
 #endif  /* __GTK_COLUMN_VIEW_CELL_PRIVATE_H__ */
@@ -70,9 +70,14 @@ struct _GtkColumnViewColumn
 
   int fixed_width;
 
+  /* position => CellSize of the cells that displayed the row */
+  GHashTable *cell_sizes;
+  guint width_sample_size;
+
   guint visible     : 1;
   guint resizable   : 1;
   guint expand      : 1;
+  guint in_queue_resize : 1;
 
   GMenuModel *menu;
 
@@ -85,6 +90,15 @@ struct _GtkColumnViewColumnClass
   GObjectClass parent_class;
 };
 
+typedef struct
+{
+  int minimum;
+  int natural;
+} CellSize;
+
+/* Cap on the number of rows we keep the size of */
+#define MAX_CELL_SIZES 4096
+
 enum
 {
   PROP_0,
@@ -97,6 +111,7 @@ enum
   PROP_RESIZABLE,
   PROP_EXPAND,
   PROP_FIXED_WIDTH,
+  PROP_WIDTH_SAMPLE_SIZE,
 
   N_PROPS
 };
@@ -117,6 +132,7 @@ gtk_column_view_column_dispose (GObject *object)
   g_clear_object (&self->sorter);
   g_clear_pointer (&self->title, g_free);
   g_clear_object (&self->menu);
+  g_clear_pointer (&self->cell_sizes, g_hash_table_unref);
 
   G_OBJECT_CLASS (gtk_column_view_column_parent_class)->dispose (object);
 }
@@ -167,6 +183,10 @@ gtk_column_view_column_get_property (GObject    *object,
       g_value_set_int (value, self->fixed_width);
       break;
 
+    case PROP_WIDTH_SAMPLE_SIZE:
+      g_value_set_uint (value, self->width_sample_size);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -215,6 +235,10 @@ gtk_column_view_column_set_property (GObject      *object,
       gtk_column_view_column_set_fixed_width (self, g_value_get_int (value));
       break;
 
+    case PROP_WIDTH_SAMPLE_SIZE:
+      gtk_column_view_column_set_width_sample_size (self, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -339,9 +363,28 @@ gtk_column_view_column_class_init (GtkColumnViewColumnClass *klass)
                       -1, G_MAXINT, -1,
                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkColumnViewColumn:width-sample-size:
+   *
+   * If not 0, the number of rows that are measured to determine
+   * the width of the column.
+   */
+  properties[PROP_WIDTH_SAMPLE_SIZE] =
+    g_param_spec_uint ("width-sample-size",
+                       P_("Width sample size"),
+                       P_("Number of rows measured to determine the width"),
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 }
 
+static void
+cell_size_free (gpointer data)
+{
+  g_slice_free (CellSize, data);
+}
+
 static void
 gtk_column_view_column_init (GtkColumnViewColumn *self)
 {
@@ -351,6 +394,8 @@ gtk_column_view_column_init (GtkColumnViewColumn *self)
   self->resizable = FALSE;
   self->expand = FALSE;
   self->fixed_width = -1;
+  self->cell_sizes = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, cell_size_free);
 }
 
 /**
@@ -403,7 +448,8 @@ gtk_column_view_column_add_cell (GtkColumnViewColumn *self,
   self->first_cell = cell;
 
   gtk_widget_set_visible (GTK_WIDGET (cell), self->visible);
-  gtk_column_view_column_queue_resize (self);
+  /* Measured in gtk_column_view_column_measure() if its item is unknown */
+  gtk_widget_queue_resize (GTK_WIDGET (cell));
 }
 
 void
@@ -413,7 +459,7 @@ gtk_column_view_column_remove_cell (GtkColumnViewColumn *self,
   if (cell == self->first_cell)
     self->first_cell = gtk_column_view_cell_get_next (cell);
 
-  gtk_column_view_column_queue_resize (self);
+  /* The size of the cell's item stays cached */
   gtk_widget_queue_resize (GTK_WIDGET (cell));
 }
 
@@ -431,10 +477,139 @@ gtk_column_view_column_queue_resize (GtkColumnViewColumn *self)
   if (self->header)
     gtk_widget_queue_resize (self->header);
 
+  self->in_queue_resize = TRUE;
   for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
     {
       gtk_widget_queue_resize (GTK_WIDGET (cell));
     }
+  self->in_queue_resize = FALSE;
+}
+
+/*
+ * gtk_column_view_column_cell_resized:
+ * @self: a #GtkColumnViewColumn
+ * @cell: a cell of @self that queued a resize
+ *
+ * Forgets the size of @cell's item if it was measured before and
+ * the contents of the cell changed since.
+ */
+void
+gtk_column_view_column_cell_resized (GtkColumnViewColumn *self,
+                                     GtkColumnViewCell   *cell)
+{
+  gpointer position;
+  CellSize *size;
+  gpointer item;
+
+  if (self->in_queue_resize)
+    return;
+
+  /* A cell that got bound to a different item resizes, too, but
+   * the size of its new row is still valid.
+   */
+  item = gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (cell));
+  if (item == NULL || item != gtk_column_view_cell_get_measured_item (cell))
+    return;
+
+  position = GUINT_TO_POINTER (gtk_list_item_widget_get_position (GTK_LIST_ITEM_WIDGET (cell)));
+  size = g_hash_table_lookup (self->cell_sizes, position);
+  if (size == NULL)
+    return;
+
+  if (size->minimum >= self->minimum_size_request ||
+      size->natural >= self->natural_size_request)
+    {
+      /* The column might get smaller */
+      g_hash_table_remove (self->cell_sizes, position);
+      gtk_column_view_column_queue_resize (self);
+    }
+  else
+    {
+      g_hash_table_remove (self->cell_sizes, position);
+    }
+}
+
+/*
+ * gtk_column_view_column_items_changed:
+ * @self: a #GtkColumnViewColumn
+ * @position: the position of the change
+ * @removed: the number of removed items
+ * @added: the number of added items
+ *
+ * Forgets the sizes of the removed rows and moves the sizes of
+ * the rows after them to their new positions.
+ */
+void
+gtk_column_view_column_items_changed (GtkColumnViewColumn *self,
+                                      guint                position,
+                                      guint                removed,
+                                      guint                added)
+{
+  GHashTableIter iter;
+  GHashTable *moved;
+  gpointer key, value;
+  gboolean changed = FALSE;
+
+  if (removed == added)
+    {
+      guint i;
+
+      /* Nothing moves, only the replaced rows are gone */
+      for (i = position; i < position + removed; i++)
+        changed |= g_hash_table_remove (self->cell_sizes, GUINT_TO_POINTER (i));
+    }
+  else
+    {
+      moved = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                     NULL, cell_size_free);
+
+      g_hash_table_iter_init (&iter, self->cell_sizes);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          guint pos = GPOINTER_TO_UINT (key);
+
+          if (pos < position)
+            continue;
+
+          if (pos < position + removed)
+            {
+              g_hash_table_iter_remove (&iter);
+              changed = TRUE;
+              continue;
+            }
+
+          g_hash_table_iter_steal (&iter);
+          g_hash_table_insert (moved, GUINT_TO_POINTER (pos - removed + added), value);
+        }
+
+      g_hash_table_iter_init (&iter, moved);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          g_hash_table_iter_steal (&iter);
+          g_hash_table_insert (self->cell_sizes, key, value);
+        }
+      g_hash_table_unref (moved);
+    }
+
+  if (changed)
+    gtk_column_view_column_queue_resize (self);
+}
+
+/*
+ * gtk_column_view_column_clear_cell_sizes:
+ * @self: a #GtkColumnViewColumn
+ *
+ * Forgets the sizes of all items, so that only the currently
+ * displayed rows are measured again.
+ */
+void
+gtk_column_view_column_clear_cell_sizes (GtkColumnViewColumn *self)
+{
+  if (g_hash_table_size (self->cell_sizes) == 0)
+    return;
+
+  g_hash_table_remove_all (self->cell_sizes);
+  gtk_column_view_column_queue_resize (self);
 }
 
 void
@@ -442,16 +617,22 @@ gtk_column_view_column_measure (GtkColumnViewColumn *self,
                                 int                 *minimum,
                                 int                 *natural)
 {
+  GtkColumnViewCell *cell;
+
   if (self->fixed_width > -1)
     {
       self->minimum_size_request  = self->fixed_width;
       self->natural_size_request  = self->fixed_width;
+      *minimum = self->minimum_size_request;
+      *natural = self->natural_size_request;
+      return;
     }
 
   if (self->minimum_size_request < 0)
     {
-      GtkColumnViewCell *cell;
-      int min, nat, cell_min, cell_nat;
+      GHashTableIter iter;
+      gpointer value;
+      int min, nat;
 
       if (self->header)
         {
@@ -463,22 +644,62 @@ gtk_column_view_column_measure (GtkColumnViewColumn *self,
           nat = 0;
         }
 
-      for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+      /* Items that were measured before count even when they are
+       * not displayed anymore, so the width doesn't change while
+       * scrolling.
+       */
+      g_hash_table_iter_init (&iter, self->cell_sizes);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
         {
-          gtk_widget_measure (GTK_WIDGET (cell),
-                              GTK_ORIENTATION_HORIZONTAL,
-                              -1,
-                              &cell_min, &cell_nat,
-                              NULL, NULL);
-
-          min = MAX (min, cell_min);
-          nat = MAX (nat, cell_nat);
+          CellSize *size = value;
+
+          min = MAX (min, size->minimum);
+          nat = MAX (nat, size->natural);
         }
 
       self->minimum_size_request = min;
       self->natural_size_request = nat;
     }
 
+  for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+    {
+      gpointer position;
+      CellSize *size;
+      gpointer item;
+
+      item = gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (cell));
+      if (item == NULL)
+        continue;
+
+      gtk_column_view_cell_set_measured_item (cell, item);
+
+      position = GUINT_TO_POINTER (gtk_list_item_widget_get_position (GTK_LIST_ITEM_WIDGET (cell)));
+      if (g_hash_table_contains (self->cell_sizes, position))
+        continue;
+
+      if (self->width_sample_size > 0 &&
+          g_hash_table_size (self->cell_sizes) >= self->width_sample_size)
+        continue;
+
+      /* Don't grow without bounds when scrolling through huge models.
+       * The current width is kept, only the sizes it came from are
+       * forgotten.
+       */
+      if (g_hash_table_size (self->cell_sizes) >= MAX_CELL_SIZES)
+        g_hash_table_remove_all (self->cell_sizes);
+
+      size = g_slice_new (CellSize);
+      gtk_widget_measure (GTK_WIDGET (cell),
+                          GTK_ORIENTATION_HORIZONTAL,
+                          -1,
+                          &size->minimum, &size->natural,
+                          NULL, NULL);
+      g_hash_table_insert (self->cell_sizes, position, size);
+
+      self->minimum_size_request = MAX (self->minimum_size_request, size->minimum);
+      self->natural_size_request = MAX (self->natural_size_request, size->natural);
+    }
+
   *minimum = self->minimum_size_request;
   *natural = self->natural_size_request;
 }
@@ -488,6 +709,17 @@ gtk_column_view_column_allocate (GtkColumnViewColumn *self,
                                  int                  offset,
                                  int                  size)
 {
+  if (self->allocation_offset != offset || self->allocation_size != size)
+    {
+      GtkColumnViewCell *cell;
+
+      /* Cells don't queue a resize anymore when other cells get
+       * added, so make sure their rows pick up the new allocation.
+       */
+      for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+        gtk_widget_queue_allocate (gtk_widget_get_parent (GTK_WIDGET (cell)));
+    }
+
   self->allocation_offset = offset;
   self->allocation_size = size;
   self->header_position = offset;
@@ -607,6 +839,7 @@ gtk_column_view_column_set_column_view (GtkColumnViewColumn *self,
 
   gtk_column_view_column_remove_cells (self);
   gtk_column_view_column_remove_header (self);
+  g_hash_table_remove_all (self->cell_sizes);
 
   self->view = view;
 
@@ -1007,6 +1240,59 @@ gtk_column_view_column_get_fixed_width (GtkColumnViewColumn *self)
   return self->fixed_width;
 }
 
+/**
+ * gtk_column_view_column_set_width_sample_size:
+ * @self: a #GtkColumnViewColumn
+ * @sample_size: the number of rows to measure, or 0 for all
+ *
+ * Sets how many rows are measured to determine the width of @self.
+ *
+ * The column remembers the width of every row it has displayed, so
+ * that it doesn't change size while scrolling. With a sample size
+ * of 0, every row is measured once when it is displayed and the
+ * column grows when a wider row comes into view.
+ *
+ * Otherwise, only the first @sample_size rows that are displayed
+ * get measured and the column keeps its width after that. Rows are
+ * measured again when their contents change or when items are
+ * removed from the model.
+ *
+ * Setting a fixed width with gtk_column_view_column_set_fixed_width()
+ * overrides this.
+ */
+void
+gtk_column_view_column_set_width_sample_size (GtkColumnViewColumn *self,
+                                              guint                sample_size)
+{
+  g_return_if_fail (GTK_IS_COLUMN_VIEW_COLUMN (self));
+
+  if (self->width_sample_size == sample_size)
+    return;
+
+  self->width_sample_size = sample_size;
+
+  gtk_column_view_column_clear_cell_sizes (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_WIDTH_SAMPLE_SIZE]);
+}
+
+/**
+ * gtk_column_view_column_get_width_sample_size:
+ * @self: a #GtkColumnViewColumn
+ *
+ * Gets the number of rows that are measured to determine the width
+ * of @self. See gtk_column_view_column_set_width_sample_size().
+ *
+ * Returns: the number of rows measured, or 0 for all
+ */
+guint
+gtk_column_view_column_get_width_sample_size (GtkColumnViewColumn *self)
+{
+  g_return_val_if_fail (GTK_IS_COLUMN_VIEW_COLUMN (self), 0);
+
+  return self->width_sample_size;
+}
+
 GtkWidget *
 gtk_column_view_column_get_header (GtkColumnViewColumn *self)
 {
@@ -89,6 +89,12 @@ void                    gtk_column_view_column_set_fixed_width          (GtkColu
 GDK_AVAILABLE_IN_ALL
 int                     gtk_column_view_column_get_fixed_width          (GtkColumnViewColumn    *self);
 
+GDK_AVAILABLE_IN_ALL
+void                    gtk_column_view_column_set_width_sample_size    (GtkColumnViewColumn    *self,
+                                                                         guint                   sample_size);
+GDK_AVAILABLE_IN_ALL
+guint                   gtk_column_view_column_get_width_sample_size    (GtkColumnViewColumn    *self);
+
 GDK_AVAILABLE_IN_ALL
 void                    gtk_column_view_column_set_resizable            (GtkColumnViewColumn    *self,
                                                                          gboolean                resizable);
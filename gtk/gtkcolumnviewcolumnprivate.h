@@ -39,6 +39,13 @@ GtkColumnViewCell *     gtk_column_view_column_get_first_cell           (GtkColu
 GtkWidget *             gtk_column_view_column_get_header               (GtkColumnViewColumn    *self);
 
 void                    gtk_column_view_column_queue_resize             (GtkColumnViewColumn    *self);
+void                    gtk_column_view_column_cell_resized             (GtkColumnViewColumn    *self,
+                                                                         GtkColumnViewCell      *cell);
+void                    gtk_column_view_column_clear_cell_sizes         (GtkColumnViewColumn    *self);
+void                    gtk_column_view_column_items_changed            (GtkColumnViewColumn    *self,
+                                                                         guint                   position,
+                                                                         guint                   removed,
+                                                                         guint                   added);
 void                    gtk_column_view_column_measure                  (GtkColumnViewColumn    *self,
                                                                          int                    *minimum,
                                                                          int                    *natural);
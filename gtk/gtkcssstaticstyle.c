@@ -214,6 +214,8 @@ gtk_css_ ## NAME ## _values_new_compute (GtkCssStaticStyle *sstyle, \
                                           lookup->values[id].value, \
                                           lookup->values[id].section); \
     } \
+\
+  style->NAME = (GtkCss ## TYPE ## Values *)gtk_css_values_intern ((GtkCssValues *)style->NAME); \
 } \
 static GtkBitmask * gtk_css_ ## NAME ## _values_mask; \
 static GtkCssValues * gtk_css_ ## NAME ## _initial_values; \
@@ -231,7 +233,7 @@ gtk_css_ ## NAME ## _values_init (void) \
       gtk_css_ ## NAME ## _values_mask = _gtk_bitmask_set (gtk_css_ ## NAME ## _values_mask, id, TRUE); \
     } \
 \
-  gtk_css_ ## NAME ## _initial_values = gtk_css_ ## NAME ## _create_initial_values (); \
+  gtk_css_ ## NAME ## _initial_values = gtk_css_values_intern (gtk_css_ ## NAME ## _create_initial_values ()); \
 } \
 \
 static inline gboolean \
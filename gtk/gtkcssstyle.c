@@ -39,6 +39,8 @@
 #include "gtkstylepropertyprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+#include <string.h>
+
 G_DEFINE_ABSTRACT_TYPE (GtkCssStyle, gtk_css_style, G_TYPE_OBJECT)
 
 static GtkCssSection *
@@ -717,6 +719,83 @@ static const int values_size[] = {
 
 #define GET_VALUES(v) (GtkCssValue **)((guint8 *)(v) + sizeof (GtkCssValues))
 
+/* Value groups of static styles are interned, so that all styles with
+ * the same values share one group, and finding the changes between two
+ * styles can skip every group that is shared.
+ *
+ * Groups are compared by the identity of their values, not by
+ * _gtk_css_value_equal(). That is cheap, and good enough because
+ * computing hands out the same values for the same declarations in
+ * most cases: already computed values compute to themselves, inherited
+ * values are taken from the parent, and initial values are mostly
+ * static.
+ */
+static GHashTable *interned_values;
+
+static guint
+gtk_css_values_hash (gconstpointer data)
+{
+  GtkCssValues *values = (GtkCssValues *) data;
+  GtkCssValue **v = GET_VALUES (values);
+  guint hash;
+  int i;
+
+  hash = TYPE_INDEX (values->type);
+
+  for (i = 0; i < N_VALUES (values->type); i++)
+    hash = (hash << 5) - hash + g_direct_hash (v[i]);
+
+  return hash;
+}
+
+static gboolean
+gtk_css_values_equal (gconstpointer a,
+                      gconstpointer b)
+{
+  GtkCssValues *values1 = (GtkCssValues *) a;
+  GtkCssValues *values2 = (GtkCssValues *) b;
+
+  if (TYPE_INDEX (values1->type) != TYPE_INDEX (values2->type))
+    return FALSE;
+
+  return memcmp (GET_VALUES (values1),
+                 GET_VALUES (values2),
+                 N_VALUES (values1->type) * sizeof (GtkCssValue *)) == 0;
+}
+
+/*
+ * gtk_css_values_intern:
+ * @values: (transfer full) (nullable): values that won't be modified anymore
+ *
+ * Looks for a group with the same values as @values and returns that
+ * one instead, or makes @values the group that later lookups find.
+ *
+ * Returns: (transfer full) (nullable): the interned values
+ */
+GtkCssValues *
+gtk_css_values_intern (GtkCssValues *values)
+{
+  GtkCssValues *interned;
+
+  if (values == NULL || values->interned)
+    return values;
+
+  if (G_UNLIKELY (interned_values == NULL))
+    interned_values = g_hash_table_new (gtk_css_values_hash, gtk_css_values_equal);
+
+  interned = g_hash_table_lookup (interned_values, values);
+  if (interned)
+    {
+      gtk_css_values_unref (values);
+      return gtk_css_values_ref (interned);
+    }
+
+  values->interned = TRUE;
+  g_hash_table_add (interned_values, values);
+
+  return values;
+}
+
 GtkCssValues *gtk_css_values_ref (GtkCssValues *values)
 {
   values->ref_count++;
@@ -730,6 +809,9 @@ gtk_css_values_free (GtkCssValues *values)
   int i;
   GtkCssValue **v = GET_VALUES (values);
 
+  if (values->interned)
+    g_hash_table_remove (interned_values, values);
+
   for (i = 0; i < N_VALUES (values->type); i++)
     {
       if (v[i])
@@ -50,19 +50,37 @@
  * This means you do not need access to the #GtkDirectoryList but can access
  * the #GFile directly from the #GFileInfo when operating with a #GtkListView
  * or similar.
+ *
+ * Files that are found while loading are collected and added to the list
+ * in one go at most once per frame, so a big directory does not cause a
+ * flood of #GListModel::items-changed emissions. When the
+ * #GtkDirectoryList:threaded property is set, the enumeration itself is
+ * done in a worker thread, too.
+ *
+ * Attributes that are expensive to query, like thumbnails or sniffed
+ * content types, can be set as #GtkDirectoryList:lazy-attributes instead.
+ * They are only queried for the files passed to
+ * gtk_directory_list_query_lazy_attributes(), which is typically called
+ * when binding a list item to its #GFileInfo. Once the query finishes, the
+ * item is replaced with a #GFileInfo that has the additional attributes.
  */
 
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
 
+/* Files found while loading are added at most this often */
+#define FLUSH_INTERVAL_MS 16
+
 enum {
   PROP_0,
   PROP_ATTRIBUTES,
   PROP_ERROR,
   PROP_FILE,
   PROP_IO_PRIORITY,
+  PROP_LAZY_ATTRIBUTES,
   PROP_LOADING,
   PROP_MONITORED,
+  PROP_THREADED,
   NUM_PROPERTIES
 };
 
@@ -71,14 +89,22 @@ struct _GtkDirectoryList
   GObject parent_instance;
 
   char *attributes;
+  char *lazy_attributes;
   GFile *file;
   GFileMonitor *monitor;
   gboolean monitored;
+  gboolean threaded;
   int io_priority;
 
   GCancellable *cancellable;
   GError *error; /* Error while loading */
   GSequence *items; /* Use GPtrArray or GListStore here? */
+
+  GPtrArray *pending; /* GFileInfos loaded, but not yet in items */
+  guint flush_id;
+
+  GCancellable *lazy_cancellable;
+  GHashTable *lazy_queries; /* GFileInfo => GSequenceIter */
 };
 
 struct _GtkDirectoryListClass
@@ -88,6 +114,9 @@ struct _GtkDirectoryListClass
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
+/* Set on GFileInfos that have their lazy attributes */
+static GQuark lazy_attributes_quark;
+
 static GType
 gtk_directory_list_get_item_type (GListModel *list)
 {
@@ -150,10 +179,18 @@ gtk_directory_list_set_property (GObject      *object,
       gtk_directory_list_set_io_priority (self, g_value_get_int (value));
       break;
 
+    case PROP_LAZY_ATTRIBUTES:
+      gtk_directory_list_set_lazy_attributes (self, g_value_get_string (value));
+      break;
+
     case PROP_MONITORED:
       gtk_directory_list_set_monitored (self, g_value_get_boolean (value));
       break;
 
+    case PROP_THREADED:
+      gtk_directory_list_set_threaded (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -186,6 +223,10 @@ gtk_directory_list_get_property (GObject     *object,
       g_value_set_int (value, self->io_priority);
       break;
 
+    case PROP_LAZY_ATTRIBUTES:
+      g_value_set_string (value, self->lazy_attributes);
+      break;
+
     case PROP_LOADING:
       g_value_set_boolean (value, gtk_directory_list_is_loading (self));
       break;
@@ -194,6 +235,10 @@ gtk_directory_list_get_property (GObject     *object,
       g_value_set_boolean (value, gtk_directory_list_get_monitored (self));
       break;
 
+    case PROP_THREADED:
+      g_value_set_boolean (value, gtk_directory_list_get_threaded (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -203,6 +248,9 @@ gtk_directory_list_get_property (GObject     *object,
 static gboolean
 gtk_directory_list_stop_loading (GtkDirectoryList *self)
 {
+  g_clear_handle_id (&self->flush_id, g_source_remove);
+  g_ptr_array_set_size (self->pending, 0);
+
   if (self->cancellable == NULL)
     return FALSE;
 
@@ -211,6 +259,18 @@ gtk_directory_list_stop_loading (GtkDirectoryList *self)
   return TRUE;
 }
 
+static void
+gtk_directory_list_stop_lazy_queries (GtkDirectoryList *self)
+{
+  if (self->lazy_cancellable)
+    {
+      g_cancellable_cancel (self->lazy_cancellable);
+      g_clear_object (&self->lazy_cancellable);
+    }
+
+  g_hash_table_remove_all (self->lazy_queries);
+}
+
 static void directory_changed (GFileMonitor       *monitor,
                                GFile              *file,
                                GFile              *other_file,
@@ -231,10 +291,12 @@ gtk_directory_list_dispose (GObject *object)
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (object);
 
   gtk_directory_list_stop_loading (self);
+  gtk_directory_list_stop_lazy_queries (self);
   gtk_directory_list_stop_monitoring (self);
 
   g_clear_object (&self->file);
   g_clear_pointer (&self->attributes, g_free);
+  g_clear_pointer (&self->lazy_attributes, g_free);
 
   g_clear_error (&self->error);
   g_clear_pointer (&self->items, g_sequence_free);
@@ -242,6 +304,17 @@ gtk_directory_list_dispose (GObject *object)
   G_OBJECT_CLASS (gtk_directory_list_parent_class)->dispose (object);
 }
 
+static void
+gtk_directory_list_finalize (GObject *object)
+{
+  GtkDirectoryList *self = GTK_DIRECTORY_LIST (object);
+
+  g_ptr_array_unref (self->pending);
+  g_hash_table_unref (self->lazy_queries);
+
+  G_OBJECT_CLASS (gtk_directory_list_parent_class)->finalize (object);
+}
+
 static void
 gtk_directory_list_class_init (GtkDirectoryListClass *class)
 {
@@ -250,6 +323,7 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
   gobject_class->set_property = gtk_directory_list_set_property;
   gobject_class->get_property = gtk_directory_list_get_property;
   gobject_class->dispose = gtk_directory_list_dispose;
+  gobject_class->finalize = gtk_directory_list_finalize;
 
   /**
    * GtkDirectoryList:attributes:
@@ -299,6 +373,18 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                         -G_MAXINT, G_MAXINT, G_PRIORITY_DEFAULT,
                         GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDirectoryList:lazy-attributes:
+   *
+   * Attributes that are only queried on request
+   */
+  properties[PROP_LAZY_ATTRIBUTES] =
+      g_param_spec_string ("lazy-attributes",
+                           P_("Lazy attributes"),
+                           P_("Attributes that are only queried on request"),
+                           NULL,
+                           GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkDirectoryList:loading:
    *
@@ -323,13 +409,29 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                             TRUE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDirectoryList:threaded:
+   *
+   * %TRUE if the directory is enumerated in a worker thread
+   */
+  properties[PROP_THREADED] =
+      g_param_spec_boolean ("threaded",
+                            P_("threaded"),
+                            P_("TRUE if the directory is enumerated in a worker thread"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
+
+  lazy_attributes_quark = g_quark_from_static_string ("gtk-directory-list-lazy-attributes");
 }
 
 static void
 gtk_directory_list_init (GtkDirectoryList *self)
 {
   self->items = g_sequence_new (g_object_unref);
+  self->pending = g_ptr_array_new_with_free_func (g_object_unref);
+  self->lazy_queries = g_hash_table_new (NULL, NULL);
   self->io_priority = G_PRIORITY_DEFAULT;
   self->monitored = TRUE;
 }
@@ -361,6 +463,8 @@ gtk_directory_list_clear_items (GtkDirectoryList *self)
 {
   guint n_items;
 
+  gtk_directory_list_stop_lazy_queries (self);
+
   n_items = g_sequence_get_length (self->items);
   if (n_items > 0)
     {
@@ -377,6 +481,76 @@ gtk_directory_list_clear_items (GtkDirectoryList *self)
     }
 }
 
+static void
+gtk_directory_list_flush (GtkDirectoryList *self)
+{
+  gpointer *infos;
+  gsize i, n;
+  guint position;
+
+  g_clear_handle_id (&self->flush_id, g_source_remove);
+
+  if (self->pending->len == 0)
+    return;
+
+  position = g_sequence_get_length (self->items);
+  infos = g_ptr_array_steal (self->pending, &n);
+  for (i = 0; i < n; i++)
+    g_sequence_append (self->items, infos[i]);
+  g_free (infos);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, n);
+}
+
+static gboolean
+gtk_directory_list_flush_cb (gpointer data)
+{
+  GtkDirectoryList *self = data;
+
+  self->flush_id = 0;
+  gtk_directory_list_flush (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Takes ownership of @info */
+static void
+gtk_directory_list_queue_file (GtkDirectoryList *self,
+                               GFileInfo        *info)
+{
+  g_ptr_array_add (self->pending, info);
+
+  if (self->flush_id == 0)
+    {
+      self->flush_id = g_timeout_add_full (self->io_priority,
+                                           FLUSH_INTERVAL_MS,
+                                           gtk_directory_list_flush_cb,
+                                           self,
+                                           NULL);
+      g_source_set_name_by_id (self->flush_id, "[gtk] gtk_directory_list_flush_cb");
+    }
+}
+
+static void
+gtk_directory_list_finish_loading (GtkDirectoryList *self,
+                                   GError           *error)
+{
+  gtk_directory_list_flush (self);
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  g_clear_object (&self->cancellable);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
+
+  if (error)
+    {
+      self->error = error;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ERROR]);
+    }
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
 static void
 gtk_directory_list_enumerator_closed_cb (GObject      *source,
                                          GAsyncResult *res,
@@ -394,7 +568,6 @@ gtk_directory_list_got_files_cb (GObject      *source,
   GFileEnumerator *enumerator = G_FILE_ENUMERATOR (source);
   GError *error = NULL;
   GList *l, *files;
-  guint n;
 
   files = g_file_enumerator_next_files_finish (enumerator, res, &error);
 
@@ -412,22 +585,10 @@ gtk_directory_list_got_files_cb (GObject      *source,
                                      gtk_directory_list_enumerator_closed_cb,
                                      NULL);
 
-      g_object_freeze_notify (G_OBJECT (self));
-
-      g_clear_object (&self->cancellable);
-      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
-
-      if (error)
-        {
-          self->error = error;
-          g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ERROR]);
-        }
-
-      g_object_thaw_notify (G_OBJECT (self));
+      gtk_directory_list_finish_loading (self, error);
       return;
     }
 
-  n = 0;
   for (l = files; l; l = l->next)
     {
       GFileInfo *info;
@@ -437,8 +598,7 @@ gtk_directory_list_got_files_cb (GObject      *source,
       file = g_file_enumerator_get_child (enumerator, info);
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
       g_object_unref (file);
-      g_sequence_append (self->items, info);
-      n++;
+      gtk_directory_list_queue_file (self, info);
     }
   g_list_free (files);
 
@@ -448,9 +608,6 @@ gtk_directory_list_got_files_cb (GObject      *source,
                                       self->cancellable,
                                       gtk_directory_list_got_files_cb,
                                       self);
-
-  if (n > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
 }
 
 static void
@@ -472,12 +629,7 @@ gtk_directory_list_got_enumerator_cb (GObject      *source,
           return;
         }
 
-      g_object_freeze_notify (G_OBJECT (self));
-      self->error = error;
-      g_clear_object (&self->cancellable);
-      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
-      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ERROR]);
-      g_object_thaw_notify (G_OBJECT (self));
+      gtk_directory_list_finish_loading (self, error);
       return;
     }
 
@@ -490,6 +642,160 @@ gtk_directory_list_got_enumerator_cb (GObject      *source,
   g_object_unref (enumerator);
 }
 
+/* A batch of files found by the worker thread. The last batch of a
+ * load has @done set and carries the error, if any.
+ */
+typedef struct
+{
+  GtkDirectoryList *self; /* invalid if cancelled */
+  GCancellable *cancellable;
+  GPtrArray *files;
+  GError *error;
+  gboolean done;
+} GtkDirectoryListBatch;
+
+typedef struct
+{
+  GtkDirectoryList *self; /* invalid if cancelled */
+  char *attributes;
+  GMainContext *context;
+  int io_priority;
+} GtkDirectoryListThreadData;
+
+static void
+gtk_directory_list_batch_free (gpointer data)
+{
+  GtkDirectoryListBatch *batch = data;
+
+  g_object_unref (batch->cancellable);
+  g_clear_pointer (&batch->files, g_ptr_array_unref);
+  g_clear_error (&batch->error);
+  g_slice_free (GtkDirectoryListBatch, batch);
+}
+
+static void
+gtk_directory_list_thread_data_free (gpointer data)
+{
+  GtkDirectoryListThreadData *tdata = data;
+
+  g_free (tdata->attributes);
+  g_main_context_unref (tdata->context);
+  g_slice_free (GtkDirectoryListThreadData, tdata);
+}
+
+static gboolean
+gtk_directory_list_got_batch (gpointer data)
+{
+  GtkDirectoryListBatch *batch = data;
+  GtkDirectoryList *self = batch->self;
+  guint i;
+
+  if (g_cancellable_is_cancelled (batch->cancellable))
+    return G_SOURCE_REMOVE;
+
+  if (batch->files)
+    {
+      for (i = 0; i < batch->files->len; i++)
+        gtk_directory_list_queue_file (self, g_object_ref (g_ptr_array_index (batch->files, i)));
+    }
+
+  if (batch->done)
+    {
+      if (g_error_matches (batch->error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return G_SOURCE_REMOVE;
+
+      gtk_directory_list_finish_loading (self, g_steal_pointer (&batch->error));
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Batches and the final result are all delivered with the same
+ * priority, so they arrive in the order they were sent.
+ */
+static void
+gtk_directory_list_send_batch (GtkDirectoryListThreadData *tdata,
+                               GCancellable               *cancellable,
+                               GPtrArray                  *files,
+                               GError                     *error,
+                               gboolean                    done)
+{
+  GtkDirectoryListBatch *batch;
+
+  batch = g_slice_new0 (GtkDirectoryListBatch);
+  batch->self = tdata->self;
+  batch->cancellable = g_object_ref (cancellable);
+  batch->files = files;
+  batch->error = error;
+  batch->done = done;
+
+  g_main_context_invoke_full (tdata->context,
+                              tdata->io_priority,
+                              gtk_directory_list_got_batch,
+                              batch,
+                              gtk_directory_list_batch_free);
+}
+
+static void
+gtk_directory_list_load_thread (GTask        *task,
+                                gpointer      source_object,
+                                gpointer      task_data,
+                                GCancellable *cancellable)
+{
+  GtkDirectoryListThreadData *tdata = task_data;
+  GFile *file = source_object;
+  GFileEnumerator *enumerator;
+  GError *error = NULL;
+
+  enumerator = g_file_enumerate_children (file,
+                                          tdata->attributes,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          cancellable,
+                                          &error);
+  if (enumerator == NULL)
+    {
+      gtk_directory_list_send_batch (tdata, cancellable, NULL, error, TRUE);
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  while (TRUE)
+    {
+      GPtrArray *files;
+      GFileInfo *info;
+      GFile *child;
+
+      files = g_ptr_array_new_with_free_func (g_object_unref);
+
+      /* Creating the GFiles is a noticeable part of the work for big
+       * directories, so we do it here instead of in the main thread. */
+      while (files->len < 50 * FILES_PER_QUERY &&
+             g_file_enumerator_iterate (enumerator, &info, &child, cancellable, &error) &&
+             info != NULL)
+        {
+          g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (child));
+          g_ptr_array_add (files, g_object_ref (info));
+        }
+
+      if (files->len == 0)
+        {
+          g_ptr_array_unref (files);
+          break;
+        }
+
+      gtk_directory_list_send_batch (tdata, cancellable, files, NULL, FALSE);
+
+      if (error)
+        break;
+    }
+
+  g_file_enumerator_close (enumerator, NULL, NULL);
+  g_object_unref (enumerator);
+
+  gtk_directory_list_send_batch (tdata, cancellable, NULL, error, TRUE);
+  g_task_return_boolean (task, TRUE);
+}
+
 static void
 gtk_directory_list_start_loading (GtkDirectoryList *self)
 {
@@ -506,13 +812,35 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
     }
 
   self->cancellable = g_cancellable_new ();
-  g_file_enumerate_children_async (self->file,
-                                   self->attributes,
-                                   G_FILE_QUERY_INFO_NONE,
-                                   self->io_priority,
-                                   self->cancellable,
-                                   gtk_directory_list_got_enumerator_cb,
-                                   self);
+
+  if (self->threaded)
+    {
+      GtkDirectoryListThreadData *tdata;
+      GTask *task;
+
+      tdata = g_slice_new (GtkDirectoryListThreadData);
+      tdata->self = self;
+      tdata->attributes = g_strdup (self->attributes);
+      tdata->context = g_main_context_ref_thread_default ();
+      tdata->io_priority = self->io_priority;
+
+      task = g_task_new (self->file, self->cancellable, NULL, NULL);
+      g_task_set_source_tag (task, gtk_directory_list_start_loading);
+      g_task_set_priority (task, self->io_priority);
+      g_task_set_task_data (task, tdata, gtk_directory_list_thread_data_free);
+      g_task_run_in_thread (task, gtk_directory_list_load_thread);
+      g_object_unref (task);
+    }
+  else
+    {
+      g_file_enumerate_children_async (self->file,
+                                       self->attributes,
+                                       G_FILE_QUERY_INFO_NONE,
+                                       self->io_priority,
+                                       self->cancellable,
+                                       gtk_directory_list_got_enumerator_cb,
+                                       self);
+    }
 
   if (!was_loading)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
@@ -547,6 +875,7 @@ got_existing_file_info_cb (GObject      *source,
   GtkDirectoryList *self = GTK_DIRECTORY_LIST (data);
   GFileInfo *info;
   GSequenceIter *iter;
+  guint i;
 
   info = g_file_query_info_finish (file, res, NULL);
   if (!info)
@@ -563,9 +892,22 @@ got_existing_file_info_cb (GObject      *source,
       if (g_file_equal (f, file))
         {
           guint position = g_sequence_iter_get_position (iter);
+          g_hash_table_remove (self->lazy_queries, item);
           g_sequence_set (iter, g_object_ref (info));
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
-          break;
+          return;
+        }
+    }
+
+  for (i = 0; i < self->pending->len; i++)
+    {
+      GFileInfo *item = g_ptr_array_index (self->pending, i);
+      GFile *f = G_FILE (g_file_info_get_attribute_object (item, "standard::file"));
+      if (g_file_equal (f, file))
+        {
+          g_object_unref (item);
+          g_ptr_array_index (self->pending, i) = g_object_ref (info);
+          return;
         }
     }
 }
@@ -575,6 +917,7 @@ gtk_directory_list_remove_file (GtkDirectoryList *self,
                                 GFile            *file)
 {
   GSequenceIter *iter;
+  guint i;
 
   for (iter = g_sequence_get_begin_iter (self->items);
        !g_sequence_iter_is_end (iter);
@@ -585,9 +928,21 @@ gtk_directory_list_remove_file (GtkDirectoryList *self,
       if (g_file_equal (f, file))
         {
           guint position = g_sequence_iter_get_position (iter);
+          g_hash_table_remove (self->lazy_queries, item);
           g_sequence_remove (iter);
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
-          break;
+          return;
+        }
+    }
+
+  for (i = 0; i < self->pending->len; i++)
+    {
+      GFileInfo *item = g_ptr_array_index (self->pending, i);
+      GFile *f = G_FILE (g_file_info_get_attribute_object (item, "standard::file"));
+      if (g_file_equal (f, file))
+        {
+          g_ptr_array_remove_index (self->pending, i);
+          return;
         }
     }
 }
@@ -889,3 +1244,228 @@ gtk_directory_list_get_monitored (GtkDirectoryList *self)
 
   return self->monitored;
 }
+
+/**
+ * gtk_directory_list_set_threaded:
+ * @self: a #GtkDirectoryList
+ * @threaded: %TRUE to enumerate the directory in a worker thread
+ *
+ * Sets whether the directory is enumerated in a worker thread.
+ *
+ * By default, the enumeration uses the asynchronous #GFileEnumerator
+ * API and the found files are prepared in the main thread. For very
+ * big directories, doing all of this in a worker thread keeps the
+ * main thread responsive while loading.
+ *
+ * Changing this while @self is loading restarts the loading.
+ */
+void
+gtk_directory_list_set_threaded (GtkDirectoryList *self,
+                                 gboolean          threaded)
+{
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (self->threaded == threaded)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  self->threaded = threaded;
+
+  if (gtk_directory_list_is_loading (self))
+    gtk_directory_list_start_loading (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_THREADED]);
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * gtk_directory_list_get_threaded:
+ * @self: a #GtkDirectoryList
+ *
+ * Returns whether the directory is enumerated in a worker thread.
+ *
+ * Returns: %TRUE if a worker thread is used
+ */
+gboolean
+gtk_directory_list_get_threaded (GtkDirectoryList *self)
+{
+  g_return_val_if_fail (GTK_IS_DIRECTORY_LIST (self), FALSE);
+
+  return self->threaded;
+}
+
+/**
+ * gtk_directory_list_set_lazy_attributes:
+ * @self: a #GtkDirectoryList
+ * @attributes: (allow-none): the attributes to query on request
+ *
+ * Sets the attributes that are only queried for the files passed
+ * to gtk_directory_list_query_lazy_attributes().
+ *
+ * Use this for attributes that are expensive to get, like
+ * #G_FILE_ATTRIBUTE_THUMBNAIL_PATH or a #G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE
+ * that requires sniffing the file contents.
+ *
+ * Changing the lazy attributes does not reload the directory, but
+ * files that already got their lazy attributes will not be queried
+ * again.
+ */
+void
+gtk_directory_list_set_lazy_attributes (GtkDirectoryList *self,
+                                        const char       *attributes)
+{
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (g_strcmp0 (self->lazy_attributes, attributes) == 0)
+    return;
+
+  gtk_directory_list_stop_lazy_queries (self);
+
+  g_free (self->lazy_attributes);
+  self->lazy_attributes = g_strdup (attributes);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LAZY_ATTRIBUTES]);
+}
+
+/**
+ * gtk_directory_list_get_lazy_attributes:
+ * @self: a #GtkDirectoryList
+ *
+ * Gets the attributes that are queried on request.
+ *
+ * Returns: (nullable) (transfer none): The lazily queried attributes
+ */
+const char *
+gtk_directory_list_get_lazy_attributes (GtkDirectoryList *self)
+{
+  g_return_val_if_fail (GTK_IS_DIRECTORY_LIST (self), NULL);
+
+  return self->lazy_attributes;
+}
+
+typedef struct
+{
+  GtkDirectoryList *self; /* invalid if cancelled */
+  GCancellable *cancellable;
+  GFileInfo *info;
+} LazyQuery;
+
+static void
+lazy_query_free (LazyQuery *query)
+{
+  g_object_unref (query->cancellable);
+  g_object_unref (query->info);
+  g_slice_free (LazyQuery, query);
+}
+
+static void
+got_lazy_attributes_cb (GObject      *source,
+                        GAsyncResult *res,
+                        gpointer      data)
+{
+  LazyQuery *query = data;
+  GtkDirectoryList *self = query->self;
+  GSequenceIter *iter;
+  GFileInfo *result, *info;
+  char **names;
+  guint i;
+
+  result = g_file_query_info_finish (G_FILE (source), res, NULL);
+
+  if (g_cancellable_is_cancelled (query->cancellable))
+    goto out;
+
+  /* The file was removed or replaced in the meantime */
+  iter = g_hash_table_lookup (self->lazy_queries, query->info);
+  if (iter == NULL)
+    goto out;
+
+  g_hash_table_remove (self->lazy_queries, query->info);
+
+  if (result == NULL)
+    {
+      /* Don't try again */
+      g_object_set_qdata (G_OBJECT (query->info), lazy_attributes_quark, GINT_TO_POINTER (TRUE));
+      goto out;
+    }
+
+  info = g_file_info_dup (query->info);
+  names = g_file_info_list_attributes (result, NULL);
+  for (i = 0; names[i]; i++)
+    {
+      GFileAttributeType type;
+      gpointer value;
+
+      if (g_file_info_get_attribute_data (result, names[i], &type, &value, NULL))
+        g_file_info_set_attribute (info, names[i], type, value);
+    }
+  g_strfreev (names);
+  g_object_set_qdata (G_OBJECT (info), lazy_attributes_quark, GINT_TO_POINTER (TRUE));
+
+  g_sequence_set (iter, info);
+  g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_iter_get_position (iter), 1, 1);
+
+out:
+  g_clear_object (&result);
+  lazy_query_free (query);
+}
+
+/**
+ * gtk_directory_list_query_lazy_attributes:
+ * @self: a #GtkDirectoryList
+ * @position: the position of the file
+ *
+ * Starts querying the #GtkDirectoryList:lazy-attributes for the file
+ * at @position.
+ *
+ * When the query is done, the #GFileInfo at @position is replaced with
+ * one that additionally has the lazy attributes set. Files are only
+ * queried once, so it is fine to call this every time a list item is
+ * bound.
+ *
+ * If no lazy attributes are set, this function does nothing.
+ */
+void
+gtk_directory_list_query_lazy_attributes (GtkDirectoryList *self,
+                                          guint             position)
+{
+  GSequenceIter *iter;
+  GFileInfo *info;
+  LazyQuery *query;
+  GFile *file;
+
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (self->lazy_attributes == NULL)
+    return;
+
+  iter = g_sequence_get_iter_at_pos (self->items, position);
+  if (g_sequence_iter_is_end (iter))
+    return;
+
+  info = g_sequence_get (iter);
+  if (g_object_get_qdata (G_OBJECT (info), lazy_attributes_quark) ||
+      g_hash_table_contains (self->lazy_queries, info))
+    return;
+
+  if (self->lazy_cancellable == NULL)
+    self->lazy_cancellable = g_cancellable_new ();
+
+  g_hash_table_insert (self->lazy_queries, info, iter);
+
+  query = g_slice_new (LazyQuery);
+  query->self = self;
+  query->cancellable = g_object_ref (self->lazy_cancellable);
+  query->info = g_object_ref (info);
+
+  file = G_FILE (g_file_info_get_attribute_object (info, "standard::file"));
+  g_file_query_info_async (file,
+                           self->lazy_attributes,
+                           G_FILE_QUERY_INFO_NONE,
+                           self->io_priority,
+                           self->lazy_cancellable,
+                           got_lazy_attributes_cb,
+                           query);
+}
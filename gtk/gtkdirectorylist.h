@@ -68,6 +68,21 @@ void                    gtk_directory_list_set_monitored        (GtkDirectoryLis
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_directory_list_get_monitored        (GtkDirectoryList       *self);
 
+GDK_AVAILABLE_IN_ALL
+void                    gtk_directory_list_set_threaded         (GtkDirectoryList       *self,
+                                                                 gboolean                threaded);
+GDK_AVAILABLE_IN_ALL
+gboolean                gtk_directory_list_get_threaded         (GtkDirectoryList       *self);
+
+GDK_AVAILABLE_IN_ALL
+void                    gtk_directory_list_set_lazy_attributes  (GtkDirectoryList       *self,
+                                                                 const char             *attributes);
+GDK_AVAILABLE_IN_ALL
+const char *            gtk_directory_list_get_lazy_attributes  (GtkDirectoryList       *self);
+GDK_AVAILABLE_IN_ALL
+void                    gtk_directory_list_query_lazy_attributes (GtkDirectoryList      *self,
+                                                                 guint                   position);
+
 G_END_DECLS
 
 #endif /* __GTK_DIRECTORY_LIST_H__ */
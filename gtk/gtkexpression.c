@@ -20,7 +20,7 @@
 
 #include "config.h"
 
-#include "gtkexpression.h"
+#include "gtkexpressionprivate.h"
 
 /* XXX: For g_memdup2() */
 #include "gtkprivate.h"
@@ -1128,6 +1128,7 @@ gtk_property_expression_evaluate (GtkExpression *expr,
 }
 
 typedef struct _GtkPropertyExpressionWatch GtkPropertyExpressionWatch;
+typedef struct _GtkWatchDispatcher GtkWatchDispatcher;
 
 struct _GtkPropertyExpressionWatch
 {
@@ -1136,31 +1137,265 @@ struct _GtkPropertyExpressionWatch
 
   GtkPropertyExpression *expr;
   gpointer               this;
-  GClosure              *closure;
+  GtkWatchDispatcher    *dispatcher;
   guchar                 sub[0];
 };
 
+/* All property watches on an object share a single notify handler.
+ *
+ * Rows in list widgets tend to bind lots of properties of the same
+ * item, and rebinding a row used to connect and disconnect a signal
+ * handler for every one of them. With the dispatcher, only the first
+ * watch on an object connects to ::notify and only the last one
+ * disconnects, the rest is adding to and removing from an array.
+ *
+ * The dispatcher is attached to the object, it does not keep the
+ * object alive.
+ */
+struct _GtkWatchDispatcher
+{
+  GObject *object;
+  GClosure *closure;
+  /* property name quark => GPtrArray of GtkPropertyExpressionWatch */
+  GHashTable *watches;
+  guint n_watches;
+  /* while notifying, removed watches are only set to NULL */
+  guint dispatching;
+  guint needs_compact : 1;
+};
+
+static GQuark watch_dispatcher_quark;
+
+static void
+gtk_watch_dispatcher_notify_cb (GObject            *object,
+                                GParamSpec         *pspec,
+                                GtkWatchDispatcher *dispatcher);
+
+static void
+gtk_watch_dispatcher_free (gpointer data)
+{
+  GtkWatchDispatcher *dispatcher = data;
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
+
+  /* The object is gone, make sure the watches don't try to
+   * remove themselves later.
+   */
+  g_hash_table_iter_init (&iter, dispatcher->watches);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      GPtrArray *array = value;
+
+      for (i = 0; i < array->len; i++)
+        {
+          GtkPropertyExpressionWatch *pwatch = g_ptr_array_index (array, i);
+
+          if (pwatch)
+            pwatch->dispatcher = NULL;
+        }
+    }
+
+  g_closure_invalidate (dispatcher->closure);
+  g_closure_unref (dispatcher->closure);
+  g_hash_table_unref (dispatcher->watches);
+  g_slice_free (GtkWatchDispatcher, dispatcher);
+}
+
+static GtkWatchDispatcher *
+gtk_watch_dispatcher_get (GObject *object)
+{
+  GtkWatchDispatcher *dispatcher;
+
+  if (G_UNLIKELY (watch_dispatcher_quark == 0))
+    watch_dispatcher_quark = g_quark_from_static_string ("gtk-expression-watch-dispatcher");
+
+  dispatcher = g_object_get_qdata (object, watch_dispatcher_quark);
+  if (dispatcher)
+    return dispatcher;
+
+  dispatcher = g_slice_new0 (GtkWatchDispatcher);
+  dispatcher->object = object;
+  dispatcher->watches = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+  dispatcher->closure = g_cclosure_new (G_CALLBACK (gtk_watch_dispatcher_notify_cb), dispatcher, NULL);
+  g_closure_ref (dispatcher->closure);
+  g_closure_sink (dispatcher->closure);
+  g_signal_connect_closure_by_id (object,
+                                  g_signal_lookup ("notify", G_OBJECT_TYPE (object)),
+                                  0,
+                                  dispatcher->closure,
+                                  FALSE);
+
+  g_object_set_qdata_full (object, watch_dispatcher_quark, dispatcher, gtk_watch_dispatcher_free);
+
+  return dispatcher;
+}
+
+static void
+gtk_watch_dispatcher_compact (GtkWatchDispatcher *dispatcher)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, dispatcher->watches);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      GPtrArray *array = value;
+      guint i, j;
+
+      /* Keep the watches in the order they were connected */
+      for (i = 0, j = 0; i < array->len; i++)
+        {
+          if (g_ptr_array_index (array, i) != NULL)
+            g_ptr_array_index (array, j++) = g_ptr_array_index (array, i);
+        }
+      g_ptr_array_set_size (array, j);
+
+      if (array->len == 0)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  dispatcher->needs_compact = FALSE;
+}
+
+/* Frees the dispatcher once the last watch is gone, so the
+ * object doesn't pay for signal emissions nobody listens to.
+ */
 static void
-gtk_property_expression_watch_destroy_closure (GtkPropertyExpressionWatch *pwatch)
+gtk_watch_dispatcher_maybe_free (GtkWatchDispatcher *dispatcher)
 {
-  if (pwatch->closure == NULL)
+  if (dispatcher->dispatching > 0)
     return;
 
-  g_closure_invalidate (pwatch->closure);
-  g_closure_unref (pwatch->closure);
-  pwatch->closure = NULL;
+  if (dispatcher->needs_compact)
+    gtk_watch_dispatcher_compact (dispatcher);
+
+  if (dispatcher->n_watches == 0)
+    g_object_set_qdata (dispatcher->object, watch_dispatcher_quark, NULL);
 }
 
 static void
-gtk_property_expression_watch_notify_cb (GObject                    *object,
-                                         GParamSpec                 *pspec,
-                                         GtkPropertyExpressionWatch *pwatch)
+gtk_watch_dispatcher_notify_cb (GObject            *object,
+                                GParamSpec         *pspec,
+                                GtkWatchDispatcher *dispatcher)
 {
-  pwatch->notify (pwatch->user_data);
+  GPtrArray *array;
+  guint i, n;
+
+  array = g_hash_table_lookup (dispatcher->watches,
+                               GUINT_TO_POINTER (g_param_spec_get_name_quark (pspec)));
+  if (array == NULL)
+    return;
+
+  g_ptr_array_ref (array);
+  dispatcher->dispatching++;
+
+  /* Watches added while notifying only get notified next time */
+  n = array->len;
+  for (i = 0; i < n; i++)
+    {
+      GtkPropertyExpressionWatch *pwatch = g_ptr_array_index (array, i);
+
+      if (pwatch)
+        pwatch->notify (pwatch->user_data);
+    }
+
+  dispatcher->dispatching--;
+  g_ptr_array_unref (array);
+
+  gtk_watch_dispatcher_maybe_free (dispatcher);
+}
+
+static void
+gtk_watch_dispatcher_add (GtkWatchDispatcher         *dispatcher,
+                          GtkPropertyExpressionWatch *pwatch)
+{
+  gpointer key = GUINT_TO_POINTER (g_param_spec_get_name_quark (pwatch->expr->pspec));
+  GPtrArray *array;
+
+  array = g_hash_table_lookup (dispatcher->watches, key);
+  if (array == NULL)
+    {
+      array = g_ptr_array_new ();
+      g_hash_table_insert (dispatcher->watches, key, array);
+    }
+
+  g_ptr_array_add (array, pwatch);
+  dispatcher->n_watches++;
+  pwatch->dispatcher = dispatcher;
+}
+
+static void
+gtk_watch_dispatcher_remove (GtkWatchDispatcher         *dispatcher,
+                             GtkPropertyExpressionWatch *pwatch)
+{
+  gpointer key = GUINT_TO_POINTER (g_param_spec_get_name_quark (pwatch->expr->pspec));
+  GPtrArray *array;
+  guint pos;
+
+  array = g_hash_table_lookup (dispatcher->watches, key);
+  if (!g_ptr_array_find (array, pwatch, &pos))
+    g_assert_not_reached ();
+
+  pwatch->dispatcher = NULL;
+  dispatcher->n_watches--;
+
+  if (dispatcher->dispatching > 0)
+    {
+      g_ptr_array_index (array, pos) = NULL;
+      dispatcher->needs_compact = TRUE;
+      return;
+    }
+
+  g_ptr_array_remove_index (array, pos);
+  if (array->len == 0)
+    g_hash_table_remove (dispatcher->watches, key);
+
+  gtk_watch_dispatcher_maybe_free (dispatcher);
+}
+
+/*<private>
+ * gtk_expression_get_watch_counts:
+ * @object: a #GObject
+ * @n_properties: (out): return location for the number of watched properties
+ * @n_watches: (out): return location for the number of watches
+ *
+ * Gets statistics about the property expressions watching @object,
+ * for use by the inspector.
+ */
+void
+gtk_expression_get_watch_counts (GObject *object,
+                                 guint   *n_properties,
+                                 guint   *n_watches)
+{
+  GtkWatchDispatcher *dispatcher = NULL;
+
+  if (watch_dispatcher_quark != 0)
+    dispatcher = g_object_get_qdata (object, watch_dispatcher_quark);
+
+  if (dispatcher)
+    {
+      *n_properties = g_hash_table_size (dispatcher->watches);
+      *n_watches = dispatcher->n_watches;
+    }
+  else
+    {
+      *n_properties = 0;
+      *n_watches = 0;
+    }
+}
+
+static void
+gtk_property_expression_watch_disconnect (GtkPropertyExpressionWatch *pwatch)
+{
+  if (pwatch->dispatcher == NULL)
+    return;
+
+  gtk_watch_dispatcher_remove (pwatch->dispatcher, pwatch);
 }
 
 static void
-gtk_property_expression_watch_create_closure (GtkPropertyExpressionWatch *pwatch)
+gtk_property_expression_watch_connect (GtkPropertyExpressionWatch *pwatch)
 {
   GObject *object;
 
@@ -1168,15 +1403,7 @@ gtk_property_expression_watch_create_closure (GtkPropertyExpressionWatch *pwatch
   if (object == NULL)
     return;
 
-  pwatch->closure = g_cclosure_new (G_CALLBACK (gtk_property_expression_watch_notify_cb), pwatch, NULL);
-  if (!g_signal_connect_closure_by_id (object,
-                                       g_signal_lookup ("notify", G_OBJECT_TYPE (object)),
-                                       g_quark_from_string (pwatch->expr->pspec->name),
-                                       g_closure_ref (pwatch->closure),
-                                       FALSE))
-    {
-      g_assert_not_reached ();
-    }
+  gtk_watch_dispatcher_add (gtk_watch_dispatcher_get (object), pwatch);
 
   g_object_unref (object);
 }
@@ -1186,8 +1413,8 @@ gtk_property_expression_watch_expr_notify_cb (gpointer data)
 {
   GtkPropertyExpressionWatch *pwatch = data;
 
-  gtk_property_expression_watch_destroy_closure (pwatch);
-  gtk_property_expression_watch_create_closure (pwatch);
+  gtk_property_expression_watch_disconnect (pwatch);
+  gtk_property_expression_watch_connect (pwatch);
   pwatch->notify (pwatch->user_data);
 }
 
@@ -1218,6 +1445,7 @@ gtk_property_expression_watch (GtkExpression         *expr,
   pwatch->user_data = user_data;
   pwatch->expr = self;
   pwatch->this = this_;
+  pwatch->dispatcher = NULL;
   if (self->expr && !gtk_expression_is_static (self->expr))
     {
       gtk_expression_subwatch_init (self->expr,
@@ -1227,7 +1455,7 @@ gtk_property_expression_watch (GtkExpression         *expr,
                                     pwatch);
     }
 
-  gtk_property_expression_watch_create_closure (pwatch);
+  gtk_property_expression_watch_connect (pwatch);
 }
 
 static void
@@ -1237,7 +1465,7 @@ gtk_property_expression_unwatch (GtkExpression         *expr,
   GtkPropertyExpressionWatch *pwatch = (GtkPropertyExpressionWatch *) watch;
   GtkPropertyExpression *self = (GtkPropertyExpression *) expr;
 
-  gtk_property_expression_watch_destroy_closure (pwatch);
+  gtk_property_expression_watch_disconnect (pwatch);
 
   if (self->expr && !gtk_expression_is_static (self->expr))
     gtk_expression_subwatch_finish (self->expr, (GtkExpressionSubWatch *) pwatch->sub);
@@ -23,6 +23,7 @@
 
 #include "gtkbitset.h"
 #include "gtkintl.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -139,21 +140,29 @@ gtk_filter_list_model_model_init (GListModelInterface *iface)
 G_DEFINE_TYPE_WITH_CODE (GtkFilterListModel, gtk_filter_list_model, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_filter_list_model_model_init))
 
-static gboolean
-gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
-                                          guint               position)
+/* How many items to get from the model at once when filtering */
+#define GTK_FILTER_BATCH_SIZE 64
+
+static void
+gtk_filter_list_model_run_filter_on_items (GtkFilterListModel *self,
+                                           guint               position,
+                                           guint               n_items)
 {
-  gpointer item;
-  gboolean visible;
+  gpointer items[GTK_FILTER_BATCH_SIZE];
+  guint i;
 
   /* all other cases should have beeen optimized away */
   g_assert (self->strictness == GTK_FILTER_MATCH_SOME);
+  g_assert (n_items <= GTK_FILTER_BATCH_SIZE);
 
-  item = g_list_model_get_item (self->model, position);
-  visible = gtk_filter_match (self->filter, item);
-  g_object_unref (item);
+  n_items = gtk_list_model_get_items (self->model, position, n_items, items);
 
-  return visible;
+  for (i = 0; i < n_items; i++)
+    {
+      if (gtk_filter_match (self->filter, items[i]))
+        gtk_bitset_add (self->matches, position + i);
+      g_object_unref (items[i]);
+    }
 }
 
 static void
@@ -161,7 +170,7 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
                                   guint               n_steps)
 {
   GtkBitsetIter iter;
-  guint i, pos;
+  guint i, pos, n;
   gboolean more;
 
   g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
@@ -169,12 +178,19 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   if (self->pending == NULL)
     return;
 
-  for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
-       i < n_steps && more;
-       i++, more = gtk_bitset_iter_next (&iter, &pos))
+  more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
+  for (i = 0; i < n_steps && more; i += n)
     {
-      if (gtk_filter_list_model_run_filter_on_item (self, pos))
-        gtk_bitset_add (self->matches, pos);
+      /* Filter runs of consecutive pending items in one go */
+      for (n = 1; n < GTK_FILTER_BATCH_SIZE && i + n < n_steps; n++)
+        {
+          if (!gtk_bitset_contains (self->pending, pos + n))
+            break;
+        }
+
+      gtk_filter_list_model_run_filter_on_items (self, pos, n);
+
+      more = gtk_bitset_iter_init_at (&iter, self->pending, pos + n, &pos);
     }
 
   if (more)
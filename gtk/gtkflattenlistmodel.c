@@ -23,6 +23,7 @@
 
 #include "gtkrbtreeprivate.h"
 #include "gtkintl.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -202,8 +203,39 @@ gtk_flatten_list_model_model_init (GListModelInterface *iface)
   iface->get_item = gtk_flatten_list_model_get_item;
 }
 
+static guint
+gtk_flatten_list_model_get_items (GtkListModelBatch *batch,
+                                  guint              position,
+                                  guint              n_items,
+                                  gpointer          *items)
+{
+  GtkFlattenListModel *self = GTK_FLATTEN_LIST_MODEL (batch);
+  FlattenNode *node;
+  guint model_pos, i;
+
+  if (!self->items)
+    return 0;
+
+  /* Only look up the first model, the rest are its successors */
+  node = gtk_flatten_list_model_get_nth (self->items, position, &model_pos);
+  for (i = 0; i < n_items && node != NULL; node = gtk_rb_tree_node_get_next (node))
+    {
+      i += gtk_list_model_get_items (node->model, model_pos, n_items - i, items + i);
+      model_pos = 0;
+    }
+
+  return i;
+}
+
+static void
+gtk_flatten_list_model_batch_init (GtkListModelBatchInterface *iface)
+{
+  iface->get_items = gtk_flatten_list_model_get_items;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkFlattenListModel, gtk_flatten_list_model, G_TYPE_OBJECT,
-                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_flatten_list_model_model_init))
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_flatten_list_model_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_LIST_MODEL_BATCH, gtk_flatten_list_model_batch_init))
 
 static void
 gtk_flatten_list_model_items_changed_cb (GListModel          *model,
@@ -0,0 +1,407 @@
+/* gtkicontexturecache.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkicontexturecacheprivate.h"
+
+#include "gtkdebug.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* An on-disk cache for rasterized SVG icons.
+ *
+ * Every entry is a file in $XDG_CACHE_HOME/gtk-4.0/icon-textures that
+ * is named after a hash of the icon file's path, mtime and size and of
+ * the size, scale and symbolic-ness it was rendered at. So entries never
+ * need to be invalidated, a changed icon just doesn't find its old entry
+ * anymore.
+ *
+ * The file is a small header followed by the pixels in the layout that
+ * gdk_memory_texture_new() expects, so a cache hit is an mmap() and
+ * needs no copying or decoding at all.
+ *
+ * Hits update the entry's mtime, and when the cache grows above
+ * GTK_ICON_TEXTURE_CACHE_MAX_SIZE the least recently used entries are
+ * removed. Writing entries and evicting old ones happens in a worker
+ * thread, so loading icons never waits for it.
+ *
+ * The cache can be turned off with GTK_DEBUG=no-icon-cache.
+ */
+
+#define CACHE_MAGIC "GtkIcTx1"
+
+/* Written in native byte order, so entries from a machine with
+ * a different one are rejected.
+ */
+#define BYTE_ORDER_MARK 0x01020304
+
+/* How much to write before checking the size of the cache again */
+#define EVICTION_INTERVAL (GTK_ICON_TEXTURE_CACHE_MAX_SIZE / 4)
+
+typedef struct
+{
+  char magic[8];
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+  guint32 format;
+  guint32 byte_order;
+  /* Pads the header to 64 bytes so the pixels are well aligned */
+  guint32 reserved[9];
+} IconTextureHeader;
+
+G_STATIC_ASSERT (sizeof (IconTextureHeader) == 64);
+
+/* Only touched by the worker thread */
+static gsize bytes_since_eviction = EVICTION_INTERVAL;
+
+static GMutex pending_lock;
+static GCond pending_cond;
+static guint n_pending;
+
+static const char *
+get_cache_dir (void)
+{
+  static char *cache_dir;
+
+  if (g_once_init_enter (&cache_dir))
+    {
+      char *dir = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "icon-textures", NULL);
+      g_once_init_leave (&cache_dir, dir);
+    }
+
+  return cache_dir;
+}
+
+char *
+gtk_icon_texture_cache_get_key (const char *filename,
+                                int         size,
+                                int         scale,
+                                gboolean    symbolic)
+{
+  GStatBuf st;
+  char *data;
+  char *key;
+
+  if (g_stat (filename, &st) != 0)
+    return NULL;
+
+  data = g_strdup_printf ("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT "\n%d\n%d\n%d",
+                          filename,
+                          (gint64) st.st_mtime,
+                          (gint64) st.st_size,
+                          size, scale, symbolic ? 1 : 0);
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, data, -1);
+  g_free (data);
+
+  return key;
+}
+
+static gboolean
+header_is_valid (const IconTextureHeader *header,
+                 gsize                    length)
+{
+  gsize bpp;
+
+  if (memcmp (header->magic, CACHE_MAGIC, sizeof (header->magic)) != 0 ||
+      header->byte_order != BYTE_ORDER_MARK)
+    return FALSE;
+
+  if (header->format == GDK_MEMORY_GDK_PIXBUF_ALPHA)
+    bpp = 4;
+  else if (header->format == GDK_MEMORY_GDK_PIXBUF_OPAQUE)
+    bpp = 3;
+  else
+    return FALSE;
+
+  if (header->width == 0 || header->height == 0 ||
+      header->stride < header->width * bpp)
+    return FALSE;
+
+  return length == sizeof (IconTextureHeader) + (gsize) header->stride * header->height;
+}
+
+GdkTexture *
+gtk_icon_texture_cache_lookup (const char *key)
+{
+  IconTextureHeader header;
+  GMappedFile *mapped;
+  GBytes *bytes, *pixels;
+  GdkTexture *texture;
+  char *path;
+  gsize length;
+
+  path = g_build_filename (get_cache_dir (), key, NULL);
+
+  mapped = g_mapped_file_new (path, FALSE, NULL);
+  if (mapped == NULL)
+    {
+      g_free (path);
+      return NULL;
+    }
+
+  length = g_mapped_file_get_length (mapped);
+  if (length < sizeof (IconTextureHeader))
+    goto invalid;
+
+  memcpy (&header, g_mapped_file_get_contents (mapped), sizeof (IconTextureHeader));
+  if (!header_is_valid (&header, length))
+    goto invalid;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  pixels = g_bytes_new_from_bytes (bytes,
+                                   sizeof (IconTextureHeader),
+                                   length - sizeof (IconTextureHeader));
+  texture = gdk_memory_texture_new (header.width, header.height,
+                                    header.format,
+                                    pixels,
+                                    header.stride);
+  g_bytes_unref (pixels);
+  g_bytes_unref (bytes);
+  g_mapped_file_unref (mapped);
+
+  /* Mark as recently used for eviction */
+  g_utime (path, NULL);
+
+  GTK_NOTE (ICONTHEME, g_message ("icon texture cache hit for %s", key));
+
+  g_free (path);
+
+  return texture;
+
+invalid:
+  GTK_NOTE (ICONTHEME, g_message ("removing invalid icon texture cache entry %s", key));
+  g_mapped_file_unref (mapped);
+  g_unlink (path);
+  g_free (path);
+
+  return NULL;
+}
+
+typedef struct
+{
+  char *path;
+  gint64 mtime;
+  gint64 size;
+} CacheEntry;
+
+static int
+compare_entries (gconstpointer a,
+                 gconstpointer b)
+{
+  const CacheEntry *ea = a;
+  const CacheEntry *eb = b;
+
+  if (ea->mtime < eb->mtime)
+    return -1;
+  else if (ea->mtime > eb->mtime)
+    return 1;
+  else
+    return 0;
+}
+
+/* Removes the least recently used entries until the cache is at 3/4
+ * of its maximum size, so we don't do this again right away.
+ */
+static void
+evict_entries (void)
+{
+  const char *cache_dir = get_cache_dir ();
+  GArray *entries;
+  const char *name;
+  gint64 total;
+  GDir *dir;
+  guint i;
+
+  dir = g_dir_open (cache_dir, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (CacheEntry));
+  total = 0;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      CacheEntry entry;
+      GStatBuf st;
+
+      entry.path = g_build_filename (cache_dir, name, NULL);
+      if (g_stat (entry.path, &st) != 0)
+        {
+          g_free (entry.path);
+          continue;
+        }
+
+      entry.mtime = st.st_mtime;
+      entry.size = st.st_size;
+      total += entry.size;
+      g_array_append_val (entries, entry);
+    }
+
+  g_dir_close (dir);
+
+  if (total > GTK_ICON_TEXTURE_CACHE_MAX_SIZE)
+    {
+      g_array_sort (entries, compare_entries);
+
+      for (i = 0; i < entries->len && total > GTK_ICON_TEXTURE_CACHE_MAX_SIZE / 4 * 3; i++)
+        {
+          CacheEntry *entry = &g_array_index (entries, CacheEntry, i);
+
+          if (g_unlink (entry->path) == 0)
+            total -= entry->size;
+        }
+
+      GTK_NOTE (ICONTHEME, g_message ("evicted %u icon texture cache entries", i));
+    }
+
+  for (i = 0; i < entries->len; i++)
+    g_free (g_array_index (entries, CacheEntry, i).path);
+  g_array_free (entries, TRUE);
+}
+
+static void
+write_entry (const char *key,
+             GdkPixbuf  *pixbuf)
+{
+  IconTextureHeader header = { { 0, }, };
+  const guchar *src;
+  guchar *data;
+  gsize row_size, length;
+  char *path;
+  int width, height, stride, n_channels;
+  int y;
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  stride = gdk_pixbuf_get_rowstride (pixbuf);
+  n_channels = gdk_pixbuf_get_n_channels (pixbuf);
+  row_size = width * n_channels;
+
+  memcpy (header.magic, CACHE_MAGIC, sizeof (header.magic));
+  header.width = width;
+  header.height = height;
+  header.stride = stride;
+  header.format = gdk_pixbuf_get_has_alpha (pixbuf) ? GDK_MEMORY_GDK_PIXBUF_ALPHA
+                                                     : GDK_MEMORY_GDK_PIXBUF_OPAQUE;
+  header.byte_order = BYTE_ORDER_MARK;
+
+  if (!header_is_valid (&header, sizeof (IconTextureHeader) + (gsize) stride * height))
+    return;
+
+  /* The last row of a pixbuf may be shorter than the stride, but a
+   * memory texture wants all of them, so copy row by row.
+   */
+  length = sizeof (IconTextureHeader) + (gsize) stride * height;
+  data = g_malloc0 (length);
+  memcpy (data, &header, sizeof (IconTextureHeader));
+
+  src = gdk_pixbuf_read_pixels (pixbuf);
+  for (y = 0; y < height; y++)
+    memcpy (data + sizeof (IconTextureHeader) + y * stride, src + y * stride, row_size);
+
+  g_mkdir_with_parents (get_cache_dir (), 0700);
+
+  path = g_build_filename (get_cache_dir (), key, NULL);
+  /* This writes to a temporary file and renames it, so readers never
+   * see a partial entry and existing mappings stay intact. */
+  g_file_set_contents (path, (const char *) data, length, NULL);
+  g_free (path);
+  g_free (data);
+
+  bytes_since_eviction += length;
+  if (bytes_since_eviction >= EVICTION_INTERVAL)
+    {
+      bytes_since_eviction = 0;
+      evict_entries ();
+    }
+}
+
+typedef struct
+{
+  char *key;
+  GdkPixbuf *pixbuf;
+} StoreJob;
+
+static void
+store_thread_func (gpointer data,
+                   gpointer user_data)
+{
+  StoreJob *job = data;
+
+  write_entry (job->key, job->pixbuf);
+
+  g_free (job->key);
+  g_object_unref (job->pixbuf);
+  g_slice_free (StoreJob, job);
+
+  g_mutex_lock (&pending_lock);
+  n_pending--;
+  if (n_pending == 0)
+    g_cond_broadcast (&pending_cond);
+  g_mutex_unlock (&pending_lock);
+}
+
+static GThreadPool *
+get_store_pool (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
+    {
+      /* A single thread, so writes and evictions don't race each other */
+      GThreadPool *p = g_thread_pool_new (store_thread_func, NULL, 1, FALSE, NULL);
+      g_once_init_leave (&pool, p);
+    }
+
+  return pool;
+}
+
+/* Queues the pixbuf to be written to the cache. The pixbuf must not
+ * be modified afterwards.
+ */
+void
+gtk_icon_texture_cache_store (const char *key,
+                              GdkPixbuf  *pixbuf)
+{
+  StoreJob *job;
+
+  if (gdk_pixbuf_get_bits_per_sample (pixbuf) != 8 ||
+      gdk_pixbuf_get_colorspace (pixbuf) != GDK_COLORSPACE_RGB)
+    return;
+
+  job = g_slice_new (StoreJob);
+  job->key = g_strdup (key);
+  job->pixbuf = g_object_ref (pixbuf);
+
+  g_mutex_lock (&pending_lock);
+  n_pending++;
+  g_mutex_unlock (&pending_lock);
+
+  g_thread_pool_push (get_store_pool (), job, NULL);
+}
+
+/* Waits until all queued entries have been written */
+void
+gtk_icon_texture_cache_flush (void)
+{
+  g_mutex_lock (&pending_lock);
+  while (n_pending > 0)
+    g_cond_wait (&pending_cond, &pending_lock);
+  g_mutex_unlock (&pending_lock);
+}
@@ -0,0 +1,38 @@
+/* gtkicontexturecacheprivate.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK_ICON_TEXTURE_CACHE_PRIVATE_H__
+#define __GTK_ICON_TEXTURE_CACHE_PRIVATE_H__
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gdk/gdk.h>
+
+G_BEGIN_DECLS
+
+/* Cap on the total size of the cache directory */
+#define GTK_ICON_TEXTURE_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
+char *          gtk_icon_texture_cache_get_key          (const char     *filename,
+                                                         int             size,
+                                                         int             scale,
+                                                         gboolean        symbolic);
+GdkTexture *    gtk_icon_texture_cache_lookup           (const char     *key);
+void            gtk_icon_texture_cache_store            (const char     *key,
+                                                         GdkPixbuf      *pixbuf);
+void            gtk_icon_texture_cache_flush            (void);
+
+G_END_DECLS
+
+#endif /* __GTK_ICON_TEXTURE_CACHE_PRIVATE_H__ */
@@ -43,6 +43,7 @@
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkdebug.h"
 #include "gtkiconcacheprivate.h"
+#include "gtkicontexturecacheprivate.h"
 #include "gtkintl.h"
 #include "gtkmain.h"
 #include "gtksettingsprivate.h"
@@ -2414,17 +2415,62 @@ choose_icon (GtkIconTheme      *self,
 }
 
 static void
-load_icon_thread (GTask        *task,
-                  gpointer      source_object,
-                  gpointer      task_data,
-                  GCancellable *cancellable)
+load_icon_thread (gpointer data,
+                  gpointer user_data)
 {
-  GtkIconPaintable *self = GTK_ICON_PAINTABLE (source_object);
+  GtkIconPaintable *self = data;
 
   g_mutex_lock (&self->texture_lock);
   icon_ensure_texture__locked (self, TRUE);
   g_mutex_unlock (&self->texture_lock);
-  g_task_return_pointer (task, NULL, NULL);
+
+  g_object_unref (self);
+}
+
+/* Icons are loaded in a pool of their own, so that a window full of
+ * icons can use all cores without taking up all of GIO's threads.
+ */
+static GThreadPool *
+get_icon_load_pool (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (load_icon_thread,
+                                    NULL,
+                                    g_get_num_processors (),
+                                    FALSE,
+                                    NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/* Starts loading the texture of @icon in a thread, unless it is
+ * already loaded or being loaded.
+ *
+ * This must not be called with the icon theme locked, since the
+ * loading only takes the icon's texture_lock.
+ */
+static void
+icon_queue_load (GtkIconPaintable *icon)
+{
+  gboolean has_texture;
+
+  /* If we fail to get the lock it is because some other thread is
+     currently loading the icon, so we need to do nothing */
+  if (!g_mutex_trylock (&icon->texture_lock))
+    return;
+
+  has_texture = icon->texture != NULL;
+  g_mutex_unlock (&icon->texture_lock);
+
+  if (!has_texture)
+    g_thread_pool_push (get_icon_load_pool (), g_object_ref (icon), NULL);
 }
 
 /**
@@ -2501,26 +2547,80 @@ gtk_icon_theme_lookup_icon (GtkIconTheme       *self,
   gtk_icon_theme_unlock (self);
 
   if (flags & GTK_ICON_LOOKUP_PRELOAD)
+    icon_queue_load (icon);
+
+  return icon;
+}
+
+/**
+ * gtk_icon_theme_prefetch_icons:
+ * @self: a #GtkIconTheme
+ * @icon_names: (array zero-terminated=1): the names of the icons to prefetch
+ * @size: desired icon size
+ * @scale: the window scale the icons will be displayed on
+ * @direction: text direction the icons will be displayed in
+ * @flags: flags modifying the behavior of the icon lookup
+ *
+ * Looks up all of @icon_names like gtk_icon_theme_lookup_icon() and
+ * starts loading them in a pool of worker threads.
+ *
+ * This is useful for warming up the icons of a window while it is
+ * being constructed, so that they are already loaded when the window
+ * is first drawn. Later lookups of the same icons will find the
+ * prefetched #GtkIconPaintables.
+ *
+ * The icons are kept alive as long as the returned model exists, so
+ * keep it around until the icons are in use.
+ *
+ * Returns: (transfer full): a #GListModel of the #GtkIconPaintables
+ *     for @icon_names
+ */
+GListModel *
+gtk_icon_theme_prefetch_icons (GtkIconTheme       *self,
+                               const char * const *icon_names,
+                               int                 size,
+                               int                 scale,
+                               GtkTextDirection    direction,
+                               GtkIconLookupFlags  flags)
+{
+  GtkIconPaintable **icons;
+  GListStore *store;
+  guint i, n_icons;
+
+  g_return_val_if_fail (GTK_IS_ICON_THEME (self), NULL);
+  g_return_val_if_fail (icon_names != NULL, NULL);
+  g_return_val_if_fail (scale >= 1, NULL);
+
+  n_icons = g_strv_length ((char **) icon_names);
+  icons = g_new (GtkIconPaintable *, n_icons);
+
+  /* Look up all icons with a single lock of the theme, and only
+   * load them after unlocking it */
+  gtk_icon_theme_lock (self);
+
+  for (i = 0; i < n_icons; i++)
     {
-      gboolean has_texture = FALSE;
+      const char *names[2];
 
-      /* If we fail to get the lock it is because some other thread is
-         currently loading the icon, so we need to do nothing */
-      if (g_mutex_trylock (&icon->texture_lock))
-        {
-          has_texture = icon->texture != NULL;
-          g_mutex_unlock (&icon->texture_lock);
+      names[0] = icon_names[i];
+      names[1] = NULL;
 
-          if (!has_texture)
-            {
-              GTask *task = g_task_new (icon, NULL, NULL, NULL);
-              g_task_run_in_thread (task, load_icon_thread);
-              g_object_unref (task);
-            }
-        }
+      icons[i] = choose_icon (self, names, size, scale, direction, flags, FALSE);
     }
 
-  return icon;
+  gtk_icon_theme_unlock (self);
+
+  for (i = 0; i < n_icons; i++)
+    icon_queue_load (icons[i]);
+
+  store = g_list_store_new (GTK_TYPE_ICON_PAINTABLE);
+  g_list_store_splice (store, 0, 0, (gpointer *) icons, n_icons);
+
+  for (i = 0; i < n_icons; i++)
+    g_object_unref (icons[i]);
+  g_free (icons);
+
+  return G_LIST_MODEL (store);
 }
 
 /* Error quark */
@@ -3720,6 +3820,7 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
   gint64 before;
   int pixel_size;
   GError *load_error = NULL;
+  char *cache_key = NULL;
 
   icon_cache_mark_used_if_cached (icon);
 
@@ -3733,6 +3834,21 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
    */
   pixel_size = icon->desired_size * icon->desired_scale;
 
+  /* Rendering SVGs is slow, so we keep the results around on disk */
+  if (icon->is_svg && !icon->is_resource && icon->filename &&
+      !GTK_DEBUG_CHECK (NO_ICON_CACHE))
+    {
+      cache_key = gtk_icon_texture_cache_get_key (icon->filename,
+                                                  pixel_size,
+                                                  icon->desired_scale,
+                                                  gtk_icon_paintable_is_symbolic (icon));
+      if (cache_key)
+        icon->texture = gtk_icon_texture_cache_lookup (cache_key);
+
+      if (icon->texture)
+        goto out;
+    }
+
   /* At this point, we need to actually get the icon; either from the
    * builtin image or by loading the file
    */
@@ -3800,6 +3916,9 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
                                                                       pixel_size, pixel_size,
                                                                       TRUE, NULL,
                                                                       &load_error);
+
+              if (source_pixbuf && cache_key)
+                gtk_icon_texture_cache_store (cache_key, source_pixbuf);
             }
           else
             source_pixbuf = _gdk_pixbuf_new_from_stream (stream,
@@ -3829,6 +3948,9 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
 
   g_assert (icon->texture != NULL);
 
+out:
+  g_free (cache_key);
+
   if (GDK_PROFILER_IS_RUNNING)
     {
       gint64 end = GDK_PROFILER_CURRENT_TIME;
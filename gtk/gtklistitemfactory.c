@@ -21,6 +21,7 @@
 
 #include "gtklistitemfactoryprivate.h"
 
+#include "gtkintl.h"
 #include "gtklistitemprivate.h"
 
 /**
@@ -69,10 +70,25 @@
  * Once you have chosen your factory and created it, you need to set it on the
  * view widget you want to use it with, such as via gtk_list_view_set_factory().
  * Reusing factories across different views is allowed, but very uncommon.
+ *
+ * Views usually destroy widgets they don't need anymore, for example when
+ * their model changes. With gtk_list_item_factory_set_pool_size(), the
+ * factory keeps a number of those widgets around after they have been
+ * unbound, and all views using the factory reuse them instead of setting
+ * up new ones.
  */
 
+enum {
+  PROP_0,
+  PROP_POOL_SIZE,
+
+  N_PROPS
+};
+
 G_DEFINE_TYPE (GtkListItemFactory, gtk_list_item_factory, G_TYPE_OBJECT)
 
+static GParamSpec *properties[N_PROPS] = { NULL, };
+
 static void
 gtk_list_item_factory_default_setup (GtkListItemFactory *self,
                                      GtkListItemWidget  *widget,
@@ -102,12 +118,91 @@ gtk_list_item_factory_default_update (GtkListItemFactory *self,
   gtk_list_item_widget_default_update (widget, list_item, position, item, selected);
 }
 
+static void
+gtk_list_item_factory_drain_pool (GtkListItemFactory *self,
+                                  guint               pool_size)
+{
+  while (g_queue_get_length (&self->pool) > pool_size)
+    g_object_unref (g_queue_pop_tail (&self->pool));
+}
+
+static void
+gtk_list_item_factory_dispose (GObject *object)
+{
+  GtkListItemFactory *self = GTK_LIST_ITEM_FACTORY (object);
+
+  gtk_list_item_factory_drain_pool (self, 0);
+  g_clear_handle_id (&self->drain_pool_id, g_source_remove);
+
+  G_OBJECT_CLASS (gtk_list_item_factory_parent_class)->dispose (object);
+}
+
+static void
+gtk_list_item_factory_get_property (GObject    *object,
+                                    guint       property_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+  GtkListItemFactory *self = GTK_LIST_ITEM_FACTORY (object);
+
+  switch (property_id)
+    {
+    case PROP_POOL_SIZE:
+      g_value_set_uint (value, self->pool_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_list_item_factory_set_property (GObject      *object,
+                                    guint         property_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  GtkListItemFactory *self = GTK_LIST_ITEM_FACTORY (object);
+
+  switch (property_id)
+    {
+    case PROP_POOL_SIZE:
+      gtk_list_item_factory_set_pool_size (self, g_value_get_uint (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+    }
+}
+
 static void
 gtk_list_item_factory_class_init (GtkListItemFactoryClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->dispose = gtk_list_item_factory_dispose;
+  gobject_class->get_property = gtk_list_item_factory_get_property;
+  gobject_class->set_property = gtk_list_item_factory_set_property;
+
   klass->setup = gtk_list_item_factory_default_setup;
   klass->teardown = gtk_list_item_factory_default_teardown;
   klass->update = gtk_list_item_factory_default_update;
+
+  /**
+   * GtkListItemFactory:pool-size:
+   *
+   * Number of unused widgets to keep around for reuse
+   */
+  properties[PROP_POOL_SIZE] =
+    g_param_spec_uint ("pool-size",
+                       P_("Pool size"),
+                       P_("Number of unused widgets to keep around for reuse"),
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPS, properties);
 }
 
 static void
@@ -164,3 +259,161 @@ gtk_list_item_factory_update (GtkListItemFactory *self,
   g_object_thaw_notify (G_OBJECT (list_item));
 }
 
+
+static gboolean
+gtk_list_item_factory_drain_pool_cb (gpointer data)
+{
+  GtkListItemFactory *self = data;
+
+  self->drain_pool_id = 0;
+
+  if (self->n_users == 0)
+    gtk_list_item_factory_drain_pool (self, 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+gtk_list_item_factory_add_user (GtkListItemFactory *self)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_FACTORY (self));
+
+  self->n_users++;
+}
+
+void
+gtk_list_item_factory_remove_user (GtkListItemFactory *self)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_FACTORY (self));
+  g_return_if_fail (self->n_users > 0);
+
+  self->n_users--;
+
+  /* Pooled widgets keep a reference to us, so drop them once nobody
+   * uses us anymore. But wait a bit, views often get replaced by new
+   * views using the same factory.
+   */
+  if (self->n_users == 0 &&
+      self->drain_pool_id == 0 &&
+      !g_queue_is_empty (&self->pool))
+    {
+      self->drain_pool_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                                             gtk_list_item_factory_drain_pool_cb,
+                                             g_object_ref (self),
+                                             g_object_unref);
+      g_source_set_name_by_id (self->drain_pool_id, "[gtk] gtk_list_item_factory_drain_pool_cb");
+    }
+}
+
+/*
+ * gtk_list_item_factory_recycle_widget:
+ * @self: a #GtkListItemFactory
+ * @widget: a widget created with @self that isn't needed anymore
+ *
+ * Unparents and unbinds @widget and keeps it for
+ * gtk_list_item_factory_reuse_widget() if the pool isn't full yet.
+ * Otherwise @widget is just unparented, which destroys it.
+ */
+void
+gtk_list_item_factory_recycle_widget (GtkListItemFactory *self,
+                                      GtkListItemWidget  *widget)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_FACTORY (self));
+  g_return_if_fail (GTK_IS_LIST_ITEM_WIDGET (widget));
+
+  if (g_queue_get_length (&self->pool) >= self->pool_size)
+    {
+      gtk_widget_unparent (GTK_WIDGET (widget));
+      return;
+    }
+
+  g_object_ref (widget);
+  gtk_list_item_widget_set_pooled (widget, TRUE);
+  gtk_widget_unparent (GTK_WIDGET (widget));
+
+  gtk_list_item_widget_update (widget, GTK_INVALID_LIST_POSITION, NULL, FALSE);
+  g_queue_push_head (&self->pool, widget);
+}
+
+/*
+ * gtk_list_item_factory_reuse_widget:
+ * @self: a #GtkListItemFactory
+ * @css_name: the CSS name of the widget
+ * @role: the accessible role of the widget
+ *
+ * Takes a widget out of the pool of unused widgets, if one
+ * with the given @css_name and @role exists.
+ *
+ * Returns: (transfer full) (nullable): a widget to reuse
+ */
+GtkListItemWidget *
+gtk_list_item_factory_reuse_widget (GtkListItemFactory *self,
+                                    const char         *css_name,
+                                    GtkAccessibleRole   role)
+{
+  GList *l;
+
+  g_return_val_if_fail (GTK_IS_LIST_ITEM_FACTORY (self), NULL);
+
+  for (l = self->pool.head; l; l = l->next)
+    {
+      GtkWidget *widget = l->data;
+
+      if (g_str_equal (gtk_widget_get_css_name (widget), css_name) &&
+          gtk_accessible_get_accessible_role (GTK_ACCESSIBLE (widget)) == role)
+        {
+          g_queue_delete_link (&self->pool, l);
+          gtk_list_item_widget_set_pooled (GTK_LIST_ITEM_WIDGET (widget), FALSE);
+          return GTK_LIST_ITEM_WIDGET (widget);
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * gtk_list_item_factory_set_pool_size:
+ * @self: a #GtkListItemFactory
+ * @pool_size: the number of widgets to keep
+ *
+ * Sets how many widgets that views don't need anymore are kept
+ * around to be reused.
+ *
+ * Widgets in the pool are unbound but not torn down, so views using
+ * @self get them without going through setup again. This is useful
+ * when views frequently replace their model or when multiple views
+ * share the factory and get created and destroyed.
+ *
+ * The pool is emptied when no view uses @self anymore.
+ */
+void
+gtk_list_item_factory_set_pool_size (GtkListItemFactory *self,
+                                     guint               pool_size)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_FACTORY (self));
+
+  if (self->pool_size == pool_size)
+    return;
+
+  self->pool_size = pool_size;
+  gtk_list_item_factory_drain_pool (self, pool_size);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_POOL_SIZE]);
+}
+
+/**
+ * gtk_list_item_factory_get_pool_size:
+ * @self: a #GtkListItemFactory
+ *
+ * Gets the number of unused widgets @self keeps around.
+ * See gtk_list_item_factory_set_pool_size().
+ *
+ * Returns: the pool size
+ */
+guint
+gtk_list_item_factory_get_pool_size (GtkListItemFactory *self)
+{
+  g_return_val_if_fail (GTK_IS_LIST_ITEM_FACTORY (self), 0);
+
+  return self->pool_size;
+}
@@ -42,6 +42,12 @@ G_BEGIN_DECLS
 GDK_AVAILABLE_IN_ALL
 GType        gtk_list_item_factory_get_type       (void) G_GNUC_CONST;
 
+GDK_AVAILABLE_IN_ALL
+void         gtk_list_item_factory_set_pool_size  (GtkListItemFactory     *self,
+                                                   guint                   pool_size);
+GDK_AVAILABLE_IN_ALL
+guint        gtk_list_item_factory_get_pool_size  (GtkListItemFactory     *self);
+
 
 G_END_DECLS
 
@@ -29,6 +29,13 @@ G_BEGIN_DECLS
 struct _GtkListItemFactory
 {
   GObject parent_instance;
+
+  /* unparented and unbound widgets, we own a reference to them */
+  GQueue pool;
+  guint pool_size;
+  /* number of list item managers using this factory */
+  guint n_users;
+  guint drain_pool_id;
 };
 
 struct _GtkListItemFactoryClass
@@ -65,6 +72,14 @@ void                    gtk_list_item_factory_update            (GtkListItemFact
                                                                  gpointer                item,
                                                                  gboolean                selected);
 
+void                    gtk_list_item_factory_add_user          (GtkListItemFactory     *self);
+void                    gtk_list_item_factory_remove_user       (GtkListItemFactory     *self);
+void                    gtk_list_item_factory_recycle_widget    (GtkListItemFactory     *self,
+                                                                 GtkListItemWidget      *widget);
+GtkListItemWidget *     gtk_list_item_factory_reuse_widget      (GtkListItemFactory     *self,
+                                                                 const char             *css_name,
+                                                                 GtkAccessibleRole       role);
+
 
 G_END_DECLS
 
@@ -21,11 +21,20 @@
 
 #include "gtklistitemmanagerprivate.h"
 
+#include "gtkbitset.h"
+#include "gtklistitemfactoryprivate.h"
 #include "gtklistitemwidgetprivate.h"
+#include "gtkselectionmodelprivate.h"
 #include "gtkwidgetprivate.h"
+#include "gdk/gdkprofilerprivate.h"
+
+#include <string.h>
 
 #define GTK_LIST_VIEW_MAX_LIST_ITEMS 200
 
+/* Time per frame that may be spent binding items when binding is deferred */
+#define GTK_LIST_ITEM_MANAGER_BIND_BUDGET (4 * G_TIME_SPAN_MILLISECOND)
+
 struct _GtkListItemManager
 {
   GObject parent_instance;
@@ -36,9 +45,18 @@ struct _GtkListItemManager
   gboolean single_click_activate;
   const char *item_css_name;
   GtkAccessibleRole item_role;
+  gsize element_size;
+  gboolean keep_item_data;
 
   GtkRbTree *items;
   GSList *trackers;
+
+  gboolean defer_binding;
+  gint64 bind_frame; /* frame counter of the frame bind_time is for */
+  gint64 bind_time;
+  guint deferred_bind_id;
+  /* Bumped on every items-changed, positions are outdated then */
+  guint n_model_changes;
 };
 
 struct _GtkListItemManagerClass
@@ -72,6 +90,11 @@ static void             gtk_list_item_manager_move_list_item    (GtkListItemMana
 static void             gtk_list_item_manager_release_list_item (GtkListItemManager     *self,
                                                                  GHashTable             *change,
                                                                  GtkWidget              *widget);
+static void             gtk_list_item_manager_recycle_list_item (GtkListItemManager     *self,
+                                                                 GtkWidget              *widget);
+static void             gtk_list_item_manager_bind_list_item    (GtkListItemManager     *self,
+                                                                 GtkWidget              *widget,
+                                                                 guint                   position);
 G_DEFINE_TYPE (GtkListItemManager, gtk_list_item_manager, G_TYPE_OBJECT)
 
 void
@@ -129,6 +152,7 @@ gtk_list_item_manager_new_for_size (GtkWidget            *widget,
   self->widget = widget;
   self->item_css_name = g_intern_string (item_css_name);
   self->item_role = item_role;
+  self->element_size = element_size;
 
   self->items = gtk_rb_tree_new_for_size (element_size,
                                           augment_size,
@@ -249,6 +273,29 @@ gtk_list_item_manager_get_item_augment (GtkListItemManager *self,
   return gtk_rb_tree_get_augment (self->items, item);
 }
 
+#define ITEM_DATA(item) ((guint8 *) (item) + sizeof (GtkListItemManagerItem))
+
+/* Splits the first @n_items off @item into a new item before it */
+static GtkListItemManagerItem *
+gtk_list_item_manager_split_item (GtkListItemManager     *self,
+                                  GtkListItemManagerItem *item,
+                                  guint                   n_items)
+{
+  GtkListItemManagerItem *new_item;
+
+  g_assert (item->widget == NULL);
+  g_assert (n_items > 0 && n_items < item->n_items);
+
+  new_item = gtk_rb_tree_insert_before (self->items, item);
+  new_item->n_items = n_items;
+  if (self->keep_item_data)
+    memcpy (ITEM_DATA (new_item), ITEM_DATA (item), self->element_size - sizeof (GtkListItemManagerItem));
+  item->n_items -= n_items;
+  gtk_rb_tree_node_mark_dirty (item);
+
+  return new_item;
+}
+
 static void
 gtk_list_item_tracker_unset_position (GtkListItemManager *self,
                                       GtkListItemTracker *tracker)
@@ -397,7 +444,16 @@ gtk_list_item_manager_add_items (GtkListItemManager *self,
   item = gtk_list_item_manager_get_nth (self, position, &offset);
 
   if (item == NULL || item->widget)
-    item = gtk_rb_tree_insert_before (self->items, item);
+    {
+      item = gtk_rb_tree_insert_before (self->items, item);
+    }
+  else if (self->keep_item_data)
+    {
+      /* The new items don't share the data of the existing ones */
+      if (offset > 0)
+        gtk_list_item_manager_split_item (self, item, offset);
+      item = gtk_rb_tree_insert_before (self->items, item);
+    }
   item->n_items += n_items;
   gtk_rb_tree_node_mark_dirty (item);
 
@@ -412,6 +468,10 @@ gtk_list_item_manager_merge_list_items (GtkListItemManager     *self,
   if (first->widget || second->widget)
     return FALSE;
 
+  if (self->keep_item_data &&
+      memcmp (ITEM_DATA (first), ITEM_DATA (second), self->element_size - sizeof (GtkListItemManagerItem)) != 0)
+    return FALSE;
+
   first->n_items += second->n_items;
   gtk_rb_tree_node_mark_dirty (first);
   gtk_rb_tree_remove (self->items, second);
@@ -455,8 +515,7 @@ gtk_list_item_manager_release_items (GtkListItemManager *self,
               if (next && next->widget == NULL)
                 {
                   i += next->n_items;
-                  if (!gtk_list_item_manager_merge_list_items (self, next, item))
-                    g_assert_not_reached ();
+                  gtk_list_item_manager_merge_list_items (self, next, item);
                   item = gtk_rb_tree_node_get_next (next);
                 }
               else 
@@ -510,21 +569,13 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
       insert_after = new_item ? new_item->widget : NULL;
 
       if (offset > 0)
-        {
-          new_item = gtk_rb_tree_insert_before (self->items, item);
-          new_item->n_items = offset;
-          item->n_items -= offset;
-          gtk_rb_tree_node_mark_dirty (item);
-        }
+        gtk_list_item_manager_split_item (self, item, offset);
 
       for (i = 0; i < query_n_items; i++)
         {
           if (item->n_items > 1)
             {
-              new_item = gtk_rb_tree_insert_before (self->items, item);
-              new_item->n_items = 1;
-              item->n_items--;
-              gtk_rb_tree_node_mark_dirty (item);
+              new_item = gtk_list_item_manager_split_item (self, item, 1);
             }
           else
             {
@@ -558,6 +609,11 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
                     }
                 }
             }
+          else if (gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (new_item->widget)) == NULL)
+            {
+              /* A placeholder, maybe it's tracked now or there's time to bind it */
+              gtk_list_item_manager_bind_list_item (self, new_item->widget, position + i);
+            }
           else
             {
               if (update_start <= position + i)
@@ -580,11 +636,15 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
                                               GtkListItemManager *self)
 {
   GHashTable *change;
+  GHashTableIter iter;
+  gpointer widget;
   GSList *l;
   guint n_items;
 
+  self->n_model_changes++;
+
   n_items = g_list_model_get_n_items (G_LIST_MODEL (self->model));
-  change = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify )gtk_widget_unparent);
+  change = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   gtk_list_item_manager_remove_items (self, change, position, removed);
   gtk_list_item_manager_add_items (self, position, added);
@@ -635,11 +695,8 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
 
           if (offset > 0)
             {
-              new_item = gtk_rb_tree_insert_before (self->items, item);
-              new_item->n_items = offset;
-              item->n_items -= offset;
+              gtk_list_item_manager_split_item (self, item, offset);
               offset = 0;
-              gtk_rb_tree_node_mark_dirty (item);
             }
 
           if (item->n_items == 1)
@@ -649,10 +706,7 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
             }
           else
             {
-              new_item = gtk_rb_tree_insert_before (self->items, item);
-              new_item->n_items = 1;
-              item->n_items--;
-              gtk_rb_tree_node_mark_dirty (item);
+              new_item = gtk_list_item_manager_split_item (self, item, 1);
             }
 
           new_item->widget = widget;
@@ -728,6 +782,9 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
       tracker->widget = GTK_LIST_ITEM_WIDGET (item->widget);
     }
 
+  g_hash_table_iter_init (&iter, change);
+  while (g_hash_table_iter_next (&iter, NULL, &widget))
+    gtk_list_item_manager_recycle_list_item (self, widget);
   g_hash_table_unref (change);
 
   gtk_widget_queue_resize (self->widget);
@@ -740,8 +797,13 @@ gtk_list_item_manager_model_selection_changed_cb (GListModel         *model,
                                                   GtkListItemManager *self)
 {
   GtkListItemManagerItem *item;
+  GtkBitset *changes;
   guint offset;
 
+  /* If the model told us exactly what changed, only rows in there
+   * need updating, no matter how far apart they are. */
+  changes = gtk_selection_model_get_exact_changes (GTK_SELECTION_MODEL (model));
+
   item = gtk_list_item_manager_get_nth (self, position, &offset);
 
   if (offset)
@@ -756,7 +818,8 @@ gtk_list_item_manager_model_selection_changed_cb (GListModel         *model,
 
   while (n_items > 0)
     {
-      if (item->widget)
+      if (item->widget &&
+          (changes == NULL || gtk_bitset_contains (changes, position)))
         gtk_list_item_manager_update_list_item (self, item->widget, position);
       position += item->n_items;
       n_items -= MIN (n_items, item->n_items);
@@ -792,9 +855,19 @@ gtk_list_item_manager_dispose (GObject *object)
 {
   GtkListItemManager *self = GTK_LIST_ITEM_MANAGER (object);
 
+  if (self->deferred_bind_id)
+    {
+      gtk_widget_remove_tick_callback (self->widget, self->deferred_bind_id);
+      self->deferred_bind_id = 0;
+    }
+
   gtk_list_item_manager_clear_model (self);
 
-  g_clear_object (&self->factory);
+  if (self->factory)
+    {
+      gtk_list_item_factory_remove_user (self->factory);
+      g_clear_object (&self->factory);
+    }
 
   g_clear_pointer (&self->items, gtk_rb_tree_unref);
 
@@ -830,7 +903,11 @@ gtk_list_item_manager_set_factory (GtkListItemManager *self,
   n_items = self->model ? g_list_model_get_n_items (G_LIST_MODEL (self->model)) : 0;
   gtk_list_item_manager_remove_items (self, NULL, 0, n_items);
 
+  if (self->factory)
+    gtk_list_item_factory_remove_user (self->factory);
   g_set_object (&self->factory, factory);
+  if (factory)
+    gtk_list_item_factory_add_user (factory);
 
   gtk_list_item_manager_add_items (self, 0, n_items);
 
@@ -895,6 +972,221 @@ gtk_list_item_manager_get_model (GtkListItemManager *self)
   return self->model;
 }
 
+static gboolean
+gtk_list_item_manager_has_bind_budget (GtkListItemManager *self)
+{
+  GdkFrameClock *clock;
+  gint64 frame;
+
+  clock = gtk_widget_get_frame_clock (self->widget);
+  if (clock == NULL)
+    return TRUE;
+
+  frame = gdk_frame_clock_get_frame_counter (clock);
+  if (frame != self->bind_frame)
+    {
+      self->bind_frame = frame;
+      self->bind_time = 0;
+    }
+
+  return self->bind_time < GTK_LIST_ITEM_MANAGER_BIND_BUDGET;
+}
+
+static gboolean
+gtk_list_item_manager_is_tracked_position (GtkListItemManager *self,
+                                           guint               position)
+{
+  GSList *l;
+
+  for (l = self->trackers; l; l = l->next)
+    {
+      GtkListItemTracker *tracker = l->data;
+
+      if (tracker->position == position)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_list_item_manager_do_bind_list_item (GtkListItemManager *self,
+                                         GtkWidget          *widget,
+                                         guint               position,
+                                         gboolean            selected)
+{
+  gpointer item;
+  gint64 before, after;
+
+  before = g_get_monotonic_time ();
+
+  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (widget), position, item, selected);
+  g_object_unref (item);
+
+  after = g_get_monotonic_time ();
+  self->bind_time += after - before;
+
+  if (GDK_PROFILER_IS_RUNNING)
+    gdk_profiler_add_markf (before * 1000, (after - before) * 1000, "list item bind", "%u", position);
+}
+
+static guint
+gtk_list_item_manager_get_tracker_distance (GtkListItemManager *self,
+                                            guint               position)
+{
+  guint distance = G_MAXUINT;
+  GSList *l;
+
+  for (l = self->trackers; l; l = l->next)
+    {
+      GtkListItemTracker *tracker = l->data;
+
+      if (tracker->position == GTK_INVALID_LIST_POSITION)
+        continue;
+
+      if (tracker->position > position)
+        distance = MIN (distance, tracker->position - position);
+      else
+        distance = MIN (distance, position - tracker->position);
+    }
+
+  return distance;
+}
+
+typedef struct
+{
+  GtkWidget *widget;
+  guint position;
+  guint distance;
+} DeferredBind;
+
+static int
+compare_deferred_binds (gconstpointer a,
+                        gconstpointer b)
+{
+  const DeferredBind *da = a;
+  const DeferredBind *db = b;
+
+  if (da->distance != db->distance)
+    return da->distance < db->distance ? -1 : 1;
+
+  return da->position < db->position ? -1 : (da->position > db->position ? 1 : 0);
+}
+
+static gboolean
+gtk_list_item_manager_deferred_bind_cb (GtkWidget     *widget,
+                                        GdkFrameClock *clock,
+                                        gpointer       data)
+{
+  GtkListItemManager *self = data;
+  GtkListItemManagerItem *item;
+  GArray *pending;
+  guint i, position, n_model_changes;
+
+  if (!gtk_list_item_manager_has_bind_budget (self))
+    return G_SOURCE_CONTINUE;
+
+  /* Collect the placeholders once per frame, sorted so that the ones
+   * closest to what the user looks at are bound first.
+   */
+  pending = g_array_new (FALSE, FALSE, sizeof (DeferredBind));
+  position = 0;
+  for (item = gtk_rb_tree_get_first (self->items);
+       item != NULL;
+       item = gtk_rb_tree_node_get_next (item))
+    {
+      if (item->widget &&
+          gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (item->widget)) == NULL)
+        {
+          DeferredBind bind = {
+            g_object_ref (item->widget),
+            position,
+            gtk_list_item_manager_get_tracker_distance (self, position)
+          };
+
+          g_array_append_val (pending, bind);
+        }
+
+      position += item->n_items;
+    }
+
+  if (pending->len == 0)
+    {
+      g_array_unref (pending);
+      self->deferred_bind_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  g_array_sort (pending, compare_deferred_binds);
+
+  /* Bound rows usually have a different size than placeholders */
+  gtk_widget_queue_resize (self->widget);
+
+  n_model_changes = self->n_model_changes;
+  for (i = 0; i < pending->len && gtk_list_item_manager_has_bind_budget (self); i++)
+    {
+      DeferredBind *bind = &g_array_index (pending, DeferredBind, i);
+
+      /* Binding runs application code, which may change the model */
+      if (self->n_model_changes != n_model_changes)
+        break;
+
+      if (gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (bind->widget)) != NULL)
+        continue;
+
+      gtk_list_item_manager_do_bind_list_item (self,
+                                               bind->widget,
+                                               bind->position,
+                                               gtk_list_item_widget_get_selected (GTK_LIST_ITEM_WIDGET (bind->widget)));
+    }
+
+  for (i = 0; i < pending->len; i++)
+    g_object_unref (g_array_index (pending, DeferredBind, i).widget);
+  g_array_unref (pending);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/*
+ * gtk_list_item_manager_bind_list_item:
+ * @self: a #GtkListItemManager
+ * @widget: the list item widget to bind
+ * @position: the position to bind @widget to
+ *
+ * Binds @widget to the item at @position.
+ *
+ * When binding is deferred and this frame's time for binding is used
+ * up, @widget is instead set to @position without an item, so that it
+ * shows up as an empty row. It gets bound in one of the next frames.
+ * Tracked positions are always bound right away.
+ */
+static void
+gtk_list_item_manager_bind_list_item (GtkListItemManager *self,
+                                      GtkWidget          *widget,
+                                      guint               position)
+{
+  gboolean selected;
+
+  selected = gtk_selection_model_is_selected (self->model, position);
+
+  if (self->defer_binding &&
+      !gtk_list_item_manager_is_tracked_position (self, position) &&
+      !gtk_list_item_manager_has_bind_budget (self))
+    {
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (widget), position, NULL, selected);
+
+      if (self->deferred_bind_id == 0)
+        self->deferred_bind_id = gtk_widget_add_tick_callback (self->widget,
+                                                               gtk_list_item_manager_deferred_bind_cb,
+                                                               self,
+                                                               NULL);
+      return;
+    }
+
+  gtk_list_item_manager_do_bind_list_item (self, widget, position, selected);
+}
+
 /*
  * gtk_list_item_manager_acquire_list_item:
  * @self: a #GtkListItemManager
@@ -919,22 +1211,27 @@ gtk_list_item_manager_acquire_list_item (GtkListItemManager *self,
                                          GtkWidget          *prev_sibling)
 {
   GtkWidget *result;
-  gpointer item;
-  gboolean selected;
 
   g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), NULL);
   g_return_val_if_fail (prev_sibling == NULL || GTK_IS_WIDGET (prev_sibling), NULL);
 
-  result = gtk_list_item_widget_new (self->factory,
-                                     self->item_css_name,
-                                     self->item_role);
+  if (self->factory)
+    result = (GtkWidget *) gtk_list_item_factory_reuse_widget (self->factory,
+                                                               self->item_css_name,
+                                                               self->item_role);
+  else
+    result = NULL;
+
+  if (result == NULL)
+    result = gtk_list_item_widget_new (self->factory,
+                                       self->item_css_name,
+                                       self->item_role);
+  else
+    g_object_force_floating (G_OBJECT (result));
 
   gtk_list_item_widget_set_single_click_activate (GTK_LIST_ITEM_WIDGET (result), self->single_click_activate);
 
-  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
-  selected = gtk_selection_model_is_selected (self->model, position);
-  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (result), position, item, selected);
-  g_object_unref (item);
+  gtk_list_item_manager_bind_list_item (self, result, position);
   gtk_widget_insert_after (result, self->widget, prev_sibling);
 
   return GTK_WIDGET (result);
@@ -1008,17 +1305,8 @@ gtk_list_item_manager_move_list_item (GtkListItemManager     *self,
                                       guint                   position,
                                       GtkWidget              *prev_sibling)
 {
-  gpointer item;
-  gboolean selected;
-
-  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
-  selected = gtk_selection_model_is_selected (self->model, position);
-  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (list_item),
-                               position,
-                               item,
-                               selected);
+  gtk_list_item_manager_bind_list_item (self, list_item, position);
   gtk_widget_insert_after (list_item, _gtk_widget_get_parent (list_item), prev_sibling);
-  g_object_unref (item);
 }
 
 /**
@@ -1048,6 +1336,25 @@ gtk_list_item_manager_update_list_item (GtkListItemManager *self,
                                selected);
 }
 
+/*
+ * gtk_list_item_manager_recycle_list_item:
+ * @self: a #GtkListItemManager
+ * @widget: a list item widget that isn't needed anymore
+ *
+ * Hands @widget to the factory's pool, which unparents it and
+ * destroys it if the pool is full. Without a factory there is
+ * no pool, so @widget is just unparented.
+ */
+static void
+gtk_list_item_manager_recycle_list_item (GtkListItemManager *self,
+                                         GtkWidget          *widget)
+{
+  if (self->factory == NULL)
+    gtk_widget_unparent (widget);
+  else
+    gtk_list_item_factory_recycle_widget (self->factory, GTK_LIST_ITEM_WIDGET (widget));
+}
+
 /*
  * gtk_list_item_manager_release_list_item:
  * @self: a #GtkListItemManager
@@ -1067,7 +1374,8 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
   g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
   g_return_if_fail (GTK_IS_LIST_ITEM_WIDGET (item));
 
-  if (change != NULL)
+  /* Placeholders have no item to find them by */
+  if (change != NULL && gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (item)) != NULL)
     {
       if (!g_hash_table_replace (change, gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (item)), item))
         {
@@ -1077,7 +1385,7 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
       return;
     }
 
-  gtk_widget_unparent (item);
+  gtk_list_item_manager_recycle_list_item (self, item);
 }
 
 void
@@ -1099,6 +1407,51 @@ gtk_list_item_manager_set_single_click_activate (GtkListItemManager *self,
     }
 }
 
+/*
+ * gtk_list_item_manager_set_keep_item_data:
+ * @self: a #GtkListItemManager
+ * @keep_item_data: %TRUE to keep the data of items
+ *
+ * Usually the data that widgets store in items after the
+ * #GtkListItemManagerItem is only valid for items with a widget,
+ * and items without one are merged freely.
+ *
+ * If @keep_item_data is set, that data describes all the positions in
+ * an item. Items are then only merged if their data is the same, items
+ * that are split keep a copy of the data, and new positions get new
+ * items with zeroed data.
+ */
+void
+gtk_list_item_manager_set_keep_item_data (GtkListItemManager *self,
+                                          gboolean            keep_item_data)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
+
+  self->keep_item_data = keep_item_data;
+}
+
+/*
+ * gtk_list_item_manager_set_defer_binding:
+ * @self: a #GtkListItemManager
+ * @defer_binding: %TRUE to defer binding
+ *
+ * Sets whether binding items may be deferred to later frames once
+ * binding took up a certain amount of time in the current frame.
+ * See gtk_list_item_manager_bind_list_item().
+ */
+void
+gtk_list_item_manager_set_defer_binding (GtkListItemManager *self,
+                                         gboolean            defer_binding)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
+
+  self->defer_binding = defer_binding;
+
+  /* Bind leftover placeholders */
+  if (!defer_binding)
+    gtk_list_item_manager_ensure_items (self, NULL, G_MAXUINT);
+}
+
 gboolean
 gtk_list_item_manager_get_single_click_activate (GtkListItemManager   *self)
 {
@@ -94,6 +94,11 @@ void                    gtk_list_item_manager_set_single_click_activate
                                                                  gboolean                single_click_activate);
 gboolean                gtk_list_item_manager_get_single_click_activate
                                                                 (GtkListItemManager     *self);
+void                    gtk_list_item_manager_set_keep_item_data
+                                                                (GtkListItemManager     *self,
+                                                                 gboolean                keep_item_data);
+void                    gtk_list_item_manager_set_defer_binding (GtkListItemManager     *self,
+                                                                 gboolean                defer_binding);
 
 GtkListItemTracker *    gtk_list_item_tracker_new               (GtkListItemManager     *self);
 void                    gtk_list_item_tracker_free              (GtkListItemManager     *self,
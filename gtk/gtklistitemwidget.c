@@ -44,6 +44,8 @@ struct _GtkListItemWidgetPrivate
   guint position;
   gboolean selected;
   gboolean single_click_activate;
+  /* Kept by the factory for reuse, so keep the list item too */
+  gboolean pooled;
 };
 
 enum {
@@ -148,7 +150,7 @@ gtk_list_item_widget_root (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_list_item_widget_parent_class)->root (widget);
 
-  if (priv->factory)
+  if (priv->factory && priv->list_item == NULL)
     gtk_list_item_factory_setup (priv->factory, self);
 }
 
@@ -160,7 +162,7 @@ gtk_list_item_widget_unroot (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_list_item_widget_parent_class)->unroot (widget);
 
-  if (priv->list_item)
+  if (priv->list_item && !priv->pooled)
       gtk_list_item_factory_teardown (priv->factory, self);
 }
 
@@ -194,7 +196,10 @@ gtk_list_item_widget_dispose (GObject *object)
   GtkListItemWidget *self = GTK_LIST_ITEM_WIDGET (object);
   GtkListItemWidgetPrivate *priv = gtk_list_item_widget_get_instance_private (self);
 
-  g_assert (priv->list_item == NULL);
+  g_assert (priv->list_item == NULL || priv->pooled);
+
+  if (priv->list_item)
+    gtk_list_item_factory_teardown (priv->factory, self);
 
   g_clear_object (&priv->item);
   g_clear_object (&priv->factory);
@@ -598,6 +603,18 @@ gtk_list_item_widget_set_factory (GtkListItemWidget  *self,
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FACTORY]);
 }
 
+/* Pooled widgets keep their list item when they get unrooted,
+ * so they don't need to be set up again when they are reused.
+ */
+void
+gtk_list_item_widget_set_pooled (GtkListItemWidget *self,
+                                 gboolean           pooled)
+{
+  GtkListItemWidgetPrivate *priv = gtk_list_item_widget_get_instance_private (self);
+
+  priv->pooled = pooled;
+}
+
 void
 gtk_list_item_widget_set_single_click_activate (GtkListItemWidget *self,
                                                 gboolean           single_click_activate)
@@ -0,0 +1,82 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtklistmodelbatchprivate.h"
+
+/*
+ * SECTION:gtklistmodelbatch
+ * @short_description: an interface for list models that can hand out
+ *                     many items at once
+ *
+ * Getting items one by one via g_list_model_get_item() means a
+ * vfunc call and usually a lookup for every item. That adds up for
+ * models that pass items through from other models when large ranges
+ * of items are needed, like when filtering or sorting.
+ *
+ * Models implementing this interface can instead look up the start
+ * of a range once and then hand out all of its items.
+ */
+
+G_DEFINE_INTERFACE (GtkListModelBatch, gtk_list_model_batch, G_TYPE_LIST_MODEL)
+
+static void
+gtk_list_model_batch_default_init (GtkListModelBatchInterface *iface)
+{
+}
+
+/*
+ * gtk_list_model_get_items:
+ * @model: a #GListModel
+ * @position: the position of the first item to get
+ * @n_items: the number of items to get
+ * @items: (out caller-allocates) (array length=n_items): array to
+ *     store the items in
+ *
+ * Stores references to the items from @position to @position + @n_items
+ * in @model in @items. Items past the end of @model are not stored.
+ *
+ * If @model does not implement #GtkListModelBatch, the items are
+ * queried one by one with g_list_model_get_item().
+ *
+ * Returns: the number of items stored in @items. The caller
+ *     owns a reference to each of them.
+ */
+guint
+gtk_list_model_get_items (GListModel *model,
+                          guint       position,
+                          guint       n_items,
+                          gpointer   *items)
+{
+  guint i;
+
+  g_return_val_if_fail (G_IS_LIST_MODEL (model), 0);
+
+  if (GTK_IS_LIST_MODEL_BATCH (model))
+    return GTK_LIST_MODEL_BATCH_GET_IFACE (model)->get_items (GTK_LIST_MODEL_BATCH (model),
+                                                              position,
+                                                              n_items,
+                                                              items);
+
+  for (i = 0; i < n_items; i++)
+    {
+      items[i] = g_list_model_get_item (model, position + i);
+      if (items[i] == NULL)
+        break;
+    }
+
+  return i;
+}
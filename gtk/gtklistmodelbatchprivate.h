@@ -0,0 +1,54 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_LIST_MODEL_BATCH_PRIVATE_H__
+#define __GTK_LIST_MODEL_BATCH_PRIVATE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_LIST_MODEL_BATCH                           (gtk_list_model_batch_get_type ())
+#define GTK_LIST_MODEL_BATCH(inst)                          (G_TYPE_CHECK_INSTANCE_CAST ((inst),                     \
+                                                             GTK_TYPE_LIST_MODEL_BATCH, GtkListModelBatch))
+#define GTK_IS_LIST_MODEL_BATCH(inst)                       (G_TYPE_CHECK_INSTANCE_TYPE ((inst),                     \
+                                                             GTK_TYPE_LIST_MODEL_BATCH))
+#define GTK_LIST_MODEL_BATCH_GET_IFACE(inst)                (G_TYPE_INSTANCE_GET_INTERFACE ((inst),                  \
+                                                             GTK_TYPE_LIST_MODEL_BATCH,                              \
+                                                             GtkListModelBatchInterface))
+
+typedef struct _GtkListModelBatch                           GtkListModelBatch;
+typedef struct _GtkListModelBatchInterface                  GtkListModelBatchInterface;
+
+struct _GtkListModelBatchInterface
+{
+  GTypeInterface g_iface;
+
+  guint (* get_items)          (GtkListModelBatch   *self,
+                                guint                position,
+                                guint                n_items,
+                                gpointer            *items);
+};
+
+GType                   gtk_list_model_batch_get_type                   (void);
+
+guint                   gtk_list_model_get_items                        (GListModel          *model,
+                                                                         guint                position,
+                                                                         guint                n_items,
+                                                                         gpointer            *items);
+
+G_END_DECLS
+
+#endif /* __GTK_LIST_MODEL_BATCH_PRIVATE_H__ */
@@ -149,6 +149,7 @@ struct _ListRow
 {
   GtkListItemManagerItem parent;
   guint height; /* per row */
+  guint height_cached; /* height was measured, see GtkListView:cache-row-heights */
 };
 
 struct _ListRowAugment
@@ -165,6 +166,9 @@ enum
   PROP_SHOW_SEPARATORS,
   PROP_SINGLE_CLICK_ACTIVATE,
   PROP_ENABLE_RUBBERBAND,
+  PROP_CACHE_ROW_HEIGHTS,
+  PROP_DEFER_BINDING,
+  PROP_FIXED_ROW_HEIGHT,
 
   N_PROPS
 };
@@ -230,6 +234,12 @@ list_row_augment (GtkRbTree *tree,
     }
 }
 
+static inline gboolean
+gtk_list_view_has_fixed_row_height (GtkListView *self)
+{
+  return self->fixed_row_height >= 0;
+}
+
 static ListRow *
 gtk_list_view_get_row_at_y (GtkListView *self,
                             int          y,
@@ -329,6 +339,26 @@ gtk_list_view_get_allocation_along (GtkListBase *base,
   guint skip;
   int y;
 
+  if (gtk_list_view_has_fixed_row_height (self))
+    {
+      /* All rows have the same height, no need to look at the tree */
+      if (pos >= gtk_list_base_get_n_items (base))
+        {
+          if (offset)
+            *offset = 0;
+          if (size)
+            *size = 0;
+          return FALSE;
+        }
+
+      if (offset)
+        *offset = pos * self->row_height;
+      if (size)
+        *size = self->row_height;
+
+      return TRUE;
+    }
+
   row = gtk_list_item_manager_get_nth (self->item_manager, pos, &skip);
   if (row == NULL)
     {
@@ -381,6 +411,17 @@ gtk_list_view_get_items_in_rect (GtkListBase                 *base,
   if (n_items == 0)
     return result;
 
+  if (gtk_list_view_has_fixed_row_height (self))
+    {
+      if (self->row_height <= 0)
+        return result;
+
+      first = MIN (MAX (rect->y, 0) / self->row_height, n_items - 1);
+      last = MIN (MAX (rect->y + rect->height, 0) / self->row_height, n_items - 1);
+      gtk_bitset_add_range_closed (result, first, last);
+      return result;
+    }
+
   row = gtk_list_view_get_row_at_y (self, rect->y, NULL);
   if (row)
     first = gtk_list_item_manager_get_item_position (self->item_manager, row);
@@ -425,6 +466,26 @@ gtk_list_view_get_position_from_allocation (GtkListBase           *base,
   if (across >= self->list_width)
     return FALSE;
 
+  if (gtk_list_view_has_fixed_row_height (self))
+    {
+      if (self->row_height <= 0 || along < 0)
+        return FALSE;
+
+      *pos = along / self->row_height;
+      if (*pos >= gtk_list_base_get_n_items (base))
+        return FALSE;
+
+      if (area)
+        {
+          area->x = 0;
+          area->width = self->list_width;
+          area->y = *pos * self->row_height;
+          area->height = self->row_height;
+        }
+
+      return TRUE;
+    }
+
   row = gtk_list_view_get_row_at_y (self, along, &remaining);
   if (row == NULL)
     return FALSE;
@@ -471,6 +532,19 @@ gtk_list_view_get_unknown_row_height (GtkListView *self,
   return g_array_index (heights, int, heights->len / 2);
 }
 
+static void
+gtk_list_view_clear_cached_row_heights (GtkListView *self)
+{
+  ListRow *row;
+
+  for (row = gtk_list_item_manager_get_first (self->item_manager);
+       row != NULL;
+       row = gtk_rb_tree_node_get_next (row))
+    {
+      row->height_cached = FALSE;
+    }
+}
+
 static void
 gtk_list_view_measure_across (GtkWidget      *widget,
                               GtkOrientation  orientation,
@@ -507,6 +581,44 @@ gtk_list_view_measure_across (GtkWidget      *widget,
   *natural = nat;
 }
 
+/* Measures the height all rows get when rows have a fixed height.
+ * If the height isn't given, it is measured from the first row that
+ * has a widget.
+ *
+ * Returns: %FALSE if the height is unknown, because no row has a widget
+ */
+static gboolean
+gtk_list_view_measure_fixed_row_height (GtkListView    *self,
+                                        GtkOrientation  orientation,
+                                        int             for_size,
+                                        int            *minimum,
+                                        int            *natural)
+{
+  ListRow *row;
+
+  if (self->fixed_row_height > 0)
+    {
+      *minimum = *natural = self->fixed_row_height;
+      return TRUE;
+    }
+
+  for (row = gtk_list_item_manager_get_first (self->item_manager);
+       row != NULL;
+       row = gtk_rb_tree_node_get_next (row))
+    {
+      if (row->parent.widget)
+        {
+          gtk_widget_measure (row->parent.widget,
+                              orientation, for_size,
+                              minimum, natural, NULL, NULL);
+          return TRUE;
+        }
+    }
+
+  *minimum = *natural = 0;
+  return FALSE;
+}
+
 static void
 gtk_list_view_measure_list (GtkWidget      *widget,
                             GtkOrientation  orientation,
@@ -520,6 +632,19 @@ gtk_list_view_measure_list (GtkWidget      *widget,
   GArray *min_heights, *nat_heights;
   guint n_unknown;
 
+  if (gtk_list_view_has_fixed_row_height (self))
+    {
+      guint n_items = gtk_list_base_get_n_items (GTK_LIST_BASE (self));
+
+      if (!gtk_list_view_measure_fixed_row_height (self, orientation, for_size, &min, &nat))
+        min = nat = self->row_height;
+
+      /* Huge models would overflow */
+      *minimum = MIN ((gint64) n_items * min, G_MAXINT);
+      *natural = MIN ((gint64) n_items * nat, G_MAXINT);
+      return;
+    }
+
   min_heights = g_array_new (FALSE, FALSE, sizeof (int));
   nat_heights = g_array_new (FALSE, FALSE, sizeof (int));
   n_unknown = 0;
@@ -540,6 +665,11 @@ gtk_list_view_measure_list (GtkWidget      *widget,
           min += child_min;
           nat += child_nat;
         }
+      else if (row->height_cached)
+        {
+          min += row->height * row->parent.n_items;
+          nat += row->height * row->parent.n_items;
+        }
       else
         {
           n_unknown += row->parent.n_items;
@@ -608,7 +738,53 @@ gtk_list_view_size_allocate (GtkWidget *widget,
   else
     self->list_width = MAX (nat, self->list_width);
 
+  if (gtk_list_view_has_fixed_row_height (self))
+    {
+      guint pos;
+
+      /* step 2: determine the height of all rows */
+      if (gtk_list_view_measure_fixed_row_height (self, orientation, self->list_width, &min, &nat))
+        self->row_height = scroll_policy == GTK_SCROLL_MINIMUM ? min : nat;
+
+      /* step 3: update the adjustments */
+      gtk_list_base_update_adjustments (GTK_LIST_BASE (self),
+                                        self->list_width,
+                                        MIN ((gint64) gtk_list_base_get_n_items (GTK_LIST_BASE (self)) * self->row_height, G_MAXINT),
+                                        gtk_widget_get_size (widget, opposite_orientation),
+                                        gtk_widget_get_size (widget, orientation),
+                                        &x, &y);
+
+      /* step 4: allocate the widgets */
+      pos = 0;
+      for (row = gtk_list_item_manager_get_first (self->item_manager);
+           row != NULL;
+           row = gtk_rb_tree_node_get_next (row))
+        {
+          if (row->parent.widget)
+            {
+              gtk_list_base_size_allocate_child (GTK_LIST_BASE (self),
+                                                 row->parent.widget,
+                                                 -x,
+                                                 (int) pos * self->row_height - y,
+                                                 self->list_width,
+                                                 self->row_height);
+            }
+
+          pos += row->parent.n_items;
+        }
+
+      gtk_list_base_allocate_rubberband (GTK_LIST_BASE (self));
+      return;
+    }
+
   /* step 2: determine height of known list items */
+  if (self->cache_row_heights && self->cached_width != self->list_width)
+    {
+      /* rows might have a different height at the new width */
+      gtk_list_view_clear_cached_row_heights (self);
+      self->cached_width = self->list_width;
+    }
+
   heights = g_array_new (FALSE, FALSE, sizeof (int));
 
   for (row = gtk_list_item_manager_get_first (self->item_manager);
@@ -616,7 +792,11 @@ gtk_list_view_size_allocate (GtkWidget *widget,
        row = gtk_rb_tree_node_get_next (row))
     {
       if (row->parent.widget == NULL)
-        continue;
+        {
+          if (row->height_cached)
+            g_array_append_val (heights, row->height);
+          continue;
+        }
 
       gtk_widget_measure (row->parent.widget, orientation,
                           self->list_width,
@@ -630,6 +810,7 @@ gtk_list_view_size_allocate (GtkWidget *widget,
           row->height = row_height;
           gtk_rb_tree_node_mark_dirty (row);
         }
+      row->height_cached = self->cache_row_heights;
       g_array_append_val (heights, row_height);
     }
 
@@ -641,7 +822,7 @@ gtk_list_view_size_allocate (GtkWidget *widget,
        row != NULL;
        row = gtk_rb_tree_node_get_next (row))
     {
-      if (row->parent.widget)
+      if (row->parent.widget || row->height_cached)
         continue;
 
       if (row->height != row_height)
@@ -723,6 +904,18 @@ gtk_list_view_get_property (GObject    *object,
       g_value_set_boolean (value, gtk_list_base_get_enable_rubberband (GTK_LIST_BASE (self)));
       break;
 
+    case PROP_CACHE_ROW_HEIGHTS:
+      g_value_set_boolean (value, self->cache_row_heights);
+      break;
+
+    case PROP_DEFER_BINDING:
+      g_value_set_boolean (value, self->defer_binding);
+      break;
+
+    case PROP_FIXED_ROW_HEIGHT:
+      g_value_set_int (value, self->fixed_row_height);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -759,6 +952,18 @@ gtk_list_view_set_property (GObject      *object,
       gtk_list_view_set_enable_rubberband (self, g_value_get_boolean (value));
       break;
 
+    case PROP_CACHE_ROW_HEIGHTS:
+      gtk_list_view_set_cache_row_heights (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_DEFER_BINDING:
+      gtk_list_view_set_defer_binding (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_FIXED_ROW_HEIGHT:
+      gtk_list_view_set_fixed_row_height (self, g_value_get_int (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -869,6 +1074,43 @@ gtk_list_view_class_init (GtkListViewClass *klass)
                           FALSE,
                           G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkListView:cache-row-heights:
+   *
+   * Remember the height of rows that have been measured
+   */
+  properties[PROP_CACHE_ROW_HEIGHTS] =
+    g_param_spec_boolean ("cache-row-heights",
+                          P_("Cache row heights"),
+                          P_("Remember the height of rows that have been measured"),
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * GtkListView:defer-binding:
+   *
+   * Spread binding newly visible rows over multiple frames
+   */
+  properties[PROP_DEFER_BINDING] =
+    g_param_spec_boolean ("defer-binding",
+                          P_("Defer binding"),
+                          P_("Spread binding newly visible rows over multiple frames"),
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * GtkListView:fixed-row-height:
+   *
+   * The height of all rows, 0 to use the height of the first row or
+   * -1 to measure every row
+   */
+  properties[PROP_FIXED_ROW_HEIGHT] =
+    g_param_spec_int ("fixed-row-height",
+                      P_("Fixed row height"),
+                      P_("The height of all rows, 0 to use the height of the first row or -1 to measure every row"),
+                      -1, G_MAXINT, -1,
+                      G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 
   /**
@@ -915,6 +1157,7 @@ static void
 gtk_list_view_init (GtkListView *self)
 {
   self->item_manager = gtk_list_base_get_manager (GTK_LIST_BASE (self));
+  self->fixed_row_height = -1;
 
   gtk_list_base_set_anchor_max_widgets (GTK_LIST_BASE (self),
                                         GTK_LIST_VIEW_MAX_LIST_ITEMS,
@@ -1158,3 +1401,176 @@ gtk_list_view_get_enable_rubberband (GtkListView *self)
 
   return gtk_list_base_get_enable_rubberband (GTK_LIST_BASE (self));
 }
+
+/**
+ * gtk_list_view_set_cache_row_heights:
+ * @self: a #GtkListView
+ * @cache_row_heights: %TRUE to remember the height of rows
+ *
+ * Sets whether the list view remembers the height of rows
+ * after it has measured them.
+ *
+ * Usually, only rows that currently have a widget are measured and
+ * the height of all other rows is estimated from them. When rows have
+ * very different heights, this makes the scrollbar and scrolling to
+ * far away rows imprecise.
+ *
+ * With this enabled, rows keep their height when their widget gets
+ * reused for another row, so every row that has been displayed once
+ * is positioned exactly. Only the remaining rows are estimated.
+ * The remembered heights are forgotten when the width of the
+ * list view changes or when the items they belong to are removed.
+ *
+ * This costs some memory for every row whose height differs from
+ * the height of its neighbors.
+ */
+void
+gtk_list_view_set_cache_row_heights (GtkListView *self,
+                                     gboolean     cache_row_heights)
+{
+  g_return_if_fail (GTK_IS_LIST_VIEW (self));
+
+  if (self->cache_row_heights == cache_row_heights)
+    return;
+
+  self->cache_row_heights = cache_row_heights;
+  self->cached_width = -1;
+
+  gtk_list_view_clear_cached_row_heights (self);
+  gtk_list_item_manager_set_keep_item_data (self->item_manager, cache_row_heights);
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CACHE_ROW_HEIGHTS]);
+}
+
+/**
+ * gtk_list_view_get_cache_row_heights:
+ * @self: a #GtkListView
+ *
+ * Returns whether the list view remembers the height of rows.
+ * See gtk_list_view_set_cache_row_heights().
+ *
+ * Returns: %TRUE if row heights are remembered
+ */
+gboolean
+gtk_list_view_get_cache_row_heights (GtkListView *self)
+{
+  g_return_val_if_fail (GTK_IS_LIST_VIEW (self), FALSE);
+
+  return self->cache_row_heights;
+}
+
+/**
+ * gtk_list_view_set_defer_binding:
+ * @self: a #GtkListView
+ * @defer_binding: %TRUE to spread binding rows over multiple frames
+ *
+ * Sets whether the list view may delay binding rows to their items.
+ *
+ * Usually, all rows that become visible are bound right away. When
+ * binding is expensive, scrolling far or resizing the list view can
+ * make a single frame take a long time.
+ *
+ * With this enabled, the list view stops binding rows once it spent
+ * a few milliseconds on it in the current frame. The remaining rows
+ * are shown without an item until they get bound in one of the next
+ * frames, starting with the ones closest to the focused and selected
+ * rows and the scroll position. Those rows themselves are always
+ * bound right away.
+ *
+ * Factories used with this should cope with list items whose
+ * #GtkListItem:item is %NULL.
+ */
+void
+gtk_list_view_set_defer_binding (GtkListView *self,
+                                 gboolean     defer_binding)
+{
+  g_return_if_fail (GTK_IS_LIST_VIEW (self));
+
+  if (self->defer_binding == defer_binding)
+    return;
+
+  self->defer_binding = defer_binding;
+
+  gtk_list_item_manager_set_defer_binding (self->item_manager, defer_binding);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFER_BINDING]);
+}
+
+/**
+ * gtk_list_view_get_defer_binding:
+ * @self: a #GtkListView
+ *
+ * Returns whether the list view may delay binding rows.
+ * See gtk_list_view_set_defer_binding().
+ *
+ * Returns: %TRUE if binding rows may be deferred
+ */
+gboolean
+gtk_list_view_get_defer_binding (GtkListView *self)
+{
+  g_return_val_if_fail (GTK_IS_LIST_VIEW (self), FALSE);
+
+  return self->defer_binding;
+}
+
+/**
+ * gtk_list_view_set_fixed_row_height:
+ * @self: a #GtkListView
+ * @fixed_row_height: the height of all rows, 0 to use the height
+ *   of the first row, or -1 to measure every row
+ *
+ * Sets whether all rows of the list view have the same height.
+ *
+ * Usually, the list view measures every row that has a widget and
+ * estimates the height of the others. For lists with a lot of rows
+ * that are known to be the same height, this is wasted effort.
+ *
+ * If @fixed_row_height is positive, all rows get that height and no
+ * row is measured along the list. If it is 0, the list view measures
+ * the first row that has a widget and gives all rows its height.
+ *
+ * Either way, finding the position of a row or the row at a position
+ * no longer depends on the number of rows, so scrolling to far away
+ * rows and dragging the scrollbar stay fast for huge lists.
+ *
+ * Rows that would be taller than the fixed height are cut off.
+ *
+ * By default, every row is measured, which corresponds to -1.
+ */
+void
+gtk_list_view_set_fixed_row_height (GtkListView *self,
+                                    int          fixed_row_height)
+{
+  g_return_if_fail (GTK_IS_LIST_VIEW (self));
+  g_return_if_fail (fixed_row_height >= -1);
+
+  if (self->fixed_row_height == fixed_row_height)
+    return;
+
+  self->fixed_row_height = fixed_row_height;
+  self->row_height = MAX (fixed_row_height, 0);
+
+  /* heights measured while rows had a fixed height are bogus */
+  gtk_list_view_clear_cached_row_heights (self);
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FIXED_ROW_HEIGHT]);
+}
+
+/**
+ * gtk_list_view_get_fixed_row_height:
+ * @self: a #GtkListView
+ *
+ * Returns the value set via gtk_list_view_set_fixed_row_height().
+ *
+ * Returns: the fixed height of rows, 0 if it is measured from the
+ *   first row or -1 if every row is measured
+ */
+int
+gtk_list_view_get_fixed_row_height (GtkListView *self)
+{
+  g_return_val_if_fail (GTK_IS_LIST_VIEW (self), -1);
+
+  return self->fixed_row_height;
+}
@@ -81,6 +81,24 @@ void            gtk_list_view_set_enable_rubberband             (GtkListView
 GDK_AVAILABLE_IN_ALL
 gboolean        gtk_list_view_get_enable_rubberband             (GtkListView            *self);
 
+GDK_AVAILABLE_IN_ALL
+void            gtk_list_view_set_cache_row_heights             (GtkListView            *self,
+                                                                 gboolean                cache_row_heights);
+GDK_AVAILABLE_IN_ALL
+gboolean        gtk_list_view_get_cache_row_heights             (GtkListView            *self);
+
+GDK_AVAILABLE_IN_ALL
+void            gtk_list_view_set_defer_binding                 (GtkListView            *self,
+                                                                 gboolean                defer_binding);
+GDK_AVAILABLE_IN_ALL
+gboolean        gtk_list_view_get_defer_binding                 (GtkListView            *self);
+
+GDK_AVAILABLE_IN_ALL
+void            gtk_list_view_set_fixed_row_height              (GtkListView            *self,
+                                                                 int                     fixed_row_height);
+GDK_AVAILABLE_IN_ALL
+int             gtk_list_view_get_fixed_row_height              (GtkListView            *self);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListView, g_object_unref)
 
 G_END_DECLS
@@ -31,8 +31,17 @@ struct _GtkListView
 
   GtkListItemManager *item_manager;
   gboolean show_separators;
+  gboolean cache_row_heights;
+  gboolean defer_binding;
 
   int list_width;
+  /* list_width the cached row heights were measured at */
+  int cached_width;
+
+  /* -1 if rows are measured individually, see GtkListView:fixed-row-height */
+  int fixed_row_height;
+  /* height of all rows if fixed_row_height >= 0 */
+  int row_height;
 };
 
 struct _GtkListViewClass
@@ -23,6 +23,7 @@
 
 #include "gtkrbtreeprivate.h"
 #include "gtkintl.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -157,6 +158,36 @@ gtk_map_list_model_get_n_items (GListModel *list)
   return g_list_model_get_n_items (self->model);
 }
 
+/* Splits @node, which starts at @offset, so that @position gets a
+ * node of its own and stores the mapped @item in it.
+ */
+static void
+gtk_map_list_model_map_item (GtkMapListModel *self,
+                             MapNode         *node,
+                             guint            offset,
+                             guint            position,
+                             gpointer         item)
+{
+  if (offset != position)
+    {
+      MapNode *before = gtk_rb_tree_insert_before (self->items, node);
+      before->n_items = position - offset;
+      node->n_items -= before->n_items;
+      gtk_rb_tree_node_mark_dirty (node);
+    }
+
+  if (node->n_items > 1)
+    {
+      MapNode *after = gtk_rb_tree_insert_after (self->items, node);
+      after->n_items = node->n_items - 1;
+      node->n_items = 1;
+      gtk_rb_tree_node_mark_dirty (node);
+    }
+
+  node->item = self->map_func (item, self->user_data);
+  g_object_add_weak_pointer (node->item, &node->item);
+}
+
 static gpointer
 gtk_map_list_model_get_item (GListModel *list,
                              guint       position)
@@ -178,24 +209,8 @@ gtk_map_list_model_get_item (GListModel *list,
   if (node->item)
     return g_object_ref (node->item);
 
-  if (offset != position)
-    {
-      MapNode *before = gtk_rb_tree_insert_before (self->items, node);
-      before->n_items = position - offset;
-      node->n_items -= before->n_items;
-      gtk_rb_tree_node_mark_dirty (node);
-    }
-
-  if (node->n_items > 1)
-    {
-      MapNode *after = gtk_rb_tree_insert_after (self->items, node);
-      after->n_items = node->n_items - 1;
-      node->n_items = 1;
-      gtk_rb_tree_node_mark_dirty (node);
-    }
-
-  node->item = self->map_func (g_list_model_get_item (self->model, position), self->user_data);
-  g_object_add_weak_pointer (node->item, &node->item);
+  gtk_map_list_model_map_item (self, node, offset, position,
+                               g_list_model_get_item (self->model, position));
 
   return node->item;
 }
@@ -208,8 +223,70 @@ gtk_map_list_model_model_init (GListModelInterface *iface)
   iface->get_item = gtk_map_list_model_get_item;
 }
 
+static guint
+gtk_map_list_model_get_items (GtkListModelBatch *batch,
+                              guint              position,
+                              guint              n_items,
+                              gpointer          *items)
+{
+  GtkMapListModel *self = GTK_MAP_LIST_MODEL (batch);
+  MapNode *node;
+  guint offset, i;
+
+  if (self->model == NULL)
+    return 0;
+
+  if (self->items == NULL)
+    return gtk_list_model_get_items (self->model, position, n_items, items);
+
+  node = gtk_map_list_model_get_nth (self->items, position, &offset);
+  for (i = 0; i < n_items && node != NULL; node = gtk_rb_tree_node_get_next (node))
+    {
+      if (node->item)
+        {
+          items[i++] = g_object_ref (node->item);
+        }
+      else
+        {
+          guint start, n, j;
+
+          /* Get all the items of this node from the model at once,
+           * then map them one by one.
+           */
+          start = position + i;
+          n = MIN (offset + node->n_items - start, n_items - i);
+          n = gtk_list_model_get_items (self->model, start, n, items + i);
+          if (n == 0)
+            break;
+
+          for (j = 0; j < n; j++)
+            {
+              if (j > 0)
+                {
+                  node = gtk_rb_tree_node_get_next (node);
+                  offset = start + j;
+                }
+              gtk_map_list_model_map_item (self, node, offset, start + j, items[i + j]);
+              items[i + j] = node->item;
+            }
+          i += n;
+        }
+
+      offset = position + i;
+    }
+
+  return i;
+}
+
+static void
+gtk_map_list_model_batch_init (GtkListModelBatchInterface *iface)
+{
+  iface->get_items = gtk_map_list_model_get_items;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkMapListModel, gtk_map_list_model, G_TYPE_OBJECT,
-                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_map_list_model_model_init))
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_map_list_model_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_LIST_MODEL_BATCH, gtk_map_list_model_batch_init))
 
 static void
 gtk_map_list_model_items_changed_cb (GListModel      *model,
@@ -22,8 +22,9 @@
 #include "gtkmultiselection.h"
 
 #include "gtkbitset.h"
+#include "gtkfilter.h"
 #include "gtkintl.h"
-#include "gtkselectionmodel.h"
+#include "gtkselectionmodelprivate.h"
 
 /**
  * SECTION:gtkmultiselection
@@ -33,6 +34,10 @@
  *
  * GtkMultiSelection is an implementation of the #GtkSelectionModel interface
  * that allows selecting multiple elements.
+ *
+ * Besides the functions of the #GtkSelectionModel interface, it provides
+ * gtk_multi_selection_invert() and gtk_multi_selection_select_matching()
+ * to change large selections in one go.
  */
 
 struct _GtkMultiSelection
@@ -165,7 +170,7 @@ gtk_multi_selection_set_selection (GtkSelectionModel *model,
 {
   GtkMultiSelection *self = GTK_MULTI_SELECTION (model);
   GtkBitset *changes;
-  guint min, max, n_items;
+  guint max, n_items;
 
   /* changes = (self->selected XOR selected) AND mask
    * But doing it this way avoids looking at all values outside the mask
@@ -174,24 +179,22 @@ gtk_multi_selection_set_selection (GtkSelectionModel *model,
   gtk_bitset_difference (changes, self->selected);
   gtk_bitset_intersect (changes, mask);
 
-  min = gtk_bitset_get_minimum (changes);
-  max = gtk_bitset_get_maximum (changes);
-
   /* sanity check */
+  max = gtk_bitset_get_maximum (changes);
   n_items = self->model ? g_list_model_get_n_items (self->model) : 0;
-  if (max >= n_items)
-    {
-      gtk_bitset_remove_range_closed (changes, n_items, max);
-      max = gtk_bitset_get_maximum (changes);
-    }
+  if (!gtk_bitset_is_empty (changes) && max >= n_items)
+    gtk_bitset_remove_range_closed (changes, n_items, max);
 
   /* actually do the change */
   gtk_multi_selection_toggle_selection (self, changes);
 
-  gtk_bitset_unref (changes);
+  /* Changes can be far apart, like when shift-clicking after selecting
+   * everything, so tell list widgets exactly which items changed instead
+   * of making them look at every item in between.
+   */
+  gtk_selection_model_selection_changed_exact (model, changes);
 
-  if (min <= max)
-    gtk_selection_model_selection_changed (model, min, max - min + 1);
+  gtk_bitset_unref (changes);
 
   return TRUE;
 }
@@ -454,3 +457,97 @@ gtk_multi_selection_set_model (GtkMultiSelection *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
+
+/**
+ * gtk_multi_selection_invert:
+ * @self: a #GtkMultiSelection
+ *
+ * Selects all unselected items and unselects all selected items.
+ **/
+void
+gtk_multi_selection_invert (GtkMultiSelection *self)
+{
+  GtkBitset *selected, *mask;
+  guint n_items;
+
+  g_return_if_fail (GTK_IS_MULTI_SELECTION (self));
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self));
+  if (n_items == 0)
+    return;
+
+  mask = gtk_bitset_new_range (0, n_items);
+  selected = gtk_bitset_copy (mask);
+  gtk_bitset_subtract (selected, self->selected);
+
+  gtk_selection_model_set_selection (GTK_SELECTION_MODEL (self), selected, mask);
+
+  gtk_bitset_unref (selected);
+  gtk_bitset_unref (mask);
+}
+
+/**
+ * gtk_multi_selection_select_matching:
+ * @self: a #GtkMultiSelection
+ * @filter: the #GtkFilter to match items with
+ * @unselect_rest: whether previously selected items that don't match
+ *     should be unselected
+ *
+ * Selects all items that match @filter.
+ *
+ * If @filter matches all or no items according to
+ * gtk_filter_get_strictness(), the items are not looked at.
+ **/
+void
+gtk_multi_selection_select_matching (GtkMultiSelection *self,
+                                     GtkFilter         *filter,
+                                     gboolean           unselect_rest)
+{
+  GtkBitset *selected, *mask;
+  guint i, n_items;
+
+  g_return_if_fail (GTK_IS_MULTI_SELECTION (self));
+  g_return_if_fail (GTK_IS_FILTER (filter));
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self));
+  if (n_items == 0)
+    return;
+
+  switch (gtk_filter_get_strictness (filter))
+    {
+    case GTK_FILTER_MATCH_NONE:
+      selected = gtk_bitset_new_empty ();
+      break;
+
+    case GTK_FILTER_MATCH_ALL:
+      selected = gtk_bitset_new_range (0, n_items);
+      break;
+
+    case GTK_FILTER_MATCH_SOME:
+      selected = gtk_bitset_new_empty ();
+      for (i = 0; i < n_items; i++)
+        {
+          gpointer item = g_list_model_get_item (self->model, i);
+
+          if (gtk_filter_match (filter, item))
+            gtk_bitset_add (selected, i);
+
+          g_object_unref (item);
+        }
+      break;
+
+    default:
+      g_assert_not_reached ();
+      return;
+    }
+
+  if (unselect_rest)
+    mask = gtk_bitset_new_range (0, n_items);
+  else
+    mask = gtk_bitset_ref (selected);
+
+  gtk_selection_model_set_selection (GTK_SELECTION_MODEL (self), selected, mask);
+
+  gtk_bitset_unref (selected);
+  gtk_bitset_unref (mask);
+}
@@ -21,6 +21,7 @@
 #define __GTK_MULTI_SELECTION_H__
 
 #include <gtk/gtktypes.h>
+#include <gtk/gtkfilter.h>
 #include <gtk/gtkselectionmodel.h>
 
 G_BEGIN_DECLS
@@ -39,6 +40,13 @@ GDK_AVAILABLE_IN_ALL
 void                gtk_multi_selection_set_model          (GtkMultiSelection    *self,
                                                             GListModel           *model);
 
+GDK_AVAILABLE_IN_ALL
+void                gtk_multi_selection_invert             (GtkMultiSelection    *self);
+GDK_AVAILABLE_IN_ALL
+void                gtk_multi_selection_select_matching    (GtkMultiSelection    *self,
+                                                            GtkFilter            *filter,
+                                                            gboolean              unselect_rest);
+
 G_END_DECLS
 
 #endif /* __GTK_MULTI_SELECTION_H__ */
@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkselectionmodel.h"
+#include "gtkselectionmodelprivate.h"
 
 #include "gtkbitset.h"
 #include "gtkintl.h"
@@ -75,6 +75,7 @@ enum {
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
+static GQuark exact_changes_quark;
 
 static gboolean
 gtk_selection_model_default_is_selected (GtkSelectionModel *model,
@@ -242,6 +243,8 @@ gtk_selection_model_default_init (GtkSelectionModelInterface *iface)
   iface->unselect_all = gtk_selection_model_default_unselect_all;
   iface->set_selection = gtk_selection_model_default_set_selection;
 
+  exact_changes_quark = g_quark_from_static_string ("gtk-selection-model-exact-changes");
+
   /**
    * GtkSelectionModel::selection-changed
    * @model: a #GtkSelectionModel
@@ -537,6 +540,25 @@ gtk_selection_model_set_selection (GtkSelectionModel *model,
   return iface->set_selection (model, selected, mask);
 }
 
+static void
+gtk_selection_model_emit_selection_changed (GtkSelectionModel *model,
+                                            guint              position,
+                                            guint              n_items,
+                                            GtkBitset         *changes)
+{
+  GtkBitset *outer;
+
+  /* Nested emissions must not see the changes of the outer one,
+   * so this is set for every emission and restored afterwards.
+   */
+  outer = g_object_steal_qdata (G_OBJECT (model), exact_changes_quark);
+  g_object_set_qdata (G_OBJECT (model), exact_changes_quark, changes);
+
+  g_signal_emit (model, signals[SELECTION_CHANGED], 0, position, n_items);
+
+  g_object_set_qdata (G_OBJECT (model), exact_changes_quark, outer);
+}
+
 /**
  * gtk_selection_model_selection_changed:
  * @model: a #GtkSelectionModel
@@ -556,6 +578,55 @@ gtk_selection_model_selection_changed (GtkSelectionModel *model,
   g_return_if_fail (n_items > 0);
   g_return_if_fail (position + n_items <= g_list_model_get_n_items (G_LIST_MODEL (model)));
 
-  g_signal_emit (model, signals[SELECTION_CHANGED], 0, position, n_items);
+  gtk_selection_model_emit_selection_changed (model, position, n_items, NULL);
+}
+
+/*
+ * gtk_selection_model_selection_changed_exact:
+ * @model: a #GtkSelectionModel
+ * @changes: the items whose selection state changed
+ *
+ * Like gtk_selection_model_selection_changed(), but for implementations
+ * that know exactly which items changed. The signal is emitted for the
+ * range spanning @changes as usual, and handlers inside GTK can use
+ * gtk_selection_model_get_exact_changes() to only look at the items
+ * that actually changed.
+ */
+void
+gtk_selection_model_selection_changed_exact (GtkSelectionModel *model,
+                                             GtkBitset         *changes)
+{
+  guint min, max;
+
+  g_return_if_fail (GTK_IS_SELECTION_MODEL (model));
+  g_return_if_fail (changes != NULL);
+
+  if (gtk_bitset_is_empty (changes))
+    return;
+
+  min = gtk_bitset_get_minimum (changes);
+  max = gtk_bitset_get_maximum (changes);
+  g_return_if_fail (max < g_list_model_get_n_items (G_LIST_MODEL (model)));
+
+  gtk_selection_model_emit_selection_changed (model, min, max - min + 1, changes);
+}
+
+/*
+ * gtk_selection_model_get_exact_changes:
+ * @model: a #GtkSelectionModel
+ *
+ * Returns the exact set of changed items while a
+ * #GtkSelectionModel::selection-changed signal emitted via
+ * gtk_selection_model_selection_changed_exact() is running.
+ *
+ * Returns: (transfer none) (nullable): the changed items or %NULL if
+ *     every item in the signalled range has to be assumed changed
+ */
+GtkBitset *
+gtk_selection_model_get_exact_changes (GtkSelectionModel *model)
+{
+  g_return_val_if_fail (GTK_IS_SELECTION_MODEL (model), NULL);
+
+  return g_object_get_qdata (G_OBJECT (model), exact_changes_quark);
 }
 
@@ -95,6 +95,15 @@ struct _GtkShortcutController
   guint custom_shortcuts : 1;
 
   guint last_activated;
+
+  /* Index of the shortcuts by the keyvals that can trigger them,
+   * created on demand.
+   * normalized keyval => GArray of positions in shortcuts
+   * Shortcuts with triggers we can't index are stored under 0.
+   */
+  GHashTable *index;
+  /* position => item, so we know what was removed */
+  GPtrArray *indexed_items;
 };
 
 struct _GtkShortcutControllerClass
@@ -113,6 +122,299 @@ enum {
 
 static GParamSpec *properties[N_PROPS] = { NULL, };
 
+static guint
+normalize_keyval (guint keyval)
+{
+  if (keyval == GDK_KEY_ISO_Left_Tab)
+    return GDK_KEY_Tab;
+
+  return gdk_keyval_to_lower (keyval);
+}
+
+/* Collects the keyvals of key presses that can activate @trigger.
+ * Returns %FALSE if that isn't known.
+ */
+static gboolean
+collect_trigger_keyvals (GtkShortcutTrigger *trigger,
+                         GArray             *keyvals)
+{
+  guint keyval;
+
+  if (trigger == NULL || GTK_IS_NEVER_TRIGGER (trigger))
+    return TRUE;
+
+  if (GTK_IS_KEYVAL_TRIGGER (trigger))
+    {
+      keyval = normalize_keyval (gtk_keyval_trigger_get_keyval (GTK_KEYVAL_TRIGGER (trigger)));
+      g_array_append_val (keyvals, keyval);
+      return TRUE;
+    }
+
+  if (GTK_IS_MNEMONIC_TRIGGER (trigger))
+    {
+      keyval = normalize_keyval (gtk_mnemonic_trigger_get_keyval (GTK_MNEMONIC_TRIGGER (trigger)));
+      g_array_append_val (keyvals, keyval);
+      return TRUE;
+    }
+
+  if (GTK_IS_ALTERNATIVE_TRIGGER (trigger))
+    {
+      GtkAlternativeTrigger *alternative = GTK_ALTERNATIVE_TRIGGER (trigger);
+
+      return collect_trigger_keyvals (gtk_alternative_trigger_get_first (alternative), keyvals) &&
+             collect_trigger_keyvals (gtk_alternative_trigger_get_second (alternative), keyvals);
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_shortcut_controller_index_add (GtkShortcutController *self,
+                                   guint                  position,
+                                   GtkShortcut           *shortcut)
+{
+  GArray *keyvals;
+  guint i;
+
+  keyvals = g_array_new (FALSE, FALSE, sizeof (guint));
+  if (!collect_trigger_keyvals (gtk_shortcut_get_trigger (shortcut), keyvals))
+    {
+      guint unknown = 0;
+      g_array_append_val (keyvals, unknown);
+    }
+
+  for (i = 0; i < keyvals->len; i++)
+    {
+      guint keyval = g_array_index (keyvals, guint, i);
+      GArray *positions;
+
+      positions = g_hash_table_lookup (self->index, GUINT_TO_POINTER (keyval));
+      if (positions == NULL)
+        {
+          positions = g_array_new (FALSE, FALSE, sizeof (guint));
+          g_hash_table_insert (self->index, GUINT_TO_POINTER (keyval), positions);
+        }
+      g_array_append_val (positions, position);
+    }
+
+  g_array_free (keyvals, TRUE);
+}
+
+static void gtk_shortcut_controller_clear_index (GtkShortcutController *self);
+
+static void
+gtk_shortcut_controller_trigger_changed_cb (GtkShortcut           *shortcut,
+                                            GParamSpec            *pspec,
+                                            GtkShortcutController *self)
+{
+  /* Rare enough that it's not worth updating the index in place */
+  gtk_shortcut_controller_clear_index (self);
+}
+
+static void
+gtk_shortcut_controller_index_insert (GtkShortcutController *self,
+                                      guint                  position,
+                                      guint                  n_items)
+{
+  guint i;
+
+  for (i = position; i < position + n_items; i++)
+    {
+      gpointer item = g_list_model_get_item (self->shortcuts, i);
+
+      if (GTK_IS_SHORTCUT (item))
+        {
+          g_signal_connect (item, "notify::trigger",
+                            G_CALLBACK (gtk_shortcut_controller_trigger_changed_cb), self);
+          gtk_shortcut_controller_index_add (self, i, item);
+        }
+
+      g_ptr_array_insert (self->indexed_items, i, item);
+    }
+}
+
+static void
+gtk_shortcut_controller_clear_index (GtkShortcutController *self)
+{
+  guint i;
+
+  if (self->index == NULL)
+    return;
+
+  for (i = 0; i < self->indexed_items->len; i++)
+    {
+      gpointer item = g_ptr_array_index (self->indexed_items, i);
+
+      if (GTK_IS_SHORTCUT (item))
+        g_signal_handlers_disconnect_by_func (item, gtk_shortcut_controller_trigger_changed_cb, self);
+    }
+
+  g_clear_pointer (&self->indexed_items, g_ptr_array_unref);
+  g_clear_pointer (&self->index, g_hash_table_unref);
+}
+
+static void
+gtk_shortcut_controller_ensure_index (GtkShortcutController *self)
+{
+  if (self->index)
+    return;
+
+  self->index = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_array_unref);
+  self->indexed_items = g_ptr_array_new_with_free_func (g_object_unref);
+
+  gtk_shortcut_controller_index_insert (self, 0, g_list_model_get_n_items (self->shortcuts));
+}
+
+static void
+gtk_shortcut_controller_items_changed_cb (GListModel            *model,
+                                          guint                  position,
+                                          guint                  removed,
+                                          guint                  added,
+                                          GtkShortcutController *self)
+{
+  if (self->index)
+    {
+      GHashTableIter iter;
+      gpointer value;
+      guint i;
+
+      for (i = position; i < position + removed; i++)
+        {
+          gpointer item = g_ptr_array_index (self->indexed_items, i);
+
+          if (GTK_IS_SHORTCUT (item))
+            g_signal_handlers_disconnect_by_func (item, gtk_shortcut_controller_trigger_changed_cb, self);
+        }
+      g_ptr_array_remove_range (self->indexed_items, position, removed);
+
+      /* Drop the removed positions and move the ones after them */
+      g_hash_table_iter_init (&iter, self->index);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        {
+          GArray *positions = value;
+
+          for (i = 0; i < positions->len; )
+            {
+              guint *pos = &g_array_index (positions, guint, i);
+
+              if (*pos < position)
+                {
+                  i++;
+                }
+              else if (*pos < position + removed)
+                {
+                  g_array_remove_index_fast (positions, i);
+                }
+              else
+                {
+                  *pos = *pos - removed + added;
+                  i++;
+                }
+            }
+        }
+
+      gtk_shortcut_controller_index_insert (self, position, added);
+    }
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+}
+
+static void
+add_candidates (GtkShortcutController *self,
+                GArray                *candidates,
+                guint                  keyval,
+                guint                  start,
+                guint                  n_items)
+{
+  GArray *positions;
+  guint i;
+
+  positions = g_hash_table_lookup (self->index, GUINT_TO_POINTER (keyval));
+  if (positions == NULL)
+    return;
+
+  for (i = 0; i < positions->len; i++)
+    {
+      /* Store them relative to start, so sorting gives us the
+       * order we want to try them in.
+       */
+      guint rotated = (g_array_index (positions, guint, i) + n_items - start) % n_items;
+      g_array_append_val (candidates, rotated);
+    }
+}
+
+static int
+compare_positions (gconstpointer a,
+                   gconstpointer b)
+{
+  guint pos_a = *(const guint *) a;
+  guint pos_b = *(const guint *) b;
+
+  return pos_a < pos_b ? -1 : (pos_a > pos_b ? 1 : 0);
+}
+
+/* Finds the positions of all shortcuts that might be triggered by
+ * @event, starting after the last activated one. Every shortcut that
+ * can match is returned, but not all returned shortcuts match.
+ */
+static GArray *
+gtk_shortcut_controller_get_candidates (GtkShortcutController *self,
+                                        GdkEvent              *event)
+{
+  GArray *candidates;
+  guint start, n_items, i, j;
+
+  candidates = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  n_items = g_list_model_get_n_items (self->shortcuts);
+  if (n_items == 0)
+    return candidates;
+
+  gtk_shortcut_controller_ensure_index (self);
+  start = (self->last_activated + 1) % n_items;
+
+  add_candidates (self, candidates, 0, start, n_items);
+
+  /* All triggers we index only match key presses. Key events also
+   * match triggers for other keyvals of the same key, so look at all
+   * of them.
+   */
+  if (gdk_event_get_event_type (event) == GDK_KEY_PRESS)
+    {
+      guint *keyvals;
+      int n_keyvals, k;
+
+      add_candidates (self, candidates,
+                      normalize_keyval (gdk_key_event_get_keyval (event)),
+                      start, n_items);
+
+      if (gdk_display_map_keycode (gdk_event_get_display (event),
+                                   gdk_key_event_get_keycode (event),
+                                   NULL, &keyvals, &n_keyvals))
+        {
+          for (k = 0; k < n_keyvals; k++)
+            add_candidates (self, candidates, normalize_keyval (keyvals[k]), start, n_items);
+          g_free (keyvals);
+        }
+    }
+
+  g_array_sort (candidates, compare_positions);
+
+  /* Remove duplicates and turn them back into positions */
+  for (i = 0, j = 0; i < candidates->len; i++)
+    {
+      guint rotated = g_array_index (candidates, guint, i);
+
+      if (j > 0 && g_array_index (candidates, guint, j - 1) == (rotated + start) % n_items)
+        continue;
+
+      g_array_index (candidates, guint, j++) = (rotated + start) % n_items;
+    }
+  g_array_set_size (candidates, j);
+
+  return candidates;
+}
+
 static GType
 gtk_shortcut_controller_list_model_get_item_type (GListModel *list)
 {
@@ -215,10 +517,10 @@ gtk_shortcut_controller_set_property (GObject      *object,
             self->custom_shortcuts = FALSE;
           }
 
-        self->shortcuts_changed_id =  g_signal_connect_swapped (self->shortcuts,
-                                                                "items-changed",
-                                                                G_CALLBACK (g_list_model_items_changed),
-                                                                self);
+        self->shortcuts_changed_id = g_signal_connect (self->shortcuts,
+                                                       "items-changed",
+                                                       G_CALLBACK (gtk_shortcut_controller_items_changed_cb),
+                                                       self);
       }
       break;
 
@@ -262,6 +564,8 @@ gtk_shortcut_controller_dispose (GObject *object)
   if (self->custom_shortcuts)
     g_list_store_remove_all (G_LIST_STORE (self->shortcuts));
 
+  gtk_shortcut_controller_clear_index (self);
+
   G_OBJECT_CLASS (gtk_shortcut_controller_parent_class)->dispose (object);
 }
 
@@ -299,11 +603,14 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
 {
   GtkShortcutController *self = GTK_SHORTCUT_CONTROLLER (controller);
   int i, p;
+  GArray *candidates;
   GArray *shortcuts = NULL;
   gboolean has_exact = FALSE;
   gboolean retval = FALSE;
 
-  for (i = 0, p = g_list_model_get_n_items (self->shortcuts); i < p; i++)
+  candidates = gtk_shortcut_controller_get_candidates (self, event);
+
+  for (i = 0; i < candidates->len; i++)
     {
       GtkShortcut *shortcut;
       ShortcutData *data;
@@ -311,7 +618,7 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
       GtkWidget *widget;
       GtkNative *native;
 
-      index = (self->last_activated + 1 + i) % g_list_model_get_n_items (self->shortcuts);
+      index = g_array_index (candidates, guint, i);
       shortcut = g_list_model_get_item (self->shortcuts, index);
       if (!GTK_IS_SHORTCUT (shortcut))
         {
@@ -380,6 +687,8 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
       data->widget = widget;
     }
 
+  g_array_free (candidates, TRUE);
+
 #ifdef G_ENABLE_DEBUG
   if (GTK_DEBUG_CHECK (KEYBINDINGS))
     {
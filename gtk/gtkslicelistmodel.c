@@ -22,6 +22,7 @@
 #include "gtkslicelistmodel.h"
 
 #include "gtkintl.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -114,8 +115,35 @@ gtk_slice_list_model_model_init (GListModelInterface *iface)
   iface->get_item = gtk_slice_list_model_get_item;
 }
 
+static guint
+gtk_slice_list_model_get_items (GtkListModelBatch *batch,
+                                guint              position,
+                                guint              n_items,
+                                gpointer          *items)
+{
+  GtkSliceListModel *self = GTK_SLICE_LIST_MODEL (batch);
+
+  if (self->model == NULL)
+    return 0;
+
+  if (position >= self->size)
+    return 0;
+
+  return gtk_list_model_get_items (self->model,
+                                   position + self->offset,
+                                   MIN (n_items, self->size - position),
+                                   items);
+}
+
+static void
+gtk_slice_list_model_batch_init (GtkListModelBatchInterface *iface)
+{
+  iface->get_items = gtk_slice_list_model_get_items;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkSliceListModel, gtk_slice_list_model, G_TYPE_OBJECT,
-                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_slice_list_model_model_init))
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_slice_list_model_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_LIST_MODEL_BATCH, gtk_slice_list_model_batch_init))
 
 static void
 gtk_slice_list_model_items_changed_cb (GListModel        *model,
@@ -23,6 +23,7 @@
 
 #include "gtkbitset.h"
 #include "gtkintl.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkprivate.h"
 #include "gtksorterprivate.h"
 #include "timsort/gtktimsortprivate.h"
@@ -52,6 +53,9 @@
  */
 #define GTK_SORT_STEP_TIME_US (1000) /* 1 millisecond */
 
+/* How many items to get from the model at once when creating keys */
+#define GTK_SORT_KEY_BATCH_SIZE (64)
+
 /**
  * SECTION:gtksortlistmodel
  * @title: GtkSortListModel
@@ -215,20 +219,32 @@ gtk_sort_list_model_sort_step (GtkSortListModel *self,
 
   if (!gtk_bitset_is_empty (self->missing_keys))
     {
+      gpointer items[GTK_SORT_KEY_BATCH_SIZE];
       GtkBitsetIter iter;
-      guint pos;
+      guint pos, n, n_items, i;
+      gboolean more;
 
-      for (gtk_bitset_iter_init_first (&iter, self->missing_keys, &pos);
-           gtk_bitset_iter_is_valid (&iter);
-           gtk_bitset_iter_next (&iter, &pos))
+      for (more = gtk_bitset_iter_init_first (&iter, self->missing_keys, &pos);
+           more;
+           more = gtk_bitset_iter_init_at (&iter, self->missing_keys, pos + n, &pos))
         {
-          gpointer item = g_list_model_get_item (self->model, pos);
-          gtk_sort_keys_init_key (self->sort_keys, item, key_from_pos (self, pos));
-          g_object_unref (item);
+          /* Create keys for runs of consecutive items in one go */
+          for (n = 1; n < GTK_SORT_KEY_BATCH_SIZE; n++)
+            {
+              if (!gtk_bitset_contains (self->missing_keys, pos + n))
+                break;
+            }
+
+          n_items = gtk_list_model_get_items (self->model, pos, n, items);
+          for (i = 0; i < n_items; i++)
+            {
+              gtk_sort_keys_init_key (self->sort_keys, items[i], key_from_pos (self, pos + i));
+              g_object_unref (items[i]);
+            }
 
           if (g_get_monotonic_time () >= end_time && !finish)
             {
-              gtk_bitset_remove_range_closed (self->missing_keys, 0, pos);
+              gtk_bitset_remove_range_closed (self->missing_keys, 0, pos + n - 1);
               *out_position = 0;
               *out_n_items = 0;
               return TRUE;
@@ -24,6 +24,7 @@
 #include "gtkbuildable.h"
 #include "gtkbuilderprivate.h"
 #include "gtkintl.h"
+#include "gtklistmodelbatchprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -60,15 +61,47 @@
 
  */
 
-#define GDK_ARRAY_ELEMENT_TYPE GtkStringObject *
-#define GDK_ARRAY_NAME objects
-#define GDK_ARRAY_TYPE_NAME Objects
-#define GDK_ARRAY_FREE_FUNC g_object_unref
+typedef struct _StringChunk StringChunk;
+typedef struct _StringItem StringItem;
+
+/* The strings of a list are not allocated one by one, but stored
+ * next to each other in chunks. A chunk is freed once all strings
+ * stored in it have been removed from the list, so a string stays
+ * at the same address for as long as it is part of the list.
+ */
+struct _StringChunk
+{
+  gsize size;
+  gsize used;
+  guint n_strings;
+  char data[];
+};
+
+struct _StringItem
+{
+  char *string;
+  StringChunk *chunk;
+};
+
+/* The size of the chunks strings are normally stored in.
+ * Strings bigger than a quarter of this get a chunk of their own.
+ */
+#define STRING_CHUNK_SIZE (16 * 1024 - sizeof (StringChunk))
+
+#define GDK_ARRAY_ELEMENT_TYPE StringItem
+#define GDK_ARRAY_NAME items
+#define GDK_ARRAY_TYPE_NAME Items
+#define GDK_ARRAY_BY_VALUE 1
 #include "gdk/gdkarrayimpl.c"
 
 struct _GtkStringObject
 {
   GObject parent_instance;
+  /* If list is set, the object was created by it and
+   * string points into the list's chunks.
+   * Otherwise, the object owns the string.
+   */
+  GtkStringList *list;
   char *string;
 };
 
@@ -79,6 +112,9 @@ enum {
 
 G_DEFINE_TYPE (GtkStringObject, gtk_string_object, G_TYPE_OBJECT);
 
+static void gtk_string_list_forget_object (GtkStringList   *self,
+                                           GtkStringObject *object);
+
 static void
 gtk_string_object_init (GtkStringObject *object)
 {
@@ -89,7 +125,10 @@ gtk_string_object_finalize (GObject *object)
 {
   GtkStringObject *self = GTK_STRING_OBJECT (object);
 
-  g_free (self->string);
+  if (self->list)
+    gtk_string_list_forget_object (self->list, self);
+  else
+    g_free (self->string);
 
   G_OBJECT_CLASS (gtk_string_object_parent_class)->finalize (object);
 }
@@ -132,17 +171,6 @@ gtk_string_object_class_init (GtkStringObjectClass *class)
 
 }
 
-static GtkStringObject *
-gtk_string_object_new_take (char *string)
-{
-  GtkStringObject *obj;
-
-  obj = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
-  obj->string = string;
-
-  return obj;
-}
-
 /**
  * gtk_string_object_new:
  * @string: (not nullable): The string to wrap
@@ -154,7 +182,12 @@ gtk_string_object_new_take (char *string)
 GtkStringObject *
 gtk_string_object_new (const char *string)
 {
-  return gtk_string_object_new_take (g_strdup (string));
+  GtkStringObject *obj;
+
+  obj = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
+  obj->string = g_strdup (string);
+
+  return obj;
 }
 
 /**
@@ -177,7 +210,11 @@ struct _GtkStringList
 {
   GObject parent_instance;
 
-  Objects items;
+  Items items;
+  /* the chunk new strings are added to */
+  StringChunk *chunk;
+  /* string => GtkStringObject, not holding a reference */
+  GHashTable *objects;
 };
 
 struct _GtkStringListClass
@@ -185,6 +222,82 @@ struct _GtkStringListClass
   GObjectClass parent_class;
 };
 
+static StringChunk *
+string_chunk_new (gsize size)
+{
+  StringChunk *chunk;
+
+  chunk = g_malloc (sizeof (StringChunk) + size);
+  chunk->size = size;
+  chunk->used = 0;
+  chunk->n_strings = 0;
+
+  return chunk;
+}
+
+static void
+gtk_string_list_add_string (GtkStringList *self,
+                            const char    *string,
+                            gsize          len,
+                            StringItem    *item)
+{
+  StringChunk *chunk = self->chunk;
+
+  if (chunk == NULL || chunk->size - chunk->used < len + 1)
+    {
+      if (len + 1 > STRING_CHUNK_SIZE / 4)
+        {
+          chunk = string_chunk_new (len + 1);
+        }
+      else
+        {
+          if (chunk && chunk->n_strings == 0)
+            g_free (chunk);
+          chunk = self->chunk = string_chunk_new (STRING_CHUNK_SIZE);
+        }
+    }
+
+  item->string = chunk->data + chunk->used;
+  item->chunk = chunk;
+  memcpy (item->string, string, len);
+  item->string[len] = '\0';
+  chunk->used += len + 1;
+  chunk->n_strings++;
+}
+
+static void
+gtk_string_list_forget_object (GtkStringList   *self,
+                               GtkStringObject *object)
+{
+  g_hash_table_remove (self->objects, object->string);
+}
+
+static void
+gtk_string_list_remove_string (GtkStringList *self,
+                               StringItem    *item)
+{
+  StringChunk *chunk = item->chunk;
+  GtkStringObject *object;
+
+  object = g_hash_table_lookup (self->objects, item->string);
+  if (object)
+    {
+      /* The object outlives the string, so it needs its own copy */
+      g_hash_table_remove (self->objects, item->string);
+      object->list = NULL;
+      object->string = g_strdup (object->string);
+    }
+
+  chunk->n_strings--;
+  if (chunk->n_strings > 0)
+    return;
+
+  if (chunk == self->chunk)
+    chunk->used = 0;
+  else
+    g_free (chunk);
+}
+
 static GType
 gtk_string_list_get_item_type (GListModel *list)
 {
@@ -196,7 +309,28 @@ gtk_string_list_get_n_items (GListModel *list)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
 
-  return objects_get_size (&self->items);
+  return items_get_size (&self->items);
+}
+
+static GtkStringObject *
+gtk_string_list_get_object (GtkStringList *self,
+                            StringItem    *item)
+{
+  GtkStringObject *object;
+
+  /* Objects are created on demand, but as long as one is alive,
+   * it is handed out for its string.
+   */
+  object = g_hash_table_lookup (self->objects, item->string);
+  if (object)
+    return g_object_ref (object);
+
+  object = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
+  object->list = self;
+  object->string = item->string;
+  g_hash_table_insert (self->objects, item->string, object);
+
+  return object;
 }
 
 static gpointer
@@ -205,10 +339,10 @@ gtk_string_list_get_item (GListModel *list,
 {
   GtkStringList *self = GTK_STRING_LIST (list);
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return g_object_ref (objects_get (&self->items, position));
+  return gtk_string_list_get_object (self, items_index (&self->items, position));
 }
 
 static void
@@ -219,6 +353,31 @@ gtk_string_list_model_init (GListModelInterface *iface)
   iface->get_item = gtk_string_list_get_item;
 }
 
+static guint
+gtk_string_list_get_items (GtkListModelBatch *batch,
+                           guint              position,
+                           guint              n_items,
+                           gpointer          *items)
+{
+  GtkStringList *self = GTK_STRING_LIST (batch);
+  guint i;
+
+  if (position >= items_get_size (&self->items))
+    return 0;
+
+  n_items = MIN (n_items, items_get_size (&self->items) - position);
+  for (i = 0; i < n_items; i++)
+    items[i] = gtk_string_list_get_object (self, items_index (&self->items, position + i));
+
+  return n_items;
+}
+
+static void
+gtk_string_list_batch_init (GtkListModelBatchInterface *iface)
+{
+  iface->get_items = gtk_string_list_get_items;
+}
+
 typedef struct
 {
   GtkBuilder    *builder;
@@ -388,30 +547,48 @@ G_DEFINE_TYPE_WITH_CODE (GtkStringList, gtk_string_list, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE,
                                                 gtk_string_list_buildable_init)
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
-                                                gtk_string_list_model_init))
+                                                gtk_string_list_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_LIST_MODEL_BATCH,
+                                                gtk_string_list_batch_init))
 
 static void
 gtk_string_list_dispose (GObject *object)
 {
   GtkStringList *self = GTK_STRING_LIST (object);
+  guint i;
 
-  objects_clear (&self->items);
+  for (i = 0; i < items_get_size (&self->items); i++)
+    gtk_string_list_remove_string (self, items_index (&self->items, i));
+  items_clear (&self->items);
+  g_clear_pointer (&self->chunk, g_free);
 
   G_OBJECT_CLASS (gtk_string_list_parent_class)->dispose (object);
 }
 
+static void
+gtk_string_list_finalize (GObject *object)
+{
+  GtkStringList *self = GTK_STRING_LIST (object);
+
+  g_hash_table_unref (self->objects);
+
+  G_OBJECT_CLASS (gtk_string_list_parent_class)->finalize (object);
+}
+
 static void
 gtk_string_list_class_init (GtkStringListClass *class)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
 
   gobject_class->dispose = gtk_string_list_dispose;
+  gobject_class->finalize = gtk_string_list_finalize;
 }
 
 static void
 gtk_string_list_init (GtkStringList *self)
 {
-  objects_init (&self->items);
+  items_init (&self->items);
+  self->objects = g_hash_table_new (NULL, NULL);
 }
 
 /**
@@ -434,6 +611,74 @@ gtk_string_list_new (const char * const *strings)
   return self;
 }
 
+/**
+ * gtk_string_list_new_from_bytes:
+ * @bytes: the newline-separated strings to put in the model
+ *
+ * Creates a new #GtkStringList with one string for every line
+ * in @bytes.
+ *
+ * Lines are separated by `\n`. A newline at the end of @bytes
+ * does not add an empty string at the end of the list. The
+ * contents of @bytes must not contain nul bytes.
+ *
+ * This is much faster than adding the strings one by one for
+ * big lists, because all of them are copied at once.
+ *
+ * Returns: a new #GtkStringList
+ */
+GtkStringList *
+gtk_string_list_new_from_bytes (GBytes *bytes)
+{
+  GtkStringList *self;
+  StringChunk *chunk;
+  const char *data;
+  char *p, *end;
+  gsize size;
+  guint i, n_lines;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  self = g_object_new (GTK_TYPE_STRING_LIST, NULL);
+
+  data = g_bytes_get_data (bytes, &size);
+  if (size == 0)
+    return self;
+
+  /* Copy everything into a single chunk and split it in place */
+  chunk = string_chunk_new (size + 1);
+  memcpy (chunk->data, data, size);
+  chunk->data[size] = '\0';
+  chunk->used = size + 1;
+
+  n_lines = 0;
+  for (p = chunk->data; (p = memchr (p, '\n', chunk->data + size - p)); p++)
+    n_lines++;
+  if (chunk->data[size - 1] != '\n')
+    n_lines++;
+
+  items_splice (&self->items, 0, 0, FALSE, NULL, n_lines);
+  chunk->n_strings = n_lines;
+
+  p = chunk->data;
+  for (i = 0; i < n_lines; i++)
+    {
+      StringItem *item = items_index (&self->items, i);
+
+      end = memchr (p, '\n', chunk->data + size - p);
+      if (end)
+        *end = '\0';
+
+      item->string = p;
+      item->chunk = chunk;
+
+      if (end)
+        p = end + 1;
+    }
+
+  return self;
+}
+
 /**
  * gtk_string_list_splice:
  * @self: a #GtkStringList
@@ -460,23 +705,30 @@ gtk_string_list_splice (GtkStringList      *self,
                         guint               n_removals,
                         const char * const *additions)
 {
+  StringItem *new_items;
   guint i, n_additions;
 
   g_return_if_fail (GTK_IS_STRING_LIST (self));
   g_return_if_fail (position + n_removals >= position); /* overflow */
-  g_return_if_fail (position + n_removals <= objects_get_size (&self->items));
+  g_return_if_fail (position + n_removals <= items_get_size (&self->items));
 
   if (additions)
     n_additions = g_strv_length ((char **) additions);
   else
     n_additions = 0;
 
-  objects_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
-
+  /* Copy the additions before removing anything, they might be
+   * strings from this list.
+   */
+  new_items = g_new (StringItem, n_additions);
   for (i = 0; i < n_additions; i++)
-    {
-      *objects_index (&self->items, position + i) = gtk_string_object_new (additions[i]);
-    }
+    gtk_string_list_add_string (self, additions[i], strlen (additions[i]), &new_items[i]);
+
+  for (i = 0; i < n_removals; i++)
+    gtk_string_list_remove_string (self, items_index (&self->items, position + i));
+
+  items_splice (&self->items, position, n_removals, FALSE, new_items, n_additions);
+  g_free (new_items);
 
   if (n_removals || n_additions)
     g_list_model_items_changed (G_LIST_MODEL (self), position, n_removals, n_additions);
@@ -496,11 +748,14 @@ void
 gtk_string_list_append (GtkStringList *self,
                         const char    *string)
 {
+  StringItem item;
+
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new (string));
+  gtk_string_list_add_string (self, string, strlen (string), &item);
+  items_append (&self->items, &item);
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), items_get_size (&self->items) - 1, 0, 1);
 }
 
 /**
@@ -522,11 +777,15 @@ void
 gtk_string_list_take (GtkStringList *self,
                       char          *string)
 {
+  StringItem item;
+
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new_take (string));
+  gtk_string_list_add_string (self, string, strlen (string), &item);
+  g_free (string);
+  items_append (&self->items, &item);
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), items_get_size (&self->items) - 1, 0, 1);
 }
 
 /**
@@ -565,8 +824,8 @@ gtk_string_list_get_string (GtkStringList *self,
 {
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), NULL);
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return objects_get (&self->items, position)->string;
+  return items_index (&self->items, position)->string;
 }
@@ -216,6 +216,8 @@
 typedef struct _SortElt SortElt;
 typedef struct _SortLevel SortLevel;
 typedef struct _SortData SortData;
+typedef struct _SortEntry SortEntry;
+typedef struct _SortMerge SortMerge;
 
 struct _SortElt
 {
@@ -247,13 +249,43 @@ struct _SortData
   int parent_path_depth;
 };
 
+struct _SortEntry
+{
+  SortElt *elt;
+  char *key; /* collation key, when sorting text columns */
+};
+
+/* State of a bottom-up merge sort of a level, so that it can be
+ * done in steps.
+ */
+struct _SortMerge
+{
+  SortEntry *entries;
+  SortEntry *tmp;
+  int n_entries;
+
+  /* the text column to sort by, or -1 */
+  int key_column;
+  int n_keys;
+
+  int width;
+  int start;
+  int i, j, k;
+};
+
 /* Properties */
 enum {
   PROP_0,
   /* Construct args */
-  PROP_MODEL
+  PROP_MODEL,
+  PROP_INCREMENTAL
 };
 
+/* Time spent sorting before returning to the main loop when
+ * sorting incrementally.
+ */
+#define SORT_STEP_TIME_US (1000) /* 1 millisecond */
+
 
 struct _GtkTreeModelSortPrivate
 {
@@ -273,6 +305,11 @@ struct _GtkTreeModelSortPrivate
   gpointer default_sort_data;
   GDestroyNotify default_sort_destroy;
 
+  /* incremental sorting of the root level */
+  gboolean incremental;
+  guint sort_cb;
+  SortMerge *merge;
+
   /* signal ids */
   gulong changed_id;
   gulong inserted_id;
@@ -440,6 +477,11 @@ static int          gtk_tree_model_sort_offset_compare_func (gconstpointer     a
                                                              gpointer          user_data);
 static void         gtk_tree_model_sort_clear_cache_helper  (GtkTreeModelSort *tree_model_sort,
                                                              SortLevel        *level);
+static void         gtk_tree_model_sort_stop_sorting        (GtkTreeModelSort *tree_model_sort);
+static void         gtk_tree_model_sort_restart_sorting     (GtkTreeModelSort *tree_model_sort);
+static void         gtk_tree_model_sort_pending_row_changed (GtkTreeModelSort *tree_model_sort,
+                                                             SortElt          *elt,
+                                                             GtkTreeIter      *s_iter);
 
 
 G_DEFINE_TYPE_WITH_CODE (GtkTreeModelSort, gtk_tree_model_sort, G_TYPE_OBJECT,
@@ -485,6 +527,21 @@ gtk_tree_model_sort_class_init (GtkTreeModelSortClass *class)
 							P_("The model for the TreeModelSort to sort"),
 							GTK_TYPE_TREE_MODEL,
 							GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  /**
+   * GtkTreeModelSort:incremental:
+   *
+   * If the toplevel rows should be sorted incrementally.
+   *
+   * See gtk_tree_model_sort_set_incremental().
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_INCREMENTAL,
+                                   g_param_spec_boolean ("incremental",
+                                                         P_("Incremental"),
+                                                         P_("Sort rows incrementally"),
+                                                         FALSE,
+                                                         GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY));
 }
 
 static void
@@ -590,6 +647,9 @@ gtk_tree_model_sort_set_property (GObject      *object,
     case PROP_MODEL:
       gtk_tree_model_sort_set_model (tree_model_sort, g_value_get_object (value));
       break;
+    case PROP_INCREMENTAL:
+      gtk_tree_model_sort_set_incremental (tree_model_sort, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -609,6 +669,9 @@ gtk_tree_model_sort_get_property (GObject    *object,
     case PROP_MODEL:
       g_value_set_object (value, gtk_tree_model_sort_get_model (tree_model_sort));
       break;
+    case PROP_INCREMENTAL:
+      g_value_set_boolean (value, tree_model_sort->priv->incremental);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -775,7 +838,21 @@ gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
   level = iter.user_data;
   elt = iter.user_data2;
 
+  /* A pending sort of the toplevel puts the row into place when it
+   * is done, so don't move it now.
+   */
+  if (level == priv->root && priv->sort_cb != 0)
+    {
+      if (start_s_iter)
+        tmpiter = *start_s_iter;
+      else
+        gtk_tree_model_get_iter (priv->child_model, &tmpiter, start_s_path);
+
+      gtk_tree_model_sort_pending_row_changed (tree_model_sort, elt, &tmpiter);
+    }
+
   if (g_sequence_get_length (level->seq) < 2 ||
+      (level == priv->root && priv->sort_cb != 0) ||
       (priv->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID &&
        priv->default_sort_func == NO_SORT_FUNC))
     {
@@ -909,6 +986,9 @@ gtk_tree_model_sort_row_inserted (GtkTreeModel          *s_model,
       free_s_path = TRUE;
     }
 
+  if (gtk_tree_path_get_depth (s_path) == 1)
+    gtk_tree_model_sort_restart_sorting (tree_model_sort);
+
   if (!s_iter)
     gtk_tree_model_get_iter (s_model, &real_s_iter, s_path);
   else
@@ -1031,6 +1111,9 @@ gtk_tree_model_sort_row_deleted (GtkTreeModel *s_model,
 
   g_return_if_fail (s_path != NULL);
 
+  if (gtk_tree_path_get_depth (s_path) == 1)
+    gtk_tree_model_sort_restart_sorting (tree_model_sort);
+
   path = gtk_real_tree_model_sort_convert_child_path_to_path (tree_model_sort, s_path, FALSE);
   if (path == NULL)
     return;
@@ -1105,6 +1188,8 @@ gtk_tree_model_sort_rows_reordered (GtkTreeModel *s_model,
 
   if (s_path == NULL || gtk_tree_path_get_depth (s_path) == 0)
     {
+      gtk_tree_model_sort_restart_sorting (tree_model_sort);
+
       if (priv->root == NULL)
 	return;
       path = gtk_tree_path_new ();
@@ -1885,35 +1970,48 @@ gtk_tree_model_sort_offset_compare_func (gconstpointer a,
 }
 
 static void
-gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
-				SortLevel        *level,
-				gboolean          recurse,
-				gboolean          emit_reordered)
+sort_data_get_child_iter (SortData      *data,
+                          const SortElt *elt,
+                          GtkTreeIter   *iter)
 {
-  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
-  int i;
-  GSequenceIter *begin_siter, *end_siter, *siter;
-  SortElt *begin_elt;
-  int *new_order;
-
-  GtkTreeIter iter;
-  GtkTreePath *path;
+  GtkTreeModelSortPrivate *priv = data->tree_model_sort->priv;
 
-  SortData data;
+  if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (data->tree_model_sort))
+    {
+      *iter = elt->iter;
+    }
+  else
+    {
+      data->parent_path_indices [data->parent_path_depth-1] = elt->offset;
+      gtk_tree_model_get_iter (GTK_TREE_MODEL (priv->child_model), iter, data->parent_path);
+    }
+}
 
-  g_return_if_fail (level != NULL);
+/* Returns the column if the level is sorted by the default sort
+ * function on a text column. Those can be sorted by comparing
+ * collation keys, which is much faster than g_utf8_collate().
+ */
+static int
+sort_data_get_key_column (SortData *data)
+{
+  GtkTreeModelSortPrivate *priv = data->tree_model_sort->priv;
+  int column;
 
-  begin_siter = g_sequence_get_begin_iter (level->seq);
-  begin_elt = g_sequence_get (begin_siter);
+  if (data->sort_func != _gtk_tree_data_list_compare_func)
+    return -1;
 
-  if (g_sequence_get_length (level->seq) < 1 && !begin_elt->children)
-    return;
+  column = GPOINTER_TO_INT (data->sort_data);
+  if (G_TYPE_FUNDAMENTAL (gtk_tree_model_get_column_type (priv->child_model, column)) != G_TYPE_STRING)
+    return -1;
 
-  iter.stamp = priv->stamp;
-  iter.user_data = level;
-  iter.user_data2 = begin_elt;
+  return column;
+}
 
-  gtk_tree_model_sort_ref_node (GTK_TREE_MODEL (tree_model_sort), &iter);
+static void
+sort_level_save_order (SortLevel *level)
+{
+  GSequenceIter *siter, *end_siter;
+  int i;
 
   i = 0;
   end_siter = g_sequence_get_end_iter (level->seq);
@@ -1926,16 +2024,193 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
       elt->old_index = i;
       i++;
     }
+}
 
-  fill_sort_data (&data, tree_model_sort, level);
+static SortMerge *
+sort_merge_new (SortLevel *level,
+                SortData  *data)
+{
+  GSequenceIter *siter, *end_siter;
+  SortMerge *merge;
+  int i;
 
-  if (data.sort_func == NO_SORT_FUNC)
-    g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
-                     &data);
-  else
-    g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
+  merge = g_slice_new0 (SortMerge);
+  merge->n_entries = g_sequence_get_length (level->seq);
+  merge->entries = g_new0 (SortEntry, merge->n_entries);
+  merge->tmp = g_new0 (SortEntry, merge->n_entries);
+  merge->key_column = sort_data_get_key_column (data);
 
-  free_sort_data (&data);
+  i = 0;
+  end_siter = g_sequence_get_end_iter (level->seq);
+  for (siter = g_sequence_get_begin_iter (level->seq);
+       siter != end_siter;
+       siter = g_sequence_iter_next (siter))
+    merge->entries[i++].elt = g_sequence_get (siter);
+
+  merge->width = 1;
+  merge->start = 0;
+  merge->i = 0;
+  merge->j = MIN (1, merge->n_entries);
+  merge->k = 0;
+
+  return merge;
+}
+
+static void
+sort_merge_free (SortMerge *merge)
+{
+  int i;
+
+  /* @entries always contains every entry exactly once, @tmp may
+   * contain copies.
+   */
+  for (i = 0; i < merge->n_entries; i++)
+    g_free (merge->entries[i].key);
+
+  g_free (merge->entries);
+  g_free (merge->tmp);
+  g_slice_free (SortMerge, merge);
+}
+
+static int
+sort_merge_compare (SortMerge       *merge,
+                    SortData        *data,
+                    const SortEntry *a,
+                    const SortEntry *b)
+{
+  int retval;
+
+  if (merge->key_column < 0)
+    {
+      if (data->sort_func == NO_SORT_FUNC)
+        return gtk_tree_model_sort_offset_compare_func (a->elt, b->elt, data);
+      else
+        return gtk_tree_model_sort_compare_func (a->elt, b->elt, data);
+    }
+
+  retval = strcmp (a->key, b->key);
+
+  if (data->tree_model_sort->priv->order == GTK_SORT_DESCENDING)
+    {
+      if (retval > 0)
+	retval = -1;
+      else if (retval < 0)
+	retval = 1;
+    }
+
+  return retval;
+}
+
+static gboolean
+sort_merge_should_stop (gint64 end_time,
+                        guint *counter)
+{
+  if (end_time == 0)
+    return FALSE;
+
+  /* Don't query the time too often */
+  if (++(*counter) % 128 != 0)
+    return FALSE;
+
+  return g_get_monotonic_time () >= end_time;
+}
+
+/* Continues sorting until @end_time. If @end_time is 0, sorts
+ * until done.
+ *
+ * Returns: %TRUE if the entries are sorted
+ */
+static gboolean
+sort_merge_step (SortMerge *merge,
+                 SortData  *data,
+                 gint64     end_time)
+{
+  GtkTreeModelSortPrivate *priv = data->tree_model_sort->priv;
+  int n = merge->n_entries;
+  guint counter = 0;
+
+  if (merge->key_column >= 0)
+    {
+      while (merge->n_keys < n)
+        {
+          SortEntry *entry = &merge->entries[merge->n_keys];
+          GValue value = G_VALUE_INIT;
+          GtkTreeIter iter;
+          const char *str;
+
+          sort_data_get_child_iter (data, entry->elt, &iter);
+          gtk_tree_model_get_value (priv->child_model, &iter, merge->key_column, &value);
+          str = g_value_get_string (&value);
+          entry->key = g_utf8_collate_key (str ? str : "", -1);
+          g_value_unset (&value);
+
+          merge->n_keys++;
+
+          if (sort_merge_should_stop (end_time, &counter))
+            return FALSE;
+        }
+    }
+
+  while (merge->width < n)
+    {
+      int mid = MIN (merge->start + merge->width, n);
+      int end = MIN (merge->start + 2 * merge->width, n);
+
+      while (merge->k < end)
+        {
+          if (merge->i < mid &&
+              (merge->j >= end ||
+               sort_merge_compare (merge, data, &merge->entries[merge->i], &merge->entries[merge->j]) <= 0))
+            merge->tmp[merge->k++] = merge->entries[merge->i++];
+          else
+            merge->tmp[merge->k++] = merge->entries[merge->j++];
+
+          if (sort_merge_should_stop (end_time, &counter))
+            return FALSE;
+        }
+
+      merge->start = end;
+      if (merge->start >= n)
+        {
+          SortEntry *swap = merge->entries;
+
+          merge->entries = merge->tmp;
+          merge->tmp = swap;
+          merge->width *= 2;
+          merge->start = 0;
+        }
+
+      merge->i = merge->start;
+      merge->j = MIN (merge->start + merge->width, n);
+      merge->k = merge->start;
+    }
+
+  return TRUE;
+}
+
+/* Moves the elements of @level into the sorted order */
+static void
+sort_merge_apply (SortMerge *merge,
+                  SortLevel *level)
+{
+  GSequenceIter *end_siter;
+  int i;
+
+  end_siter = g_sequence_get_end_iter (level->seq);
+  for (i = 0; i < merge->n_entries; i++)
+    g_sequence_move (merge->entries[i].elt->siter, end_siter);
+}
+
+static void
+gtk_tree_model_sort_emit_level_reordered (GtkTreeModelSort *tree_model_sort,
+                                          SortLevel        *level)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  GSequenceIter *siter, *end_siter;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+  int *new_order;
+  int i;
 
   new_order = g_new (int, g_sequence_get_length (level->seq));
 
@@ -1950,31 +2225,82 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
       new_order[i++] = elt->old_index;
     }
 
-  if (emit_reordered)
+  gtk_tree_model_sort_increment_stamp (tree_model_sort);
+  if (level->parent_elt)
     {
-      gtk_tree_model_sort_increment_stamp (tree_model_sort);
-      if (level->parent_elt)
-	{
-	  iter.stamp = priv->stamp;
-	  iter.user_data = level->parent_level;
-	  iter.user_data2 = level->parent_elt;
+      iter.stamp = priv->stamp;
+      iter.user_data = level->parent_level;
+      iter.user_data2 = level->parent_elt;
 
-	  path = gtk_tree_model_get_path (GTK_TREE_MODEL (tree_model_sort),
-					  &iter);
+      path = gtk_tree_model_get_path (GTK_TREE_MODEL (tree_model_sort),
+                                      &iter);
 
-	  gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_model_sort), path,
-					 &iter, new_order);
-	}
-      else
-	{
-	  /* toplevel list */
-	  path = gtk_tree_path_new ();
-	  gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_model_sort), path,
-					 NULL, new_order);
-	}
+      gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_model_sort), path,
+                                     &iter, new_order);
+    }
+  else
+    {
+      /* toplevel list */
+      path = gtk_tree_path_new ();
+      gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_model_sort), path,
+                                     NULL, new_order);
+    }
 
-      gtk_tree_path_free (path);
+  gtk_tree_path_free (path);
+  g_free (new_order);
+}
+
+static void
+gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
+				SortLevel        *level,
+				gboolean          recurse,
+				gboolean          emit_reordered)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  GSequenceIter *begin_siter, *end_siter, *siter;
+  SortElt *begin_elt;
+
+  GtkTreeIter iter;
+
+  SortData data;
+
+  g_return_if_fail (level != NULL);
+
+  begin_siter = g_sequence_get_begin_iter (level->seq);
+  begin_elt = g_sequence_get (begin_siter);
+
+  if (g_sequence_get_length (level->seq) < 1 && !begin_elt->children)
+    return;
+
+  iter.stamp = priv->stamp;
+  iter.user_data = level;
+  iter.user_data2 = begin_elt;
+
+  gtk_tree_model_sort_ref_node (GTK_TREE_MODEL (tree_model_sort), &iter);
+
+  sort_level_save_order (level);
+
+  fill_sort_data (&data, tree_model_sort, level);
+
+  if (data.sort_func == NO_SORT_FUNC)
+    g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
+                     &data);
+  else if (sort_data_get_key_column (&data) >= 0)
+    {
+      SortMerge *merge;
+
+      merge = sort_merge_new (level, &data);
+      sort_merge_step (merge, &data, 0);
+      sort_merge_apply (merge, level);
+      sort_merge_free (merge);
     }
+  else
+    g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
+
+  free_sort_data (&data);
+
+  if (emit_reordered)
+    gtk_tree_model_sort_emit_level_reordered (tree_model_sort, level);
 
   /* recurse, if possible */
   if (recurse)
@@ -1993,8 +2319,6 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 	}
     }
 
-  g_free (new_order);
-
   /* get the iter we referenced at the beginning of this function and
    * unref it again
    */
@@ -2005,11 +2329,152 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
   gtk_tree_model_sort_unref_node (GTK_TREE_MODEL (tree_model_sort), &iter);
 }
 
+static void
+gtk_tree_model_sort_finish_sorting (GtkTreeModelSort *tree_model_sort)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  SortLevel *level = priv->root;
+  GtkTreeIter iter;
+
+  g_clear_handle_id (&priv->sort_cb, g_source_remove);
+
+  sort_merge_apply (priv->merge, level);
+  g_clear_pointer (&priv->merge, sort_merge_free);
+
+  /* keep the level alive while emitting */
+  iter.stamp = priv->stamp;
+  iter.user_data = level;
+  iter.user_data2 = g_sequence_get (g_sequence_get_begin_iter (level->seq));
+  gtk_tree_model_sort_ref_node (GTK_TREE_MODEL (tree_model_sort), &iter);
+
+  gtk_tree_model_sort_emit_level_reordered (tree_model_sort, level);
+
+  iter.stamp = priv->stamp;
+  gtk_tree_model_sort_unref_node (GTK_TREE_MODEL (tree_model_sort), &iter);
+}
+
+/* Sorts the root level for a bit. The order of the rows doesn't
+ * change until the sort is complete, so everything keeps working
+ * while sorting. Toplevel changes of the child model restart the sort.
+ */
+static gboolean
+gtk_tree_model_sort_run_sort (GtkTreeModelSort *tree_model_sort,
+                              gint64            end_time)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  SortData data;
+  gboolean done;
+
+  /* rows might have been deleted since we started */
+  if (g_sequence_get_length (SORT_LEVEL (priv->root)->seq) < 2)
+    {
+      gtk_tree_model_sort_stop_sorting (tree_model_sort);
+      return TRUE;
+    }
+
+  fill_sort_data (&data, tree_model_sort, priv->root);
+
+  if (priv->merge == NULL)
+    {
+      sort_level_save_order (priv->root);
+      priv->merge = sort_merge_new (priv->root, &data);
+    }
+
+  done = sort_merge_step (priv->merge, &data, end_time);
+
+  free_sort_data (&data);
+
+  if (done)
+    gtk_tree_model_sort_finish_sorting (tree_model_sort);
+
+  return done;
+}
+
+static gboolean
+gtk_tree_model_sort_sort_cb (gpointer data)
+{
+  GtkTreeModelSort *tree_model_sort = data;
+
+  if (gtk_tree_model_sort_run_sort (tree_model_sort, g_get_monotonic_time () + SORT_STEP_TIME_US))
+    return G_SOURCE_REMOVE;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+gtk_tree_model_sort_stop_sorting (GtkTreeModelSort *tree_model_sort)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+
+  g_clear_handle_id (&priv->sort_cb, g_source_remove);
+  g_clear_pointer (&priv->merge, sort_merge_free);
+}
+
+/* Called when rows are added to, removed from or moved in the
+ * toplevel of the child model, the pending sort refers to the old
+ * rows. Changes below the toplevel don't affect it.
+ */
+static void
+gtk_tree_model_sort_restart_sorting (GtkTreeModelSort *tree_model_sort)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+
+  g_clear_pointer (&priv->merge, sort_merge_free);
+}
+
+/* Called when a toplevel row changes while the toplevel is sorted.
+ * The sort only starts over if the value it sorts by changed. With
+ * a custom sort function, we can't tell.
+ */
+static void
+gtk_tree_model_sort_pending_row_changed (GtkTreeModelSort *tree_model_sort,
+                                         SortElt          *elt,
+                                         GtkTreeIter      *s_iter)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  SortMerge *merge = priv->merge;
+  GValue value = G_VALUE_INIT;
+  const char *str;
+  char *key;
+  int i;
+
+  if (merge == NULL)
+    return;
+
+  if (merge->key_column < 0)
+    {
+      gtk_tree_model_sort_restart_sorting (tree_model_sort);
+      return;
+    }
+
+  for (i = 0; i < merge->n_entries; i++)
+    {
+      if (merge->entries[i].elt == elt)
+        break;
+    }
+
+  /* the key is computed later */
+  if (i == merge->n_entries || merge->entries[i].key == NULL)
+    return;
+
+  gtk_tree_model_get_value (priv->child_model, s_iter, merge->key_column, &value);
+  str = g_value_get_string (&value);
+  key = g_utf8_collate_key (str ? str : "", -1);
+
+  if (strcmp (key, merge->entries[i].key) != 0)
+    gtk_tree_model_sort_restart_sorting (tree_model_sort);
+
+  g_free (key);
+  g_value_unset (&value);
+}
+
 static void
 gtk_tree_model_sort_sort (GtkTreeModelSort *tree_model_sort)
 {
   GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
 
+  gtk_tree_model_sort_stop_sorting (tree_model_sort);
+
   if (priv->sort_column_id == GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
     return;
 
@@ -2030,8 +2495,38 @@ gtk_tree_model_sort_sort (GtkTreeModelSort *tree_model_sort)
   else
     g_return_if_fail (priv->default_sort_func != NULL);
 
-  gtk_tree_model_sort_sort_level (tree_model_sort, priv->root,
-				  TRUE, TRUE);
+  if (priv->incremental)
+    {
+      SortLevel *level = priv->root;
+      GSequenceIter *siter, *end_siter;
+
+      /* Only the toplevel is sorted incrementally, child levels
+       * are usually small.
+       */
+      end_siter = g_sequence_get_end_iter (level->seq);
+      for (siter = g_sequence_get_begin_iter (level->seq);
+           siter != end_siter;
+           siter = g_sequence_iter_next (siter))
+        {
+          SortElt *elt = g_sequence_get (siter);
+
+          if (elt->children)
+            gtk_tree_model_sort_sort_level (tree_model_sort,
+                                            elt->children,
+                                            TRUE, TRUE);
+        }
+
+      if (g_sequence_get_length (level->seq) > 1)
+        {
+          priv->sort_cb = g_idle_add (gtk_tree_model_sort_sort_cb, tree_model_sort);
+          g_source_set_name_by_id (priv->sort_cb, "[gtk] gtk_tree_model_sort_sort_cb");
+        }
+    }
+  else
+    {
+      gtk_tree_model_sort_sort_level (tree_model_sort, priv->root,
+                                      TRUE, TRUE);
+    }
 }
 
 /* signal helpers */
@@ -2209,6 +2704,72 @@ gtk_tree_model_sort_get_model (GtkTreeModelSort *tree_model)
   return tree_model->priv->child_model;
 }
 
+/**
+ * gtk_tree_model_sort_set_incremental:
+ * @tree_model_sort: a #GtkTreeModelSort
+ * @incremental: %TRUE to sort incrementally
+ *
+ * Sets whether the toplevel rows of @tree_model_sort are sorted
+ * incrementally.
+ *
+ * When incremental sorting is enabled, changing the sort column or
+ * the sort function does not sort the toplevel rows right away. They
+ * are sorted in the background in short steps instead, and the model
+ * emits #GtkTreeModel::rows-reordered once when done. The order of
+ * the rows stays the same until then, so the model stays usable while
+ * sorting. Adding, removing or reordering toplevel rows of the child
+ * model restarts the sort, and so does changing the value a toplevel
+ * row is sorted by.
+ *
+ * This is useful for models with a lot of rows, where sorting would
+ * block the UI.
+ *
+ * When sorting by a string column with the default sort function, the
+ * collation keys of the strings are computed once per sort, whether
+ * sorting incrementally or not.
+ *
+ * By default, incremental sorting is disabled.
+ */
+void
+gtk_tree_model_sort_set_incremental (GtkTreeModelSort *tree_model_sort,
+                                     gboolean          incremental)
+{
+  GtkTreeModelSortPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TREE_MODEL_SORT (tree_model_sort));
+
+  priv = tree_model_sort->priv;
+  incremental = !!incremental;
+
+  if (priv->incremental == incremental)
+    return;
+
+  priv->incremental = incremental;
+
+  /* finish a pending sort right away */
+  if (!incremental && priv->sort_cb != 0)
+    gtk_tree_model_sort_run_sort (tree_model_sort, 0);
+
+  g_object_notify (G_OBJECT (tree_model_sort), "incremental");
+}
+
+/**
+ * gtk_tree_model_sort_get_incremental:
+ * @tree_model_sort: a #GtkTreeModelSort
+ *
+ * Returns whether incremental sorting was enabled via
+ * gtk_tree_model_sort_set_incremental().
+ *
+ * Returns: %TRUE if incremental sorting is enabled
+ */
+gboolean
+gtk_tree_model_sort_get_incremental (GtkTreeModelSort *tree_model_sort)
+{
+  g_return_val_if_fail (GTK_IS_TREE_MODEL_SORT (tree_model_sort), FALSE);
+
+  return tree_model_sort->priv->incremental;
+}
+
 
 static GtkTreePath *
 gtk_real_tree_model_sort_convert_child_path_to_path (GtkTreeModelSort *tree_model_sort,
@@ -2586,6 +3147,9 @@ gtk_tree_model_sort_free_level (GtkTreeModelSort *tree_model_sort,
 
   g_assert (sort_level);
 
+  if (sort_level == priv->root)
+    gtk_tree_model_sort_stop_sorting (tree_model_sort);
+
   end_siter = g_sequence_get_end_iter (sort_level->seq);
   for (siter = g_sequence_get_begin_iter (sort_level->seq);
        siter != end_siter;
@@ -84,6 +84,11 @@ void          gtk_tree_model_sort_clear_cache                (GtkTreeModelSort *
 GDK_AVAILABLE_IN_ALL
 gboolean      gtk_tree_model_sort_iter_is_valid              (GtkTreeModelSort *tree_model_sort,
                                                               GtkTreeIter      *iter);
+GDK_AVAILABLE_IN_ALL
+void          gtk_tree_model_sort_set_incremental            (GtkTreeModelSort *tree_model_sort,
+                                                              gboolean          incremental);
+GDK_AVAILABLE_IN_ALL
+gboolean      gtk_tree_model_sort_get_incremental            (GtkTreeModelSort *tree_model_sort);
 
 
 G_END_DECLS
@@ -3473,16 +3473,53 @@ gtk_widget_queue_draw (GtkWidget *widget)
     {
       GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-      if (priv->draw_needed)
+      /* A widget that only needs its effects redrawn still has its
+       * content node, and that one needs to go now, too. */
+      if (priv->draw_needed && priv->content_node == NULL)
         break;
 
       priv->draw_needed = TRUE;
       g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+      g_clear_pointer (&priv->content_node, gsk_render_node_unref);
       if (GTK_IS_NATIVE (widget) && _gtk_widget_get_realized (widget))
         gdk_surface_queue_render (gtk_native_get_surface (GTK_NATIVE (widget)));
     }
 }
 
+/*
+ * gtk_widget_queue_draw_effects:
+ * @widget: a #GtkWidget
+ *
+ * Like gtk_widget_queue_draw(), but for when only the opacity or the
+ * filter of @widget changed. The contents of @widget are kept, so the
+ * next snapshot only wraps them in new effect nodes instead of calling
+ * GtkWidgetClass.snapshot() for @widget and its children.
+ */
+static void
+gtk_widget_queue_draw_effects (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (!_gtk_widget_get_mapped (widget))
+    return;
+
+  if (priv->draw_needed)
+    return;
+
+  priv->draw_needed = TRUE;
+  g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+
+  if (GTK_IS_NATIVE (widget))
+    {
+      if (_gtk_widget_get_realized (widget))
+        gdk_surface_queue_render (gtk_native_get_surface (GTK_NATIVE (widget)));
+    }
+  else if (priv->parent)
+    {
+      gtk_widget_queue_draw (priv->parent);
+    }
+}
+
 static void
 gtk_widget_set_alloc_needed (GtkWidget *widget);
 /**
@@ -4876,14 +4913,24 @@ gtk_widget_real_css_changed (GtkWidget         *widget,
             }
           else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TRANSFORM))
             {
-              gtk_widget_queue_allocate (priv->parent);
+              /* The transform is computed when allocating us with our
+               * previous allocation, so there's no need to bother the
+               * parent's layout. It only needs to redraw us with the
+               * new transform. */
+              gtk_widget_set_alloc_needed (widget);
+              if (priv->parent)
+                gtk_widget_queue_draw (priv->parent);
             }
 
-          if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW) ||
+          if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW & ~GTK_CSS_AFFECTS_POSTEFFECT) ||
               (has_text && gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_CONTENT)))
             {
               gtk_widget_queue_draw (widget);
             }
+          else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_POSTEFFECT))
+            {
+              gtk_widget_queue_draw_effects (widget);
+            }
         }
     }
   else
@@ -10239,7 +10286,7 @@ gtk_widget_set_opacity (GtkWidget *widget,
 
   priv->user_alpha = alpha;
 
-  gtk_widget_queue_draw (widget);
+  gtk_widget_queue_draw_effects (widget);
 
   g_object_notify_by_pspec (G_OBJECT (widget), widget_props[PROP_OPACITY]);
 }
@@ -11353,12 +11400,41 @@ gtk_widget_list_controllers (GtkWidget           *widget,
 }
 
 static GskRenderNode *
-gtk_widget_create_render_node (GtkWidget   *widget,
-                               GtkSnapshot *snapshot)
+gtk_widget_create_content_node (GtkWidget   *widget,
+                                GtkSnapshot *snapshot)
 {
   GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (widget);
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkCssBoxes boxes;
+
+  gtk_css_boxes_init (&boxes, widget);
+
+  gtk_snapshot_push_collect (snapshot);
+
+  gtk_css_style_snapshot_background (&boxes, snapshot);
+  gtk_css_style_snapshot_border (&boxes, snapshot);
+
+  if (priv->overflow == GTK_OVERFLOW_HIDDEN)
+    {
+      gtk_snapshot_push_rounded_clip (snapshot, gtk_css_boxes_get_padding_box (&boxes));
+      klass->snapshot (widget, snapshot);
+      gtk_snapshot_pop (snapshot);
+    }
+  else
+    {
+      klass->snapshot (widget, snapshot);
+    }
+
+  gtk_css_style_snapshot_outline (&boxes, snapshot);
+
+  return gtk_snapshot_pop_collect (snapshot);
+}
+
+static GskRenderNode *
+gtk_widget_create_render_node (GtkWidget   *widget,
+                               GtkSnapshot *snapshot)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkCssValue *filter_value;
   double css_opacity, opacity;
   GtkCssStyle *style;
@@ -11371,7 +11447,8 @@ gtk_widget_create_render_node (GtkWidget   *widget,
   if (opacity <= 0.0)
     return NULL;
 
-  gtk_css_boxes_init (&boxes, widget);
+  if (priv->content_node == NULL)
+    priv->content_node = gtk_widget_create_content_node (widget, snapshot);
 
   gtk_snapshot_push_collect (snapshot);
   gtk_snapshot_push_debug (snapshot,
@@ -11384,21 +11461,8 @@ gtk_widget_create_render_node (GtkWidget   *widget,
   if (opacity < 1.0)
     gtk_snapshot_push_opacity (snapshot, opacity);
 
-  gtk_css_style_snapshot_background (&boxes, snapshot);
-  gtk_css_style_snapshot_border (&boxes, snapshot);
-
-  if (priv->overflow == GTK_OVERFLOW_HIDDEN)
-    {
-      gtk_snapshot_push_rounded_clip (snapshot, gtk_css_boxes_get_padding_box (&boxes));
-      klass->snapshot (widget, snapshot);
-      gtk_snapshot_pop (snapshot);
-    }
-  else
-    {
-      klass->snapshot (widget, snapshot);
-    }
-
-  gtk_css_style_snapshot_outline (&boxes, snapshot);
+  if (priv->content_node)
+    gtk_snapshot_append_node (snapshot, priv->content_node);
 
   if (opacity < 1.0)
     gtk_snapshot_pop (snapshot);
@@ -167,6 +167,9 @@ struct _GtkWidgetPrivate
 
   /* The render node we draw or %NULL if not yet created.*/
   GskRenderNode *render_node;
+  /* The part of render_node below opacity and filter, kept around so
+   * that changing only those doesn't need a new snapshot. */
+  GskRenderNode *content_node;
 
   /* The layout manager, or %NULL */
   GtkLayoutManager *layout_manager;
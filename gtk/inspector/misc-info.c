@@ -29,6 +29,7 @@
 #include "gtkframe.h"
 #include "gtkbutton.h"
 #include "gtkmenubutton.h"
+#include "gtkexpressionprivate.h"
 #include "gtkwidgetprivate.h"
 #include "gtkbinlayout.h"
 
@@ -45,6 +46,8 @@ struct _GtkInspectorMiscInfo
   GtkWidget *type_popover;
   GtkWidget *refcount_row;
   GtkWidget *refcount;
+  GtkWidget *expression_watches_row;
+  GtkWidget *expression_watches;
   GtkWidget *state_row;
   GtkWidget *state;
   GtkWidget *buildable_id_row;
@@ -300,6 +303,7 @@ static gboolean
 update_info (gpointer data)
 {
   GtkInspectorMiscInfo *sl = data;
+  guint n_properties, n_watches;
   char *tmp;
   GType gtype;
 
@@ -318,6 +322,12 @@ update_info (gpointer data)
       tmp = g_strdup_printf ("%d", sl->object->ref_count);
       gtk_label_set_text (GTK_LABEL (sl->refcount), tmp);
       g_free (tmp);
+
+      gtk_expression_get_watch_counts (sl->object, &n_properties, &n_watches);
+      tmp = g_strdup_printf (dngettext (GETTEXT_PACKAGE, "%u on %u property", "%u on %u properties", n_properties),
+                             n_watches, n_properties);
+      gtk_label_set_text (GTK_LABEL (sl->expression_watches), tmp);
+      g_free (tmp);
     }
 
   if (GTK_IS_WIDGET (sl->object))
@@ -532,6 +542,8 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, type);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, refcount_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, refcount);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, expression_watches_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, expression_watches);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, state_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, state);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, buildable_id_row);
@@ -267,6 +267,92 @@ memory_format_from_pix_fmt (enum AVPixelFormat pix_fmt)
     }
 }
 
+/* GdkMemoryTexture's YUV formats use BT.601 limited range, so only
+ * frames in that colorimetry can be passed on without converting.
+ * Like most players, we assume HD content without colorspace
+ * information to be BT.709.
+ */
+static gboolean
+gtk_ff_media_file_frame_is_bt601 (AVFrame *frame)
+{
+  if (frame->color_range == AVCOL_RANGE_JPEG)
+    return FALSE;
+
+  switch (frame->colorspace)
+    {
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+      return TRUE;
+
+    case AVCOL_SPC_UNSPECIFIED:
+      return frame->height < 720;
+
+    default:
+      return FALSE;
+    }
+}
+
+/* Copies the planes of a 4:2:0 frame into the layout GdkMemoryTexture
+ * expects, so we don't need to convert it to RGB with swscale.
+ */
+static GdkTexture *
+gtk_ff_media_file_texture_from_yuv_frame (GtkFfMediaFile *video,
+                                          AVFrame        *frame)
+{
+  GdkTexture *texture;
+  GdkMemoryFormat format;
+  int width, height, chroma_height;
+  gsize stride, chroma_stride, chroma_bytes, size;
+  guint n_planes, i;
+  GBytes *bytes;
+  guchar *data, *dest;
+  int y;
+
+  width = video->codec_ctx->width;
+  height = video->codec_ctx->height;
+  chroma_height = (height + 1) / 2;
+  /* the interleaved NV12 chroma rows need an even stride */
+  stride = (width + 1) & ~1;
+
+  if (frame->format == AV_PIX_FMT_NV12)
+    {
+      format = GDK_MEMORY_NV12;
+      n_planes = 2;
+      chroma_stride = stride;
+      chroma_bytes = stride;
+    }
+  else
+    {
+      format = GDK_MEMORY_I420;
+      n_planes = 3;
+      chroma_stride = (stride + 1) / 2;
+      chroma_bytes = (width + 1) / 2;
+    }
+
+  size = stride * height + (n_planes - 1) * chroma_stride * chroma_height;
+  data = g_try_malloc (size);
+  if (data == NULL)
+    return NULL;
+
+  dest = data;
+  for (y = 0; y < height; y++)
+    memcpy (dest + y * stride, frame->data[0] + y * frame->linesize[0], width);
+  dest += stride * height;
+
+  for (i = 1; i < n_planes; i++)
+    {
+      for (y = 0; y < chroma_height; y++)
+        memcpy (dest + y * chroma_stride, frame->data[i] + y * frame->linesize[i], chroma_bytes);
+      dest += chroma_stride * chroma_height;
+    }
+
+  bytes = g_bytes_new_take (data, size);
+  texture = gdk_memory_texture_new (width, height, format, bytes, stride);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
 static gboolean
 gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
                                 GtkVideoFrameFFMpeg *result)
@@ -313,6 +399,32 @@ gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
       return FALSE;
     }
 
+  if ((frame->format == AV_PIX_FMT_YUV420P ||
+       frame->format == AV_PIX_FMT_NV12) &&
+      gtk_ff_media_file_frame_is_bt601 (frame))
+    {
+      texture = gtk_ff_media_file_texture_from_yuv_frame (video, frame);
+      if (texture == NULL)
+        {
+          gtk_media_stream_error (GTK_MEDIA_STREAM (video),
+                                  G_IO_ERROR,
+                                  G_IO_ERROR_FAILED,
+                                  _("Not enough memory"));
+          av_frame_free (&frame);
+          return FALSE;
+        }
+
+      gtk_video_frame_ffmpeg_init (result,
+                                   texture,
+                                   av_rescale_q (frame->best_effort_timestamp,
+                                                 video->format_ctx->streams[video->stream_id]->time_base,
+                                                 (AVRational) { 1, G_USEC_PER_SEC }));
+
+      av_frame_free (&frame);
+
+      return TRUE;
+    }
+
   data = g_try_malloc0 (video->codec_ctx->width * video->codec_ctx->height * 4);
   if (data == NULL)
     {
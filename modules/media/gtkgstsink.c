@@ -50,7 +50,13 @@ GST_DEBUG_CATEGORY (gtk_debug_gst_sink);
 
 #define FORMATS "{ BGRA, ARGB, RGBA, ABGR, RGB, BGR }"
 
-#define NOGL_CAPS GST_VIDEO_CAPS_MAKE (FORMATS)
+/* GdkMemoryTexture only knows BT.601 limited range YUV, so other
+ * colorimetries need to be converted to RGB upstream.
+ */
+#define YUV_FORMATS "{ NV12, I420 }"
+
+#define NOGL_CAPS GST_VIDEO_CAPS_MAKE (FORMATS) "; " \
+                  GST_VIDEO_CAPS_MAKE (YUV_FORMATS) ", colorimetry = (string) bt601"
 
 static GstStaticPadTemplate gtk_gst_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
@@ -147,6 +153,14 @@ gtk_gst_sink_set_caps (GstBaseSink *bsink,
   if (!gst_video_info_from_caps (&self->v_info, caps))
     return FALSE;
 
+  if (GST_VIDEO_INFO_IS_YUV (&self->v_info) &&
+      (GST_VIDEO_INFO_COLORIMETRY (&self->v_info).matrix != GST_VIDEO_COLOR_MATRIX_BT601 ||
+       GST_VIDEO_INFO_COLORIMETRY (&self->v_info).range != GST_VIDEO_COLOR_RANGE_16_235))
+    {
+      GST_DEBUG_OBJECT (self, "unsupported colorimetry");
+      return FALSE;
+    }
+
   return TRUE;
 }
 
@@ -247,6 +261,10 @@ gtk_gst_memory_format_from_video (GstVideoFormat format)
       return GDK_MEMORY_R8G8B8;
     case GST_VIDEO_FORMAT_BGR:
       return GDK_MEMORY_B8G8R8;
+    case GST_VIDEO_FORMAT_NV12:
+      return GDK_MEMORY_NV12;
+    case GST_VIDEO_FORMAT_I420:
+      return GDK_MEMORY_I420;
     default:
       g_assert_not_reached ();
       return GDK_MEMORY_A8R8G8B8;
@@ -260,6 +278,61 @@ video_frame_free (GstVideoFrame *frame)
   g_free (frame);
 }
 
+/* GdkMemoryTexture expects the planes of planar formats to follow
+ * each other with fixed strides, see the GdkMemoryFormat docs.
+ * Frames that are laid out differently get their planes copied,
+ * which is still a lot cheaper than converting them to RGB.
+ */
+static GBytes *
+gtk_gst_sink_bytes_from_planar_frame (GstVideoFrame *frame)
+{
+  guint n_planes = GST_VIDEO_FRAME_N_PLANES (frame);
+  gsize stride[3], height[3], offset[3], size;
+  gboolean contiguous;
+  guchar *data;
+  guint i, y;
+
+  height[0] = GST_VIDEO_FRAME_HEIGHT (frame);
+  stride[0] = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  offset[0] = 0;
+  contiguous = TRUE;
+
+  for (i = 1; i < n_planes; i++)
+    {
+      height[i] = (height[0] + 1) / 2;
+      stride[i] = n_planes == 2 ? stride[0] : (stride[0] + 1) / 2;
+      offset[i] = offset[i - 1] + stride[i - 1] * height[i - 1];
+
+      if ((guchar *) GST_VIDEO_FRAME_PLANE_DATA (frame, i) != (guchar *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) + offset[i] ||
+          GST_VIDEO_FRAME_PLANE_STRIDE (frame, i) != stride[i])
+        contiguous = FALSE;
+    }
+
+  size = offset[n_planes - 1] + stride[n_planes - 1] * height[n_planes - 1];
+
+  if (contiguous)
+    return g_bytes_new_with_free_func (GST_VIDEO_FRAME_PLANE_DATA (frame, 0),
+                                       size,
+                                       (GDestroyNotify) video_frame_free,
+                                       frame);
+
+  data = g_malloc (size);
+  for (i = 0; i < n_planes; i++)
+    {
+      const guchar *plane = GST_VIDEO_FRAME_PLANE_DATA (frame, i);
+      gsize plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, i);
+
+      for (y = 0; y < height[i]; y++)
+        memcpy (data + offset[i] + y * stride[i],
+                plane + y * plane_stride,
+                MIN (stride[i], plane_stride));
+    }
+
+  video_frame_free (frame);
+
+  return g_bytes_new_take (data, size);
+}
+
 static GdkTexture *
 gtk_gst_sink_texture_from_buffer (GtkGstSink *self,
                                   GstBuffer  *buffer,
@@ -290,20 +363,33 @@ gtk_gst_sink_texture_from_buffer (GtkGstSink *self,
     }
   else if (gst_video_frame_map (frame, &self->v_info, buffer, GST_MAP_READ))
     {
+      GdkMemoryFormat format;
       GBytes *bytes;
-
-      bytes = g_bytes_new_with_free_func (frame->data[0],
-                                          frame->info.height * frame->info.stride[0],
-                                          (GDestroyNotify) video_frame_free,
-                                          frame);
-      texture = gdk_memory_texture_new (frame->info.width,
-                                        frame->info.height,
-                                        gtk_gst_memory_format_from_video (GST_VIDEO_FRAME_FORMAT (frame)),
+      int width, height, stride;
+      double par;
+
+      format = gtk_gst_memory_format_from_video (GST_VIDEO_FRAME_FORMAT (frame));
+      width = frame->info.width;
+      height = frame->info.height;
+      stride = frame->info.stride[0];
+      par = ((double) frame->info.par_n) / ((double) frame->info.par_d);
+
+      /* frame is freed with the bytes */
+      if (GST_VIDEO_INFO_IS_YUV (&frame->info))
+        bytes = gtk_gst_sink_bytes_from_planar_frame (frame);
+      else
+        bytes = g_bytes_new_with_free_func (frame->data[0],
+                                            frame->info.height * frame->info.stride[0],
+                                            (GDestroyNotify) video_frame_free,
+                                            frame);
+      texture = gdk_memory_texture_new (width,
+                                        height,
+                                        format,
                                         bytes,
-                                        frame->info.stride[0]);
+                                        stride);
       g_bytes_unref (bytes);
 
-      *pixel_aspect_ratio = ((double) frame->info.par_n) / ((double) frame->info.par_d);
+      *pixel_aspect_ratio = par;
     }
   else
     {
@@ -1,6 +1,7 @@
 /* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
 
 #include <gsk/gskcairoblurprivate.h>
+#include <stdlib.h>
 
 static void
 init_surface (cairo_t *cr)
@@ -16,38 +17,60 @@ init_surface (cairo_t *cr)
   cairo_fill (cr);
 }
 
-int
-main (int argc, char **argv)
+static void
+run_benchmark (GTimer       *timer,
+               int           size,
+               GskBlurFlags  flags,
+               const char   *name)
 {
   cairo_surface_t *surface;
   cairo_t *cr;
-  GTimer *timer;
   double msec;
   int i, j;
-  int size;
-
-  timer = g_timer_new ();
-
-  size = 2000;
 
   surface = cairo_image_surface_create (CAIRO_FORMAT_A8, size, size);
 
   cr = cairo_create (surface);
 
-  /* We do everything three times, first two as warmup */
+  g_print ("%dx%d, %s\n", size, size, name);
+
+  /* We do everything twice, first as warmup */
   for (j = 0; j < 2; j++)
     {
       for (i = 1; i < 16; i++)
 	{
 	  init_surface (cr);
 	  g_timer_start (timer);
-	  gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
+	  gsk_cairo_blur_surface (surface, i, flags);
 	  msec = g_timer_elapsed (timer, NULL) * 1000;
 	  if (j == 1)
-	    g_print ("Radius %2d: %.2f msec, %.2f kpixels/msec:\n", i, msec, size*size/(msec*1000));
+	    g_print ("Radius %2d: %.2f msec, %.2f MB/s\n", i, msec, size*size/(msec*1000));
 	}
     }
 
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+}
+
+int
+main (int argc, char **argv)
+{
+  GTimer *timer;
+  int size;
+
+  timer = g_timer_new ();
+
+  size = 2000;
+  if (argc > 1)
+    size = atoi (argv[1]);
+
+  run_benchmark (timer, size, GSK_BLUR_X | GSK_BLUR_Y, "both directions");
+  run_benchmark (timer, size, GSK_BLUR_X, "horizontal");
+  run_benchmark (timer, size, GSK_BLUR_Y, "vertical");
+
+  /* Typical box shadow sizes, these don't use the parallel path */
+  run_benchmark (timer, 200, GSK_BLUR_X | GSK_BLUR_Y, "both directions");
+
   g_timer_destroy (timer);
 
   return 0;
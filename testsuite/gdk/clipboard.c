@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include <gtk/gtk.h>
 
@@ -70,6 +71,204 @@ test_clipboard_basic (void)
   g_value_unset (&value);
 }
 
+/* The serialized payload is a G_TYPE_UINT with its size */
+#define PAYLOAD_A "application/x-gdk-test-payload-a"
+#define PAYLOAD_B "application/x-gdk-test-payload-b"
+#define PAYLOAD_C "application/x-gdk-test-payload-c"
+
+static guint n_serialized[3];
+
+static GBytes *
+payload_new (const char *mime_type,
+             guint       size)
+{
+  guchar *data;
+  guint i;
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = i * 7 + mime_type[strlen (mime_type) - 1];
+
+  return g_bytes_new_take (data, size);
+}
+
+static void
+payload_written (GObject      *stream,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GdkContentSerializer *serializer = user_data;
+  GError *error = NULL;
+
+  if (g_output_stream_write_all_finish (G_OUTPUT_STREAM (stream), result, NULL, &error))
+    gdk_content_serializer_return_success (serializer);
+  else
+    gdk_content_serializer_return_error (serializer, error);
+}
+
+static void
+serialize_payload (GdkContentSerializer *serializer)
+{
+  const char *mime_type = gdk_content_serializer_get_mime_type (serializer);
+  guint *counter = gdk_content_serializer_get_user_data (serializer);
+  GBytes *bytes;
+
+  (*counter)++;
+
+  bytes = payload_new (mime_type, g_value_get_uint (gdk_content_serializer_get_value (serializer)));
+  gdk_content_serializer_set_task_data (serializer, bytes, (GDestroyNotify) g_bytes_unref);
+  g_output_stream_write_all_async (gdk_content_serializer_get_output_stream (serializer),
+                                   g_bytes_get_data (bytes, NULL),
+                                   g_bytes_get_size (bytes),
+                                   gdk_content_serializer_get_priority (serializer),
+                                   gdk_content_serializer_get_cancellable (serializer),
+                                   payload_written,
+                                   serializer);
+}
+
+static void
+payload_spliced (GObject      *stream,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  GError *error = NULL;
+
+  g_output_stream_splice_finish (G_OUTPUT_STREAM (stream), result, &error);
+  g_assert_no_error (error);
+
+  *(gboolean *) data = TRUE;
+}
+
+static void
+payload_received (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      data)
+{
+  GOutputStream *output = data;
+  GInputStream *input;
+  GError *error = NULL;
+
+  input = gdk_clipboard_read_finish (GDK_CLIPBOARD (source), result, NULL, &error);
+  g_assert_no_error (error);
+
+  g_output_stream_splice_async (output,
+                                input,
+                                G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                G_PRIORITY_DEFAULT,
+                                NULL,
+                                payload_spliced,
+                                g_object_get_data (G_OBJECT (output), "done"));
+  g_object_unref (input);
+}
+
+/* Reads @mime_type from @clipboard and checks that the payload
+ * arrives unchanged
+ */
+static void
+read_payload (GdkClipboard *clipboard,
+              const char   *mime_type,
+              guint         size)
+{
+  GOutputStream *output;
+  GBytes *bytes, *expected;
+  gboolean done = FALSE;
+
+  output = g_memory_output_stream_new_resizable ();
+  g_object_set_data (G_OBJECT (output), "done", &done);
+  gdk_clipboard_read_async (clipboard,
+                            (const char *[2]) { mime_type, NULL },
+                            G_PRIORITY_DEFAULT,
+                            NULL,
+                            payload_received,
+                            output);
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+  expected = payload_new (mime_type, size);
+  g_assert_true (g_bytes_equal (bytes, expected));
+
+  g_bytes_unref (expected);
+  g_bytes_unref (bytes);
+  g_object_unref (output);
+}
+
+static void
+set_payload (GdkClipboard *clipboard,
+             guint         size)
+{
+  GdkContentProvider *content;
+  GValue value = G_VALUE_INIT;
+
+  g_value_init (&value, G_TYPE_UINT);
+  g_value_set_uint (&value, size);
+  content = gdk_content_provider_new_for_value (&value);
+  gdk_clipboard_set_content (clipboard, content);
+  g_object_unref (content);
+  g_value_unset (&value);
+
+  memset (n_serialized, 0, sizeof (n_serialized));
+}
+
+static void
+test_clipboard_serialize_cache (void)
+{
+  GdkClipboard *clipboard;
+
+  clipboard = gdk_display_get_clipboard (gdk_display_get_default ());
+
+  /* Reading the same format twice only serializes once */
+  set_payload (clipboard, 1024 * 1024 + 1);
+  read_payload (clipboard, PAYLOAD_A, 1024 * 1024 + 1);
+  g_assert_cmpuint (n_serialized[0], ==, 1);
+  read_payload (clipboard, PAYLOAD_A, 1024 * 1024 + 1);
+  g_assert_cmpuint (n_serialized[0], ==, 1);
+
+  read_payload (clipboard, PAYLOAD_B, 1024 * 1024 + 1);
+  g_assert_cmpuint (n_serialized[1], ==, 1);
+  g_assert_cmpuint (n_serialized[0], ==, 1);
+
+  /* New content gets serialized again */
+  set_payload (clipboard, 1024);
+  read_payload (clipboard, PAYLOAD_A, 1024);
+  g_assert_cmpuint (n_serialized[0], ==, 1);
+
+  gdk_clipboard_set_content (clipboard, NULL);
+}
+
+static void
+test_clipboard_serialize_cache_size (void)
+{
+  GdkClipboard *clipboard;
+  guint size = 24 * 1024 * 1024;
+
+  clipboard = gdk_display_get_clipboard (gdk_display_get_default ());
+  set_payload (clipboard, size);
+
+  read_payload (clipboard, PAYLOAD_A, size);
+  read_payload (clipboard, PAYLOAD_B, size);
+  read_payload (clipboard, PAYLOAD_A, size);
+  g_assert_cmpuint (n_serialized[0], ==, 1);
+  g_assert_cmpuint (n_serialized[1], ==, 1);
+
+  /* Only 2 of the payloads fit into the cache, the one that was
+   * cached first has to go.
+   */
+  read_payload (clipboard, PAYLOAD_C, size);
+  g_assert_cmpuint (n_serialized[2], ==, 1);
+
+  read_payload (clipboard, PAYLOAD_B, size);
+  read_payload (clipboard, PAYLOAD_C, size);
+  g_assert_cmpuint (n_serialized[1], ==, 1);
+  g_assert_cmpuint (n_serialized[2], ==, 1);
+
+  read_payload (clipboard, PAYLOAD_A, size);
+  g_assert_cmpuint (n_serialized[0], ==, 2);
+
+  gdk_clipboard_set_content (clipboard, NULL);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -77,7 +276,13 @@ main (int argc, char *argv[])
 
   gtk_init ();
 
+  gdk_content_register_serializer (G_TYPE_UINT, PAYLOAD_A, serialize_payload, &n_serialized[0], NULL);
+  gdk_content_register_serializer (G_TYPE_UINT, PAYLOAD_B, serialize_payload, &n_serialized[1], NULL);
+  gdk_content_register_serializer (G_TYPE_UINT, PAYLOAD_C, serialize_payload, &n_serialized[2], NULL);
+
   g_test_add_func ("/clipboard/basic", test_clipboard_basic);
+  g_test_add_func ("/clipboard/serialize-cache", test_clipboard_serialize_cache);
+  g_test_add_func ("/clipboard/serialize-cache-size", test_clipboard_serialize_cache_size);
 
   return g_test_run ();
 }
@@ -44,6 +44,24 @@ static MemoryData tests[GDK_MEMORY_N_FORMATS] = {
   { 4, FALSE, { RGBA(FF,FF,00,00), RGBA(FF,00,FF,00), RGBA(FF,00,00,FF), RGBA(00,00,00,00), RGBA(AA,99,33,66) } },
   { 3, TRUE,  { RGBA(00,00,FF,00), RGBA(00,FF,00,00), RGBA(FF,00,00,00), RGBA(00,00,00,00), RGBA(44,22,66,00) } },
   { 3, TRUE,  { RGBA(FF,00,00,00), RGBA(00,FF,00,00), RGBA(00,00,FF,00), RGBA(00,00,00,00), RGBA(66,22,44,00) } },
+  /* planar formats are tested separately */
+  { 0, TRUE,  { RGBA(00,00,00,00), } },
+  { 0, TRUE,  { RGBA(00,00,00,00), } },
+};
+
+typedef struct _YuvData {
+  const char *name;
+  guchar yuv[3];
+  guchar rgb[3];
+} YuvData;
+
+/* BT.601, limited range */
+static const YuvData yuv_colors[] = {
+  { "black", { 0x10, 0x80, 0x80 }, { 0x00, 0x00, 0x00 } },
+  { "white", { 0xEB, 0x80, 0x80 }, { 0xFF, 0xFF, 0xFF } },
+  { "red",   { 0x51, 0x5A, 0xF0 }, { 0xFF, 0x00, 0x00 } },
+  { "green", { 0x91, 0x36, 0x22 }, { 0x00, 0xFF, 0x00 } },
+  { "blue",  { 0x29, 0xF0, 0x6E }, { 0x00, 0x00, 0xFF } },
 };
 
 static void
@@ -173,6 +191,158 @@ test_download_4x4_with_stride (gconstpointer data)
   g_object_unref (test);
 }
 
+/* @blocks holds the color of every 2x2 block of pixels, row by row */
+static GdkTexture *
+create_yuv_texture (GdkMemoryFormat  format,
+                    const YuvData  **blocks,
+                    int              width,
+                    int              height,
+                    gsize            stride)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  guchar *data;
+  gsize chroma_width, chroma_height, chroma_stride, size;
+  int x, y;
+
+  chroma_width = (width + 1) / 2;
+  chroma_height = (height + 1) / 2;
+  if (format == GDK_MEMORY_NV12)
+    {
+      chroma_stride = stride;
+      size = stride * height + chroma_stride * chroma_height;
+    }
+  else
+    {
+      chroma_stride = (stride + 1) / 2;
+      size = stride * height + 2 * chroma_stride * chroma_height;
+    }
+
+  data = g_malloc0 (size);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      data[y * stride + x] = blocks[(y / 2) * chroma_width + x / 2]->yuv[0];
+
+  for (y = 0; y < chroma_height; y++)
+    for (x = 0; x < chroma_width; x++)
+      {
+        const YuvData *color = blocks[y * chroma_width + x];
+
+        if (format == GDK_MEMORY_NV12)
+          {
+            data[stride * height + y * chroma_stride + 2 * x] = color->yuv[1];
+            data[stride * height + y * chroma_stride + 2 * x + 1] = color->yuv[2];
+          }
+        else
+          {
+            data[stride * height + y * chroma_stride + x] = color->yuv[1];
+            data[stride * height + (chroma_height + y) * chroma_stride + x] = color->yuv[2];
+          }
+      }
+
+  bytes = g_bytes_new_take (data, size);
+  texture = gdk_memory_texture_new (width, height, format, bytes, stride);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static void
+test_download_yuv (GdkMemoryFormat  format,
+                   const YuvData  **blocks,
+                   int              width,
+                   int              height,
+                   gsize            stride)
+{
+  GdkTexture *texture;
+  guchar *data;
+  int x, y;
+
+  texture = create_yuv_texture (format, blocks, width, height, stride);
+
+  data = g_malloc (width * height * 4);
+  gdk_texture_download (texture, data, width * 4);
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          const YuvData *color = blocks[(y / 2) * ((width + 1) / 2) + x / 2];
+          const guchar *pixel = &data[y * width * 4 + x * 4];
+          guint32 argb = *(guint32 *) pixel;
+
+          /* allow for rounding differences */
+          g_assert_cmpuint (argb >> 24, ==, 0xFF);
+          g_assert_cmpint (ABS ((int) ((argb >> 16) & 0xFF) - color->rgb[0]), <=, 2);
+          g_assert_cmpint (ABS ((int) ((argb >> 8) & 0xFF) - color->rgb[1]), <=, 2);
+          g_assert_cmpint (ABS ((int) (argb & 0xFF) - color->rgb[2]), <=, 2);
+        }
+    }
+
+  g_free (data);
+  g_object_unref (texture);
+}
+
+static void
+test_download_yuv_uniform (GdkMemoryFormat  format,
+                           const YuvData   *color,
+                           int              width,
+                           int              height,
+                           gsize            stride)
+{
+  const YuvData **blocks;
+  int i, n_blocks;
+
+  n_blocks = ((width + 1) / 2) * ((height + 1) / 2);
+  blocks = g_new (const YuvData *, n_blocks);
+  for (i = 0; i < n_blocks; i++)
+    blocks[i] = color;
+
+  test_download_yuv (format, blocks, width, height, stride);
+
+  g_free (blocks);
+}
+
+static void
+test_download_yuv_4x4 (gconstpointer data)
+{
+  const TestData *test_data = data;
+
+  test_download_yuv_uniform (test_data->format, &yuv_colors[test_data->color], 4, 4, 4);
+}
+
+static void
+test_download_yuv_odd_with_stride (gconstpointer data)
+{
+  const TestData *test_data = data;
+
+  test_download_yuv_uniform (test_data->format, &yuv_colors[test_data->color], 5, 3, 8);
+}
+
+/* Every 2x2 block gets a different color than its neighbors, so
+ * using the chroma of the wrong block or the wrong plane shows.
+ */
+static void
+test_download_yuv_pattern (gconstpointer data)
+{
+  const TestData *test_data = data;
+  const YuvData **blocks;
+  int x, y, chroma_width, chroma_height;
+
+  /* odd sizes for partial blocks at the right and bottom edges */
+  chroma_width = (7 + 1) / 2;
+  chroma_height = (5 + 1) / 2;
+  blocks = g_new (const YuvData *, chroma_width * chroma_height);
+  for (y = 0; y < chroma_height; y++)
+    for (x = 0; x < chroma_width; x++)
+      blocks[y * chroma_width + x] = &yuv_colors[(x + 2 * y) % G_N_ELEMENTS (yuv_colors)];
+
+  test_download_yuv (test_data->format, blocks, 7, 5, 9);
+
+  g_free (blocks);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -186,6 +356,42 @@ main (int argc, char *argv[])
 
   for (format = 0; format < GDK_MEMORY_N_FORMATS; format++)
     {
+      if (format == GDK_MEMORY_NV12 || format == GDK_MEMORY_I420)
+        {
+          TestData *test_data;
+          char *test_name;
+
+          for (color = 0; color < G_N_ELEMENTS (yuv_colors); color++)
+            {
+              test_data = g_new (TestData, 1);
+              test_name = g_strdup_printf ("/memorytexture/download_4x4/%s/%s",
+                                           g_enum_get_value (enum_class, format)->value_nick,
+                                           yuv_colors[color].name);
+              test_data->format = format;
+              test_data->color = color;
+              g_test_add_data_func_full (test_name, test_data, test_download_yuv_4x4, g_free);
+              g_free (test_name);
+
+              test_data = g_new (TestData, 1);
+              test_name = g_strdup_printf ("/memorytexture/download_odd_with_stride/%s/%s",
+                                           g_enum_get_value (enum_class, format)->value_nick,
+                                           yuv_colors[color].name);
+              test_data->format = format;
+              test_data->color = color;
+              g_test_add_data_func_full (test_name, test_data, test_download_yuv_odd_with_stride, g_free);
+              g_free (test_name);
+            }
+
+          test_data = g_new (TestData, 1);
+          test_name = g_strdup_printf ("/memorytexture/download_pattern/%s",
+                                       g_enum_get_value (enum_class, format)->value_nick);
+          test_data->format = format;
+          test_data->color = 0;
+          g_test_add_data_func_full (test_name, test_data, test_download_yuv_pattern, g_free);
+          g_free (test_name);
+          continue;
+        }
+
       for (color = 0; color < N_COLORS; color++)
         {
           TestData *test_data = g_new (TestData, 1);
@@ -226,5 +432,6 @@ main (int argc, char *argv[])
         }
     }
 
+
   return g_test_run ();
 }
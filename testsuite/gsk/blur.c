@@ -0,0 +1,205 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <gsk/gskcairoblurprivate.h>
+#include <math.h>
+#include <string.h>
+
+/* One box blur pass over @n values that are @step bytes apart,
+ * summing up every window separately. This is what the sliding
+ * window in gskcairoblur.c computes, written the slow way.
+ */
+static void
+reference_box_pass (guchar *data,
+                    int     n,
+                    int     step,
+                    int     d,
+                    int     shift)
+{
+  guchar *result;
+  int offset;
+  int i, k;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  result = g_malloc (n);
+
+  for (i = 0; i < n; i++)
+    {
+      int sum = 0;
+
+      for (k = i + offset - d + 1; k <= i + offset; k++)
+        {
+          if (k >= 0 && k < n)
+            sum += data[k * step];
+        }
+
+      result[i] = (sum + d / 2) / d;
+    }
+
+  for (i = 0; i < n; i++)
+    data[i * step] = result[i];
+
+  g_free (result);
+}
+
+static void
+reference_box_blur (guchar *data,
+                    int     n,
+                    int     step,
+                    int     d)
+{
+  if (d % 2 == 1)
+    {
+      reference_box_pass (data, n, step, d, 0);
+      reference_box_pass (data, n, step, d, 0);
+      reference_box_pass (data, n, step, d, 0);
+    }
+  else
+    {
+      reference_box_pass (data, n, step, d, 1);
+      reference_box_pass (data, n, step, d, -1);
+      reference_box_pass (data, n, step, d + 1, 0);
+    }
+}
+
+/* The whole stride is blurred, and columns before rows */
+static void
+reference_blur (guchar       *data,
+                int           stride,
+                int           height,
+                int           radius,
+                GskBlurFlags  flags)
+{
+  int d = (int) (3.0 * sqrt (2 * G_PI) / 4 * radius);
+  int i;
+
+  if (flags & GSK_BLUR_Y)
+    {
+      for (i = 0; i < stride; i++)
+        reference_box_blur (data + i, height, stride, d);
+    }
+
+  if (flags & GSK_BLUR_X)
+    {
+      for (i = 0; i < height; i++)
+        reference_box_blur (data + i * stride, stride, 1, d);
+    }
+}
+
+static void
+check_blur (int          width,
+            int          height,
+            int          radius,
+            GskBlurFlags flags)
+{
+  cairo_surface_t *surface;
+  guchar *data, *expected;
+  int stride, x, y;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, width, height);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < stride; x++)
+      data[y * stride + x] = g_test_rand_int_range (0, 256);
+  cairo_surface_mark_dirty (surface);
+
+  expected = g_malloc (stride * height);
+  memcpy (expected, data, stride * height);
+  reference_blur (expected, stride, height, radius, flags);
+
+  gsk_cairo_blur_surface (surface, radius, flags);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < stride; x++)
+      {
+        if (data[y * stride + x] != expected[y * stride + x])
+          {
+            g_test_message ("%dx%d, radius %d, flags %d: pixel %d,%d is %u, expected %u",
+                            width, height, radius, flags, x, y,
+                            data[y * stride + x], expected[y * stride + x]);
+            g_test_fail ();
+            goto out;
+          }
+      }
+
+out:
+  g_free (expected);
+  cairo_surface_destroy (surface);
+}
+
+static const GskBlurFlags blur_flags[] = {
+  GSK_BLUR_X,
+  GSK_BLUR_Y,
+  GSK_BLUR_X | GSK_BLUR_Y,
+};
+
+static void
+test_blur_reference (void)
+{
+  /* Sizes around the 64 column strips the vertical pass works in,
+   * and radii using both the unrolled box sizes and the generic ones.
+   */
+  static const struct {
+    int width;
+    int height;
+  } sizes[] = {
+    { 1, 1 },
+    { 7, 5 },
+    { 64, 3 },
+    { 65, 70 },
+    { 130, 20 },
+    { 200, 129 },
+  };
+  static const int radii[] = { 2, 3, 4, 7, 10, 17, 40 };
+  guint i, j, k;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    for (j = 0; j < G_N_ELEMENTS (radii); j++)
+      for (k = 0; k < G_N_ELEMENTS (blur_flags); k++)
+        check_blur (sizes[i].width, sizes[i].height, radii[j], blur_flags[k]);
+}
+
+/* Large enough to be split up between threads */
+static void
+test_blur_reference_large (void)
+{
+  static const int radii[] = { 2, 10, 17 };
+  guint j, k;
+
+  for (j = 0; j < G_N_ELEMENTS (radii); j++)
+    for (k = 0; k < G_N_ELEMENTS (blur_flags); k++)
+      check_blur (601, 520, radii[j], blur_flags[k]);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/blur/reference", test_blur_reference);
+  g_test_add_func ("/blur/reference-large", test_blur_reference_large);
+
+  return g_test_run ();
+}
@@ -2505,6 +2505,403 @@ test_expressions (void)
     }
 }
 
+static int label_changed_count;
+
+G_MODULE_EXPORT void
+builder_list_item_label_changed (GtkLabel    *label,
+                                 GParamSpec  *pspec,
+                                 GtkListItem *list_item)
+{
+  g_assert_true (GTK_IS_LIST_ITEM (list_item));
+
+  label_changed_count++;
+}
+
+static void
+check_list_item_factory (const char *ui,
+                         const char *css_class)
+{
+  GtkStringList *strings;
+  GtkListItemFactory *factory;
+  GtkWidget *window, *list, *row, *box, *label, *copy;
+  GBytes *bytes;
+  const char *expected;
+
+  strings = gtk_string_list_new ((const char *[]) { "a", "b", NULL });
+  bytes = g_bytes_new_static (ui, strlen (ui));
+  factory = gtk_builder_list_item_factory_new_from_bytes (NULL, bytes);
+  g_bytes_unref (bytes);
+
+  label_changed_count = 0;
+  list = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (strings))), factory);
+  /* Rows are only set up once they are rooted */
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), list);
+
+  expected = "a";
+  for (row = gtk_widget_get_first_child (list);
+       row != NULL;
+       row = gtk_widget_get_next_sibling (row))
+    {
+      box = gtk_widget_get_first_child (row);
+      g_assert_true (GTK_IS_BOX (box));
+
+      label = gtk_widget_get_first_child (box);
+      g_assert_true (GTK_IS_LABEL (label));
+      g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, expected);
+      g_assert_cmpfloat (gtk_label_get_xalign (GTK_LABEL (label)), ==, 0.0);
+      g_assert_cmpstr (gtk_buildable_get_buildable_id (GTK_BUILDABLE (label)), ==, "label");
+      if (css_class)
+        g_assert_true (gtk_widget_has_css_class (label, css_class));
+
+      copy = gtk_widget_get_next_sibling (label);
+      g_assert_true (GTK_IS_LABEL (copy));
+      g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (copy)), ==, expected);
+
+      expected = "b";
+    }
+
+  g_assert_cmpstr (expected, ==, "b");
+  g_assert_cmpint (label_changed_count, >=, 2);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+static void
+test_list_item_factory (void)
+{
+#define LIST_ITEM_TEMPLATE(label_extra) \
+    "<interface>" \
+    "  <template class='GtkListItem'>" \
+    "    <property name='child'>" \
+    "      <object class='GtkBox'>" \
+    "        <child>" \
+    "          <object class='GtkLabel' id='label'>" \
+    "            <property name='xalign'>0</property>" \
+    "            <binding name='label'>" \
+    "              <lookup name='string' type='GtkStringObject'>" \
+    "                <lookup name='item'>GtkListItem</lookup>" \
+    "              </lookup>" \
+    "            </binding>" \
+    "            <signal name='notify::label' handler='builder_list_item_label_changed'/>" \
+    label_extra \
+    "          </object>" \
+    "        </child>" \
+    "        <child>" \
+    "          <object class='GtkLabel'>" \
+    "            <property name='label' bind-source='label' bind-property='label' bind-flags='sync-create'/>" \
+    "          </object>" \
+    "        </child>" \
+    "      </object>" \
+    "    </property>" \
+    "  </template>" \
+    "</interface>"
+
+  /* Set up without GtkBuilder */
+  check_list_item_factory (LIST_ITEM_TEMPLATE (""), NULL);
+  /* Custom tags need GtkBuilder */
+  check_list_item_factory (LIST_ITEM_TEMPLATE ("<style><class name='custom'/></style>"), "custom");
+
+#undef LIST_ITEM_TEMPLATE
+}
+
+static void
+test_nested_list_item_factory (void)
+{
+  const char *ui =
+    "<interface>"
+    "  <template class='GtkListItem'>"
+    "    <property name='child'>"
+    "      <object class='GtkListView'>"
+    "        <property name='factory'>"
+    "          <object class='GtkBuilderListItemFactory'>"
+    "            <property name='bytes'><![CDATA["
+    "<interface>"
+    "  <template class='GtkListItem'>"
+    "    <property name='child'>"
+    "      <object class='GtkLabel'>"
+    "        <signal name='notify::label' handler='nested_label_changed'/>"
+    "      </object>"
+    "    </property>"
+    "  </template>"
+    "</interface>"
+    "]]></property>"
+    "          </object>"
+    "        </property>"
+    "      </object>"
+    "    </property>"
+    "  </template>"
+    "</interface>";
+  GtkBuilderScope *scope;
+  GtkStringList *strings;
+  GtkListItemFactory *factory, *nested;
+  GtkWidget *window, *list, *row, *nested_list;
+  GtkSelectionModel *model;
+  GBytes *bytes;
+  guint n_rows;
+
+  /* Only this scope knows the handler of the nested template */
+  scope = gtk_builder_cscope_new ();
+  gtk_builder_cscope_add_callback_symbol (GTK_BUILDER_CSCOPE (scope),
+                                          "nested_label_changed",
+                                          G_CALLBACK (builder_list_item_label_changed));
+
+  strings = gtk_string_list_new ((const char *[]) { "a", "b", NULL });
+  bytes = g_bytes_new_static (ui, strlen (ui));
+  factory = gtk_builder_list_item_factory_new_from_bytes (scope, bytes);
+  g_bytes_unref (bytes);
+
+  list = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (strings))), factory);
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), list);
+
+  n_rows = 0;
+  for (row = gtk_widget_get_first_child (list);
+       row != NULL;
+       row = gtk_widget_get_next_sibling (row))
+    {
+      nested_list = gtk_widget_get_first_child (row);
+      g_assert_true (GTK_IS_LIST_VIEW (nested_list));
+
+      nested = gtk_list_view_get_factory (GTK_LIST_VIEW (nested_list));
+      g_assert_true (GTK_IS_BUILDER_LIST_ITEM_FACTORY (nested));
+      g_assert_true (gtk_builder_list_item_factory_get_scope (GTK_BUILDER_LIST_ITEM_FACTORY (nested)) == scope);
+
+      n_rows++;
+    }
+
+  g_assert_cmpuint (n_rows, ==, 2);
+
+  /* The nested factory resolves its handler through the scope */
+  nested_list = gtk_widget_get_first_child (gtk_widget_get_first_child (list));
+  model = GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (gtk_string_list_new ((const char *[]) { "c", NULL }))));
+  gtk_list_view_set_model (GTK_LIST_VIEW (nested_list), model);
+  g_object_unref (model);
+
+  row = gtk_widget_get_first_child (nested_list);
+  g_assert_nonnull (row);
+  g_assert_true (GTK_IS_LABEL (gtk_widget_get_first_child (row)));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (scope);
+}
+
+static void
+test_nested_list_item_factory_scope (void)
+{
+  const char *ui =
+    "<interface>"
+    "  <template class='GtkListItem'>"
+    "    <property name='child'>"
+    "      <object class='GtkListView'>"
+    "        <property name='factory'>"
+    "          <object class='GtkBuilderListItemFactory'>"
+    "            <property name='scope'>"
+    "              <object class='GtkBuilderCScope'/>"
+    "            </property>"
+    "            <property name='bytes'><![CDATA["
+    "<interface>"
+    "  <template class='GtkListItem'/>"
+    "</interface>"
+    "]]></property>"
+    "          </object>"
+    "        </property>"
+    "      </object>"
+    "    </property>"
+    "  </template>"
+    "</interface>";
+  GtkBuilderScope *scope, *nested_scope;
+  GtkStringList *strings;
+  GtkListItemFactory *factory, *nested;
+  GtkWidget *window, *list, *nested_list;
+  GBytes *bytes;
+
+  scope = gtk_builder_cscope_new ();
+  strings = gtk_string_list_new ((const char *[]) { "a", NULL });
+  bytes = g_bytes_new_static (ui, strlen (ui));
+  factory = gtk_builder_list_item_factory_new_from_bytes (scope, bytes);
+  g_bytes_unref (bytes);
+
+  list = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (strings))), factory);
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), list);
+
+  /* A scope set by the template wins over ours */
+  nested_list = gtk_widget_get_first_child (gtk_widget_get_first_child (list));
+  g_assert_true (GTK_IS_LIST_VIEW (nested_list));
+  nested = gtk_list_view_get_factory (GTK_LIST_VIEW (nested_list));
+  nested_scope = gtk_builder_list_item_factory_get_scope (GTK_BUILDER_LIST_ITEM_FACTORY (nested));
+  g_assert_true (GTK_IS_BUILDER_CSCOPE (nested_scope));
+  g_assert_true (nested_scope != scope);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (scope);
+}
+
+/* A box that looks up objects in the builder from its buildable hooks */
+#define TEST_TYPE_LOOKUP_BOX (test_lookup_box_get_type ())
+G_DECLARE_FINAL_TYPE (TestLookupBox, test_lookup_box, TEST, LOOKUP_BOX, GtkBox)
+
+struct _TestLookupBox
+{
+  GtkBox parent_instance;
+
+  GObject *added_target;
+  GObject *finished_target;
+  GObject *finished_template;
+};
+
+static GtkBuildableIface *test_lookup_box_parent_buildable_iface;
+
+static void
+test_lookup_box_buildable_add_child (GtkBuildable *buildable,
+                                     GtkBuilder   *builder,
+                                     GObject      *child,
+                                     const char   *type)
+{
+  TestLookupBox *self = TEST_LOOKUP_BOX (buildable);
+
+  self->added_target = gtk_builder_get_object (builder, "target");
+
+  test_lookup_box_parent_buildable_iface->add_child (buildable, builder, child, type);
+}
+
+static void
+test_lookup_box_buildable_parser_finished (GtkBuildable *buildable,
+                                           GtkBuilder   *builder)
+{
+  TestLookupBox *self = TEST_LOOKUP_BOX (buildable);
+
+  self->finished_target = gtk_builder_get_object (builder, "target");
+  self->finished_template = gtk_builder_get_object (builder, "GtkListItem");
+}
+
+static void
+test_lookup_box_buildable_init (GtkBuildableIface *iface)
+{
+  test_lookup_box_parent_buildable_iface = g_type_interface_peek_parent (iface);
+
+  iface->add_child = test_lookup_box_buildable_add_child;
+  iface->parser_finished = test_lookup_box_buildable_parser_finished;
+}
+
+G_DEFINE_TYPE_WITH_CODE (TestLookupBox, test_lookup_box, GTK_TYPE_BOX,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE,
+                                                test_lookup_box_buildable_init))
+
+static void
+test_lookup_box_class_init (TestLookupBoxClass *klass)
+{
+}
+
+static void
+test_lookup_box_init (TestLookupBox *self)
+{
+}
+
+static void
+test_list_item_factory_builder_lookup (void)
+{
+  const char *ui =
+    "<interface>"
+    "  <template class='GtkListItem'>"
+    "    <property name='child'>"
+    "      <object class='TestLookupBox'>"
+    "        <child>"
+    "          <object class='GtkLabel' id='target'/>"
+    "        </child>"
+    "      </object>"
+    "    </property>"
+    "  </template>"
+    "</interface>";
+  GtkStringList *strings;
+  GtkListItemFactory *factory;
+  GtkWidget *window, *list, *row;
+  GBytes *bytes;
+  guint n_rows;
+
+  g_type_ensure (TEST_TYPE_LOOKUP_BOX);
+
+  strings = gtk_string_list_new ((const char *[]) { "a", "b", NULL });
+  bytes = g_bytes_new_static (ui, strlen (ui));
+  factory = gtk_builder_list_item_factory_new_from_bytes (NULL, bytes);
+  g_bytes_unref (bytes);
+
+  list = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (strings))), factory);
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), list);
+
+  /* Every row finds its own objects */
+  n_rows = 0;
+  for (row = gtk_widget_get_first_child (list);
+       row != NULL;
+       row = gtk_widget_get_next_sibling (row))
+    {
+      TestLookupBox *box = TEST_LOOKUP_BOX (gtk_widget_get_first_child (row));
+      GObject *label = G_OBJECT (gtk_widget_get_first_child (GTK_WIDGET (box)));
+
+      g_assert_true (GTK_IS_LABEL (label));
+      g_assert_true (box->added_target == label);
+      g_assert_true (box->finished_target == label);
+      g_assert_true (GTK_IS_LIST_ITEM (box->finished_template));
+      g_assert_true (gtk_list_item_get_child (GTK_LIST_ITEM (box->finished_template)) == GTK_WIDGET (box));
+
+      n_rows++;
+    }
+
+  g_assert_cmpuint (n_rows, ==, 2);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+static void
+check_precompiled (const char *data,
+                   gsize       len,
+                   GQuark      domain,
+                   int         code)
+{
+  GtkBuilder *builder;
+  GError *error = NULL;
+
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, data, len, &error);
+  if (domain)
+    {
+      g_assert_error (error, domain, code);
+      g_error_free (error);
+    }
+  else
+    g_assert_no_error (error);
+
+  g_object_unref (builder);
+}
+
+static void
+test_precompiled (void)
+{
+#define CHECK_PRECOMPILED(data, domain, code) \
+  check_precompiled (data, sizeof (data) - 1, domain, code)
+
+  /* <interface/> */
+  CHECK_PRECOMPILED ("GBU\0\x01\x0ainterface\0\x00\x00\x00\x01", 0, 0);
+  /* Different format version */
+  CHECK_PRECOMPILED ("GBU\0\x02\x0ainterface\0\x00\x00\x00\x01", GTK_BUILDER_ERROR, GTK_BUILDER_ERROR_VERSION_MISMATCH);
+  /* String table past the end */
+  CHECK_PRECOMPILED ("GBU\0\x01\x7finterface\0", G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE);
+  /* String offset past the string table */
+  CHECK_PRECOMPILED ("GBU\0\x01\x0ainterface\0\x00\x20\x00\x01", G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE);
+  /* Truncated record */
+  CHECK_PRECOMPILED ("GBU\0\x01\x0ainterface\0\x00\x00", G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE);
+  /* More attributes than data */
+  CHECK_PRECOMPILED ("GBU\0\x01\x0ainterface\0\x00\x00\x7f\x00\x00\x01", G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE);
+  /* Unbalanced end element */
+  CHECK_PRECOMPILED ("GBU\0\x01\x0ainterface\0\x01", G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE);
+  /* Unclosed element */
+  CHECK_PRECOMPILED ("GBU\0\x01\x0ainterface\0\x00\x00\x00", G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE);
+
+#undef CHECK_PRECOMPILED
+}
+
 int
 main (int argc, char **argv)
 {
@@ -2552,6 +2949,11 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Shortcuts", test_shortcuts);
   g_test_add_func ("/Builder/Transforms", test_transforms);
   g_test_add_func ("/Builder/Expressions", test_expressions);
+  g_test_add_func ("/Builder/ListItemFactory", test_list_item_factory);
+  g_test_add_func ("/Builder/NestedListItemFactory", test_nested_list_item_factory);
+  g_test_add_func ("/Builder/NestedListItemFactoryScope", test_nested_list_item_factory_scope);
+  g_test_add_func ("/Builder/ListItemFactoryBuilderLookup", test_list_item_factory_builder_lookup);
+  g_test_add_func ("/Builder/Precompiled", test_precompiled);
 
   return g_test_run();
 }
@@ -0,0 +1,216 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+/* A widget that is 10 pixels wide per character of its item */
+#define TEST_TYPE_SIZED (test_sized_get_type ())
+G_DECLARE_FINAL_TYPE (TestSized, test_sized, TEST, SIZED, GtkWidget)
+
+struct _TestSized
+{
+  GtkWidget parent_instance;
+
+  int width;
+};
+
+G_DEFINE_TYPE (TestSized, test_sized, GTK_TYPE_WIDGET)
+
+static void
+test_sized_measure (GtkWidget      *widget,
+                    GtkOrientation  orientation,
+                    int             for_size,
+                    int            *minimum,
+                    int            *natural,
+                    int            *minimum_baseline,
+                    int            *natural_baseline)
+{
+  TestSized *self = TEST_SIZED (widget);
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    *minimum = *natural = self->width;
+  else
+    *minimum = *natural = 10;
+}
+
+static void
+test_sized_class_init (TestSizedClass *klass)
+{
+  GTK_WIDGET_CLASS (klass)->measure = test_sized_measure;
+}
+
+static void
+test_sized_init (TestSized *self)
+{
+}
+
+static GPtrArray *sized_widgets;
+
+static void
+setup_item (GtkSignalListItemFactory *factory,
+            GtkListItem              *list_item)
+{
+  GtkWidget *child = g_object_new (TEST_TYPE_SIZED, NULL);
+
+  g_ptr_array_add (sized_widgets, child);
+  gtk_list_item_set_child (list_item, child);
+}
+
+static void
+bind_item (GtkSignalListItemFactory *factory,
+           GtkListItem              *list_item)
+{
+  TestSized *child = TEST_SIZED (gtk_list_item_get_child (list_item));
+  GtkStringObject *item = gtk_list_item_get_item (list_item);
+
+  child->width = 10 * strlen (gtk_string_object_get_string (item));
+  gtk_widget_queue_resize (GTK_WIDGET (child));
+}
+
+static void
+after_paint (GdkFrameClock *clock,
+             gboolean      *done)
+{
+  *done = TRUE;
+}
+
+static void
+wait_for_layout (GtkWidget *widget)
+{
+  GdkFrameClock *clock = gtk_widget_get_frame_clock (widget);
+  gboolean done = FALSE;
+  gulong id;
+
+  id = g_signal_connect (clock, "after-paint", G_CALLBACK (after_paint), &done);
+  gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_LAYOUT);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+  g_signal_handler_disconnect (clock, id);
+}
+
+/* All visible cells of the column get the column's width */
+static int
+get_column_width (void)
+{
+  guint i;
+
+  for (i = 0; i < sized_widgets->len; i++)
+    {
+      GtkWidget *widget = g_ptr_array_index (sized_widgets, i);
+
+      if (gtk_widget_get_mapped (widget))
+        return gtk_widget_get_width (widget);
+    }
+
+  g_assert_not_reached ();
+  return 0;
+}
+
+/* Whether a visible cell shows an item that is @width pixels wide */
+static gboolean
+shows_item_of_width (int width)
+{
+  guint i;
+
+  for (i = 0; i < sized_widgets->len; i++)
+    {
+      TestSized *widget = g_ptr_array_index (sized_widgets, i);
+
+      if (gtk_widget_get_mapped (GTK_WIDGET (widget)) && widget->width == width)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+test_cell_sizes (void)
+{
+  GtkWidget *window, *sw, *view;
+  GtkColumnViewColumn *column;
+  GtkListItemFactory *factory;
+  GtkStringList *list;
+  GtkAdjustment *vadjustment;
+  guint i;
+
+  sized_widgets = g_ptr_array_new ();
+
+  /* The first row is 300 pixels wide, all others 10 */
+  list = gtk_string_list_new (NULL);
+  gtk_string_list_append (list, "..............................");
+  for (i = 1; i < 200; i++)
+    gtk_string_list_append (list, ".");
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_item), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_item), NULL);
+
+  view = gtk_column_view_new (G_LIST_MODEL (gtk_no_selection_new (G_LIST_MODEL (list))));
+  column = gtk_column_view_column_new ("", factory);
+  gtk_column_view_append_column (GTK_COLUMN_VIEW (view), column);
+
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), view);
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 600, 200);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+  gtk_widget_show (window);
+  wait_for_layout (window);
+
+  g_assert_cmpint (get_column_width (), >=, 300);
+
+  /* The first row is scrolled out, but its width is still used */
+  vadjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw));
+  gtk_adjustment_set_value (vadjustment, gtk_adjustment_get_upper (vadjustment));
+  wait_for_layout (window);
+  wait_for_layout (window);
+
+  g_assert_false (shows_item_of_width (300));
+  g_assert_cmpint (get_column_width (), >=, 300);
+
+  /* Inserting rows before it moves its width along */
+  gtk_string_list_splice (list, 0, 0, (const char *[]) { ".", ".", NULL });
+  wait_for_layout (window);
+
+  g_assert_false (shows_item_of_width (300));
+  g_assert_cmpint (get_column_width (), >=, 300);
+
+  /* Removing rows before it, too */
+  gtk_string_list_remove (list, 0);
+  wait_for_layout (window);
+
+  g_assert_false (shows_item_of_width (300));
+  g_assert_cmpint (get_column_width (), >=, 300);
+
+  /* Replacing the row forgets its width */
+  gtk_string_list_splice (list, 1, 1, (const char *[]) { ".", NULL });
+  wait_for_layout (window);
+
+  g_assert_cmpint (get_column_width (), <, 300);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (column);
+  g_ptr_array_unref (sized_widgets);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/columnview/cell-sizes", test_cell_sizes);
+
+  return g_test_run ();
+}
@@ -0,0 +1,240 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+#define N_FILES 300
+
+static GFile *
+create_test_dir (void)
+{
+  GError *error = NULL;
+  char *path;
+  GFile *dir;
+  guint i;
+
+  path = g_dir_make_tmp ("gtk-directorylist-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  for (i = 0; i < N_FILES; i++)
+    {
+      char *name = g_strdup_printf ("%s/file-%u", path, i);
+
+      g_file_set_contents (name, "data", 4, &error);
+      g_assert_no_error (error);
+      g_free (name);
+    }
+
+  dir = g_file_new_for_path (path);
+  g_free (path);
+
+  return dir;
+}
+
+static void
+remove_test_dir (GFile *dir)
+{
+  guint i;
+
+  for (i = 0; i < N_FILES; i++)
+    {
+      char *name = g_strdup_printf ("file-%u", i);
+      GFile *file = g_file_get_child (dir, name);
+
+      g_file_delete (file, NULL, NULL);
+      g_object_unref (file);
+      g_free (name);
+    }
+
+  g_file_delete (dir, NULL, NULL);
+}
+
+static void
+items_changed (GListModel *model,
+               guint       position,
+               guint       removed,
+               guint       added,
+               guint      *counter)
+{
+  (*counter)++;
+}
+
+typedef struct
+{
+  guint n_changes;
+  guint n_added;
+} Changes;
+
+static void
+record_changes (GListModel *model,
+                guint       position,
+                guint       removed,
+                guint       added,
+                Changes    *changes)
+{
+  g_assert_cmpuint (removed, ==, 0);
+  g_assert_cmpuint (position + added, ==, g_list_model_get_n_items (model));
+
+  changes->n_changes++;
+  changes->n_added += added;
+}
+
+static void
+wait_for_loading (GtkDirectoryList *list)
+{
+  while (gtk_directory_list_is_loading (list))
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+check_load (gboolean threaded)
+{
+  GtkDirectoryList *list;
+  GFileInfo *info;
+  Changes changes = { 0, 0 };
+  GFile *dir;
+
+  dir = create_test_dir ();
+
+  list = gtk_directory_list_new ("standard::name", NULL);
+  gtk_directory_list_set_monitored (list, FALSE);
+  gtk_directory_list_set_threaded (list, threaded);
+  g_signal_connect (list, "items-changed", G_CALLBACK (record_changes), &changes);
+
+  gtk_directory_list_set_file (list, dir);
+  g_assert_true (gtk_directory_list_is_loading (list));
+  wait_for_loading (list);
+
+  g_assert_null (gtk_directory_list_get_error (list));
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, N_FILES);
+  g_assert_cmpuint (changes.n_added, ==, N_FILES);
+  /* How many batches the files arrive in depends on timing, but
+   * they must not be added one by one.
+   */
+  g_assert_cmpuint (changes.n_changes, >, 0);
+  g_assert_cmpuint (changes.n_changes, <=, N_FILES / 10);
+
+  info = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_true (G_IS_FILE (g_file_info_get_attribute_object (info, "standard::file")));
+  g_object_unref (info);
+
+  g_object_unref (list);
+  remove_test_dir (dir);
+  g_object_unref (dir);
+}
+
+static void
+test_load (void)
+{
+  check_load (FALSE);
+}
+
+static void
+test_load_threaded (void)
+{
+  check_load (TRUE);
+}
+
+static void
+test_cancel_threaded (void)
+{
+  GtkDirectoryList *list;
+  GFile *dir, *file;
+
+  dir = create_test_dir ();
+
+  /* The worker thread keeps a reference to the file until it is done */
+  file = g_file_dup (dir);
+  g_object_add_weak_pointer (G_OBJECT (file), (gpointer *) &file);
+
+  list = gtk_directory_list_new ("standard::name", NULL);
+  gtk_directory_list_set_monitored (list, FALSE);
+  gtk_directory_list_set_threaded (list, TRUE);
+  gtk_directory_list_set_file (list, file);
+  g_assert_true (gtk_directory_list_is_loading (list));
+  g_object_unref (file);
+
+  /* Batches that arrive after this must be ignored */
+  g_object_unref (list);
+
+  while (file != NULL)
+    g_main_context_iteration (NULL, TRUE);
+  while (g_main_context_iteration (NULL, FALSE));
+
+  remove_test_dir (dir);
+  g_object_unref (dir);
+}
+
+static void
+test_lazy_attributes (void)
+{
+  GtkDirectoryList *list;
+  GFileInfo *info;
+  guint n_changes = 0;
+  GFile *dir;
+
+  dir = create_test_dir ();
+
+  list = gtk_directory_list_new ("standard::name", NULL);
+  gtk_directory_list_set_monitored (list, FALSE);
+  gtk_directory_list_set_lazy_attributes (list, "standard::size");
+  gtk_directory_list_set_file (list, dir);
+  wait_for_loading (list);
+
+  info = g_list_model_get_item (G_LIST_MODEL (list), 3);
+  g_assert_false (g_file_info_has_attribute (info, "standard::size"));
+  g_object_unref (info);
+
+  g_signal_connect (list, "items-changed", G_CALLBACK (items_changed), &n_changes);
+  gtk_directory_list_query_lazy_attributes (list, 3);
+  /* A second request for the same file is ignored */
+  gtk_directory_list_query_lazy_attributes (list, 3);
+
+  while (n_changes == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  info = g_list_model_get_item (G_LIST_MODEL (list), 3);
+  g_assert_true (g_file_info_has_attribute (info, "standard::name"));
+  g_assert_true (g_file_info_has_attribute (info, "standard::file"));
+  g_assert_cmpint (g_file_info_get_size (info), ==, 4);
+  g_object_unref (info);
+
+  /* Files are only queried once */
+  n_changes = 0;
+  gtk_directory_list_query_lazy_attributes (list, 3);
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_cmpuint (n_changes, ==, 0);
+
+  g_object_unref (list);
+  remove_test_dir (dir);
+  g_object_unref (dir);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/directorylist/load", test_load);
+  g_test_add_func ("/directorylist/load-threaded", test_load_threaded);
+  g_test_add_func ("/directorylist/cancel-threaded", test_cancel_threaded);
+  g_test_add_func ("/directorylist/lazy-attributes", test_lazy_attributes);
+
+  return g_test_run ();
+}
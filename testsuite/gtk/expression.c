@@ -61,6 +61,67 @@ test_property (void)
   g_object_unref (filter);
 }
 
+typedef struct {
+  GtkExpressionWatch *other;
+  guint counter;
+} UnwatchData;
+
+static void
+unwatch_other (gpointer data)
+{
+  UnwatchData *ud = data;
+
+  ud->counter++;
+  g_clear_pointer (&ud->other, gtk_expression_watch_unwatch);
+}
+
+/* Watches on the same object share their notify handler,
+ * make sure they still behave independently.
+ */
+static void
+test_shared_watch (void)
+{
+  GtkExpression *search, *ignore_case;
+  GtkExpressionWatch *watch1, *watch2, *watch3;
+  GtkStringFilter *filter;
+  UnwatchData ud = { NULL, 0 };
+  guint counter1 = 0;
+  guint counter2 = 0;
+  guint counter3 = 0;
+
+  filter = gtk_string_filter_new (NULL);
+  search = gtk_property_expression_new (GTK_TYPE_STRING_FILTER, NULL, "search");
+  ignore_case = gtk_property_expression_new (GTK_TYPE_STRING_FILTER, NULL, "ignore-case");
+
+  watch1 = gtk_expression_watch (search, filter, inc_counter, &counter1, NULL);
+  watch2 = gtk_expression_watch (ignore_case, filter, inc_counter, &counter2, NULL);
+  watch3 = gtk_expression_watch (search, filter, unwatch_other, &ud, NULL);
+  ud.other = gtk_expression_watch (search, filter, inc_counter, &counter3, NULL);
+
+  gtk_string_filter_set_search (filter, "Hello World");
+  g_assert_cmpuint (counter1, ==, 1);
+  g_assert_cmpuint (counter2, ==, 0);
+  g_assert_cmpuint (ud.counter, ==, 1);
+  g_assert_null (ud.other);
+  g_assert_cmpuint (counter3, ==, 0);
+
+  gtk_string_filter_set_ignore_case (filter, FALSE);
+  g_assert_cmpuint (counter1, ==, 1);
+  g_assert_cmpuint (counter2, ==, 1);
+
+  gtk_expression_watch_unwatch (watch1);
+  gtk_string_filter_set_search (filter, "Hello");
+  g_assert_cmpuint (counter1, ==, 1);
+  g_assert_cmpuint (ud.counter, ==, 2);
+  g_assert_cmpuint (counter3, ==, 0);
+
+  gtk_expression_watch_unwatch (watch2);
+  gtk_expression_watch_unwatch (watch3);
+  gtk_expression_unref (search);
+  gtk_expression_unref (ignore_case);
+  g_object_unref (filter);
+}
+
 static void
 test_interface_property (void)
 {
@@ -776,6 +837,7 @@ main (int argc, char *argv[])
   setlocale (LC_ALL, "C");
 
   g_test_add_func ("/expression/property", test_property);
+  g_test_add_func ("/expression/shared-watch", test_shared_watch);
   g_test_add_func ("/expression/interface-property", test_interface_property);
   g_test_add_func ("/expression/cclosure", test_cclosure);
   g_test_add_func ("/expression/closure", test_closure);
@@ -0,0 +1,260 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <utime.h>
+#include "gtk/gtkicontexturecacheprivate.h"
+
+static char *icon_file;
+
+static char *
+get_entry_path (const char *key)
+{
+  return g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "icon-textures", key, NULL);
+}
+
+static gint64
+get_mtime (const char *path)
+{
+  GStatBuf st;
+
+  g_assert_cmpint (g_stat (path, &st), ==, 0);
+
+  return st.st_mtime;
+}
+
+static void
+set_mtime (const char *path,
+           gint64      offset)
+{
+  struct utimbuf times;
+
+  times.actime = times.modtime = time (NULL) + offset;
+  g_assert_cmpint (g_utime (path, &times), ==, 0);
+}
+
+/* An opaque pixbuf with a different color in every pixel */
+static GdkPixbuf *
+make_pixbuf (int size)
+{
+  GdkPixbuf *pixbuf;
+  guchar *pixels;
+  int x, y, stride;
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, size, size);
+  pixels = gdk_pixbuf_get_pixels (pixbuf);
+  stride = gdk_pixbuf_get_rowstride (pixbuf);
+
+  for (y = 0; y < size; y++)
+    for (x = 0; x < size; x++)
+      {
+        guchar *p = pixels + y * stride + x * 4;
+
+        p[0] = x;
+        p[1] = y;
+        p[2] = x ^ y;
+        p[3] = 255;
+      }
+
+  return pixbuf;
+}
+
+static void
+test_lookup_store (void)
+{
+  GdkPixbuf *pixbuf;
+  GdkTexture *texture;
+  guint32 *data;
+  char *key, *other;
+  int x, y;
+
+  key = gtk_icon_texture_cache_get_key (icon_file, 16, 1, FALSE);
+  g_assert_nonnull (key);
+
+  /* Any difference in how the icon is rendered gives a different key */
+  other = gtk_icon_texture_cache_get_key (icon_file, 16, 1, TRUE);
+  g_assert_cmpstr (key, !=, other);
+  g_free (other);
+  other = gtk_icon_texture_cache_get_key (icon_file, 16, 2, FALSE);
+  g_assert_cmpstr (key, !=, other);
+  g_free (other);
+
+  g_assert_null (gtk_icon_texture_cache_lookup (key));
+
+  pixbuf = make_pixbuf (16);
+  gtk_icon_texture_cache_store (key, pixbuf);
+  gtk_icon_texture_cache_flush ();
+
+  texture = gtk_icon_texture_cache_lookup (key);
+  g_assert_nonnull (texture);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 16);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 16);
+
+  data = g_new (guint32, 16 * 16);
+  gdk_texture_download (texture, (guchar *) data, 16 * 4);
+  for (y = 0; y < 16; y++)
+    for (x = 0; x < 16; x++)
+      g_assert_cmphex (data[y * 16 + x], ==, 0xff000000 | (x << 16) | (y << 8) | (x ^ y));
+
+  g_free (data);
+  g_object_unref (texture);
+  g_object_unref (pixbuf);
+  g_free (key);
+}
+
+static void
+test_invalid (void)
+{
+  GdkPixbuf *pixbuf;
+  char *key, *path, *contents;
+  gsize length;
+  guint32 byte_order;
+
+  key = gtk_icon_texture_cache_get_key (icon_file, 17, 1, FALSE);
+  path = get_entry_path (key);
+
+  /* Truncated entries are removed */
+  g_assert_true (g_file_set_contents (path, "GtkIcTx1", -1, NULL));
+  g_assert_null (gtk_icon_texture_cache_lookup (key));
+  g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+
+  /* So are ones written with a different byte order, its mark
+   * follows the magic and four other fields.
+   */
+  pixbuf = make_pixbuf (17);
+  gtk_icon_texture_cache_store (key, pixbuf);
+  gtk_icon_texture_cache_flush ();
+
+  g_assert_true (g_file_get_contents (path, &contents, &length, NULL));
+  memcpy (&byte_order, contents + 24, sizeof (guint32));
+  byte_order = GUINT32_SWAP_LE_BE (byte_order);
+  memcpy (contents + 24, &byte_order, sizeof (guint32));
+  g_assert_true (g_file_set_contents (path, contents, length, NULL));
+
+  g_assert_null (gtk_icon_texture_cache_lookup (key));
+  g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+
+  g_free (contents);
+  g_object_unref (pixbuf);
+  g_free (path);
+  g_free (key);
+}
+
+static void
+test_eviction (void)
+{
+  GdkPixbuf *pixbuf, *large;
+  GdkTexture *texture;
+  char *key, *path, *recent_key, *recent_path, *cache_dir;
+  const char *name;
+  gint64 total;
+  GDir *dir;
+  int i;
+
+  /* Hits mark entries as recently used */
+  key = gtk_icon_texture_cache_get_key (icon_file, 32, 1, FALSE);
+  path = get_entry_path (key);
+  pixbuf = make_pixbuf (32);
+  gtk_icon_texture_cache_store (key, pixbuf);
+  gtk_icon_texture_cache_flush ();
+
+  set_mtime (path, -24 * 60 * 60);
+  texture = gtk_icon_texture_cache_lookup (key);
+  g_assert_nonnull (texture);
+  g_object_unref (texture);
+  g_assert_cmpint (get_mtime (path), >, time (NULL) - 60 * 60);
+
+  /* Filling up the cache removes the least recently used entries.
+   * The entries written below all share the same mtime, so give the
+   * one that has to survive a later one.
+   */
+  recent_key = gtk_icon_texture_cache_get_key (icon_file, 33, 1, FALSE);
+  recent_path = get_entry_path (recent_key);
+  gtk_icon_texture_cache_store (recent_key, pixbuf);
+  gtk_icon_texture_cache_flush ();
+  set_mtime (path, -24 * 60 * 60);
+  set_mtime (recent_path, 60 * 60);
+
+  large = make_pixbuf (1024);
+  for (i = 0; i < 12; i++)
+    {
+      char *large_key = gtk_icon_texture_cache_get_key (icon_file, 1024 + i, 1, FALSE);
+
+      gtk_icon_texture_cache_store (large_key, large);
+      g_free (large_key);
+    }
+  gtk_icon_texture_cache_flush ();
+
+  g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+  g_assert_true (g_file_test (recent_path, G_FILE_TEST_EXISTS));
+
+  /* Eviction runs every quarter of the maximum size */
+  cache_dir = g_path_get_dirname (path);
+  dir = g_dir_open (cache_dir, 0, NULL);
+  g_assert_nonnull (dir);
+  total = 0;
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *entry = get_entry_path (name);
+      GStatBuf st;
+
+      if (g_stat (entry, &st) == 0)
+        total += st.st_size;
+      g_free (entry);
+    }
+  g_dir_close (dir);
+  g_assert_cmpint (total, <=, GTK_ICON_TEXTURE_CACHE_MAX_SIZE + GTK_ICON_TEXTURE_CACHE_MAX_SIZE / 4);
+
+  g_object_unref (large);
+  g_object_unref (pixbuf);
+  g_free (cache_dir);
+  g_free (recent_path);
+  g_free (recent_key);
+  g_free (path);
+  g_free (key);
+}
+
+int
+main (int argc, char *argv[])
+{
+  char *dir, *cache_dir;
+  int result;
+
+  /* Keep the cache away from the user's */
+  dir = g_dir_make_tmp ("icontexturecacheXXXXXX", NULL);
+  g_setenv ("XDG_CACHE_HOME", dir, TRUE);
+  cache_dir = g_build_filename (dir, "gtk-4.0", "icon-textures", NULL);
+  g_mkdir_with_parents (cache_dir, 0700);
+  g_free (cache_dir);
+
+  /* Keys are made from the icon file, so we need one */
+  icon_file = g_build_filename (dir, "icon.svg", NULL);
+  g_file_set_contents (icon_file, "<svg/>", -1, NULL);
+  g_free (dir);
+
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/icontexturecache/lookup-store", test_lookup_store);
+  g_test_add_func ("/icontexturecache/invalid", test_invalid);
+  g_test_add_func ("/icontexturecache/eviction", test_eviction);
+
+  result = g_test_run ();
+
+  g_free (icon_file);
+
+  return result;
+}
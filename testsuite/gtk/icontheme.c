@@ -789,6 +789,45 @@ test_nonsquare_symbolic (void)
   g_object_unref (info);
 }
 
+static void
+test_prefetch (void)
+{
+  const char *names[] = { "twosize-fixed", "size-test", "twosize", NULL };
+  GtkIconTheme *icon_theme;
+  GtkIconPaintable *info, *prefetched;
+  GtkSnapshot *snapshot;
+  GskRenderNode *node;
+  GListModel *icons;
+  guint i;
+
+  icon_theme = get_test_icontheme (FALSE);
+
+  icons = gtk_icon_theme_prefetch_icons (icon_theme, names, 32, 1, GTK_TEXT_DIR_NONE, 0);
+  g_assert_cmpuint (g_list_model_get_n_items (icons), ==, G_N_ELEMENTS (names) - 1);
+
+  for (i = 0; names[i]; i++)
+    {
+      prefetched = g_list_model_get_item (icons, i);
+      g_assert_cmpstr (gtk_icon_paintable_get_icon_name (prefetched), ==, names[i]);
+
+      /* Lookups find the prefetched icon */
+      info = gtk_icon_theme_lookup_icon (icon_theme, names[i], NULL, 32, 1, GTK_TEXT_DIR_NONE, 0);
+      g_assert_true (info == prefetched);
+
+      /* Snapshotting waits for the prefetch if it is still running */
+      snapshot = gtk_snapshot_new ();
+      gdk_paintable_snapshot (GDK_PAINTABLE (info), snapshot, 32, 32);
+      node = gtk_snapshot_free_to_node (snapshot);
+      g_assert_nonnull (node);
+      gsk_render_node_unref (node);
+
+      g_object_unref (info);
+      g_object_unref (prefetched);
+    }
+
+  g_object_unref (icons);
+}
+
 static void
 require_env (const char *var)
 {
@@ -799,8 +838,15 @@ require_env (const char *var)
 int
 main (int argc, char *argv[])
 {
+  char *dir;
+
   require_env ("G_TEST_SRCDIR");
 
+  /* Don't fill the user's icon texture cache */
+  dir = g_dir_make_tmp ("iconthemeXXXXXX", NULL);
+  g_setenv ("XDG_CACHE_HOME", dir, TRUE);
+  g_free (dir);
+
   gtk_test_init (&argc, &argv);
 
   g_test_add_func ("/icontheme/basics", test_basics);
@@ -815,6 +861,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/icontheme/list", test_list);
   g_test_add_func ("/icontheme/inherit", test_inherit);
   g_test_add_func ("/icontheme/nonsquare-symbolic", test_nonsquare_symbolic);
+  g_test_add_func ("/icontheme/prefetch", test_prefetch);
 
   return g_test_run();
 }
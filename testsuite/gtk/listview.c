@@ -0,0 +1,534 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+static guint n_setup;
+static guint n_teardown;
+static guint n_bind;
+
+static void
+setup_item (GtkSignalListItemFactory *factory,
+            GtkListItem              *list_item)
+{
+  n_setup++;
+  gtk_list_item_set_child (list_item, gtk_label_new (NULL));
+}
+
+static void
+teardown_item (GtkSignalListItemFactory *factory,
+               GtkListItem              *list_item)
+{
+  n_teardown++;
+}
+
+static void
+bind_item (GtkSignalListItemFactory *factory,
+           GtkListItem              *list_item)
+{
+  GtkWidget *label = gtk_list_item_get_child (list_item);
+  GtkStringObject *item = gtk_list_item_get_item (list_item);
+
+  n_bind++;
+  gtk_label_set_label (GTK_LABEL (label), gtk_string_object_get_string (item));
+}
+
+static GtkListItemFactory *
+counting_factory_new (void)
+{
+  GtkListItemFactory *factory;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_item), NULL);
+  g_signal_connect (factory, "teardown", G_CALLBACK (teardown_item), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_item), NULL);
+
+  return factory;
+}
+
+static GtkSelectionModel *
+string_model_new (guint n_items)
+{
+  GtkStringList *list;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    {
+      char *s = g_strdup_printf ("%u", i);
+      gtk_string_list_append (list, s);
+      g_free (s);
+    }
+
+  return GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (list)));
+}
+
+static void
+test_pool (void)
+{
+  GtkListItemFactory *factory;
+  GtkSelectionModel *model;
+  GtkWidget *window, *view;
+
+  n_setup = n_teardown = n_bind = 0;
+
+  factory = counting_factory_new ();
+  gtk_list_item_factory_set_pool_size (factory, 10);
+  model = string_model_new (5);
+
+  /* Rows get set up once they are rooted */
+  window = gtk_window_new ();
+  view = gtk_list_view_new (g_object_ref (model), g_object_ref (factory));
+  gtk_window_set_child (GTK_WINDOW (window), view);
+  g_assert_cmpuint (n_setup, ==, 5);
+  g_assert_cmpuint (n_bind, ==, 5);
+
+  /* Replacing the model keeps the set up widgets in the pool */
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), NULL);
+  g_assert_cmpuint (n_teardown, ==, 0);
+
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), model);
+  g_assert_cmpuint (n_setup, ==, 5);
+  g_assert_cmpuint (n_teardown, ==, 0);
+  g_assert_cmpuint (n_bind, ==, 10);
+
+  /* Widgets that don't fit into the pool are torn down */
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), NULL);
+  gtk_list_item_factory_set_pool_size (factory, 2);
+  g_assert_cmpuint (n_teardown, ==, 3);
+
+  gtk_list_item_factory_set_pool_size (factory, 0);
+  g_assert_cmpuint (n_teardown, ==, 5);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (model);
+  g_object_unref (factory);
+}
+
+static void
+test_pool_no_factory (void)
+{
+  GtkListItemFactory *factory;
+  GtkSelectionModel *model;
+  GtkWidget *window, *view;
+
+  n_setup = n_teardown = n_bind = 0;
+
+  factory = counting_factory_new ();
+  gtk_list_item_factory_set_pool_size (factory, 10);
+  model = string_model_new (5);
+
+  /* Rows without a factory have no pool to go to */
+  window = gtk_window_new ();
+  view = gtk_list_view_new (g_object_ref (model), NULL);
+  gtk_window_set_child (GTK_WINDOW (window), view);
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), NULL);
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), model);
+
+  gtk_list_view_set_factory (GTK_LIST_VIEW (view), factory);
+  g_assert_cmpuint (n_setup, ==, 5);
+
+  /* The rows go to the pool of the old factory */
+  gtk_list_view_set_factory (GTK_LIST_VIEW (view), NULL);
+  g_assert_cmpuint (n_teardown, ==, 0);
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), NULL);
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), model);
+  g_assert_cmpuint (n_setup, ==, 5);
+
+  gtk_list_view_set_factory (GTK_LIST_VIEW (view), factory);
+  g_assert_cmpuint (n_setup, ==, 5);
+  g_assert_cmpuint (n_teardown, ==, 0);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (model);
+  g_object_unref (factory);
+}
+
+static void
+after_paint (GdkFrameClock *clock,
+             gboolean      *done)
+{
+  *done = TRUE;
+}
+
+static void
+wait_for_layout (GtkWidget *widget)
+{
+  GdkFrameClock *clock = gtk_widget_get_frame_clock (widget);
+  gboolean done = FALSE;
+  gulong id;
+
+  id = g_signal_connect (clock, "after-paint", G_CALLBACK (after_paint), &done);
+  gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_LAYOUT);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+  g_signal_handler_disconnect (clock, id);
+}
+
+typedef struct
+{
+  guint position;
+  gint64 frame;
+} BindRecord;
+
+static GArray *bind_records;
+
+/* Takes longer than the time per frame for binding */
+static void
+slow_bind_item (GtkSignalListItemFactory *factory,
+                GtkListItem              *list_item)
+{
+  GtkWidget *label = gtk_list_item_get_child (list_item);
+  BindRecord record;
+
+  record.position = gtk_list_item_get_position (list_item);
+  record.frame = gdk_frame_clock_get_frame_counter (gtk_widget_get_frame_clock (label));
+  g_array_append_val (bind_records, record);
+
+  g_usleep (5 * G_TIME_SPAN_MILLISECOND);
+}
+
+static void
+test_deferred_bind_order (void)
+{
+  GtkListItemFactory *factory;
+  GtkSelectionModel *model;
+  GtkWidget *window, *sw, *view;
+  gint64 change_frame;
+  guint i, n_records, n_stable, last_distance = 0;
+
+  bind_records = g_array_new (FALSE, FALSE, sizeof (BindRecord));
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_item), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (slow_bind_item), NULL);
+
+  view = gtk_list_view_new (string_model_new (100), factory);
+  gtk_list_view_set_fixed_row_height (GTK_LIST_VIEW (view), 20);
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), view);
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 200);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+  gtk_widget_show (window);
+  wait_for_layout (window);
+
+  /* Rebind all rows, with trackers at 0 (the anchor) and 8 (the selection) */
+  gtk_list_view_set_defer_binding (GTK_LIST_VIEW (view), TRUE);
+  g_array_set_size (bind_records, 0);
+  change_frame = gdk_frame_clock_get_frame_counter (gtk_widget_get_frame_clock (view));
+
+  model = string_model_new (100);
+  gtk_list_view_set_model (GTK_LIST_VIEW (view), model);
+  g_object_unref (model);
+  gtk_widget_activate_action (view, "list.select-item", "(ubb)", 8, FALSE, FALSE);
+
+  n_stable = 0;
+  n_records = 0;
+  for (i = 0; i < 200 && n_stable < 3; i++)
+    {
+      wait_for_layout (window);
+      if (bind_records->len == n_records)
+        n_stable++;
+      else
+        n_stable = 0;
+      n_records = bind_records->len;
+    }
+
+  /* Not everything got bound right away */
+  g_assert_cmpuint (bind_records->len, >, 2);
+  g_assert_cmpint (g_array_index (bind_records, BindRecord, bind_records->len - 1).frame, >, change_frame);
+
+  /* Rows bound in later frames come closest to a tracker first */
+  n_records = 0;
+  for (i = 0; i < bind_records->len; i++)
+    {
+      BindRecord *record = &g_array_index (bind_records, BindRecord, i);
+      guint distance;
+
+      if (record->frame <= change_frame)
+        continue;
+
+      distance = MIN (record->position, (guint) ABS ((int) record->position - 8));
+      if (n_records > 0)
+        g_assert_cmpuint (distance, >=, last_distance);
+
+      last_distance = distance;
+      n_records++;
+    }
+
+  g_assert_cmpuint (n_records, >, 0);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_array_unref (bind_records);
+}
+
+static GtkWidget *
+find_row (GtkWidget  *view,
+          const char *text)
+{
+  GtkWidget *row;
+
+  for (row = gtk_widget_get_first_child (view);
+       row != NULL;
+       row = gtk_widget_get_next_sibling (row))
+    {
+      GtkWidget *label = gtk_widget_get_first_child (row);
+
+      if (GTK_IS_LABEL (label) &&
+          g_str_equal (gtk_label_get_label (GTK_LABEL (label)), text))
+        return row;
+    }
+
+  return NULL;
+}
+
+/* Checks that rows are @row_height apart, before and after scrolling */
+static void
+check_fixed_rows (GtkWidget *window,
+                  GtkWidget *sw,
+                  GtkWidget *view,
+                  int        row_height)
+{
+  GtkAdjustment *vadjustment;
+  GtkWidget *row, *picked;
+  double x, y;
+
+  vadjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw));
+  g_assert_cmpfloat (gtk_adjustment_get_upper (vadjustment), ==, 1000 * row_height);
+
+  gtk_widget_activate_action (view, "list.scroll-to-item", "u", 500);
+  wait_for_layout (window);
+  wait_for_layout (window);
+
+  g_assert_cmpfloat (gtk_adjustment_get_value (vadjustment), <=, 500 * row_height);
+  g_assert_cmpfloat (gtk_adjustment_get_value (vadjustment) + gtk_adjustment_get_page_size (vadjustment), >=, 501 * row_height);
+
+  row = find_row (view, "500");
+  g_assert_nonnull (row);
+  g_assert_cmpint (gtk_widget_get_height (row), ==, row_height);
+  g_assert_true (gtk_widget_translate_coordinates (row, view, 0, 0, &x, &y));
+  g_assert_cmpfloat (y, ==, 500 * row_height - gtk_adjustment_get_value (vadjustment));
+
+  /* Clicking in the middle of the row hits it */
+  picked = gtk_widget_pick (view, 1, y + row_height / 2, GTK_PICK_DEFAULT);
+  g_assert_true (picked == row || gtk_widget_is_ancestor (picked, row));
+
+  row = find_row (view, "501");
+  g_assert_nonnull (row);
+  g_assert_cmpint (gtk_widget_get_height (row), ==, row_height);
+  g_assert_true (gtk_widget_translate_coordinates (row, view, 0, 0, &x, &y));
+  g_assert_cmpfloat (y, ==, 501 * row_height - gtk_adjustment_get_value (vadjustment));
+
+  gtk_adjustment_set_value (vadjustment, 0);
+  wait_for_layout (window);
+}
+
+static void
+test_fixed_row_height (void)
+{
+  GtkWidget *window, *sw, *view;
+  GtkWidget *row;
+  int row_height;
+
+  view = gtk_list_view_new (string_model_new (1000), counting_factory_new ());
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), view);
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 200);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+  gtk_widget_show (window);
+
+  /* A given height */
+  gtk_list_view_set_fixed_row_height (GTK_LIST_VIEW (view), 30);
+  wait_for_layout (window);
+  check_fixed_rows (window, sw, view, 30);
+
+  /* The height of the first row */
+  gtk_list_view_set_fixed_row_height (GTK_LIST_VIEW (view), 0);
+  wait_for_layout (window);
+  row = find_row (view, "0");
+  g_assert_nonnull (row);
+  row_height = gtk_widget_get_height (row);
+  g_assert_cmpint (row_height, >, 0);
+  check_fixed_rows (window, sw, view, row_height);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+/* A row that is 10 pixels high, or wraps to 100 pixels in less than
+ * 450 pixels of width and to 50 pixels otherwise if it is tall.
+ */
+#define TEST_TYPE_WRAPPED (test_wrapped_get_type ())
+G_DECLARE_FINAL_TYPE (TestWrapped, test_wrapped, TEST, WRAPPED, GtkWidget)
+
+struct _TestWrapped
+{
+  GtkWidget parent_instance;
+
+  gboolean tall;
+};
+
+G_DEFINE_TYPE (TestWrapped, test_wrapped, GTK_TYPE_WIDGET)
+
+static GtkSizeRequestMode
+test_wrapped_get_request_mode (GtkWidget *widget)
+{
+  return GTK_SIZE_REQUEST_HEIGHT_FOR_WIDTH;
+}
+
+static void
+test_wrapped_measure (GtkWidget      *widget,
+                      GtkOrientation  orientation,
+                      int             for_size,
+                      int            *minimum,
+                      int            *natural,
+                      int            *minimum_baseline,
+                      int            *natural_baseline)
+{
+  TestWrapped *self = TEST_WRAPPED (widget);
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    *minimum = *natural = 0;
+  else if (!self->tall)
+    *minimum = *natural = 10;
+  else if (for_size >= 0 && for_size < 450)
+    *minimum = *natural = 100;
+  else
+    *minimum = *natural = 50;
+}
+
+static void
+test_wrapped_class_init (TestWrappedClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  widget_class->get_request_mode = test_wrapped_get_request_mode;
+  widget_class->measure = test_wrapped_measure;
+}
+
+static void
+test_wrapped_init (TestWrapped *self)
+{
+}
+
+static void
+setup_wrapped_item (GtkSignalListItemFactory *factory,
+                    GtkListItem              *list_item)
+{
+  gtk_list_item_set_child (list_item, g_object_new (TEST_TYPE_WRAPPED, NULL));
+}
+
+/* The first 50 rows are tall */
+static void
+bind_wrapped_item (GtkSignalListItemFactory *factory,
+                   GtkListItem              *list_item)
+{
+  TestWrapped *child = TEST_WRAPPED (gtk_list_item_get_child (list_item));
+
+  child->tall = gtk_list_item_get_position (list_item) < 50;
+  gtk_widget_queue_resize (GTK_WIDGET (child));
+}
+
+static double
+get_height_after_scrolling (GtkWidget *window,
+                            GtkWidget *sw,
+                            GtkWidget *view)
+{
+  GtkAdjustment *vadjustment;
+
+  vadjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw));
+
+  /* Gives the tall rows widgets, then moves far away from them */
+  gtk_widget_activate_action (view, "list.scroll-to-item", "u", 0);
+  wait_for_layout (window);
+  wait_for_layout (window);
+  gtk_widget_activate_action (view, "list.scroll-to-item", "u", 1999);
+  wait_for_layout (window);
+  wait_for_layout (window);
+
+  return gtk_adjustment_get_upper (vadjustment);
+}
+
+static void
+test_cache_row_heights (void)
+{
+  GtkListItemFactory *factory;
+  GtkWidget *window, *sw, *view;
+  GtkAdjustment *vadjustment;
+  double estimated, cached, cached_wide;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_wrapped_item), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_wrapped_item), NULL);
+
+  view = gtk_list_view_new (string_model_new (2000), factory);
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), view);
+  gtk_widget_set_halign (sw, GTK_ALIGN_START);
+  gtk_widget_set_size_request (sw, 300, -1);
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 700, 200);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+  gtk_widget_show (window);
+  wait_for_layout (window);
+
+  vadjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw));
+
+  /* Without the cache, only the short rows around are measured and
+   * the tall ones are estimated to be just as short.
+   */
+  g_assert_false (gtk_list_view_get_cache_row_heights (GTK_LIST_VIEW (view)));
+  estimated = get_height_after_scrolling (window, sw, view);
+
+  /* With it, the tall rows keep their height */
+  gtk_list_view_set_cache_row_heights (GTK_LIST_VIEW (view), TRUE);
+  g_assert_true (gtk_list_view_get_cache_row_heights (GTK_LIST_VIEW (view)));
+  cached = get_height_after_scrolling (window, sw, view);
+  g_assert_cmpfloat (cached, >=, estimated + 50 * 80);
+
+  /* A different width drops the heights, as the rows might wrap differently */
+  gtk_widget_set_size_request (sw, 600, -1);
+  wait_for_layout (window);
+  wait_for_layout (window);
+  g_assert_cmpint (gtk_widget_get_width (view), >=, 450);
+  g_assert_cmpfloat (gtk_adjustment_get_upper (vadjustment), ==, estimated);
+
+  /* and measures them again at the new width */
+  cached_wide = get_height_after_scrolling (window, sw, view);
+  g_assert_cmpfloat (cached_wide, >=, estimated + 50 * 30);
+  g_assert_cmpfloat (cached_wide, <=, cached - 50 * 40);
+
+  /* Turning the cache off forgets them, too */
+  gtk_list_view_set_cache_row_heights (GTK_LIST_VIEW (view), FALSE);
+  wait_for_layout (window);
+  g_assert_cmpfloat (gtk_adjustment_get_upper (vadjustment), ==, estimated);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/listview/pool", test_pool);
+  g_test_add_func ("/listview/pool-no-factory", test_pool_no_factory);
+  g_test_add_func ("/listview/deferred-bind-order", test_deferred_bind_order);
+  g_test_add_func ("/listview/fixed-row-height", test_fixed_row_height);
+  g_test_add_func ("/listview/cache-row-heights", test_cache_row_heights);
+
+  return g_test_run ();
+}
@@ -286,6 +286,42 @@ test_set_map_func (void)
   g_object_unref (map);
 }
 
+static gboolean
+is_multiple_of_four (gpointer item,
+                     gpointer unused)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)) % 4 == 0;
+}
+
+static void
+test_filter (void)
+{
+  GtkMapListModel *map;
+  GtkFilterListModel *filter;
+  GListStore *store;
+  gpointer item1, item2;
+
+  store = new_store (1, 10, 1);
+  map = new_model (store);
+
+  /* Map a few items up front so filtering has to deal with a mix
+   * of mapped and unmapped ones */
+  item1 = g_list_model_get_item (G_LIST_MODEL (map), 3);
+  g_object_set_qdata (item1, number_quark, GUINT_TO_POINTER (7));
+  item2 = g_list_model_get_item (G_LIST_MODEL (map), 8);
+
+  filter = gtk_filter_list_model_new (G_LIST_MODEL (g_object_ref (map)),
+                                      GTK_FILTER (gtk_custom_filter_new (is_multiple_of_four, NULL, NULL)));
+  assert_model (filter, "4 12 16 20");
+  assert_model (map, "2 4 6 7 10 12 14 16 18 20");
+
+  g_object_unref (item1);
+  g_object_unref (item2);
+  g_object_unref (filter);
+  g_object_unref (store);
+  g_object_unref (map);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -299,6 +335,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/maplistmodel/create", test_create);
   g_test_add_func ("/maplistmodel/set-model", test_set_model);
   g_test_add_func ("/maplistmodel/set-map-func", test_set_map_func);
+  g_test_add_func ("/maplistmodel/filter", test_filter);
 
   return g_test_run ();
 }
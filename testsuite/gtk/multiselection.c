@@ -670,6 +670,76 @@ test_set_model (void)
   g_object_unref (selection);
 }
 
+static void
+test_invert (void)
+{
+  GtkSelectionModel *selection;
+  GListStore *store;
+  gboolean ret;
+
+  store = new_store (1, 10, 1);
+  selection = new_model (store);
+
+  ret = gtk_selection_model_select_range (selection, 2, 3, FALSE);
+  g_assert_true (ret);
+  assert_selection (selection, "3 4 5");
+  assert_selection_changes (selection, "2:3");
+
+  gtk_multi_selection_invert (GTK_MULTI_SELECTION (selection));
+  assert_selection (selection, "1 2 6 7 8 9 10");
+  assert_selection_changes (selection, "0:10");
+
+  gtk_multi_selection_invert (GTK_MULTI_SELECTION (selection));
+  assert_selection (selection, "3 4 5");
+  assert_selection_changes (selection, "0:10");
+
+  g_object_unref (store);
+  g_object_unref (selection);
+}
+
+static gboolean
+is_even (gpointer item,
+         gpointer data)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark)) % 2 == 0;
+}
+
+static void
+test_select_matching (void)
+{
+  GtkSelectionModel *selection;
+  GListStore *store;
+  GtkFilter *filter;
+  gboolean ret;
+
+  store = new_store (1, 10, 1);
+  selection = new_model (store);
+
+  ret = gtk_selection_model_select_item (selection, 0, FALSE);
+  g_assert_true (ret);
+  assert_selection (selection, "1");
+  assert_selection_changes (selection, "0:1");
+
+  filter = GTK_FILTER (gtk_custom_filter_new (is_even, NULL, NULL));
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, FALSE);
+  assert_selection (selection, "1 2 4 6 8 10");
+  assert_selection_changes (selection, "1:9");
+
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, TRUE);
+  assert_selection (selection, "2 4 6 8 10");
+  assert_selection_changes (selection, "0:1");
+  g_object_unref (filter);
+
+  filter = GTK_FILTER (gtk_custom_filter_new (NULL, NULL, NULL));
+  gtk_multi_selection_select_matching (GTK_MULTI_SELECTION (selection), filter, FALSE);
+  assert_selection (selection, "1 2 3 4 5 6 7 8 9 10");
+  assert_selection_changes (selection, "0:9");
+  g_object_unref (filter);
+
+  g_object_unref (store);
+  g_object_unref (selection);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -691,6 +761,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/multiselection/set_selection", test_set_selection);
   g_test_add_func ("/multiselection/selection-filter", test_selection_filter);
   g_test_add_func ("/multiselection/set-model", test_set_model);
+  g_test_add_func ("/multiselection/invert", test_invert);
+  g_test_add_func ("/multiselection/select-matching", test_select_matching);
 
   return g_test_run ();
 }
@@ -438,6 +438,230 @@ test_action_parse (void)
   g_object_unref (action);
 }
 
+static GArray *activated;
+
+static gboolean
+record_activation (GtkWidget *widget,
+                   GVariant  *args,
+                   gpointer   user_data)
+{
+  guint id = GPOINTER_TO_UINT (user_data);
+
+  g_array_append_val (activated, id);
+
+  /* Not handled, so every matching shortcut gets tried */
+  return FALSE;
+}
+
+static GtkShortcut *
+recording_shortcut_new (GtkShortcutTrigger *trigger,
+                        guint               id)
+{
+  GtkShortcut *shortcut;
+
+  shortcut = gtk_shortcut_new (trigger,
+                               gtk_callback_action_new (record_activation, GUINT_TO_POINTER (id), NULL));
+  g_object_set_data (G_OBJECT (shortcut), "id", GUINT_TO_POINTER (id));
+
+  return shortcut;
+}
+
+/* What the controller did before it had an index: run every trigger,
+ * starting after the last activated shortcut.
+ */
+static GArray *
+linear_scan (GListModel *shortcuts,
+             GdkEvent   *event,
+             gboolean    enable_mnemonics)
+{
+  GArray *result;
+  gboolean has_exact = FALSE;
+  guint i, n_items;
+
+  result = g_array_new (FALSE, FALSE, sizeof (guint));
+  n_items = g_list_model_get_n_items (shortcuts);
+
+  for (i = 0; i < n_items; i++)
+    {
+      /* None of our shortcuts ever gets activated, so we start after 0 */
+      GtkShortcut *shortcut = g_list_model_get_item (shortcuts, (1 + i) % n_items);
+      guint id = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (shortcut), "id"));
+
+      switch (gtk_shortcut_trigger_trigger (gtk_shortcut_get_trigger (shortcut), event, enable_mnemonics))
+        {
+        case GDK_KEY_MATCH_PARTIAL:
+          if (!has_exact)
+            g_array_append_val (result, id);
+          break;
+
+        case GDK_KEY_MATCH_EXACT:
+          if (!has_exact)
+            g_array_set_size (result, 0);
+          has_exact = TRUE;
+          g_array_append_val (result, id);
+          break;
+
+        case GDK_KEY_MATCH_NONE:
+        default:
+          break;
+        }
+
+      g_object_unref (shortcut);
+    }
+
+  return result;
+}
+
+static void
+check_controller (GtkWidget          *window,
+                  GtkEventController *controller)
+{
+  const guint keyvals[] = {
+    GDK_KEY_a, GDK_KEY_A, GDK_KEY_b, GDK_KEY_u, GDK_KEY_U,
+    GDK_KEY_Tab, GDK_KEY_ISO_Left_Tab, GDK_KEY_1, GDK_KEY_exclam,
+  };
+  const GdkModifierType states[] = {
+    0, GDK_SHIFT_MASK, GDK_CONTROL_MASK, GDK_CONTROL_MASK | GDK_SHIFT_MASK, GDK_ALT_MASK,
+  };
+  const GdkEventType types[] = { GDK_KEY_PRESS, GDK_KEY_RELEASE };
+  GdkDisplay *display = gtk_widget_get_display (window);
+  GdkSurface *surface = gtk_native_get_surface (GTK_NATIVE (window));
+  GdkDevice *device = gdk_seat_get_keyboard (gdk_display_get_default_seat (display));
+  GListModel *shortcuts = G_LIST_MODEL (controller);
+  guint i, j, k;
+
+  for (i = 0; i < G_N_ELEMENTS (keyvals); i++)
+    {
+      GdkKeymapKey *keys;
+      int n_keys;
+      GdkTranslatedKey translated;
+
+      if (!gdk_display_map_keyval (display, keyvals[i], &keys, &n_keys))
+        continue;
+
+      translated.keyval = keyvals[i];
+      translated.consumed = keys[0].level > 0 ? GDK_SHIFT_MASK : 0;
+      translated.layout = keys[0].group;
+      translated.level = keys[0].level;
+
+      for (j = 0; j < G_N_ELEMENTS (states); j++)
+        for (k = 0; k < G_N_ELEMENTS (types); k++)
+          {
+            GdkEvent *event;
+            GArray *expected;
+            gboolean enable_mnemonics;
+
+            event = key_event_new (types[k],
+                                   surface,
+                                   device,
+                                   device,
+                                   GDK_CURRENT_TIME,
+                                   keys[0].keycode,
+                                   states[j],
+                                   FALSE,
+                                   &translated,
+                                   &translated);
+
+            enable_mnemonics = types[k] == GDK_KEY_PRESS &&
+                               (states[j] & gtk_accelerator_get_default_mod_mask ()) == GDK_ALT_MASK;
+            expected = linear_scan (shortcuts, event, enable_mnemonics);
+
+            g_array_set_size (activated, 0);
+            gdk_display_put_event (display, event);
+            while (g_main_context_pending (NULL))
+              g_main_context_iteration (NULL, FALSE);
+
+            g_assert_cmpuint (activated->len, ==, expected->len);
+            if (expected->len > 0)
+              g_assert_cmpmem (activated->data, activated->len * sizeof (guint),
+                               expected->data, expected->len * sizeof (guint));
+
+            g_array_free (expected, TRUE);
+            gdk_event_unref (event);
+          }
+
+      g_free (keys);
+    }
+}
+
+static void
+test_controller_index (void)
+{
+  GtkWidget *window;
+  GtkEventController *controller;
+  GtkShortcutController *shortcuts;
+  GtkShortcut *shortcut;
+  GdkSeat *seat;
+
+  seat = gdk_display_get_default_seat (gdk_display_get_default ());
+  if (!seat || !gdk_seat_get_keyboard (seat))
+    {
+      g_test_skip ("Display has no keyboard");
+      return;
+    }
+
+  activated = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  controller = gtk_shortcut_controller_new ();
+  /* Run before the window's own shortcuts can handle the keys */
+  gtk_event_controller_set_propagation_phase (controller, GTK_PHASE_CAPTURE);
+  shortcuts = GTK_SHORTCUT_CONTROLLER (controller);
+
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_keyval_trigger_new (GDK_KEY_a, GDK_CONTROL_MASK), 0));
+  /* Shifted keyvals */
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_keyval_trigger_new (GDK_KEY_A, GDK_CONTROL_MASK | GDK_SHIFT_MASK), 1));
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_keyval_trigger_new (GDK_KEY_exclam, 0), 2));
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_keyval_trigger_new (GDK_KEY_ISO_Left_Tab, GDK_SHIFT_MASK), 3));
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_keyval_trigger_new (GDK_KEY_a, 0), 4));
+  /* Mnemonics, and never triggers, which are also used for NULL */
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_mnemonic_trigger_new (GDK_KEY_u), 5));
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_mnemonic_trigger_new (GDK_KEY_U), 6));
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (g_object_ref (gtk_never_trigger_get ()), 7));
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (NULL, 8));
+  /* Alternatives, including nested ones */
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_alternative_trigger_new (gtk_keyval_trigger_new (GDK_KEY_b, GDK_CONTROL_MASK),
+                                                           gtk_mnemonic_trigger_new (GDK_KEY_a)), 9));
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_alternative_trigger_new (gtk_keyval_trigger_new (GDK_KEY_1, 0),
+                                                           gtk_alternative_trigger_new (g_object_ref (gtk_never_trigger_get ()),
+                                                                                        gtk_keyval_trigger_new (GDK_KEY_Tab, 0))), 10));
+
+  window = gtk_window_new ();
+  gtk_widget_add_controller (window, controller);
+  gtk_widget_show (window);
+  while (!gtk_widget_get_mapped (window) ||
+         !gdk_surface_get_mapped (gtk_native_get_surface (GTK_NATIVE (window))))
+    g_main_context_iteration (NULL, TRUE);
+
+  check_controller (window, controller);
+
+  /* The index follows changes to the shortcuts */
+  shortcut = g_list_model_get_item (G_LIST_MODEL (controller), 4);
+  gtk_shortcut_controller_remove_shortcut (shortcuts, shortcut);
+  g_object_unref (shortcut);
+  gtk_shortcut_controller_add_shortcut (shortcuts,
+      recording_shortcut_new (gtk_keyval_trigger_new (GDK_KEY_b, 0), 11));
+  check_controller (window, controller);
+
+  shortcut = g_list_model_get_item (G_LIST_MODEL (controller), 0);
+  gtk_shortcut_set_trigger (shortcut, gtk_keyval_trigger_new (GDK_KEY_u, GDK_CONTROL_MASK));
+  g_object_unref (shortcut);
+  check_controller (window, controller);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_array_free (activated, TRUE);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -454,6 +678,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/shortcuts/action/basic", test_action_basic);
   g_test_add_func ("/shortcuts/action/activate", test_action_activate);
   g_test_add_func ("/shortcuts/action/parse", test_action_parse);
+  g_test_add_func ("/shortcuts/controller/index", test_controller_index);
 
   return g_test_run ();
 }
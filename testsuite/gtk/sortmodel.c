@@ -1289,6 +1289,262 @@ sort_column_change (void)
   g_assert (order == GTK_SORT_ASCENDING);
 }
 
+static void
+count_reordered (GtkTreeModel *model,
+                 GtkTreePath  *path,
+                 GtkTreeIter  *iter,
+                 gpointer      new_order,
+                 guint        *counter)
+{
+  (*counter)++;
+}
+
+static void
+check_string_order (GtkTreeModel *sort_model,
+                    GtkSortType   sort_order)
+{
+  GtkTreeIter iter;
+  char *prev = NULL;
+
+  g_assert_true (gtk_tree_model_get_iter_first (sort_model, &iter));
+
+  do
+    {
+      char *value;
+
+      gtk_tree_model_get (sort_model, &iter, 0, &value, -1);
+      if (prev && sort_order == GTK_SORT_ASCENDING)
+        g_assert_cmpint (g_utf8_collate (prev, value), <=, 0);
+      else if (prev)
+        g_assert_cmpint (g_utf8_collate (prev, value), >=, 0);
+
+      g_free (prev);
+      prev = value;
+    }
+  while (gtk_tree_model_iter_next (sort_model, &iter));
+
+  g_free (prev);
+}
+
+static void
+incremental_sort (void)
+{
+  GtkListStore *store;
+  GtkTreeModel *sort_model;
+  GtkTreeIter iter;
+  guint n_reordered = 0;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < 1000; i++)
+    {
+      char *value = g_strdup_printf ("%u", (i * 7919) % 1000);
+
+      gtk_list_store_insert_with_values (store, NULL, -1, 0, value, -1);
+      g_free (value);
+    }
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_model_sort_set_incremental (GTK_TREE_MODEL_SORT (sort_model), TRUE);
+  g_signal_connect (sort_model, "rows-reordered", G_CALLBACK (count_reordered), &n_reordered);
+
+  /* build the toplevel */
+  g_assert_true (gtk_tree_model_get_iter_first (sort_model, &iter));
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  g_assert_cmpuint (n_reordered, ==, 0);
+
+  while (n_reordered == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (n_reordered, ==, 1);
+  check_string_order (sort_model, GTK_SORT_ASCENDING);
+
+  /* Changes to the child model restart the sort */
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_DESCENDING);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "500", -1);
+  while (n_reordered == 1)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (n_reordered, ==, 2);
+  check_string_order (sort_model, GTK_SORT_DESCENDING);
+
+  /* Disabling incremental sorting finishes the pending sort */
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  g_assert_cmpuint (n_reordered, ==, 2);
+  gtk_tree_model_sort_set_incremental (GTK_TREE_MODEL_SORT (sort_model), FALSE);
+  g_assert_cmpuint (n_reordered, ==, 3);
+  check_string_order (sort_model, GTK_SORT_ASCENDING);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
+static void
+count_root_reordered (GtkTreeModel *model,
+                      GtkTreePath  *path,
+                      GtkTreeIter  *iter,
+                      gpointer      new_order,
+                      guint        *counter)
+{
+  if (gtk_tree_path_get_depth (path) == 0)
+    (*counter)++;
+}
+
+/* Counts the comparisons of toplevel rows */
+static int
+counting_sort_func (GtkTreeModel *model,
+                    GtkTreeIter  *a,
+                    GtkTreeIter  *b,
+                    gpointer      user_data)
+{
+  guint *n_compares = user_data;
+  char *value_a, *value_b;
+  int result;
+
+  if (gtk_tree_store_iter_depth (GTK_TREE_STORE (model), a) == 0 &&
+      gtk_tree_store_iter_depth (GTK_TREE_STORE (model), b) == 0)
+    (*n_compares)++;
+
+  gtk_tree_model_get (model, a, 0, &value_a, -1);
+  gtk_tree_model_get (model, b, 0, &value_b, -1);
+  result = g_utf8_collate (value_a, value_b);
+  g_free (value_a);
+  g_free (value_b);
+
+  return result;
+}
+
+/* 2000 toplevel rows, the first 10 of which have 3 children */
+static GtkTreeStore *
+incremental_store_new (void)
+{
+  GtkTreeStore *store;
+  GtkTreeIter iter;
+  guint i, j;
+
+  store = gtk_tree_store_new (2, G_TYPE_STRING, G_TYPE_STRING);
+  for (i = 0; i < 2000; i++)
+    {
+      char *value = g_strdup_printf ("%u", (i * 7919) % 2000);
+
+      gtk_tree_store_insert_with_values (store, &iter, NULL, -1, 0, value, 1, value, -1);
+      for (j = 0; i < 10 && j < 3; j++)
+        gtk_tree_store_insert_with_values (store, NULL, &iter, -1, 0, value, -1);
+
+      g_free (value);
+    }
+
+  return store;
+}
+
+static GtkTreeModel *
+incremental_sort_model_new (GtkTreeStore *store)
+{
+  GtkTreeModel *sort_model;
+  GtkTreeIter iter, child;
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_model_sort_set_incremental (GTK_TREE_MODEL_SORT (sort_model), TRUE);
+
+  /* build the toplevel and the child levels */
+  g_assert_true (gtk_tree_model_get_iter_first (sort_model, &iter));
+  do
+    {
+      if (gtk_tree_model_iter_children (sort_model, &child, &iter))
+        gtk_tree_model_ref_node (sort_model, &child);
+    }
+  while (gtk_tree_model_iter_next (sort_model, &iter));
+
+  return sort_model;
+}
+
+static void
+incremental_sort_changes (void)
+{
+  GtkTreeStore *store;
+  GtkTreeModel *sort_model;
+  GtkTreeIter iter, child;
+  guint n_reordered = 0;
+  guint n_compares = 0, n_full_compares;
+
+  /* Count the comparisons of an undisturbed sort */
+  store = incremental_store_new ();
+  sort_model = incremental_sort_model_new (store);
+  g_signal_connect (sort_model, "rows-reordered", G_CALLBACK (count_root_reordered), &n_reordered);
+  gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (sort_model), 0,
+                                   counting_sort_func, &n_compares, NULL);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  while (n_reordered == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  n_full_compares = n_compares;
+  g_assert_cmpuint (n_full_compares, >, 0);
+  check_string_order (sort_model, GTK_SORT_ASCENDING);
+  g_object_unref (sort_model);
+  g_object_unref (store);
+
+  /* Changes below the toplevel don't restart the sort */
+  store = incremental_store_new ();
+  sort_model = incremental_sort_model_new (store);
+  n_reordered = n_compares = 0;
+  g_signal_connect (sort_model, "rows-reordered", G_CALLBACK (count_root_reordered), &n_reordered);
+  gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (sort_model), 0,
+                                   counting_sort_func, &n_compares, NULL);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  g_main_context_iteration (NULL, FALSE);
+
+  g_assert_true (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+  g_assert_true (gtk_tree_model_iter_children (GTK_TREE_MODEL (store), &child, &iter));
+  gtk_tree_store_set (store, &child, 0, "zzz", -1);
+  gtk_tree_store_insert_with_values (store, NULL, &iter, 0, 0, "aaa", -1);
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &child, &iter, 1));
+  gtk_tree_store_remove (store, &child);
+
+  while (n_reordered == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (n_reordered, ==, 1);
+  g_assert_cmpuint (n_compares, ==, n_full_compares);
+  check_string_order (sort_model, GTK_SORT_ASCENDING);
+  g_object_unref (sort_model);
+
+  /* Toplevel changes are picked up by the sort */
+  sort_model = incremental_sort_model_new (store);
+  n_reordered = 0;
+  g_signal_connect (sort_model, "rows-reordered", G_CALLBACK (count_root_reordered), &n_reordered);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_DESCENDING);
+  g_main_context_iteration (NULL, FALSE);
+
+  /* not the sort column */
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 5));
+  gtk_tree_store_set (store, &iter, 1, "zzz", -1);
+  g_main_context_iteration (NULL, FALSE);
+
+  /* the sort column */
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 6));
+  gtk_tree_store_set (store, &iter, 0, "zzz", -1);
+  g_main_context_iteration (NULL, FALSE);
+
+  gtk_tree_store_remove (store, &iter);
+  gtk_tree_store_insert_with_values (store, NULL, NULL, 0, 0, "~", -1);
+
+  while (n_reordered == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (sort_model, NULL), ==, 2000);
+  check_string_order (sort_model, GTK_SORT_DESCENDING);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
 /* main */
 
 void
@@ -1317,6 +1573,10 @@ register_sort_model_tests (void)
                    rows_reordered_two_levels);
   g_test_add_func ("/TreeModelSort/sorted-insert",
                    sorted_insert);
+  g_test_add_func ("/TreeModelSort/incremental",
+                   incremental_sort);
+  g_test_add_func ("/TreeModelSort/incremental-sort-changes",
+                   incremental_sort_changes);
 
   g_test_add_func ("/TreeModelSort/specific/bug-300089",
                    specific_bug_300089);
@@ -242,6 +242,61 @@ test_take (void)
   g_object_unref (list);
 }
 
+static void
+test_create_bytes (void)
+{
+  GtkStringList *list;
+  GBytes *bytes;
+
+  bytes = g_bytes_new_static ("a\nbb\n\nccc\n", 11);
+  list = gtk_string_list_new_from_bytes (bytes);
+  g_bytes_unref (bytes);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 4);
+  g_assert_cmpstr (gtk_string_list_get_string (list, 2), ==, "");
+  assert_model (list, "a bb  ccc");
+
+  gtk_string_list_append (list, "dddd");
+  gtk_string_list_remove (list, 0);
+  assert_model (list, "bb  ccc dddd");
+
+  g_object_unref (list);
+
+  bytes = g_bytes_new_static ("no newline", 10);
+  list = gtk_string_list_new_from_bytes (bytes);
+  g_bytes_unref (bytes);
+
+  assert_model (list, "no newline");
+
+  g_object_unref (list);
+}
+
+static void
+test_get_item (void)
+{
+  GtkStringList *list;
+  GtkStringObject *obj, *obj2;
+
+  list = gtk_string_list_new ((const char *[]) { "a", "b", "c", NULL });
+
+  obj = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  obj2 = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_true (obj == obj2);
+  g_object_unref (obj2);
+
+  /* objects keep their string when it is removed from the list */
+  gtk_string_list_splice (list, 0, 3, (const char *[]) { "b", NULL });
+  g_assert_cmpstr (gtk_string_object_get_string (obj), ==, "b");
+
+  obj2 = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_true (obj != obj2);
+  g_object_unref (obj2);
+
+  g_object_unref (list);
+  g_assert_cmpstr (gtk_string_object_get_string (obj), ==, "b");
+  g_object_unref (obj);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -253,10 +308,12 @@ main (int argc, char *argv[])
   g_test_add_func ("/stringlist/create/empty", test_create_empty);
   g_test_add_func ("/stringlist/create/strv", test_create_strv);
   g_test_add_func ("/stringlist/create/builder", test_create_builder);
+  g_test_add_func ("/stringlist/create/bytes", test_create_bytes);
   g_test_add_func ("/stringlist/get_string", test_get_string);
   g_test_add_func ("/stringlist/splice", test_splice);
   g_test_add_func ("/stringlist/add_remove", test_add_remove);
   g_test_add_func ("/stringlist/take", test_take);
+  g_test_add_func ("/stringlist/get_item", test_get_item);
 
   return g_test_run ();
 }
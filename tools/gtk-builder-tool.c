@@ -39,6 +39,7 @@ usage (void)
              "  simplify     Simplify the file\n"
              "  enumerate    List all named objects\n"
              "  preview      Preview the file\n"
+             "  compile      Compile the file to binary form\n"
              "\n"
              "Simplify Options:\n"
              "  --replace    Replace the file\n"
@@ -48,6 +49,9 @@ usage (void)
              "  --id=ID      Preview only the named object\n"
              "  --css=FILE   Use style from CSS file\n"
              "\n"
+             "Compile Options:\n"
+             "  --output=FILE  Write to FILE instead of stdout\n"
+             "\n"
              "Perform various tasks on GtkBuilder .ui files.\n"));
   exit (1);
 }
@@ -134,6 +138,8 @@ main (int argc, const char *argv[])
     do_enumerate (&argc, &argv);
   else if (strcmp (argv[0], "preview") == 0)
     do_preview (&argc, &argv);
+  else if (strcmp (argv[0], "compile") == 0)
+    do_compile (&argc, &argv);
   else
     usage ();
 